@@ -16,7 +16,10 @@
 //
 //	Description:  Implementation of Histo class 
 //
+#include <cassert>
 #include <vapor/MyBase.h>
+#include <vapor/DataMgr.h>
+#include <vapor/DataMgrUtils.h>
 #include "Histo.h"
 using namespace VAPoR;
 using namespace Wasp;
@@ -120,6 +123,14 @@ void Histo::addToBin(float val) {
 	}
 }
 	
+void Histo::copyBins(const Histo &rhs) {
+	assert(rhs._numBins == _numBins);
+
+	for (int i = 0; i< _numBins; i++) _binArray[i] = rhs._binArray[i];
+	_numBelow = rhs._numBelow;
+	_numAbove = rhs._numAbove;
+}
+
 int Histo::getMaxBinSize()
 {
     int maxBinSize = 0;
@@ -130,3 +141,127 @@ int Histo::getMaxBinSize()
     
     return maxBinSize;
 }
+
+HistoBuilder::HistoBuilder() {
+	_cancel = false;
+	_result = NULL;
+	_passesDone = 0;
+	_passesPolled = 0;
+	_done = false;
+	_failed = false;
+}
+
+HistoBuilder::~HistoBuilder() {
+	Cancel();
+}
+
+void HistoBuilder::Start(
+	DataMgr *dataMgr, size_t ts, string varname, int refLevel, int lod,
+	const vector <double> &minExts, const vector <double> &maxExts,
+	const Histo &histo
+) {
+	Cancel();
+
+	_result = new Histo(
+		histo.getNumBins(), histo.getMinData(), histo.getMaxData(), "", 0
+	);
+	_passesDone = 0;
+	_passesPolled = 0;
+	_done = false;
+	_failed = false;
+	_cancel = false;
+
+	_thread = std::thread(
+		&HistoBuilder::_run, this, dataMgr, ts, varname, refLevel, lod,
+		minExts, maxExts
+	);
+}
+
+void HistoBuilder::Cancel() {
+	_cancel = true;
+	if (_thread.joinable()) _thread.join();
+
+	if (_result) delete _result;
+	_result = NULL;
+}
+
+bool HistoBuilder::Poll(Histo &histo, bool &done) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	done = _done;
+	if (! _result || _passesDone == _passesPolled) return(false);
+
+	histo.copyBins(*_result);
+	_passesPolled = _passesDone;
+	return(true);
+}
+
+bool HistoBuilder::Failed() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	return(_failed);
+}
+
+bool HistoBuilder::_bin(
+	const Grid *grid, const vector <double> &minExts,
+	const vector <double> &maxExts, Histo &histo
+) {
+	float mv = grid->GetMissingValue();
+
+	Grid::ConstIterator itr = grid->cbegin(minExts, maxExts);
+	Grid::ConstIterator enditr = grid->cend();
+	for (size_t n=1; itr!=enditr; ++itr, n++) {
+		if ((n & 0xffff) == 0 && _cancel) return(false);
+
+		float v = *itr;
+		if (v != mv) histo.addToBin(v);
+	}
+	return(true);
+}
+
+void HistoBuilder::_run(
+	DataMgr *dataMgr, size_t ts, string varname, int refLevel, int lod,
+	vector <double> minExts, vector <double> maxExts
+) {
+
+	// The first pass reads the coarsest refinement level and
+	// compression, which is cheap to read and bin. The second pass
+	// rebins from scratch at the requested accuracy
+	//
+	vector <pair <int, int> > passes;
+	passes.push_back(make_pair(0, 0));
+	if (refLevel != 0 || lod != 0) passes.push_back(make_pair(refLevel, lod));
+
+	for (int pass=0; pass<passes.size(); pass++) {
+		if (_cancel) return;
+
+		int level = passes[pass].first;
+		int l = passes[pass].second;
+
+		Grid *grid = NULL;
+		int rc = DataMgrUtils::GetGrids(
+			dataMgr, ts, varname, minExts, maxExts, true, &level, &l, &grid
+		);
+		if (rc < 0) {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_failed = true;
+			_done = true;
+			return;
+		}
+
+		Histo work(
+			_result->getNumBins(), _result->getMinData(), 
+			_result->getMaxData(), "", 0
+		);
+		bool ok = _bin(grid, minExts, maxExts, work);
+
+		dataMgr->UnlockGrid(grid);
+		delete grid;
+
+		if (! ok) return;
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_result->copyBins(work);
+		_passesDone++;
+		_done = pass == passes.size()-1;
+	}
+}
@@ -20,9 +20,16 @@
 //
 #ifndef HISTO_H
 #define HISTO_H
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <vapor/MyBase.h>
 #include <vapor/StructuredGrid.h>
 
+namespace VAPoR {
+class DataMgr;
+}
+
 
 class Histo{
 public:
@@ -37,10 +44,16 @@ public:
 	void reset(int newNumBins = -1);
 	void reset(int newNumBins, float mnData, float mxData);
 	void addToBin(float val);	
+
+	//! Replace the bin counts with those of \p rhs, which must have
+	//! the same number of bins
+	//
+	void copyBins(const Histo &rhs);
 	int getMaxBinSize(); 
 	int getBinSize(int posn) {return _binArray[posn];}
-	float getMinData(){return _minData;}
-	float getMaxData(){return _maxData;}
+	int getNumBins() const {return _numBins;}
+	float getMinData() const {return _minData;}
+	float getMaxData() const {return _maxData;}
 	
 	int getTimestepOfUpdate() {return _timestepOfUpdate;}
 	string getVarnameOfUpdate() {return _varnameOfUpdate;}
@@ -58,5 +71,84 @@ private:
 	string _varnameOfUpdate;
 };
 
+//! \class HistoBuilder
+//!
+//! Populates a Histo on a background thread so that the GUI isn't
+//! blocked while large volumes are read and binned. Both the DataMgr
+//! read and the binning happen on the worker. The histogram is built 
+//! progressively: the first pass reads the variable at the coarsest
+//! refinement level and compression, so a rough histogram is available
+//! almost immediately, and the second pass rebins from the requested
+//! level. Poll() copies the most recent complete pass into the caller's
+//! Histo.
+//!
+//! The DataMgr must remain valid until Poll() reports that the build
+//! is done, or Cancel() has been called.
+//
+class HistoBuilder {
+public:
+	HistoBuilder();
+	~HistoBuilder();
+
+	//! Begin building a histogram of \p varname at time step \p ts
+	//! in the background, restricted to the box given by \p minExts 
+	//! and \p maxExts. \p refLevel and \p lod give the accuracy of the
+	//! final pass, and are lowered if the data aren't available at that
+	//! accuracy. Any build in progress is cancelled first. The bin 
+	//! count and data range are taken from \p histo, which is not 
+	//! otherwise accessed.
+	//
+	void Start(
+		VAPoR::DataMgr *dataMgr, size_t ts, std::string varname,
+		int refLevel, int lod, const std::vector <double> &minExts,
+		const std::vector <double> &maxExts, const Histo &histo
+	);
+
+	//! Stop the current build, if any, and wait for the worker to exit.
+	//! If the worker is reading data this waits for the read to finish.
+	//
+	void Cancel();
+
+	//! Copy the latest result into \p histo
+	//!
+	//! \param[out] done Set to true if the final pass has completed,
+	//! or the build failed
+	//! \retval updated True if \p histo was changed
+	//
+	bool Poll(Histo &histo, bool &done);
+
+	//! Returns true if the data could not be read. Only meaningful
+	//! once Poll() has reported that the build is done
+	//
+	bool Failed();
+
+	bool IsRunning() const {return(_thread.joinable());}
+
+private:
+	std::thread _thread;
+	std::mutex _mutex;
+	std::atomic <bool> _cancel;
+
+	Histo *_result;		// latest completed pass, guarded by _mutex
+	int _passesDone;	// guarded by _mutex
+	int _passesPolled;
+	bool _done;			// guarded by _mutex
+	bool _failed;		// guarded by _mutex
+
+	void _run(
+		VAPoR::DataMgr *dataMgr, size_t ts, std::string varname,
+		int refLevel, int lod, std::vector <double> minExts,
+		std::vector <double> maxExts
+	);
+
+	// Bin the values of \p grid within the box into \p histo. Returns
+	// false if cancelled
+	//
+	bool _bin(
+		const VAPoR::Grid *grid, const std::vector <double> &minExts,
+		const std::vector <double> &maxExts, Histo &histo
+	);
+};
+
 #endif //HISTO_H
 
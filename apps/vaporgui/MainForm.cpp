@@ -406,6 +406,11 @@ MainForm::~MainForm()
 
 	if (_modeStatusWidget) delete _modeStatusWidget;
     if (_banner) delete _banner;
+
+	// The data managers go with the control executive; stop any 
+	// histogram builds reading from them first
+	//
+	MappingFrame::CancelHistograms(NULL);
 	if (_controlExec) delete _controlExec;
 	
     // no need to delete child widgets, Qt does it all for us?? (see closeEvent)
@@ -1303,6 +1308,11 @@ void MainForm::closeDataHelper(string dataSetName) {
 
 	p->RemoveOpenDateSet(dataSetName);
 
+	// Stop histogram builds still reading from the data set's DataMgr
+	//
+	DataMgr *dataMgr = _controlExec->GetDataStatus()->GetDataMgr(dataSetName);
+	if (dataMgr) MappingFrame::CancelHistograms(dataMgr);
+
 	_controlExec->CloseData(dataSetName);
 }
 
@@ -1329,6 +1339,13 @@ bool MainForm::openDataHelper(
 	}
 #endif
 
+	// Reopening a data set replaces its DataMgr
+	//
+	DataMgr *oldDataMgr = _controlExec->GetDataStatus()->GetDataMgr(
+		dataSetName
+	);
+	if (oldDataMgr) MappingFrame::CancelHistograms(oldDataMgr);
+
 	// Open the data set
 	//
 	int rc = _controlExec->OpenData(
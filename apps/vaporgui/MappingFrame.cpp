@@ -26,6 +26,7 @@
 #include <QContextMenuEvent>
 #include <QMouseEvent>
 #include <QToolTip>
+#include <QTimer>
 
 #include <vapor/ControlExecutive.h>
 #include <vapor/DataMgrUtils.h>
@@ -82,6 +83,8 @@ void oglPopState() {
 
 };
 
+std::set <MappingFrame *> MappingFrame::_frames;
+
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
@@ -90,6 +93,9 @@ MappingFrame::MappingFrame(QWidget* parent)
     _NUM_BINS(256),
     _mapper(NULL),
     _histogram(NULL),
+    _histoBuilder(new HistoBuilder()),
+    _histoTimer(new QTimer(this)),
+    _histoDataMgr(NULL),
     _opacityMappingEnabled(false),
     _colorMappingEnabled(false),
 	_isoSliderEnabled(false),
@@ -145,6 +151,8 @@ MappingFrame::MappingFrame(QWidget* parent)
   initWidgets();
   initConnections();
   setMouseTracking(true);
+
+  _frames.insert(this);
 }
 
 //----------------------------------------------------------------------------
@@ -152,6 +160,10 @@ MappingFrame::MappingFrame(QWidget* parent)
 //----------------------------------------------------------------------------
 MappingFrame::~MappingFrame()
 {
+  _frames.erase(this);
+  cancelHistogram();
+  delete _histoBuilder;
+
 	for (int i = 0; i<_isolineSliders.size(); i++) delete _isolineSliders[i];
   makeCurrent();
 
@@ -222,6 +234,12 @@ void MappingFrame::RefreshHistogram(bool force)
     if (!force && skipRefreshHistogram()) 
             return;
 
+    // Abandon any histogram still being built, e.g. for the variable 
+    // the user just switched away from
+    //
+    cancelHistogram();
+    _histogram = _histogramMap[rendererName];
+
     string var;
     var = _rParams->GetColorMapVariableName();
     MapperFunction* mf = _rParams->GetMapperFunc(var);
@@ -233,10 +251,9 @@ void MappingFrame::RefreshHistogram(bool force)
     if (_histogram) 
         delete _histogram;
     _histogram = new Histo(256, minRange, maxRange, var, ts);
+    _histogramMap[rendererName] = _histogram;
 
     populateHistogram();
-    
-    _histogramMap[rendererName] = _histogram;
 }
 
 void MappingFrame::populateHistogram() {
@@ -248,26 +265,77 @@ void MappingFrame::populateHistogram() {
 	vector<double> minExts, maxExts;
 	_rParams->GetBox()->GetExtents(minExts, maxExts);
 
-	Grid* grid;
-
-	int rc = DataMgrUtils::GetGrids(
-		_dataMgr, ts, var, minExts, maxExts, true,
-		&refLevel, &lod, &grid
+	// The data are read and binned on a worker thread, coarsest level
+	// first. pollHistogram() picks up each pass as it completes
+	//
+	_histoDataMgr = _dataMgr;
+	_histoRendererName = getActiveRendererName();
+	_histoBuilder->Start(
+		_dataMgr, ts, var, refLevel, lod, minExts, maxExts, *_histogram
 	);
-	if (rc < 0) {
+	_histoTimer->start(100);
+}
+
+void MappingFrame::pollHistogram() {
+	if (! _histoDataMgr) {
+		_histoTimer->stop();
+		return;
+	}
+
+	map<string, Histo*>::iterator itr;
+	itr = _histogramMap.find(_histoRendererName);
+	if (itr == _histogramMap.end() || ! itr->second) {
+		cancelHistogram();
+		return;
+	}
+
+	bool done;
+	if (_histoBuilder->Poll(*itr->second, done) && itr->second == _histogram) {
+		_updateTexture = true;
+		updateGL();
+	}
+	if (! done) return;
+
+	if (_histoBuilder->Failed()) {
+		cancelHistogram();
 		MSG_ERR("Couldn't get data for Histogram");
 		return;
 	}
 
-	float v;
-	Grid::Iterator itr;
-	Grid::Iterator enditr = grid->end();
-	for (itr = grid->begin(minExts, maxExts); itr!=enditr; ++itr){
-		v = *itr;
-		if (v==grid->GetMissingValue()) continue;
-		_histogram->addToBin(v);
+	_histoTimer->stop();
+	_histoBuilder->Cancel();
+	_histoDataMgr = NULL;
+}
+
+void MappingFrame::cancelHistogram() {
+	if (! _histoDataMgr) return;
+
+	_histoTimer->stop();
+	_histoBuilder->Cancel();
+
+	// A partially built histogram must not be mistaken for a complete
+	// one, so discard it. It will be rebuilt when next needed.
+	//
+	map<string, Histo*>::iterator itr;
+	itr = _histogramMap.find(_histoRendererName);
+	if (itr != _histogramMap.end()) {
+		if (itr->second == _histogram) _histogram = NULL;
+		if (itr->second) delete itr->second;
+		_histogramMap.erase(itr);
+	}
+
+	_histoDataMgr = NULL;
+}
+
+void MappingFrame::CancelHistograms(const DataMgr *dataMgr) {
+	std::set <MappingFrame *>::iterator itr;
+	for (itr = _frames.begin(); itr != _frames.end(); ++itr) {
+		MappingFrame *frame = *itr;
+		if (! frame->_histoDataMgr) continue;
+		if (dataMgr && frame->_histoDataMgr != dataMgr) continue;
+
+		frame->cancelHistogram();
 	}
-	delete grid;
 }
 
 //----------------------------------------------------------------------------
@@ -423,6 +491,13 @@ void MappingFrame::Update(DataMgr *dataMgr,
 		_initialized = true;
 		RefreshHistogram();
 	}
+	else if (_histoDataMgr && _histoDataMgr != _dataMgr) {
+
+		// The build in progress reads from another data manager
+		//
+		cancelHistogram();
+		RefreshHistogram(true);
+	}
 
 	_minValue = getMinEditBound();
 	_maxValue = getMaxEditBound();
@@ -850,6 +925,8 @@ void MappingFrame::initWidgets()
 //----------------------------------------------------------------------------
 void MappingFrame::initConnections()
 {
+  connect(_histoTimer, SIGNAL(timeout()), this, SLOT(pollHistogram()));
+
   connect(_addOpacityControlPointAction, SIGNAL(triggered()), 
           this, SLOT(addOpacityControlPoint()));
 
@@ -1314,6 +1391,10 @@ void MappingFrame::updateTexture()
 		switch (_histogramScale) {
 		case LINEAR:
 		{
+			// Nothing may have been binned yet if the histogram is 
+			// still being built
+			//
+			if (_histogram->getMaxBinSize() == 0) break;
 			binValue = MIN(1.0, (stretch * _histogram->getBinSize(x) / 
 			   _histogram->getMaxBinSize()));
 			break;
@@ -1321,6 +1402,7 @@ void MappingFrame::updateTexture()
 
 		case LOG:
 		{
+			if (_histogram->getMaxBinSize() <= 1) break;
 			binValue = logf(stretch * _histogram->getBinSize(x)) / 
 			logf(_histogram->getMaxBinSize());
 			break;
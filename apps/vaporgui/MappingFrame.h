@@ -50,6 +50,8 @@ class QTabWidget;
 class OpacityWidget;
 class GLColorbarWidget;
 class Histo;
+class HistoBuilder;
+class QTimer;
 class DomainWidget;
 class ContourRangeSlider;
 class IsoSlider;
@@ -109,6 +111,18 @@ public:
   virtual ~MappingFrame();
 
   void RefreshHistogram(bool force=false);
+
+  //! Stop histogram builds that are reading from a data manager
+  //!
+  //! Background histogram builds read from a DataMgr on a worker
+  //! thread. This must be called before that DataMgr is destroyed: it
+  //! cancels the builds of every MappingFrame that use \p dataMgr
+  //! and waits for their workers to exit.
+  //!
+  //! \param[in] dataMgr The data manager about to be destroyed, or NULL
+  //! to stop every build
+  //
+  static void CancelHistograms(const VAPoR::DataMgr *dataMgr);
  
   //! Enable or disable the color mapping in the Transfer Function.
   //! Should be specified in the RenderEventRouter constructor
@@ -214,6 +228,7 @@ private:
   void updateHistogram();
   string getActiveRendererName() const;
   void populateHistogram();
+  void cancelHistogram();
   
 protected slots:
   void setEditMode(bool);
@@ -225,6 +240,7 @@ protected slots:
   void newHsv(int h, int s, int v);
   void bindColorToOpacity();
   void bindOpacityToColor();
+  void pollHistogram();
   
 
 signals:
@@ -325,6 +341,19 @@ private:
   Histo          *_histogram;
   map<string, Histo*> _histogramMap;
 
+  // Histograms are populated in the background. _histoDataMgr is the
+  // data manager being read, and is non-NULL while a build is active
+  //
+  HistoBuilder   *_histoBuilder;
+  QTimer         *_histoTimer;
+  VAPoR::DataMgr *_histoDataMgr;
+  string          _histoRendererName;
+
+  // Every MappingFrame in existence, so that builds can be cancelled
+  // when a data set is closed
+  //
+  static std::set <MappingFrame *> _frames;
+
   bool            _opacityMappingEnabled;
   bool            _colorMappingEnabled;
   bool			  _isoSliderEnabled;
@@ -26,6 +26,7 @@
 #include <QMouseEvent>
 #include <QCloseEvent>
 #include <QIcon>
+#include <QDir>
 #include <vapor/ControlExecutive.h>
 #include <vapor/ViewpointParams.h>
 #include <vapor/Viewpoint.h>
@@ -75,6 +76,16 @@ VizWin::VizWin(
     _glManager->shaderManager->SetResourceDirectory(shaderPath); // TODO GL
     _glManager->fontManager->SetResourceDirectory(fontPath); // TODO GL
 
+	// Keep linked shader programs between sessions so that renderers
+	// don't pay GLSL compilation on their first frame
+	//
+	QString shaderCache = QDir::homePath() + "/.vapor3_shader_cache";
+	if (QDir().mkpath(shaderCache)) {
+		_glManager->shaderManager->SetBinaryCacheDirectory(
+			shaderCache.toStdString()
+		);
+	}
+
 	setAutoBufferSwap(false);
 	_mouseClicked = false;
 	_buttonNum = 0;
@@ -25,8 +25,10 @@
 #include <qfont.h>
 #include <QMessageBox>
 #include <QFontDatabase>
+#include <QDir>
 #include "BannerGUI.h"
 #include "vapor/GetAppPath.h"
+#include "vapor/NetCDFCollection.h"
 //#include "StartupParams.h"
 #ifdef WIN32
 #include "Windows.h"
@@ -151,6 +153,14 @@ if (getenv("VAPOR_DEBUG"))
 	app = &a;
 	a.setPalette(QPalette(QColor(233,236,216), QColor(233,236,216)));
 
+	// Catalog the metadata of netCDF files, so that large collections
+	// reopen quickly in later sessions
+	//
+	QString catalogDir = QDir::homePath() + "/.vapor3_netcdf_catalog";
+	if (QDir().mkpath(catalogDir)) {
+		NetCDFCollection::SetCatalogDirectory(catalogDir.toStdString());
+	}
+
 	vector<QString> files;
 	for (int i=1; i<argc; i++) {
 		files.push_back(argv[i]);
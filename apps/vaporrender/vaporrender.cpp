@@ -0,0 +1,433 @@
+//************************************************************************
+//									*
+//		     Copyright (C)  2018				*
+//     University Corporation for Atmospheric Research			*
+//		     All Rights Reserved				*
+//									*
+//************************************************************************/
+//
+//	File:		vaporrender.cpp
+//
+//	Description:	Render a range of time steps from a VAPOR session
+//			file without a window system. Rendering is done
+//			with an OSMesa context, so frames can be produced
+//			on CPU-only batch nodes. The time step range may
+//			be split across several worker processes.
+//
+#include <vapor/glutil.h>	// Must be included first!!!
+#include <GL/osmesa.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/GetAppPath.h>
+#include <vapor/ControlExecutive.h>
+#include <vapor/ParamsMgr.h>
+#include <vapor/DataStatus.h>
+#include <vapor/ViewpointParams.h>
+#include <vapor/RenderParams.h>
+#include <vapor/GLManager.h>
+#include <vapor/LegacyGL.h>
+#include <vapor/NetCDFCollection.h>
+#include <vapor/FileUtils.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+struct opt_t {
+	string	session;
+	string	format;
+	string	name;
+	string	win;
+	string	output;
+	string	shadercache;
+	string	catalog;
+	int	ts0;
+	int	ts1;
+	int	width;
+	int	height;
+	int	nprocs;
+	int	rank;
+	int	nranks;
+	int	nthreads;
+	int	cache;
+	int	maxfiles;
+	int	chunksize;
+	OptionParser::Boolean_T	precompile;
+	OptionParser::Boolean_T	quiet;
+	OptionParser::Boolean_T	debug;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"session",	1, 	"",	"VAPOR session file (.vs3) to render"},
+	{"format",	1, 	"vdc",	"Data set format (vdc, wrf, cf, mpas)"},
+	{"name",	1, 	"",	"Data set name used in the session file. "
+		"Defaults to the name of the first data file"},
+	{"win",		1, 	"",	"Visualizer to render. Defaults to the first "
+		"visualizer in the session file"},
+	{"output",	1, 	"frame.png",	"Output file. The time step is "
+		"inserted before the file extension. The extension selects the "
+		"image format (.png, .jpg or .tif)"},
+	{"ts0",		1, 	"0",	"First time step to render"},
+	{"ts1",		1, 	"-1",	"Last time step to render. A negative value "
+		"selects the last time step"},
+	{"width",	1, 	"0",	"Image width. Defaults to the window width "
+		"stored in the session file"},
+	{"height",	1, 	"0",	"Image height. Defaults to the window height "
+		"stored in the session file"},
+	{"nprocs",	1, 	"1",	"Number of worker processes to fork on this "
+		"host"},
+	{"rank",	1, 	"0",	"Index of this host when the time step range "
+		"is split across nranks hosts (e.g. with a batch job array)"},
+	{"nranks",	1, 	"1",	"Number of hosts the time step range is split "
+		"across"},
+	{"nthreads",	1, 	"0",	"Number of data threads per worker. A value "
+		"of 0 divides the available cores between the workers"},
+	{"cache",	1, 	"1000",	"Data cache size per worker, in MBs"},
+	{"shadercache",	1, 	"",	"Directory in which to cache linked shader "
+		"programs between runs"},
+	{"catalog",	1, 	"",	"Directory in which to catalog the metadata "
+		"of netCDF files, so that large collections reopen quickly"},
+	{"maxfiles",	1, 	"64",	"Maximum number of netCDF files held open "
+		"at once by each worker. A value of 0 removes the limit"},
+	{"chunksize",	1, 	"4096",	"Size, in KBs, of the I/O buffer allocated "
+		"for each open netCDF file. Smaller values bound memory use when "
+		"time steps span many files"},
+	{"precompile",	0,	"",	"Build all shader programs before rendering "
+		"the first frame"},
+	{"quiet",	0,	"",	"Operate quietly"},
+	{"debug",	0,	"",	"Print diagnostic messages"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"session", Wasp::CvtToCPPStr, &opt.session, sizeof(opt.session)},
+	{"format", Wasp::CvtToCPPStr, &opt.format, sizeof(opt.format)},
+	{"name", Wasp::CvtToCPPStr, &opt.name, sizeof(opt.name)},
+	{"win", Wasp::CvtToCPPStr, &opt.win, sizeof(opt.win)},
+	{"output", Wasp::CvtToCPPStr, &opt.output, sizeof(opt.output)},
+	{"ts0", Wasp::CvtToInt, &opt.ts0, sizeof(opt.ts0)},
+	{"ts1", Wasp::CvtToInt, &opt.ts1, sizeof(opt.ts1)},
+	{"width", Wasp::CvtToInt, &opt.width, sizeof(opt.width)},
+	{"height", Wasp::CvtToInt, &opt.height, sizeof(opt.height)},
+	{"nprocs", Wasp::CvtToInt, &opt.nprocs, sizeof(opt.nprocs)},
+	{"rank", Wasp::CvtToInt, &opt.rank, sizeof(opt.rank)},
+	{"nranks", Wasp::CvtToInt, &opt.nranks, sizeof(opt.nranks)},
+	{"nthreads", Wasp::CvtToInt, &opt.nthreads, sizeof(opt.nthreads)},
+	{"cache", Wasp::CvtToInt, &opt.cache, sizeof(opt.cache)},
+	{"shadercache", Wasp::CvtToCPPStr, &opt.shadercache, sizeof(opt.shadercache)},
+	{"catalog", Wasp::CvtToCPPStr, &opt.catalog, sizeof(opt.catalog)},
+	{"maxfiles", Wasp::CvtToInt, &opt.maxfiles, sizeof(opt.maxfiles)},
+	{"chunksize", Wasp::CvtToInt, &opt.chunksize, sizeof(opt.chunksize)},
+	{"precompile", Wasp::CvtToBoolean, &opt.precompile, sizeof(opt.precompile)},
+	{"quiet", Wasp::CvtToBoolean, &opt.quiet, sizeof(opt.quiet)},
+	{"debug", Wasp::CvtToBoolean, &opt.debug, sizeof(opt.debug)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// Insert the zero padded time step before the extension of \p path
+//
+string frameFileName(string path, size_t ts) {
+	string ext;
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of('/');
+	if (dot != string::npos && (slash == string::npos || dot > slash)) {
+		ext = path.substr(dot);
+		path = path.substr(0, dot);
+	}
+
+	ostringstream oss;
+	oss << path << setfill('0') << setw(4) << ts << ext;
+	return(oss.str());
+}
+
+// Set the current time step of every RenderParams instance on the
+// visualizer, mapping the global time step to each data set's local
+// time step
+//
+void setCurrentTimestep(ControlExec *ce, string winName, size_t ts) {
+	DataStatus *dataStatus = ce->GetDataStatus();
+	ParamsMgr *paramsMgr = ce->GetParamsMgr();
+
+	vector <string> dataSetNames = dataStatus->GetDataMgrNames();
+	for (int i=0; i<dataSetNames.size(); i++) {
+		vector <RenderParams *> rParams;
+		paramsMgr->GetRenderParams(winName, dataSetNames[i], rParams);
+
+		size_t local_ts = dataStatus->MapGlobalToLocalTimeStep(
+			dataSetNames[i], ts
+		);
+		for (int j=0; j<rParams.size(); j++) {
+			rParams[j]->SetCurrentTimestep(local_ts);
+		}
+	}
+}
+
+// Render every time step in [opt.ts0, opt.ts1] that is assigned to
+// \p worker. Time steps are dealt out round robin so that workers
+// finish at about the same time even if the cost of a frame varies
+// over the sequence.
+//
+int render(const vector <string> &files, int worker, int nworkers) {
+
+	ControlExec *ce = new ControlExec(
+		vector <string> (), vector <string> (), opt.cache, opt.nthreads
+	);
+
+	if (ce->LoadState(opt.session) < 0) {
+		cerr << ProgName << " : failed to load session " << opt.session << endl;
+		return(-1);
+	}
+	ce->SetSaveStateEnabled(false);
+
+	ParamsMgr *paramsMgr = ce->GetParamsMgr();
+
+	string winName = opt.win;
+	if (winName.empty()) {
+		vector <string> winNames = paramsMgr->GetVisualizerNames();
+		if (winNames.empty()) {
+			cerr << ProgName << " : session has no visualizers" << endl;
+			return(-1);
+		}
+		winName = winNames[0];
+	}
+
+	ViewpointParams *vpParams = paramsMgr->GetViewpointParams(winName);
+	if (! vpParams) {
+		cerr << ProgName << " : invalid visualizer " << winName << endl;
+		return(-1);
+	}
+
+	size_t width, height;
+	vpParams->GetWindowSize(width, height);
+	if (opt.width > 0) width = opt.width;
+	if (opt.height > 0) height = opt.height;
+	if (! width || ! height) {
+		cerr << ProgName << " : image size not specified" << endl;
+		return(-1);
+	}
+	vpParams->SetWindowSize(width, height);
+
+	// The context must be current before any GL resources are created
+	//
+	const int attribs[] = {
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, 3,
+		OSMESA_CONTEXT_MINOR_VERSION, 3,
+		0
+	};
+	OSMesaContext context = OSMesaCreateContextAttribs(attribs, NULL);
+	if (! context) {
+		cerr << ProgName << " : failed to create OSMesa context" << endl;
+		return(-1);
+	}
+
+	vector <unsigned char> framebuffer(width * height * 4);
+	if (! OSMesaMakeCurrent(
+		context, framebuffer.data(), GL_UNSIGNED_BYTE, width, height
+	)) {
+		cerr << ProgName << " : failed to make OSMesa context current" << endl;
+		OSMesaDestroyContext(context);
+		return(-1);
+	}
+	glewExperimental = GL_TRUE;
+
+	GLManager *glManager = new GLManager;
+	vector <string> paths;
+	paths.push_back("shaders");
+	glManager->shaderManager->SetResourceDirectory(
+		GetAppPath("VAPOR", "share", paths)
+	);
+	paths.clear();
+	paths.push_back("fonts");
+	glManager->fontManager->SetResourceDirectory(
+		GetAppPath("VAPOR", "share", paths)
+	);
+
+	int rc = 0;
+	if (! opt.shadercache.empty()) {
+		rc = glManager->shaderManager->SetBinaryCacheDirectory(
+			opt.shadercache
+		) < 0 ? -1 : 0;
+	}
+
+	if (rc == 0) {
+		rc = ce->InitializeViz(winName, glManager);
+	}
+	if (rc == 0) {
+		glManager->legacy->Initialize();
+		rc = ce->ResizeViz(winName, width, height);
+		glViewport(0, 0, width, height);
+	}
+	if (rc == 0 && opt.precompile) {
+		rc = glManager->shaderManager->PrecompileShaders() < 0 ? -1 : 0;
+	}
+
+	string dataSetName = opt.name;
+	if (dataSetName.empty()) {
+		dataSetName = ControlExec::MakeStringConformant(Basename(files[0]));
+	}
+
+	vector <string> options = {"-project_to_pcs", "-vertical_xform"};
+	if (rc == 0) {
+		rc = ce->OpenData(files, options, dataSetName, opt.format);
+	}
+
+	size_t nts = 0;
+	if (rc == 0) {
+		nts = ce->GetDataStatus()->GetTimeCoordinates().size();
+		if (nts == 0) {
+			cerr << ProgName << " : data has no time steps" << endl;
+			rc = -1;
+		}
+	}
+
+	if (rc == 0) {
+		size_t ts1 = opt.ts1 < 0 || opt.ts1 >= nts ? nts - 1 : opt.ts1;
+
+		for (size_t ts = opt.ts0 + worker; ts <= ts1; ts += nworkers) {
+			setCurrentTimestep(ce, winName, ts);
+
+			string file = frameFileName(opt.output, ts);
+			if (ce->EnableImageCapture(file, winName) < 0) {
+				rc = -1;
+				break;
+			}
+			if (! opt.quiet) {
+				cout << ProgName << " : wrote " << file << endl;
+			}
+		}
+	}
+
+	// Renderers and Visualizers release GL resources on destruction, so
+	// they must go away while the context is still current
+	//
+	delete ce;
+	delete glManager;
+	OSMesaDestroyContext(context);
+
+	return(rc);
+}
+
+int	main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = Basename(argv[0]);
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] -session file datafiles..." << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (argc < 2 || opt.session.empty()) {
+		cerr << "Usage: " << ProgName << " [options] -session file datafiles..." << endl;
+		op.PrintOptionHelp(stderr);
+		exit(1);
+	}
+
+	if (opt.debug) {
+		MyBase::SetDiagMsgFilePtr(stderr);
+	}
+
+	if (opt.nprocs < 1 || opt.nranks < 1 || opt.rank < 0 ||
+		opt.rank >= opt.nranks || opt.ts0 < 0) {
+
+		cerr << ProgName << " : invalid worker or time step specification" << endl;
+		exit(1);
+	}
+
+	// Don't oversubscribe the host's cores when running several workers
+	//
+	if (opt.nthreads == 0 && opt.nprocs > 1) {
+		long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+		opt.nthreads = ncores > opt.nprocs ? ncores / opt.nprocs : 1;
+	}
+
+	if (! opt.catalog.empty()) {
+		if (! FileUtils::IsDirectory(opt.catalog)) {
+			cerr << ProgName << " : catalog directory " << opt.catalog << 
+				" does not exist" << endl;
+			exit(1);
+		}
+		NetCDFCollection::SetCatalogDirectory(opt.catalog);
+	}
+
+	if (opt.maxfiles < 0 || opt.chunksize <= 0) {
+		cerr << ProgName << " : invalid maxfiles or chunksize" << endl;
+		exit(1);
+	}
+	NetCDFCollection::SetMaxOpenFiles(opt.maxfiles);
+	NetCDFCollection::SetChunkSizeHint((size_t) opt.chunksize * 1024);
+
+	vector <string> files;
+	for (int i=1; i<argc; i++) {
+		files.push_back(argv[i]);
+	}
+
+	// Workers are numbered across all hosts
+	//
+	int nworkers = opt.nranks * opt.nprocs;
+	int worker0 = opt.rank * opt.nprocs;
+
+	if (opt.nprocs == 1) {
+		exit(render(files, worker0, nworkers) < 0 ? 1 : 0);
+	}
+
+	// Fork before any data or GL state exists, so that every worker
+	// starts from a clean process
+	//
+	vector <pid_t> pids;
+	for (int i=0; i<opt.nprocs; i++) {
+		pid_t pid = fork();
+		if (pid < 0) {
+			cerr << ProgName << " : fork() : " << strerror(errno) << endl;
+			break;
+		}
+		if (pid == 0) {
+			_exit(render(files, worker0 + i, nworkers) < 0 ? 1 : 0);
+		}
+		pids.push_back(pid);
+	}
+
+	int estatus = pids.size() == opt.nprocs ? 0 : 1;
+	for (int i=0; i<pids.size(); i++) {
+		int status;
+		if (waitpid(pids[i], &status, 0) < 0 ||
+			! WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+
+			estatus = 1;
+		}
+	}
+
+	exit(estatus);
+}
@@ -17,6 +17,9 @@ struct opt_t {
 	std::vector <size_t> bs;
     std::vector <size_t> cratios;
 	string wname;
+	double maxerror;
+	OptionParser::Boolean_T	relerror;
+	int nbits;
 	string xtype;
 	int numts;
 	int nthreads;
@@ -53,6 +56,21 @@ OptionParser::OptDescRec_T	set_opts[] = {
 		"bior1.5, bior2.2, bior2.4 ,bior2.6, bior2.8, bior3.1, bior3.3, "
 		"bior3.5, bior3.7, bior3.9, bior4.4"
 	},
+	{
+		"maxerror", 1, "-1.0", "Maximum absolute reconstruction error for "
+		"compressed variables. When non-negative, each block retains only "
+		"as many coefficients as are needed to meet the bound, and "
+		"cratios serve as upper limits on storage. A negative value "
+		"disables error bounded compression"
+	},
+	{"relerror",	0,	"",	"Interpret maxerror as relative to the range "
+	"of the data written by each write call (each slab of slices for "
+	"raw2vdc)"},
+	{
+		"nbits", 1, "0", "Quantize wavelet coefficients of compressed "
+		"variables to nbits bits (2 to 32) and entropy code them. "
+		"0 => store coefficients unquantized"
+	},
 	{
 		"xtype", 1,"float", "External data type representation. "
 		"Valid values are uint8 int8 int16 int32 int64 float double"
@@ -123,6 +141,9 @@ OptionParser::Option_T	get_options[] = {
 	{"bs", Wasp::CvtToSize_tVec, &opt.bs, sizeof(opt.bs)},
 	{"cratios", Wasp::CvtToSize_tVec, &opt.cratios, sizeof(opt.cratios)},
 	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"maxerror", Wasp::CvtToDouble, &opt.maxerror, sizeof(opt.maxerror)},
+	{"relerror", Wasp::CvtToBoolean, &opt.relerror, sizeof(opt.relerror)},
+	{"nbits", Wasp::CvtToInt, &opt.nbits, sizeof(opt.nbits)},
 	{"xtype", Wasp::CvtToCPPStr, &opt.xtype, sizeof(opt.xtype)},
 	{"numts", Wasp::CvtToInt, &opt.numts, sizeof(opt.numts)},
 	{"nthreads", Wasp::CvtToInt, &opt.nthreads, sizeof(opt.nthreads)},
@@ -285,6 +306,11 @@ int	main(int argc, char **argv) {
 	rc = vdc.SetCompressionBlock(opt.wname, opt.cratios);
 	if (rc<0) exit(1);
 
+	vdc.SetErrorBound(opt.maxerror, opt.relerror);
+
+	rc = vdc.SetCoeffQuantization(opt.nbits);
+	if (rc<0) exit(1);
+
 	for (int i=0; i<opt.vars3d.size(); i++) {
 		rc = vdc.DefineDataVar(
 			opt.vars3d[i], dimnames, dimnames, "", xType, true
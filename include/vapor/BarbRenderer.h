@@ -63,6 +63,15 @@ namespace VAPoR {
       
 
 	double _maxValue;
+
+	// Barbs are drawn with a single instanced draw of a shared mesh.
+	// The per barb instance data are only rebuilt when the data or 
+	// params change
+	//
+	GLuint _VAO, _meshVBO, _instanceVBO;
+	unsigned int _nMeshVertices;
+	unsigned int _nBarbs;
+	std::vector <float> _barbInstances;
 	
 	void _getMagnitudeAtPoint(
 		std::vector<VAPoR::Grid*> variables,
@@ -118,7 +127,9 @@ namespace VAPoR {
 		std::vector<VAPoR::Grid*> &varData
 	);
 
-	void _setUpLightingAndColor();
+	int _buildCache();
+
+	int _drawBarbs();
 
 	void _reFormatExtents(vector<float> &rakeExts) const;
 
@@ -173,13 +184,14 @@ namespace VAPoR {
 		float start[3], 
 		float end[3],
 		bool doColorMapping,
-		float clut[1024]);
+		float clut[1024],
+		float color[4]);
 
 	void _operateOnGrid(
 		vector <Grid *> variableData,
 		bool drawBarb=true);
 
-	bool _getColorMapping(float val, float clut[256*4]);
+ bool _getColorMapping(float val, float clut[256*4], float color[4]);
 
 	float _calculateDirVec(
 		const float start[3], 
@@ -187,40 +199,16 @@ namespace VAPoR {
 		float dirVec[3]
 	);
 
-	void _drawBackOfBarb(
-		const float dirVec[3], 
-		const float startVertex[3]
-	) const;
-
-	void _drawCylinderSides(
-		const float nextNormal[3],
-		const float nextVertex[3],
-		const float startNormal[3],
-		const float startVertex[3]
-	) const;
-
-	void _drawBarbHead(
-	    const float dirVec[3], 
-	    const float vertexPoint[3], 
-	    const float startNormal[3], 
-	    const float startVertex[3]
-	) const; 
-
-//! Protected method to draw one barb (a hexagonal tube with a cone barbhead)
+//! Protected method to add one barb (a hexagonal tube with a cone 
+//! barbhead) to the list of barb instances
 //! \param[in] const float startPoint[3] beginning position of barb
-//! \param[in] const float endPoint[3] ending position of barb
-	//void drawBarb(const float startPoint[3], const float endPoint[3]);
-	void _drawBarb(
+	void _addBarb(
 		const std::vector<Grid*> variableData,
 		float startPoint[3],
 		bool doColorMapping,
 		float clut[1024]
 	);
 		
-     
-#ifdef DEBUG
-	_printBackDiameter(const float startVertex[18]) const;
-#endif
  
       struct {
           vector<string> fieldVarNames;
@@ -241,6 +229,7 @@ namespace VAPoR {
           float colorSamples[10][3];
           float alphaSamples[10];
 		  bool needToRecalc;
+		  vector<double> scales;
       } _cacheParams;
       
       bool _isCacheDirty() const;
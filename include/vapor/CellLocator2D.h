@@ -0,0 +1,191 @@
+#ifndef _CellLocator2D_
+#define _CellLocator2D_
+
+#include <vector>
+#include <mutex>
+#include <vapor/Grid.h>
+
+namespace VAPoR {
+//
+//! \class CellLocator2D
+//! \brief Locates the cell of a 2D mesh that contains a point
+//!
+//! This class accelerates point location on curvilinear and unstructured
+//! 2D meshes. A uniform grid of bins is laid over the horizontal extents
+//! of the mesh, and each bin records the cells whose bounding boxes
+//! overlap it. A point is located by testing only the cells recorded
+//! in the bin containing the point.
+//!
+//! Cells must be convex polygons with at most MaxNodes vertices.
+//! Interpolation weights returned for a point are the Wachspress
+//! coordinates of the point with respect to the vertices of the
+//! cell containing it.
+//!
+//! The mesh coordinates are copied, so the Grid instances passed to the
+//! constructor or to Build() need not remain valid. Queries do not
+//! allocate memory, and may be performed concurrently by multiple threads.
+//!
+//! A locator may be constructed empty and built later with Build(),
+//! so that a locator shared by several grids is only built if one of
+//! them is queried.
+//!
+//! \sa KDTreeRG, WachspressCoords2D()
+//
+class VDF_API CellLocator2D {
+public:
+
+ //! Maximum number of vertices in a cell
+ //
+ static const int MaxNodes = 16;
+
+ //! Construct a cell locator for a structured mesh
+ //!
+ //! Creates a cell locator for the quadrilateral cells of a 2D
+ //! structured (curvilinear) mesh. The cell with index \a (i,j) has
+ //! vertices \a (i,j), \a (i+1,j), \a (i+1,j+1), and \a (i,j+1), in that
+ //! order, and its linear cell index is \a j*(nx-1)+i, where \a nx is
+ //! the mesh dimension along the first axis.
+ //!
+ //! \param[in] xg A Grid instance giving the X user coordinates
+ //! of each mesh vertex.
+ //! \param[in] yg A Grid instance giving the Y user coordinates
+ //! of each mesh vertex. The \p xg and \p yg Grid
+ //! instances must have identical configurations, differing only in their
+ //! data values.
+ //
+ CellLocator2D(const Grid &xg, const Grid &yg);
+
+ //! Construct an empty cell locator
+ //!
+ //! The locator must be built with Build() before it is queried
+ //
+ CellLocator2D() : _built(false) {}
+
+ //! Construct a cell locator for an unstructured mesh
+ //!
+ //! Creates a cell locator for the faces of a 2D unstructured mesh.
+ //! The cell index of a face is its row in \p vertexOnFace.
+ //!
+ //! \param[in] xg A Grid instance giving the X user coordinates
+ //! of each mesh vertex, in vertex index order.
+ //! \param[in] yg A Grid instance giving the Y user coordinates
+ //! of each mesh vertex, in vertex index order.
+ //! \param[in] vertexOnFace An array of \p nfaces by \p maxVertexPerFace
+ //! vertex indices, giving the vertices of each face.
+ //! \param[in] nfaces The number of faces in \p vertexOnFace
+ //! \param[in] maxVertexPerFace The maximum number of vertices per face
+ //! \param[in] missingID Value marking the end of a face's vertex list
+ //! when the face has fewer than \p maxVertexPerFace vertices
+ //! \param[in] nodeOffset Offset added to each element of
+ //! \p vertexOnFace to obtain a vertex index
+ //
+ CellLocator2D(
+	const Grid &xg, const Grid &yg,
+	const int *vertexOnFace, size_t nfaces, size_t maxVertexPerFace,
+	int missingID, long nodeOffset
+ );
+
+ virtual ~CellLocator2D() {}
+
+ //! Build the locator for a structured mesh
+ //!
+ //! Builds the locator as CellLocator2D(const Grid &, const Grid &)
+ //! does. Only the first call has any effect, so the caller may invoke
+ //! this before every query. Concurrent calls are safe: one thread
+ //! builds the locator and the others wait for it to finish.
+ //
+ void Build(const Grid &xg, const Grid &yg);
+
+ //! Build the locator for an unstructured mesh
+ //!
+ //! Builds the locator as the unstructured mesh constructor does.
+ //! Only the first call has any effect.
+ //
+ void Build(
+	const Grid &xg, const Grid &yg,
+	const int *vertexOnFace, size_t nfaces, size_t maxVertexPerFace,
+	int missingID, long nodeOffset
+ );
+
+ //! Locate the cell containing a point
+ //!
+ //! \param[in] x X user coordinate of the point
+ //! \param[in] y Y user coordinate of the point
+ //! \param[out] cell Index of the cell containing the point
+ //! \param[out] nodes Vertex indices of \p cell. Must have room for
+ //! MaxNodes elements
+ //! \param[out] lambda Interpolation weights for each vertex in
+ //! \p nodes. Must have room for MaxNodes elements
+ //! \param[out] nnodes Number of valid elements in \p nodes and \p lambda
+ //!
+ //! \retval inside True if the point is inside the mesh, false otherwise.
+ //! If false, the output parameters are not defined.
+ //
+ bool Locate(
+	double x, double y, size_t &cell, size_t nodes[], double lambda[],
+	int &nnodes
+ ) const;
+
+ //! Locate the cells containing many points
+ //!
+ //! Batched version of Locate(). Successive points that fall in the same
+ //! cell are located without searching.
+ //!
+ //! \param[in] n Number of points
+ //! \param[in] x X user coordinates of \p n points
+ //! \param[in] y Y user coordinates of \p n points
+ //! \param[out] cells Index of the cell containing each point, or -1
+ //! if the point is outside of the mesh
+ //! \param[out] nodes Vertex indices of the cell containing each point.
+ //! The vertices of the i'th point begin at \p nodes[i*MaxNodes]. Must
+ //! have room for \p n * MaxNodes elements
+ //! \param[out] lambda Interpolation weights, laid out like \p nodes
+ //! \param[out] nnodes Number of vertices of the cell containing each
+ //! point
+ //!
+ //! \retval count The number of points inside the mesh
+ //
+ size_t Locate(
+	size_t n, const double *x, const double *y, long *cells,
+	size_t *nodes, double *lambda, int *nnodes
+ ) const;
+
+ //! Return the number of cells
+ //
+ size_t GetNumCells() const {
+	return(_cellStart.size() ? _cellStart.size() - 1 : 0);
+ }
+
+private:
+ std::vector <float> _x;	// vertex coordinates
+ std::vector <float> _y;
+ std::vector <size_t> _cellStart;	// offset of each cell in _cellNodes
+ std::vector <int> _cellNodes;	// vertex indices of each cell
+ std::vector <float> _bbox;	// xmin, xmax, ymin, ymax of each cell
+
+ double _minx, _miny, _maxx, _maxy;	// extents of all cells
+ double _binScaleX, _binScaleY;	// bins per unit of user coordinates
+ size_t _nbx, _nby;
+ std::vector <size_t> _binStart;	// offset of each bin in _binCells
+ std::vector <int> _binCells;	// cells overlapping each bin
+ std::once_flag _once;
+ bool _built;
+
+ void _buildStructured(const Grid &xg, const Grid &yg);
+ void _buildUnstructured(
+	const Grid &xg, const Grid &yg,
+	const int *vertexOnFace, size_t nfaces, size_t maxVertexPerFace,
+	int missingID, long nodeOffset
+ );
+ void _copyCoords(const Grid &xg, const Grid &yg);
+ void _buildBins();
+
+ bool _insideCell(
+	size_t cell, const double pt[2], size_t nodes[], double lambda[],
+	int &nnodes
+ ) const;
+};
+
+};
+
+#endif
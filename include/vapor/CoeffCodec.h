@@ -0,0 +1,132 @@
+#ifndef	_CoeffCodec_h_
+#define	_CoeffCodec_h_
+
+#include <vector>
+#include <vapor/MyBase.h>
+
+namespace VAPoR {
+
+//
+//! \class CoeffCodec
+//! \brief Quantizes and entropy codes arrays of wavelet coefficients
+//!
+//! This class encodes an array of wavelet coefficients as a
+//! self-describing byte stream. Each coefficient belongs to a wavelet
+//! subband (see Compressor::GetSubbands()). The approximation 
+//! coefficients, subband 0, are few and carry most of the signal
+//! energy, so they are stored verbatim. Each detail subband is 
+//! quantized with its own uniform quantizer, whose step size is chosen
+//! from the largest coefficient magnitude in that subband and a 
+//! user-specified bit depth. The quantized values are then coded with an
+//! adaptive Rice (Golomb power-of-two) coder. If the Rice code would be
+//! larger than packing each quantized value into a fixed number of bits,
+//! the fixed width packing is used instead, so the encoded size never 
+//! exceeds GetMaxEncodedSize().
+//!
+//! The stream begins with a GetHeaderSize() byte header recording the
+//! stream length, coding mode, bit depth, number of subbands and number
+//! of verbatim coefficients. The header is followed by the step size of 
+//! each detail subband, the verbatim coefficients, and the coded 
+//! quantized values. All multi-byte values are stored least significant 
+//! byte first, independent of host byte order.
+//
+class WASP_API CoeffCodec : public Wasp::MyBase {
+public:
+
+ //! Construct a codec
+ //!
+ //! \param[in] nbits Quantization bit depth, including the sign bit.
+ //! Valid values are in the range [2..32]
+ //
+ CoeffCodec(int nbits = 16);
+
+ //! Return true if \p nbits is a valid quantization bit depth
+ //
+ static bool IsValidNumBits(int nbits) {
+	return(nbits >= 2 && nbits <= 32);
+ }
+
+ //! Return the quantization bit depth
+ //
+ int GetNumBits() const {return(_nbits); };
+
+ //! Return the size in bytes of the stream header
+ //
+ static size_t GetHeaderSize() {return(16); };
+
+ //! Return the largest size in bytes of an encoding of \p n coefficients
+ //! with bit depth \p nbits
+ //!
+ //! \param[in] n Number of coefficients
+ //! \param[in] nbits Quantization bit depth
+ //! \param[in] nbands Number of subbands, including subband 0
+ //! \param[in] napprox Number of the \p n coefficients that belong to
+ //! subband 0
+ //
+ static size_t GetMaxEncodedSize(
+	size_t n, int nbits, int nbands = 2, size_t napprox = 0
+ );
+
+ //! Return the size in bytes of an encoded stream from its header
+ //!
+ //! \param[in] header The first GetHeaderSize() bytes of a stream
+ //! returned by Encode()
+ //! \param[out] nbytes Length of the stream, including the header
+ //!
+ //! \retval status A negative int is returned if \p header is invalid
+ //
+ static int GetEncodedSize(const unsigned char *header, size_t &nbytes);
+
+ //! Quantize and encode an array of coefficients
+ //!
+ //! \param[in] src Array of \p n coefficients
+ //! \param[in] bands The subband of each coefficient in \p src, in the 
+ //! range [0..nbands-1]. Coefficients of subband 0 are stored verbatim.
+ //! If NULL, all coefficients are quantized as a single detail subband.
+ //! \param[in] nbands Number of subbands. Ignored if \p bands is NULL.
+ //! Valid values are in the range [1..255]
+ //! \param[in] n Number of coefficients in \p src
+ //! \param[out] dst Storage for the encoded stream. Must be at least
+ //! GetMaxEncodedSize() bytes
+ //! \param[out] nbytes Length of the encoded stream in bytes
+ //
+ void Encode(
+	const double *src, const unsigned char *bands, int nbands, size_t n,
+	unsigned char *dst, size_t &nbytes
+ );
+ void Encode(
+	const long *src, const unsigned char *bands, int nbands, size_t n,
+	unsigned char *dst, size_t &nbytes
+ );
+
+ //! Decode an array of coefficients
+ //!
+ //! \param[in] src Stream returned by Encode()
+ //! \param[in] srclen Number of bytes available in \p src
+ //! \param[in] bands The subband of each coefficient, as passed to 
+ //! Encode()
+ //! \param[out] dst Storage for \p n coefficients
+ //! \param[in] n Number of coefficients that were encoded
+ //!
+ //! \retval status A negative int is returned if the stream is
+ //! invalid or truncated, or doesn't match \p bands
+ //
+ int Decode(
+	const unsigned char *src, size_t srclen, const unsigned char *bands,
+	double *dst, size_t n
+ ) const;
+ int Decode(
+	const unsigned char *src, size_t srclen, const unsigned char *bands,
+	long *dst, size_t n
+ ) const;
+
+private:
+ int _nbits;
+ std::vector <long> _qvec;
+ std::vector <double> _steps;
+
+};
+
+};
+
+#endif
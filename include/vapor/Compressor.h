@@ -165,6 +165,51 @@ public:
 	vector <SignificanceMap > &sigmaps
  );
 
+ //! Decompose an array, retaining only as many coefficients as are
+ //! needed to satisfy an error bound
+ //!
+ //! This method is similar to Decompose() except that the elements
+ //! of \p dst_arr_lens give the \em maximum number of elements in each
+ //! collection S<sub>i</sub>. The largest-magnitude coefficients
+ //! are retained such that the array reconstructed from them 
+ //! by Reconstruct() differs from \p src_arr by no more than 
+ //! \p max_error at any element. The number retained is an
+ //! approximation of the fewest needed: it is found by doubling the
+ //! count until the bound is met, followed by at most four bisection
+ //! steps, so it may exceed the minimum. Collections are filled in order: a
+ //! collection contains elements only if all preceding collections are
+ //! full. The number of elements actually contained in each collection is
+ //! given by the corresponding significance map.
+ //!
+ //! The reconstruction used to measure the error honors the current
+ //! clamping settings (see ClampMinOnOff() and ClampMaxOnOff()).
+ //!
+ //! \param[in] max_error Maximum absolute error permitted at any element
+ //! of the reconstructed array
+ //! \param[out] error The maximum absolute error of the reconstruction. 
+ //! This may exceed \p max_error only if the sum of \p dst_arr_lens is
+ //! less than the total number of wavelet coefficients.
+ //!
+ //! \retval status A negative value indicates failure
+ //! \sa Decompose(), Reconstruct()
+ //
+ int Decompose(
+	const float *src_arr, float *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap > &sigmaps, double max_error, double &error
+ );
+ int Decompose(
+	const double *src_arr, double *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap > &sigmaps, double max_error, double &error
+ );
+ int Decompose(
+	const int *src_arr, int *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap > &sigmaps, double max_error, double &error
+ );
+ int Decompose(
+	const long *src_arr, long *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap > &sigmaps, double max_error, double &error
+ );
+
  //! Reconstruct a signal decomposed with Decompose()
  //!
  //! This method reconstructs a signal previosly decomposed with Decompose().
@@ -311,6 +356,30 @@ public:
  //
  int GetNumLevels() const {return(_nlevels); };
 
+ //! Returns the subband of each wavelet coefficient
+ //!
+ //! Returns, for each of the GetNumWaveCoeffs() coefficients produced
+ //! by a forward transform, the index of the subband that it belongs
+ //! to. Subband 0 contains the approximation coefficients. The detail
+ //! subbands follow, coarsest first, in the order in which they are 
+ //! stored in the decomposition: one subband per transformation level 
+ //! for 1D arrays, three for 2D arrays, and seven for 3D arrays.
+ //!
+ //! \param[out] bands Subband index of each coefficient
+ //! \retval nbands The number of subbands
+ //!
+ //! \sa GetNumWaveCoeffs(), Decompose()
+ //
+ int GetSubbands(vector <unsigned char> &bands) const;
+
+ //! Returns the number of subbands
+ //!
+ //! \sa GetSubbands()
+ //
+ int GetNumSubbands() const {
+	return(((1 << _dims.size()) - 1) * _nlevels + 1);
+ }
+
  //! Returns the number of coefficients in the smallest allowable compression
  //!
  //! Returns the minimum number of wavelet coefficients allowable
@@ -401,7 +470,9 @@ private:
 
 	vector <size_t> _dims;	// dimensions of array
 	int _nlevels;	// Number of wavelet transformation levels
-	vector <void *> _indexvec; // used to sort wavelet coefficients
+	vector <double> _magvec; // coefficient magnitudes, used to select the largest
+	vector <double> _savevec; // copy of coefficients for error bounded decomposition
+	vector <double> _reconvec; // reconstruction for error bounded decomposition
 	size_t _nx;
 	size_t _ny;
 	size_t _nz;
@@ -4,6 +4,7 @@
 #include <vapor/Grid.h>
 #include <vapor/RegularGrid.h>
 #include <vapor/KDTreeRG.h>
+#include <vapor/CellLocator2D.h>
 
 
 namespace VAPoR {
@@ -66,9 +67,15 @@ public:
  //! that may be used to find the nearest grid vertex to a given point
  //! expressed in user coordintes. The offsets returned by \p kdtree will
  //! be used as indeces into \p xrg and \p yrg.
+ //! \param[in] locator An optional CellLocator2D instance for the mesh
+ //! defined by \p xrg and \p yrg. If provided, it is used in place of
+ //! \p kdtree to find the cell containing a point. If the locator has
+ //! not been built it is built from \p xrg and \p yrg on the first
+ //! point query. Both \p kdtree and \p locator are shallow copied and
+ //! must remain valid for the life of this grid.
  //!
  //!
- //! \sa RegularGrid()
+ //! \sa RegularGrid(), CellLocator2D()
  //
  CurvilinearGrid(
 	const std::vector <size_t> &dims,
@@ -77,7 +84,8 @@ public:
 	const RegularGrid &xrg,
 	const RegularGrid &yrg,
 	const std::vector <double> &zcoords,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator = NULL
  );
 
  //! \copydoc StructuredGrid::StructuredGrid()
@@ -112,9 +120,15 @@ public:
  //! that may be used to find the nearest grid vertex to a given point
  //! expressed in user coordintes. The offsets returned by \p kdtree will
  //! be used as indeces into \p xrg and \p yrg.
+ //! \param[in] locator An optional CellLocator2D instance for the mesh
+ //! defined by \p xrg and \p yrg. If provided, it is used in place of
+ //! \p kdtree to find the cell containing a point. If the locator has
+ //! not been built it is built from \p xrg and \p yrg on the first
+ //! point query. Both \p kdtree and \p locator are shallow copied and
+ //! must remain valid for the life of this grid.
  //!
  //!
- //! \sa RegularGrid()
+ //! \sa RegularGrid(), CellLocator2D()
  //
  CurvilinearGrid(
 	const std::vector <size_t> &dims,
@@ -123,7 +137,8 @@ public:
 	const RegularGrid &xrg,
 	const RegularGrid &yrg,
 	const RegularGrid &zrg,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator = NULL
  );
 
  //! \copydoc StructuredGrid::StructuredGrid()
@@ -153,9 +168,15 @@ public:
  //! that may be used to find the nearest grid vertex to a given point
  //! expressed in user coordintes. The offsets returned by \p kdtree will
  //! be used as indeces into \p xrg and \p yrg.
+ //! \param[in] locator An optional CellLocator2D instance for the mesh
+ //! defined by \p xrg and \p yrg. If provided, it is used in place of
+ //! \p kdtree to find the cell containing a point. If the locator has
+ //! not been built it is built from \p xrg and \p yrg on the first
+ //! point query. Both \p kdtree and \p locator are shallow copied and
+ //! must remain valid for the life of this grid.
  //!
  //!
- //! \sa RegularGrid()
+ //! \sa RegularGrid(), CellLocator2D()
  //
  CurvilinearGrid(
 	const std::vector <size_t> &dims,
@@ -163,7 +184,8 @@ public:
 	const std::vector <float *> &blks,
 	const RegularGrid &xrg,
 	const RegularGrid &yrg,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator = NULL
  );
 
  CurvilinearGrid() = default;
@@ -320,6 +342,7 @@ private:
  mutable std::vector <double> _minu;
  mutable std::vector <double> _maxu;
  const KDTreeRG *_kdtree;
+ CellLocator2D *_locator;
  RegularGrid _xrg;
  RegularGrid _yrg;
  RegularGrid _zrg;
@@ -330,9 +353,12 @@ private:
 	const RegularGrid &yrg,
 	const RegularGrid &zrg,
 	const std::vector <double> &zcoords,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator
  );
 
+ const CellLocator2D *_getLocator() const;
+
  void _GetUserExtents(
 	std::vector <double> &minu, std::vector <double> &maxu
  ) const ;
@@ -353,6 +379,12 @@ private:
 	std::vector <size_t> &indices
  ) const;
 
+ bool _insideGridVertical(
+	double x, double y, double z,
+	size_t i, size_t j, size_t &k,
+	double zwgt[2]
+ ) const;
+
  bool _insideGridHelperStretched(
 	double z, size_t &k, double zwgt[2]
  ) const;
@@ -363,6 +395,10 @@ private:
 	double zwgt[2]
  ) const;
 
+ bool _getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+ ) const override;
 
 };
 };
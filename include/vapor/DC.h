@@ -1985,6 +1985,38 @@ public:
 	return(readRegionBlock(fd, min, max, region));
  }
 
+ //! Read a subregion of a variable over a range of time steps
+ //!
+ //! This method reads the subregion identified by \p min and \p max,
+ //! as with ReadRegion(), at every time step from \p ts0 to \p ts1
+ //! inclusive. The regions are stored one after another in 
+ //! \p region, with time varying slowest. It is the caller's 
+ //! responsibility to ensure adequate space is available.
+ //!
+ //! The variable need not be opened with OpenVariableRead(). Derived 
+ //! classes may read all of the time steps at once, which is much
+ //! faster than reading them one at a time when the region is small
+ //! (e.g. a probe or plot location).
+ //!
+ //! \param[in] varname Name of the variable to read
+ //! \param[in] level Refinement level of the variable
+ //! \param[in] lod Approximation level of the variable
+ //! \param[in] ts0 First time step to read
+ //! \param[in] ts1 Last time step to read
+ //! \param[in] min Minimum region extents in grid coordinates
+ //! \param[in] max Maximum region extents in grid coordinates
+ //! \param[out] region The requested subregion at each time step
+ //!
+ //! \retval status Returns a non-negative value on success
+ //! \sa ReadRegion()
+ //
+ virtual int ReadTimeSeries(
+	string varname, int level, int lod, size_t ts0, size_t ts1,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+ ) {
+	return(readTimeSeries(varname, level, lod, ts0, ts1, min, max, region));
+ }
+
  //! Read an entire variable in one call
  //!
  //! This method reads and entire variable (all time steps, all grid points)
@@ -2302,6 +2334,23 @@ public:
  //
  virtual std::vector <size_t> GetCRatios(string varname) const;
 
+ //! Return the error bound of a compressed variable
+ //!
+ //! Returns the maximum reconstruction error requested when the variable
+ //! named by \p varname was written with error bounded compression
+ //! (see VDC::SetErrorBound()). 
+ //!
+ //! \param[in] varname A string specifying the name of the variable. 
+ //! \param[out] max_error The error bound
+ //! \param[out] relative True if \p max_error is relative to the range
+ //! of the data written, false if it is an absolute error
+ //! \retval bool Returns true if variable \p varname exists and is 
+ //! error bounded
+ //
+ virtual bool GetErrorBound(
+	string varname, double &max_error, bool &relative
+ ) const;
+
 
  //! Return a boolean indicating whether a variable is a data variable 
  //!
@@ -2590,6 +2639,15 @@ protected:
     const vector <size_t> &min, const vector <size_t> &max, int *region
  ) = 0;
 
+ //! \copydoc ReadTimeSeries()
+ //!
+ //! The default implementation reads one time step at a time
+ //
+ virtual int readTimeSeries(
+	string varname, int level, int lod, size_t ts0, size_t ts1,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+ );
+
  //! \copydoc VariableExists()
  //
  virtual bool variableExists(
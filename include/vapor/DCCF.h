@@ -200,6 +200,13 @@ protected:
 	return(_readRegionTemplate(fd, min, max, region));
  }
 
+ //! \copydoc DC::ReadTimeSeries()
+ //!
+ virtual int readTimeSeries(
+	string varname, int level, int lod, size_t ts0, size_t ts1,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+ );
+
  //! \copydoc DC::VariableExists()
  //!
  virtual bool variableExists(
@@ -40,6 +40,62 @@ public:
  DCMPAS();
  virtual ~DCMPAS();
 
+ //! Return the range of cell and vertex indices inside a lat-lon box
+ //!
+ //! This method uses a coarse spatial index over the cell and vertex
+ //! locations, built on first use, to find the smallest contiguous range
+ //! of cell indices, and of vertex indices, that contains every cell and
+ //! vertex inside the box. The returned ranges are conservative: they
+ //! may include cells and vertices outside the box. They may be passed
+ //! as the horizontal extents to ReadRegion() so that only the part of
+ //! the mesh covering the box is read.
+ //!
+ //! \param[in] lonMin Western boundary of the box, in degrees
+ //! \param[in] latMin Southern boundary of the box, in degrees
+ //! \param[in] lonMax Eastern boundary of the box, in degrees
+ //! \param[in] latMax Northern boundary of the box, in degrees
+ //! \param[out] cellMin Smallest cell index in the box
+ //! \param[out] cellMax Largest cell index in the box
+ //! \param[out] vertexMin Smallest vertex index in the box
+ //! \param[out] vertexMax Largest vertex index in the box
+ //!
+ //! \retval status A negative int is returned on failure or if the
+ //! box contains no cells
+ //
+ int GetIndexExtents(
+	double lonMin, double latMin, double lonMax, double latMax,
+	size_t &cellMin, size_t &cellMax, size_t &vertexMin, size_t &vertexMax
+ );
+
+ //! Read the part of a horizontal variable inside a lat-lon box
+ //!
+ //! This method reads the cells, or vertices, of the variable open
+ //! on \p fd that fall inside the box, using the ranges returned by
+ //! GetIndexExtents(). Only that part of the variable is read from
+ //! disk. The horizontal (fastest varying) dimension of the variable
+ //! must be the cell or the vertex dimension. Any other dimensions are
+ //! read in their entirety.
+ //!
+ //! \param[in] fd A valid file descriptor returned by OpenVariableRead()
+ //! \param[in] lonMin Western boundary of the box, in degrees
+ //! \param[in] latMin Southern boundary of the box, in degrees
+ //! \param[in] lonMax Eastern boundary of the box, in degrees
+ //! \param[in] latMax Northern boundary of the box, in degrees
+ //! \param[out] min Minimum index extents of the region read
+ //! \param[out] max Maximum index extents of the region read
+ //! \param[out] region The region read, resized to hold the extents
+ //! given by \p min and \p max
+ //!
+ //! \retval status A negative int is returned on failure or if the
+ //! box contains no cells
+ //!
+ //! \sa GetIndexExtents(), ReadRegion()
+ //
+ int ReadLatLonRegion(
+	int fd, double lonMin, double latMin, double lonMax, double latMax,
+	vector <size_t> &min, vector <size_t> &max, vector <float> &region
+ );
+
 protected:
  //! Initialize the DCMPAS class
  //!
@@ -224,9 +280,20 @@ private:
  std::vector <string> _cellVars;
  std::vector <string> _pointVars;
  std::vector <string> _edgeVars;
- Wasp::SmartBuf _nEdgesOnCellBuf;
- Wasp::SmartBuf _lonCellSmartBuf;
- Wasp::SmartBuf _lonVertexSmartBuf;
+ // Time-invariant coordinate and connectivity variables, stored in
+ // native order and units. Read once on first use
+ //
+ std::map <string, Wasp::SmartBuf> _staticVarsMap;
+
+ // Spatial index: a regular lat-lon grid of bins, each recording
+ // the range of cell and vertex indices located inside it
+ //
+ size_t _indexNLon;
+ size_t _indexNLat;
+ std::vector <size_t> _indexCellMin;
+ std::vector <size_t> _indexCellMax;
+ std::vector <size_t> _indexVertexMin;
+ std::vector <size_t> _indexVertexMax;
 
  int _InitDerivedVars(NetCDFCollection *ncdfc);
  int _InitCoordvars(NetCDFCollection *ncdfc);
@@ -261,14 +328,19 @@ private:
  template <class T>
  int _getVar(size_t ts, string varname, T *buf);
 
- int _read_nEdgesOnCell(size_t ts);
- void _addMissingFlag(int *data) const;
- int _readVarToSmartBuf(
-	size_t ts, string varname, Wasp::SmartBuf &smartBuf
+ template <class T>
+ const T *_getStaticVar(string varname);
+
+ int _buildSpatialIndex();
+
+ int _addMissingFlag(
+	const vector <size_t> &min, const vector <size_t> &max, int *data
  );
- int _readCoordinates(size_t ts);
 
- void _splitOnBoundary(string varname, int *connData) const;
+ int _splitOnBoundary(
+	string varname,
+	const vector <size_t> &min, const vector <size_t> &max, int *connData
+ );
 
  int _readRegionTransposed(
 	MPASFileObject *w,
@@ -296,7 +368,7 @@ private:
  class DerivedCoordVertFromCell : public DerivedCoordVar {
  public: 
   DerivedCoordVertFromCell(
-	string derivedVarName, string derivedDimName, DC *dc, string inName,
+	string derivedVarName, string derivedDimName, DCMPAS *dc, string inName,
 	string cellsOnVertexName
   );
 
@@ -347,16 +419,10 @@ private:
 
  private:
   string _derivedDimName;
-  DC *_dc;
+  DCMPAS *_dc;
   string _inName;
   string _cellsOnVertexName;
   DC::CoordVar _coordVarInfo;
-
-  float *_getCellData();
-
-  int *_getCellsOnVertex(
-	size_t i0, size_t i1, int &vertexDegree
-  );
  };
 
 
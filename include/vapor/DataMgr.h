@@ -1,10 +1,12 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <cassert>
 #include <vapor/BlkMemMgr.h>
 #include <vapor/DC.h>
 #include <vapor/MyBase.h>
+#include <vapor/EasyThreads.h>
 #include <vapor/RegularGrid.h>
 #include <vapor/StretchedGrid.h>
 #include <vapor/LayeredGrid.h>
@@ -121,7 +123,11 @@ public:
  //! \param[in] format A string indicating the format of data collection.
  //!
  //! \param[in] mem_size Size of memory cache to be created, specified
- //! in MEGABYTES!!
+ //! in MEGABYTES!! The cache is a single pool shared by all DataMgr
+ //! instances in the process. Its size is set by the first instance
+ //! to allocate from it, and remains fixed until every instance has
+ //! been destroyed. When the pool is exhausted the least recently 
+ //! used region of any instance is evicted.
  //!
  //! \param[in] numthreads Number of parallel execution threads
  //! to be run during encoding and decoding of compressed data. A value
@@ -368,6 +374,10 @@ public:
  //
 std::vector <size_t> GetCRatios(string varname) const;
 
+ //! \copydoc DC::GetErrorBound()
+ //
+ bool GetErrorBound(string varname, double &max_error, bool &relative) const;
+
  //! Read and return variable data
  //!
  //! Reads all data for the data or coordinate variable named by \p varname 
@@ -428,6 +438,41 @@ std::vector <size_t> GetCRatios(string varname) const;
 	std::vector <size_t> min, std::vector <size_t> max, bool lock=false
  );
 
+ //! Read a variable's values in a region over a range of time steps
+ //!
+ //! This method returns in \p data the values of \p varname at the 
+ //! grid points from \p min to \p max, in grid (voxel) coordinates at
+ //! refinement level \p level, for each time step from \p ts0 to 
+ //! \p ts1 inclusive. The values are time-major: the region for
+ //! \p ts0 comes first, and within each time step the first dimension
+ //! varies fastest.
+ //!
+ //! Unlike GetVariable() the data are not cached, and no Grid is 
+ //! constructed. Native variables are read with 
+ //! DC::ReadTimeSeries(), which for netCDF based data collections reads 
+ //! the records of each file with a single request. This makes 
+ //! extracting a time series at a point, or in a small region, far
+ //! cheaper than calling GetVariable() for each time step.
+ //!
+ //! \param[in] ts0 First time step
+ //! \param[in] ts1 Last time step
+ //! \param[in] varname The name of the data variable to read
+ //! \param[in] level Grid refinement level. See DataMgr
+ //! \param[in] lod The level-of-detail. See DataMgr
+ //! \param[in] min Minimum region extents in grid coordinates
+ //! \param[in] max Maximum region extents in grid coordinates
+ //! \param[out] data The region at each time step
+ //!
+ //! \retval status A negative int is returned on failure
+ //!
+ //! \sa GetVariable(), DC::ReadTimeSeries()
+ //
+ int GetTimeSeries(
+	size_t ts0, size_t ts1, string varname, int level, int lod,
+	std::vector <size_t> min, std::vector <size_t> max,
+	std::vector <float> &data
+ );
+
  //! Compute the coordinate extents of a variable
  //!
  //! This method finds the spatial domain extents of a variable
@@ -497,6 +542,24 @@ std::vector <size_t> GetCRatios(string varname) const;
  //
  void	Clear();
 
+ //! Return the amount of shared cache memory held by this instance
+ //!
+ //! \retval size Memory, in bytes, allocated to cached regions 
+ //! belonging to this DataMgr
+ //!
+ //! \sa GetTotalMemUsage()
+ //
+ size_t GetMemUsage() const;
+
+ //! Return the amount of shared cache memory held by all instances
+ //!
+ //! \retval size Memory, in bytes, allocated to cached regions 
+ //! belonging to any DataMgr in the process
+ //!
+ //! \sa GetMemUsage()
+ //
+ static size_t GetTotalMemUsage();
+
  //! Returns true if indicated data volume is available
  //!
  //! Returns true if the variable identified by the timestep, variable
@@ -583,6 +646,37 @@ std::vector <size_t> GetCRatios(string varname) const;
  //
  bool IsVariableNative(string varname) const;
 
+ //! Add a derived data variable
+ //!
+ //! Adds the derived data variable \p derivedVar to the list of
+ //! variables available from this data set. The variable is
+ //! initialized with DerivedVar::Initialize(), and may then be
+ //! accessed with GetVariable() like a native variable. Data
+ //! returned by the derived variable are cached like native data.
+ //!
+ //! On success the DataMgr takes ownership of \p derivedVar, which
+ //! will be deleted by RemoveDerivedVar() or the DataMgr's destructor.
+ //!
+ //! An error occurs if the variable's name matches any native
+ //! or previously added derived variable name, or if the derived
+ //! variable fails to initialize.
+ //!
+ //! \retval status A negative int is returned on failure.
+ //!
+ //! \sa RemoveDerivedVar()
+ //
+ int AddDerivedVar(DerivedDataVar *derivedVar);
+
+ //! Remove a derived data variable
+ //!
+ //! Removes and deletes the derived data variable named by \p varname,
+ //! previously added with AddDerivedVar(), and purges any of its data
+ //! from the cache. If no such variable exists this method is a no-op
+ //!
+ //! \sa AddDerivedVar()
+ //
+ void RemoveDerivedVar(string varname);
+
 	
  //! Purge the cache of a variable
  //!
@@ -771,6 +865,10 @@ private:
 		_cacheVoidPtr.clear(); 
 	}
 
+	// Remove all size_t and double entries that reference varname
+	//
+	void PurgeVariable(string varname);
+
   static string _make_hash(
 	string key, size_t ts, std::vector <string> cvars, int level, int lod
   );
@@ -786,6 +884,7 @@ private:
 
  string _format;
  int _nthreads;
+ Wasp::EasyThreads *_et;
  size_t _mem_size;
 
  DC *_dc;
@@ -809,6 +908,9 @@ private:
 	std::vector <size_t> bmin;
 	std::vector <size_t> bmax;
 	int lock_counter;
+	bool derived;	// synthesized from a finer level, cheap to rebuild
+	size_t nblks;	// size of region in BlkMemMgr blocks
+	unsigned long stamp;	// value of _accessClock at last access
 	void *blks;
  } region_t;
 
@@ -817,6 +919,24 @@ private:
 
  VAPoR::BlkMemMgr  *_blk_mem_mgr;
 
+ // All instances share the BlkMemMgr pool, so eviction must consider
+ // the regions of every instance, not just our own
+ //
+ static std::vector <DataMgr *> _instances;
+ static unsigned long _accessClock;
+
+ // Guards the state shared by all instances: _instances, _accessClock,
+ // the BlkMemMgr pool, and the _regionsList of every instance, which 
+ // _free_lru() may modify on behalf of another instance. When both are
+ // needed, _mutex must be acquired first.
+ //
+ static std::recursive_mutex _cacheMutex;
+
+ // Serializes the public methods so that a worker thread (e.g. a
+ // histogram builder) may read through the same DataMgr as the GUI
+ //
+ mutable std::recursive_mutex _mutex;
+
 
  std::vector <PipeLine *> _PipeLines;
 
@@ -1057,7 +1177,8 @@ UnstructuredGrid2D *_make_grid_unstructured2d(
 	std::vector <size_t> bs,
 	int element_sz,
 	bool    lock,
-	bool fill
+	bool fill,
+	bool derived = false
  ); 
 
  void    _free_region(
@@ -184,8 +184,9 @@ public:
 	//! Set the data cache size
 	//!
 	//! Set the size of the data cache in MBs.
-	//! Has no effect until
-	//! the next data set is loaded.
+	//! The cache is a single budget shared by all open data sets, so
+	//! this has no effect until the next data set is loaded after
+	//! all currently open data sets have been closed.
 	//!
 	//! \sa DataMgr
 	//
@@ -0,0 +1,120 @@
+#include <vapor/MyPython.h>
+#include <vapor/DerivedVar.h>
+#include <vapor/DataMgr.h>
+
+#ifndef	_DERIVEDPYTHONVAR_H_
+#define	_DERIVEDPYTHONVAR_H_
+
+namespace VAPoR {
+
+//!
+//! \class DerivedPythonVar
+//!
+//! \brief Derived data variable computed by a Python function
+//!
+//! This class implements a derived data variable whose values are
+//! computed, one block at a time, by a user supplied Python function.
+//! The function is called with a NumPy array for the output block
+//! followed by one NumPy array for each input variable:
+//!
+//! \code
+//! def wind_speed(out, U, V):
+//!     numpy.sqrt(U*U + V*V, out)
+//! \endcode
+//!
+//! The arrays are views of the DataMgr's cache blocks - no data are
+//! copied. The input arrays are read-only. The function should write its
+//! results into \p out. Alternatively, the function may return an array
+//! with the shape of \p out, which will be copied into the output block.
+//!
+//! All input variables must be defined on the same mesh and have the
+//! same dimensions and block size. The derived variable inherits the
+//! mesh, time coordinate, and missing value of the first input.
+//!
+//! Inputs are read through the DataMgr that owns this variable, so
+//! they are cached and may themselves be derived. The results are cached
+//! by the DataMgr like any native variable.
+//!
+//! The Python global interpreter lock is acquired and released around
+//! each block
+//!
+//! \sa DataMgr::AddDerivedVar()
+//!
+class RENDER_API DerivedPythonVar : public DerivedDataVar {
+public:
+
+ //! \param[in] varName Name of the derived variable
+ //! \param[in] units Units of the derived variable. May be empty.
+ //! \param[in] inNames Names of the input variables passed to the
+ //! Python function, in order
+ //! \param[in] script Python script containing a definition of the
+ //! function named by \p funcName
+ //! \param[in] funcName Name of the Python function
+ //! \param[in] dataMgr DataMgr from which input variables are read.
+ //! Normally this is the DataMgr to which this variable is added.
+ //
+ DerivedPythonVar(
+	string varName, string units, const std::vector <string> &inNames,
+	string script, string funcName, DataMgr *dataMgr
+ );
+ virtual ~DerivedPythonVar();
+
+ virtual int Initialize();
+
+ virtual bool GetBaseVarInfo(DC::BaseVar &var) const;
+
+ virtual bool GetDataVarInfo(DC::DataVar &var) const;
+
+ virtual size_t GetNumRefLevels() const;
+
+ virtual std::vector <string> GetInputs() const {
+	return(_inNames);
+ }
+
+ virtual int GetDimLensAtLevel(
+	int level, std::vector <size_t> &dims_at_level,
+	std::vector <size_t> &bs_at_level
+ ) const;
+
+ virtual int OpenVariableRead(
+	size_t ts, int level=0, int lod=0
+ );
+
+ virtual int CloseVariable(int fd);
+
+ virtual int ReadRegionBlock(
+	int fd,
+	const std::vector <size_t> &min, const std::vector <size_t> &max,
+	float *region
+ );
+
+ virtual int ReadRegion(
+	int fd,
+	const std::vector <size_t> &min, const std::vector <size_t> &max,
+	float *region
+ );
+
+ virtual bool VariableExists(
+	size_t ts,
+	int reflevel,
+	int lod
+ ) const;
+
+private:
+ string _units;
+ std::vector <string> _inNames;
+ string _script;
+ string _funcName;
+ DataMgr *_dataMgr;
+ PyObject *_pFunc;
+ DC::DataVar _dataVarInfo;
+
+ int _evalBlock(
+	float *outBlk, const std::vector <float *> &inBlks,
+	const std::vector <size_t> &bs
+ );
+
+};
+};
+
+#endif
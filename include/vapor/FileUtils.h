@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace VAPoR {
 namespace FileUtils {
@@ -19,6 +20,7 @@ bool FileExists(const std::string &path);
 bool IsRegularFile(const std::string &path);
 bool IsDirectory(const std::string &path);
 FileType GetFileType(const std::string &path);
+std::vector<std::string> ListDirectory(const std::string &path);
 
 }
 }
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <glm/glm.hpp>
 #include "vapor/MyBase.h"
 
@@ -19,11 +20,15 @@ struct GLManager;
 //! This class does not do any transformation, formatting,
 //! etc., please use the TextLabel class for that.
 //!
+//! Glyphs are packed into a single texture atlas, so any amount
+//! of text can be drawn with one draw call.
+//!
 //! \author Stanislaw Jaroszynski
     
 class RENDER_API Font : public Wasp::MyBase {
     struct Glyph {
-        unsigned int textureID;
+        int atlasX;
+        int atlasY;
         int sizeX;
         int sizeY;
         int bearingX;
@@ -39,8 +44,22 @@ class RENDER_API Font : public Wasp::MyBase {
     int _size;
     unsigned int _VAO, _VBO;
     
+    // Glyphs are packed left to right into rows of the atlas. A copy
+    // of the atlas is kept so that it can be reallocated when it
+    // fills up.
+    unsigned int _atlasTexture;
+    int _atlasWidth, _atlasHeight;
+    int _rowX, _rowY, _rowHeight;
+    std::vector<unsigned char> _atlas;
+    
+    // Glyph quads of recently drawn strings, relative to the text origin
+    std::map<std::string, std::vector<float> > _layoutCache;
+    
     bool LoadGlyph(int c);
     Glyph GetGlyph(int c);
+    bool AddToAtlas(const unsigned char *bitmap, int width, int height, int pitch, int &x, int &y);
+    void GrowAtlas();
+    const std::vector<float> &GetLayout(const std::string &text);
     
 public:
     Font(GLManager *glManager, const std::string &path, int size, FT_Library library=nullptr);
@@ -54,6 +73,21 @@ public:
     //!
     void DrawText(const std::string &text, const glm::vec4 &color = glm::vec4(1));
     
+    //! Appends the vertices needed to draw text to a buffer so that
+    //! many strings can be drawn with a single DrawVertices call.
+    //! Layouts of recently used strings are cached.
+    //!
+    //! \param[out] vertices buffer the text is appended to
+    //! \param[in] position pixel offset of the text's origin
+    //! \param[in] text
+    //! \param[in] color
+    //!
+    void AddText(std::vector<float> &vertices, const glm::vec2 &position, const std::string &text, const glm::vec4 &color = glm::vec4(1));
+    
+    //! Draws all of the text in a buffer built by AddText
+    //!
+    void DrawVertices(const std::vector<float> &vertices);
+    
     //! Returns pixel dimensions of text
     //!
     glm::vec2 TextDimensions(const std::string &text);
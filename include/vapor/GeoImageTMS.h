@@ -10,6 +10,7 @@
 #include <geotiff.h>
 #endif
 #include <vapor/MyBase.h>
+#include <vapor/EasyThreads.h>
 #include <vapor/UDUnitsClass.h>
 #include "GeoTileMercator.h"
 #include "GeoImage.h"
@@ -20,6 +21,12 @@ namespace VAPoR {
 //! \brief A class for managing OSGeo Tile Map Service Specification images
 //! \author John Clyne
 //!
+//! Decoded tiles are retained in a bounded, least recently used cache
+//! (see SetCacheSize()), so panning, zooming, or changing time steps
+//! only reads tiles not already in memory. Missing tiles are decoded 
+//! in parallel, and threads that would otherwise be idle prefetch the
+//! surrounding and next coarser level-of-detail tiles.
+//!
 //
 class RENDER_API GeoImageTMS : public GeoImage {
 public:
@@ -38,6 +45,12 @@ public:
 	size_t &width, size_t &height
  );
 
+ //! Set the maximum amount of memory, in megabytes, used to cache
+ //! decoded tiles. The cache may temporarily exceed this size if a 
+ //! single requested image needs more tiles. The default is 256MB
+ //
+ void SetCacheSize(size_t mbytes);
+
 
 private:
 
@@ -51,6 +64,10 @@ private:
  size_t _tileBufSize;
 
  GeoTileMercator *_geotile;
+ size_t _cacheSize;	// max size of tile cache in bytes
+
+ Wasp::EasyThreads *_et;
+ vector <unsigned char> _readBuf;	// storage for tiles decoded in parallel
 
  string _defaultProj4String;	// proj4 string for global mercator
 
@@ -64,6 +81,21 @@ private:
     string dir, size_t tileX, size_t tileY, int lod, unsigned char *tile
  );
 
+ int _tilesRead(
+	string dir, const vector <size_t> &tileX, const vector <size_t> &tileY,
+	const vector <int> &lod, size_t nrequired
+ );
+
+ void _trimReadBuf(size_t maxBytes);
+
+ void _getPrefetchTiles(
+	size_t tileX0, size_t tileY0, size_t nxtiles, size_t nytiles, int lod,
+	size_t maxTiles, 
+	vector <size_t> &tileX, vector <size_t> &tileY, vector <int> &tileLOD
+ ) const;
+
+ size_t _maxCachedTiles() const;
+
  int _getBestLOD(
 	const double myGeoExtentsData[4], int maxWidthReq, int maxHeightReq
  ) const;
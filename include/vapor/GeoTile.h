@@ -3,6 +3,7 @@
 
 #include <string>
 #include <map>
+#include <list>
 #ifdef _WINDOWS
 #pragma warning(disable : 4251)
 #endif
@@ -159,6 +160,36 @@ public:
  //
  const unsigned char *GetTile(std::string quadkey) const;
 
+ //! Mark an image tile as recently used
+ //!
+ //! When the number of tiles is bounded (see SetMaxTiles()) the
+ //! least recently inserted or touched tiles are discarded first.
+ //!
+ //! \param[in] quadkey A Quad Key
+ //! \retval found Returns true if the tile associated with \p quadkey 
+ //! exists
+ //!
+ //! \sa SetMaxTiles(), Insert()
+ //
+ bool Touch(std::string quadkey);
+
+ //! Bound the number of image tiles stored by the class
+ //!
+ //! If inserting a tile would cause more than \p maxTiles tiles to be
+ //! stored, the least recently used tiles are discarded. The caller
+ //! must touch or insert all tiles needed by GetMap() after any other
+ //! insertions, and \p maxTiles must be at least the number of tiles
+ //! needed for a single map.
+ //!
+ //! \param[in] maxTiles Maximum number of tiles. A value of zero, the
+ //! default, means no limit
+ //
+ void SetMaxTiles(size_t maxTiles);
+
+ //! Return the number of image tiles currently stored
+ //
+ size_t GetNumTiles() const { return(_tiles.size()); }
+
  //! Return a pointer to an image tile 
  //!
  //! This method returns a pointer to the image tile associated with
@@ -280,6 +311,14 @@ public:
 private:
  size_t _pixel_size;
  std::map <std::string, unsigned char *> _tiles;
+ size_t _maxTiles;
+
+ // Quad Keys ordered most recently used first, and each key's position
+ //
+ std::list <std::string> _lru;
+ std::map <std::string, std::list <std::string>::iterator> _lruPos;
+
+ void _evict(size_t maxTiles);
 
  void _CopyTileToMap(
 	const unsigned char *tile, size_t tilePixelX0, size_t tilePixelY0,
@@ -830,14 +830,22 @@ public:
 
  private:
   InsideBox _pred;
-  ConstCoordItr _coordItr;
+  const Grid *_g;
+  std::vector <size_t> _min;	// index space bounds of box
+  std::vector <size_t> _max;
+  bool _exact;	// true if all nodes in [_min, _max] are inside box
+  std::vector <double> _coords;
 
+  bool _advance();
+  bool _inside();
  };
 
  //! Return constant grid node coordinate iterator
  //!
  //! If \p minu and \p maxu are specified the iterator is constrained to
  //! operation within the axis-aligned box defined by \p minu and \p maxu.
+ //! For structured grids only the nodes within the index space bounds
+ //! of the box are visited.
  //!
  //! \param[in] minu Minimum box coordinate.
  //! \param[in] maxu Maximum box coordinate.
@@ -926,19 +934,24 @@ public:
 
  private:
   InsideBox _pred;
-#ifdef	VAPOR3_0_0
-  ConstCoordItr _coordItr;
-#else
   const Grid *_g;
-  bool _cellInsideBox(const std::vector <size_t> &cindices) const;
-#endif
-
+  std::vector <size_t> _min;	// index space bounds of box
+  std::vector <size_t> _max;
+  bool _exact;	// true if all cells in [_min, _max] are inside box
+  std::vector <std::vector <size_t> > _nodes;
+  std::vector <double> _coords;
+
+  bool _advance();
+  bool _cellInsideBox(const std::vector <size_t> &cindices);
  };
 
  //! Return constant grid cell coordinate iterator
  //!
  //! If \p minu and \p maxu are specified the iterator is constrained to
  //! operation within the axis-aligned box defined by \p minu and \p maxu.
+ //! A cell is inside the box if all of its nodes are. For structured
+ //! grids only the cells within the index space bounds of the box 
+ //! are visited.
  //!
  //! \param[in] minu Minimum box coordinate.
  //! \param[in] maxu Maximum box coordinate.
@@ -1038,6 +1051,9 @@ public:
 	std::swap(a._xb, b._xb);
 	std::swap(a._itr, b._itr);
 	std::swap(a._pred, b._pred);
+	std::swap(a._min3d, b._min3d);
+	std::swap(a._max3d, b._max3d);
+	std::swap(a._exact, b._exact);
 
   }
 
@@ -1053,6 +1069,14 @@ public:
   size_t _xb;	// x index within a block
   float *_itr;
   InsideBox _pred;
+  std::vector <size_t> _min3d;	// index space bounds of box
+  std::vector <size_t> _max3d;
+  bool _exact;	// true if all elements in [_min3d, _max3d] are inside box
+
+  size_t _linearIndex(const std::vector <size_t> &index) const {
+	return(index[0] + _dims3d[0] * (index[1] + _dims3d[1] * index[2]));
+  }
+  void _setItr();
 
  };
 
@@ -1116,6 +1140,22 @@ private:
 	const std::vector <double> &coords, double &x, double &y, double &z
  ) const;
 
+ // Compute the range of node indices, [min, max], that may be inside 
+ // or on the box defined by minu and maxu. Nodes outside of the range
+ // must be outside of the box. If exact is true all nodes inside the 
+ // range are also inside the box. An empty range is indicated by 
+ // min[i] > max[i] for some i. 
+ //
+ // Returns false if the range can't be computed, in which case the 
+ // entire grid must be searched. Used by the bounding box iterators.
+ //
+ virtual bool _getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+ ) const {
+	return(false);
+ }
+
 };
 };
 #endif
@@ -11,6 +11,7 @@
 #include <vapor/StretchedGrid.h>
 #include <vapor/UnstructuredGrid2D.h>
 #include <vapor/UnstructuredGridLayered.h>
+#include <vapor/CellLocator2D.h>
 
 #ifndef	GRIDMGR_H
 #define GRIDMGR_H
@@ -21,7 +22,8 @@ class VDF_API GridHelper : public Wasp::MyBase {
 
 public:
 
- GridHelper(size_t max_size = 10) : _kdtreeCache(max_size) {}
+ GridHelper(size_t max_size = 10) : 
+	_kdtreeCache(max_size), _locatorCache(max_size) {}
 
  ~GridHelper();
 
@@ -158,6 +160,7 @@ private:
  };
 
  lru_cache<string, KDTreeRG> _kdtreeCache;
+ lru_cache<string, CellLocator2D> _locatorCache;
 
 
  RegularGrid *_make_grid_regular(
@@ -307,6 +310,26 @@ UnstructuredGridLayered *_make_grid_unstructured_layered(
     const vector <size_t> &bmax
  );
 
+ string _getMeshKey(
+    size_t ts,
+    int level,
+    const vector <DC::CoordVar> &cvarsinfo,
+    const vector <size_t> &bmin,
+    const vector <size_t> &bmax
+ ) const;
+
+ // Return the cached cell locator for a mesh. The locator is empty
+ // until the first grid sharing it is queried, which builds it from
+ // the grid's own coordinates.
+ //
+ CellLocator2D *_getCellLocator2D(
+    size_t ts,
+    int level,
+    const vector <DC::CoordVar> &cvarsinfo,
+    const vector <size_t> &bmin,
+    const vector <size_t> &bmax
+ );
+
 
 };
 
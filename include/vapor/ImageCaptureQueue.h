@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#ifndef WIN32
+#include <pthread.h>
+#endif
+#include <vapor/MyBase.h>
+#include <vapor/common.h>
+
+namespace VAPoR {
+
+//! \class ImageCaptureQueue
+//! \ingroup Public_Render
+//!
+//! \brief Encodes captured frames to image files on background threads
+//!
+//! Frames handed to Enqueue() are flipped to top-down order and written
+//! as TIFF or JPEG by a pool of encoder threads, so the render loop can
+//! continue while earlier frames are compressed. The number of frames
+//! waiting to be encoded is bounded; Enqueue() blocks when the queue is
+//! full. Pixel buffers are recycled through GetBuffer() to avoid a fresh
+//! allocation per frame.
+//!
+//! PNG files are written through the embedded Python interpreter, which
+//! may only be used from the thread that initialized it. PNG frames are
+//! therefore encoded synchronously by Enqueue().
+//!
+//! Errors raised by encoder threads are reported on the calling thread
+//! by the next call to Enqueue() or Wait().
+//!
+//! If no encoder thread can be started (or on Windows), all frames are
+//! encoded synchronously by Enqueue().
+//
+class RENDER_API ImageCaptureQueue : public Wasp::MyBase {
+public:
+
+    //! \param[in] nthreads Number of encoder threads. If less than one,
+    //! the number of processors is used, capped at four.
+    //! \param[in] maxPending Maximum number of frames queued for
+    //! encoding. If less than one, twice the number of threads is used.
+    //
+    ImageCaptureQueue(int nthreads = 0, int maxPending = 0);
+    ~ImageCaptureQueue();
+
+    //! Return a buffer of at least \p size bytes
+    //!
+    //! The buffer is taken from the pool of buffers released by
+    //! completed encodings, if one is large enough. Ownership
+    //! passes to the caller until the buffer is handed back with
+    //! Enqueue() or ReleaseBuffer()
+    //
+    unsigned char *GetBuffer(size_t size);
+
+    //! Return a buffer obtained with GetBuffer() to the pool without
+    //! encoding it
+    //
+    void ReleaseBuffer(unsigned char *buf);
+
+    //! Queue an RGB image for encoding
+    //!
+    //! \param[in] filename Output file. The suffix (.tif, .tiff, .jpg,
+    //! .jpeg, or .png) selects the encoder
+    //! \param[in] width Image width in pixels
+    //! \param[in] height Image height in pixels
+    //! \param[in] buf Buffer obtained from GetBuffer() containing
+    //! 3 * \p width * \p height bytes of RGB data. Ownership
+    //! returns to the queue.
+    //! \param[in] bottomUp If true rows in \p buf are ordered bottom to
+    //! top, as returned by glReadPixels()
+    //!
+    //! \retval status Returns a negative value if this or a previously
+    //! queued frame failed to encode
+    //
+    int Enqueue(
+        std::string filename, size_t width, size_t height,
+        unsigned char *buf, bool bottomUp
+    );
+
+    //! Block until all queued frames have been written
+    //!
+    //! \retval status Returns a negative value if any frame queued since
+    //! the last call failed to encode
+    //
+    int Wait();
+
+    //! Return the number of frames queued or being encoded
+    //
+    size_t GetNumPending();
+
+    //! Synchronously write an RGB image, ordered top to bottom, to a file
+    //!
+    //! \retval status Returns a negative value on failure, and sets
+    //! \p errMsg
+    //
+    static int WriteImage(
+        std::string filename, size_t width, size_t height,
+        unsigned char *buf, std::string &errMsg
+    );
+
+private:
+
+    struct Job {
+        std::string filename;
+        size_t width;
+        size_t height;
+        unsigned char *buf;
+        bool bottomUp;
+    };
+
+#ifndef WIN32
+    std::vector <pthread_t> _threads;
+    pthread_mutex_t _mutex;
+    pthread_cond_t _jobReady;
+    pthread_cond_t _jobDone;
+#endif
+    std::deque <Job> _jobs;
+    std::vector <std::pair <unsigned char *, size_t> > _freeBuffers;
+    std::vector <std::pair <unsigned char *, size_t> > _busyBuffers;
+    std::vector <std::string> _errors;
+    size_t _maxPending;
+    size_t _nActive;
+    bool _shutdown;
+
+    static void *_runWorker(void *arg);
+    void _workerLoop();
+    void _lock();
+    void _unlock();
+    void _encode(const Job &job);
+    int _reportErrors();
+    static void _flipRows(unsigned char *buf, size_t width, size_t height);
+};
+
+};
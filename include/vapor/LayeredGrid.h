@@ -331,6 +331,11 @@ private:
 	size_t i, size_t j, double z, size_t &k
  ) const;
 
+ bool _getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+ ) const override;
+
 };
 };
 #endif
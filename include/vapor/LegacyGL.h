@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <glm/glm.hpp>
 #include "vapor/ShaderProgram.h"
 
 /*
@@ -30,6 +31,12 @@ struct GLManager;
 //!
 //! This class should not be used for any intensive rendering
 //!
+//! Vertices are streamed through a single ring buffer. Between BeginBatch()
+//! and EndBatch(), consecutive untextured Begin/End blocks that share the
+//! same mode, matrices and lighting state are merged into one draw call.
+//! Any GL state that affects the merged blocks (line width, blending,
+//! depth test, etc.) must not change inside a batch.
+//!
 //! \author Stanislaw Jaroszynski
 //! \date   August, 2018
     
@@ -56,6 +63,27 @@ class RENDER_API LegacyGL {
     bool _lightingEnabled, _textureEnabled;
     float _lightDir[3];
     
+    size_t _bufferSize, _bufferOffset;
+    
+    std::vector<VertexData> _batch;
+    unsigned int _batchMode;
+    glm::mat4 _batchP, _batchMV;
+    bool _batchLighting;
+    float _batchLightDir[3];
+    int _batchDepth;
+    
+    ShaderProgram *_shader;
+    bool _uniformsSet;
+    glm::mat4 _shaderP, _shaderMV;
+    bool _shaderLighting, _shaderTexture;
+    float _shaderLightDir[3];
+    
+    void Draw(
+        unsigned int mode, const glm::mat4 &P, const glm::mat4 &MV,
+        bool lighting, bool texture, const float *lightDir,
+        const std::vector<VertexData> &vertices
+    );
+    
 public:
     LegacyGL(GLManager *glManager);
     ~LegacyGL();
@@ -79,9 +107,19 @@ public:
     void TexCoord(glm::vec2);
     void TexCoord2f(float s, float t);
     
+    //! Start merging subsequent Begin/End blocks. Calls may be nested;
+    //! pending geometry is drawn when the outermost EndBatch() is reached
+    void BeginBatch();
+    void EndBatch();
+    
+    //! Draw any geometry held back by the current batch
+    void Flush();
+    
     void EnableLighting();
     void DisableLighting();
     void LightDirectionfv(const float *f);
+    bool IsLightingEnabled() const { return _lightingEnabled; }
+    void GetLightDirection(float *f) const;
     void EnableTexture();
     void DisableTexture();
     
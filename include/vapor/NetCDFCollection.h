@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <map>
+#include <list>
 
 #include <sstream>
 #include <netcdf.h>
@@ -132,6 +133,72 @@ public:
 	const std::vector <string> &time_coordvar
  );
 
+ //! Set the directory used to catalog the metadata of netCDF files
+ //!
+ //! When a catalog directory is set, Initialize() saves the metadata
+ //! of every file it scans (dimensions, variables, attributes, and 
+ //! time coordinates) in a catalog in \p dir, one catalog per data
+ //! directory. Subsequent calls to Initialize() restore the metadata
+ //! of files whose modification time and size are unchanged from 
+ //! the catalog, without opening them. Only new or modified files are
+ //! rescanned.
+ //!
+ //! Catalogs are an optimization: if one can't be read or written,
+ //! the files are scanned as usual.
+ //!
+ //! \param[in] dir An existing directory, or the empty string to
+ //! disable catalogs (the default)
+ //!
+ static void SetCatalogDirectory(string dir) {
+	_catalogDirectory = dir;
+ }
+ static string GetCatalogDirectory() {
+	return(_catalogDirectory);
+ }
+
+ //! Set the maximum number of netCDF files held open at once
+ //!
+ //! Files are opened on demand by OpenRead(). Once more than \p n
+ //! files are open, the least recently used files that have no open
+ //! variables are closed, releasing their file descriptors and
+ //! chunk caches. Closed files are reopened transparently when next
+ //! read. Files with open variables are never closed, so the limit
+ //! may be exceeded temporarily.
+ //!
+ //! The limit applies to each class instance.
+ //!
+ //! \param[in] n Maximum number of open files. A value of zero 
+ //! removes the limit. The default is 64.
+ //!
+ //! \sa SetChunkSizeHint()
+ //
+ static void SetMaxOpenFiles(size_t n) {
+	_maxOpenFiles = n;
+ }
+ static size_t GetMaxOpenFiles() {
+	return(_maxOpenFiles);
+ }
+
+ //! Set the chunk size hint used when opening netCDF files
+ //!
+ //! Sweeps through long time series touch many files but read little
+ //! from each; a small hint keeps the per-file buffer, and hence total
+ //! memory, small. Reading large volumes from a few files favors
+ //! a larger hint. Files already open keep their current buffer size
+ //! until they are closed.
+ //!
+ //! \param[in] chsz Chunk size hint in bytes, passed to nc__open().
+ //! The default is 4MB.
+ //!
+ //! \sa NetCDFSimple::SetChunkSizeHint(), SetMaxOpenFiles()
+ //
+ static void SetChunkSizeHint(size_t chsz) {
+	_chunkSizeHint = chsz;
+ }
+ static size_t GetChunkSizeHint() {
+	return(_chunkSizeHint);
+ }
+
  //! Return a boolean indicating whether a variable exists in the 
  //! data collection.
  //!
@@ -680,6 +747,37 @@ public:
  //
  virtual int Close(int fd=0);
 
+ //! Read a hyperslab of a variable at a sequence of time steps
+ //!
+ //! This method reads the region identified by \p start and \p count
+ //! at each time step in \p timesteps, storing the results one after
+ //! another in \p data (time varies slowest). Time steps 
+ //! stored as consecutive records of the same file are read
+ //! with a single hyperslab request, so extracting a time series
+ //! for a small region costs one read per file rather than one per
+ //! time step. 
+ //!
+ //! Derived and staggered variables are read one time step at a time.
+ //! The variable need not be opened with OpenRead().
+ //!
+ //! \param[in] timesteps Time steps to read, typically increasing
+ //! \param[in] varname Name of the variable to read
+ //! \param[in] start Start vector with one element for each spatial
+ //! dimension, ordered slowest varying first
+ //! \param[in] count Count vector with one element for each spatial 
+ //! dimension
+ //! \param[out] data Storage for timesteps.size() hyperslabs
+ //!
+ //! \retval status A negative int is returned on failure
+ //!
+ //! \sa Read(), OpenRead()
+ //
+ virtual int ReadTimeSeries(
+	const std::vector <size_t> &timesteps, string varname,
+	const std::vector <size_t> &start, const std::vector <size_t> &count,
+	float *data
+ );
+
  //! Identify staggered dimensions
  //!
  //! This method informs the class instance of any staggered dimensions.
@@ -846,6 +944,13 @@ private:
  std::vector <string> _failedVars;	// Varibles that could not be added
  std::map <string, DerivedVar *> _derivedVarsMap;
  DerivedVar * _derivedVar; // if current opened variable is derived this is it
+ static string _catalogDirectory;
+ static size_t _maxOpenFiles;
+ static size_t _chunkSizeHint;
+
+ // Files with an open netCDF handle, most recently used first
+ //
+ std::list <NetCDFSimple *> _openFiles;
 
  // 
  // file handle for an open variable
@@ -874,10 +979,25 @@ private:
 
  void ReInitialize();
 
+ int _ScanFiles(
+	const std::vector <string> &files,
+	const std::vector <string> &time_coordvars,
+	std::map <string, std::map <string, std::vector <double> > > &tcvValues
+ );
+
+ int _ScanFile(
+	string file, const std::vector <string> &time_coordvars, 
+	string &metadata
+ ) const;
+
+ void _TouchFile(NetCDFSimple *netcdf);
+ void _TrimOpenFiles();
+
  int _InitializeTimesMap(
     const std::vector <string> &files, 
 	const std::vector <string> &time_dimnames,
     const std::vector <string> &time_coordvars,
+	const std::map <string, std::map <string, std::vector <double> > > &tcvValues,
     std::map <string, std::vector <double> > &timesMap,
 	std::vector <double> &times,
 	int &file_org
@@ -898,6 +1018,7 @@ private:
 	const std::vector <string> &files,
 	const std::vector <string> &time_dimnames,
 	const std::vector <string> &time_coordvars,
+	const std::map <string, std::map <string, std::vector <double> > > &tcvValues,
     std::map <string, std::vector <double> > &timesMap
  ) const;
 
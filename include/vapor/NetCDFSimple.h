@@ -159,6 +159,68 @@ public:
  //!
  int Initialize(string path);
 
+ //! Write the metadata of the current file to a stream
+ //!
+ //! This method writes, in a compact binary form, everything 
+ //! Initialize() gathered from the file: dimensions, global attributes,
+ //! and variable definitions. The result can be restored with 
+ //! LoadMetadata() without opening the netCDF file.
+ //!
+ //! \param[out] os Output stream, opened in binary mode
+ //!
+ //! \retval status A negative int is returned on failure
+ //!
+ //! \sa LoadMetadata(), Initialize()
+ //
+ int SaveMetadata(std::ostream &os) const;
+
+ //! Initialize the class instance from metadata saved by SaveMetadata()
+ //!
+ //! This method is an alternative to Initialize() for files whose
+ //! metadata was previously saved. The netCDF file named by \p path
+ //! is not accessed until a variable is opened with OpenRead().
+ //!
+ //! \param[in] path Path to the netCDF file the metadata describes
+ //! \param[in] is Input stream, opened in binary mode
+ //!
+ //! \retval status A negative int is returned if the stream could not
+ //! be parsed
+ //!
+ //! \sa SaveMetadata(), Initialize()
+ //
+ int LoadMetadata(string path, std::istream &is);
+
+ //! Write a value to a binary stream
+ //!
+ //! Helpers for SaveMetadata() and LoadMetadata(), also used by 
+ //! classes that cache metadata. Values are stored in native byte 
+ //! order; the result is meant as a cache for the host that wrote it
+ //!
+ //! \sa ReadValue(), WriteString()
+ //
+ template <class T> static void WriteValue(std::ostream &os, const T &v) {
+	os.write((const char *) &v, sizeof(v));
+ }
+
+ //! Read a value written by WriteValue()
+ //!
+ //! \retval status False if the stream could not be read
+ //
+ template <class T> static bool ReadValue(std::istream &is, T &v) {
+	return((bool) is.read((char *) &v, sizeof(v)));
+ }
+
+ //! Write a string to a binary stream, preceded by its length
+ //
+ static void WriteString(std::ostream &os, const string &s);
+
+ //! Read a string written by WriteString()
+ //!
+ //! \retval status False if the stream could not be read, or holds
+ //! an implausible length
+ //
+ static bool ReadString(std::istream &is, string &s);
+
  //! Open the named variable for reading
  //!
  //! This method prepares a netCDF variable
@@ -212,6 +274,51 @@ public:
  //
  int Close(int fd = 0);
 
+ //! Close the netCDF file
+ //!
+ //! The netCDF file is opened by the first call to OpenRead() and, 
+ //! by default, stays open for the lifetime of the class instance. This
+ //! method releases the file handle, and the library's chunk cache,
+ //! early. The file is transparently reopened by the next call to
+ //! OpenRead().
+ //!
+ //! \retval status A negative int is returned on failure, or if 
+ //! any variables are still open
+ //!
+ //! \sa IsFileOpen(), HasOpenVariables()
+ //
+ int CloseFile();
+
+ //! Return true if the netCDF file is currently open
+ //
+ bool IsFileOpen() const {
+	return(_ncid != -1);
+ }
+
+ //! Return true if any variables are open for reading
+ //
+ bool HasOpenVariables() const {
+	return(! _ovr_table.empty());
+ }
+
+ //! Set the chunk size hint passed to nc__open()
+ //!
+ //! The hint sets the size of the I/O buffer the netCDF library 
+ //! allocates for the file. Large values favor reading whole variables;
+ //! small values bound memory use when many files are open at once.
+ //! The hint takes effect the next time the file is opened.
+ //!
+ //! \param[in] chsz Chunk size hint in bytes. The default is 4MB
+ //!
+ //! \sa CloseFile()
+ //
+ void SetChunkSizeHint(size_t chsz) {
+	_chsz = chsz;
+ }
+ size_t GetChunkSizeHint() const {
+	return(_chsz);
+ }
+
  //! Return a vector of the Variables contained in the file
  //!
  //! This method returns a vector of Variable objects containing
@@ -19,10 +19,13 @@
 #include <vapor/Grid.h>
 #include <vapor/utils.h>
 #include <vapor/GetAppPath.h>
+#include <vapor/EasyThreads.h>
 
 namespace VAPoR 
 {
 
+class ShaderProgram;
+
 class RENDER_API RayCaster : public Renderer
 {
 public:
@@ -58,8 +61,16 @@ protected:
         float *frontFace, *backFace;     // user coordinates, size == bx * by * 3
         float *rightFace, *leftFace;     // user coordinates, size == by * bz * 3
         float *topFace,   *bottomFace;   // user coordinates, size == bx * bz * 3   
-        float *dataField;                // data field of this volume
+        float *dataField;                // data field of this volume, used when dataBits == 32
         unsigned char* missingValueMask; // 0 == is missing value; non-zero == not missing value
+        unsigned char* quantizedField;   // 8- or 16-bit codes of this volume, used when 
+                                         //   dataBits < 32. Code 0 marks a missing value,
+                                         //   codes 1 to CodeMax() map to valueRange.
+        int     dataBits;                // 32, 16, or 8 bits per voxel
+        bool    hasMissingValue;         // if this volume has any missing value
+        float *macroCellField;           // min and max values of each macro cell, size == 
+                                         //   macroDims[0] * macroDims[1] * macroDims[2] * 2
+        size_t  macroDims[3];            // num. of macro cells along each axis
         float   valueRange[2];           // min and max values of the volume
         size_t  dims[3];                 // num. of samples along each axis
         float   boxMin[3], boxMax[3];    // bounding box of the current volume
@@ -78,6 +89,7 @@ protected:
         size_t      myCurrentTimeStep;
         std::string myVariableName;
         int         myRefinementLevel, myCompressionLevel;
+        int         myDataBits;
 
         /* Member functions */
         UserCoordinates();    
@@ -87,11 +99,31 @@ protected:
         bool IsUpToDate(                const RayCasterParams* params,
                                               DataMgr*         dataMgr ) const;
         bool UpdateCoordinates(         const RayCasterParams* params,
-                                              DataMgr*         dataMgr );
+                                              DataMgr*         dataMgr,
+                                              Wasp::EasyThreads* et = nullptr );
+
+        // Largest code of quantizedField, or 0 if the volume is stored as floats
+        unsigned int CodeMax() const
+        {
+            return dataBits == 32 ? 0u : (1u << dataBits) - 1u;
+        }
+
+        //
+        // Compute the range of dataField over each macro cell of MacroCellSize^3 
+        //   voxels. The range of a macro cell also covers the voxels one step
+        //   outside of it, so that trilinear interpolation anywhere inside the
+        //   cell stays within the range. Macro cells made up entirely of
+        //   missing values get an empty range (min > max).
+        //
+        void UpdateMacroCells();
+
+        static const int MacroCellSize = 8;
     };  // end of struct UserCoordinates 
 
     UserCoordinates     _userCoordinates;
     std::vector<float>  _colorMap;
+    std::vector<float>  _opacityPrefixSum;  // _opacityPrefixSum[i] = sum of opacities of
+                                            //   the first i entries of _colorMap
     float               _colorMapRange[2];
 
     // OpenGL stuff
@@ -101,6 +133,8 @@ protected:
     GLuint              _volumeTextureId;           // GL_TEXTURE2
     GLuint              _missingValueTextureId;     // GL_TEXTURE3
     GLuint              _colorMapTextureId;         // GL_TEXTURE4 
+    GLuint              _macroCellTextureId;        // GL_TEXTURE5
+    GLuint              _opacityPrefixTextureId;    // GL_TEXTURE6
 
     // buffers
     GLuint              _frameBufferId;
@@ -112,10 +146,23 @@ protected:
     GLuint              _vertexBufferId; 
     GLuint              _indexBufferId; 
 
+    // formats and dimensions of the 3D textures currently allocated, 
+    //   so that same-size updates can reuse the texture storage
+    GLint               _volumeTextureFormat;
+    size_t              _volumeTextureDims[3];
+    GLint               _missingValueTextureFormat;
+    size_t              _missingValueTextureDims[3];
+    GLint               _macroCellTextureFormat;
+    size_t              _macroCellTextureDims[3];
+
+    // threads used to convert grids into volume textures
+    Wasp::EasyThreads*  _et;
+
     // shaders
     GLuint              _1stPassShaderId;
     GLuint              _2ndPassShaderId;
     GLuint              _3rdPassShaderId;
+    std::vector<ShaderProgram*> _shaderPrograms;    // owners of the ids above
 
     // current viewport in use
     GLint               _currentViewport[4];
@@ -139,13 +186,20 @@ protected:
 
     virtual void _3rdPassSpecialHandling( bool fast );
 
+    //
+    // Upload the data field, missing value mask, and macro cells of 
+    //   _userCoordinates to their 3D textures.
+    //
+    void _updateVolumeTextures();
+
     // 
     // Initialization for 1) framebuffers and 2) textures 
     //
     void _initializeFramebufferTextures();
 
     // 
-    // Simple shader compilation
+    // Shader compilation through the ShaderManager binary cache. 
+    //   Returns the program id, or 0 on failure.
     //
     GLuint _compileShaders(const char* vertex_file_path,
                            const char* fragment_file_path );
@@ -42,10 +42,19 @@ public:
     std::vector<double> GetLightingCoeffs() const;
     void SetLightingCoeffs( const std::vector<double>& coeffs );
 
+    //
+    //! Number of bits per voxel used to store the volume on the GPU.
+    //! 32 keeps full float precision. 16 and 8 store normalized integer 
+    //! codes, which take 2 and 4 times less memory.
+    //
+    long GetVolumeTextureBits() const;
+    void SetVolumeTextureBits( long bits );
+
 protected:
 
     static const std::string _lightingTag;
     static const std::string _lightingCoeffsTag;
+    static const std::string _volumeTextureBitsTag;
 };
 
 }
@@ -177,6 +177,10 @@ private:
  std::vector <double> _maxu;	// User coords of first and last voxel
  std::vector <double> _delta;	// increment between grid points in user coords
 
+ bool _getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+ ) const override;
 
 };
 };
@@ -11,20 +11,74 @@ namespace VAPoR {
 //!
 //! \brief Resource management class for shaders
 //!
+//! If a binary cache directory is set, linked programs are saved there
+//! with glGetProgramBinary and restored with glProgramBinary the next
+//! time they are requested, skipping GLSL compilation. Cache entries are
+//! keyed by a hash of the shader sources, with \#include lines expanded,
+//! and the GL vendor, renderer and version strings. Any entry the driver
+//! rejects is rebuilt from source.
+//!
 //! \author Stanislaw Jaroszynski
 //! \date    August, 2018
     
 class RENDER_API ShaderManager : public IResourceManager<std::string, ShaderProgram> {
     std::map<std::string, long> _modifiedTimes;
+    std::string _binaryCacheDirectory;
     
     std::vector<std::string> _getSourceFilePaths(const std::string &name) const;
     bool _wasFileModified(const std::string &path) const;
+    std::string _getBinaryCachePath(const std::string &name, const std::vector<std::string> &paths) const;
+    ShaderProgram *_loadCachedProgram(const std::string &path) const;
+    void _saveCachedProgram(const std::string &path, const ShaderProgram *program) const;
+    ShaderProgram *_buildProgram(const std::string &name, const std::vector<std::string> &paths) const;
     
 public:
     ShaderProgram *GetShader(const std::string &name);
     SmartShaderProgram GetSmartShader(const std::string &name);
     int LoadResourceByKey(const std::string &name);
     
+    //! Enable the on-disk program binary cache. An empty \p path
+    //! disables it.
+    //!
+    //! \param[in] path existing directory to store program binaries in
+    //!
+    //! \retval 1 is returned on success
+    //! \retval -1 is returned if \p path is not a directory
+    //!
+    int SetBinaryCacheDirectory(const std::string &path);
+    
+    //! Load every shader program found in the resource directory
+    //!
+    //! Moves compilation (or binary cache loading) of all programs to
+    //! the time of the call, instead of the first frame of each renderer.
+    //! With the binary cache enabled, this may also be called once on a
+    //! separate context to populate the cache ahead of time.
+    //!
+    //! \retval 1 is returned on success
+    //! \retval -1 is returned if any program failed to build
+    //!
+    int PrecompileShaders();
+    
+    //! Build a program from shader source files outside of the resource
+    //! directory, through the binary cache. Unlike GetShader(), the
+    //! program is not managed and the caller must delete it.
+    //!
+    //! \param[in] paths GLSL source code files, one per shader stage. The
+    //! shader type of each is determined by GetShaderTypeFromPath()
+    //!
+    //! \retval ShaderProgram* is returned on success
+    //! \retval nullptr is returned on failure
+    //!
+    ShaderProgram *CompileNewProgramFromFiles(const std::vector<std::string> &paths) const;
+    
+    //! Read a GLSL source code file, replacing each "#include name" line
+    //! with the contents of \p name from an "includes" directory in, or
+    //! one level above, the directory of \p path
+    //!
+    //! \param[in] path to GLSL source code file
+    //!
+    static std::string ReadShaderSource(const std::string &path);
+    
     //! \param[in] path to GLSL source code file
     //!
     //! \retval Shader* is returned on success
@@ -33,7 +87,8 @@ public:
     static Shader *CompileNewShaderFromFile(const std::string &path);
     
     //! Returns an OpenGL shader type enum based on the file extension.
-    //! Valid extensions are .vert, .frag, and .geom
+    //! Valid extensions are .vert, .frag, and .geom, and .vgl and .fgl
+    //! for vertex and fragment shaders
     //!
     //! \param[in] path to GLSL source code file
     //!
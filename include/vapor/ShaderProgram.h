@@ -50,6 +50,31 @@ public:
     //!
     int AddShaderFromSource(unsigned int type, const char *source);
     
+    //! Create the program from a binary previously returned by GetBinary()
+    //!
+    //! \param[in] format binary format returned by GetBinary()
+    //! \param[in] data binary program
+    //! \param[in] size size of \p data in bytes
+    //!
+    //! \retval 1 is returned on success
+    //! \retval -1 is returned if the binary was rejected, e.g. because
+    //! the driver has changed. The program is left unlinked so it may
+    //! still be built from source.
+    //!
+    int LoadBinary(unsigned int format, const void *data, size_t size);
+    
+    //! Retrieve the driver specific binary of a linked program
+    //!
+    //! \retval 1 is returned on success
+    //! \retval -1 is returned on failure
+    //!
+    int GetBinary(unsigned int *format, std::vector<char> *data) const;
+    
+    //! Returns true if the current context can save and restore
+    //! program binaries
+    //!
+    static bool IsBinarySupported();
+    
     unsigned int GetID() const;
     unsigned int WasLinkingSuccessful() const;
     
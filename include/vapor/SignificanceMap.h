@@ -195,6 +195,19 @@ public:
  //
  static size_t GetMapSize(vector <size_t> dims, size_t num_entries);
 
+ //! Return the number of entries in an encoded significance map
+ //!
+ //! This static member method decodes only the header of a map 
+ //! returned by GetMap(), returning the number of entries the 
+ //! map contains without decoding the entries themselves.
+ //!
+ //! \param[in] map An encoded significance map
+ //! \param[out] num_entries The number of entries in \p map
+ //! \retval status a negative value is returned if \p map is not
+ //! a valid encoded map
+ //
+ static int GetNumEntries(const unsigned char *map, size_t &num_entries);
+
  //! Return size in bytes of an encoded signficance map of given size
  //!
  //! This method returns the size in bytes of an encoded 
@@ -224,6 +224,11 @@ private:
 
  virtual void _getMinCellExtents(std::vector <double> &minCellExtents) const; 
 
+ bool _getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+ ) const override;
+
 };
 };
 #endif
@@ -126,6 +126,35 @@ public:
 
 protected: 
 
+ // Compute the range of indices, [lo, hi], of the regularly spaced
+ // coordinates i * delta + origin, 0 <= i < n, that are inside or on 
+ // the interval [umin, umax]. An empty range is returned as lo > hi. 
+ // delta must be positive if n > 1.
+ //
+ static void _regularIndexRange(
+	double origin, double delta, size_t n, double umin, double umax,
+	size_t &lo, size_t &hi
+ );
+
+ // Compute the range of indices, [lo, hi], of the increasing 
+ // coordinates in u that are inside or on the interval [umin, umax]. 
+ // An empty range is returned as lo > hi
+ //
+ static void _sortedIndexRange(
+	const std::vector <double> &u, double umin, double umax,
+	size_t &lo, size_t &hi
+ );
+
+ // Shrink the vertical index range, [min[2], max[2]], by trimming layers
+ // whose nodes, within the horizontal range given by min and max, all
+ // have vertical coordinates outside of [zmin, zmax]. The vertical 
+ // coordinates are given by the data values of zg.
+ //
+ static void _layerIndexRange(
+	const Grid &zg, double zmin, double zmax,
+	std::vector <size_t> &min, std::vector <size_t> &max
+ );
+
 private:
  std::vector <size_t> _cellDims;
 
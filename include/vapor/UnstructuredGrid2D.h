@@ -8,6 +8,7 @@
 #include <vapor/UnstructuredGrid.h>
 #include <vapor/UnstructuredGridCoordless.h>
 #include <vapor/KDTreeRG.h>
+#include <vapor/CellLocator2D.h>
 
 
 #ifdef WIN32
@@ -27,6 +28,12 @@ public:
 
  //! Construct a unstructured grid sampling 2D scalar function
  //!
+ //! \param[in] locator An optional CellLocator2D instance for the
+ //! faces of the grid. If provided, it is used in place of \p kdtree
+ //! to find the face containing a point. If the locator has not been
+ //! built it is built from \p xug, \p yug and \p vertexOnFace on the
+ //! first point query. Both \p kdtree and \p locator are shallow
+ //! copied and must remain valid for the life of this grid.
  //
  UnstructuredGrid2D(
 	const std::vector <size_t> &vertexDims,
@@ -43,7 +50,8 @@ public:
 	const UnstructuredGridCoordless &xug,
 	const UnstructuredGridCoordless &yug,
 	const UnstructuredGridCoordless &zug,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator = NULL
  );
 
  UnstructuredGrid2D() = default;
@@ -114,6 +122,22 @@ void GetIndices(
 	const std::vector <double> &coords
  ) const override;
 
+ //! Return the values of the grid at many points
+ //!
+ //! This is a batched version of GetValue() for points in the XY plane.
+ //! Points outside of the grid are assigned GetMissingValue().
+ //!
+ //! \param[in] n Number of points
+ //! \param[in] x X user coordinates of \p n points
+ //! \param[in] y Y user coordinates of \p n points
+ //! \param[out] values Storage for \p n values
+ //!
+ //! \sa GetValue()
+ //
+ void GetValues(
+	size_t n, const double *x, const double *y, float *values
+ ) const;
+
 
  /////////////////////////////////////////////////////////////////////////////
  //
@@ -180,6 +204,9 @@ private:
  UnstructuredGridCoordless _yug;
  UnstructuredGridCoordless _zug;
  const KDTreeRG *_kdtree;
+ CellLocator2D *_locator;
+
+ const CellLocator2D *_getLocator() const;
 
  bool _insideGrid(
 	const std::vector <double> &coords,
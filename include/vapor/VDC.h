@@ -300,6 +300,65 @@ public:
 	std::vector <size_t> &cratios
  ) const;
 
+ //! Set an error bound for subsequent compressed data variable definitions
+ //!
+ //! When an error bound is set, compressed data variables defined
+ //! afterwards with DefineDataVar() retain, for each block, only as many
+ //! wavelet coefficients as are needed to reconstruct the block
+ //! at its finest compression level with a maximum absolute error no
+ //! greater than the bound. The compression ratios specified with
+ //! SetCompressionBlock() then serve as upper limits on the storage
+ //! of each level. The bound can only be guaranteed if the smallest
+ //! compression ratio is one.
+ //!
+ //! \param[in] max_error The error bound. A negative value disables
+ //! error bounded compression, which is the default.
+ //! \param[in] relative If true \p max_error is relative to the range
+ //! of the data written by each call to Write(), WriteSlice() or PutVar().
+ //! Data written with WriteSlice() are bounded relative to the range 
+ //! of each slab of slices, not of the whole variable.
+ //!
+ //! \sa SetCompressionBlock(), DefineDataVar(), WASP::DefVar(),
+ //! DC::GetErrorBound()
+ //
+ void SetErrorBound(double max_error, bool relative) {
+	_maxError = max_error;
+	_relativeError = relative;
+ }
+
+ //! Retrieve the current error bound settings
+ //!
+ //! \sa SetErrorBound()
+ //
+ void GetErrorBound(double &max_error, bool &relative) const {
+	max_error = _maxError;
+	relative = _relativeError;
+ }
+
+ //! Set the coefficient quantization for subsequent compressed data 
+ //! variable definitions
+ //!
+ //! When \p nbits is non-zero, the wavelet coefficients of compressed 
+ //! data variables defined afterwards with DefineDataVar() are 
+ //! quantized to \p nbits bits and entropy coded, rather than stored
+ //! with the variable's external type. Quantization may be combined
+ //! with an error bound; see WASP::SetCoeffQuantization().
+ //!
+ //! \param[in] nbits Quantization bit depth in the range [2..32], or 0 to 
+ //! disable quantization, which is the default.
+ //!
+ //! \retval status A negative int is returned if \p nbits is invalid
+ //!
+ //! \sa WASP::SetCoeffQuantization(), SetErrorBound()
+ //
+ int SetCoeffQuantization(int nbits);
+
+ //! Retrieve the current coefficient quantization setting
+ //!
+ //! \sa SetCoeffQuantization()
+ //
+ int GetCoeffQuantization() const {return(_quantNBits); };
+
 
 
  //! Set the boundary periodic for subsequent variable definitions
@@ -994,6 +1053,9 @@ protected:
  std::vector <size_t> _bs;
  string _wname;
  std::vector <size_t> _cratios;
+ double _maxError;
+ bool _relativeError;
+ int _quantNBits;
  vector <bool> _periodic;
  VAPoR::UDUnits _udunits;
 
@@ -28,6 +28,7 @@
 #include <vapor/ParamsMgr.h>
 #include <vapor/Renderer.h>
 #include <vapor/AnnotationRenderer.h>
+#include <vapor/ImageCaptureQueue.h>
 
 
 
@@ -186,6 +187,25 @@ public:
 		return 0;
 	}
 
+	//! Enable or disable asynchronous readback of captured animation frames
+	//!
+	//! If enabled, frames captured during animation capture are read
+	//! into a pixel buffer object and copied to the encoder queue
+	//! during the following paintEvent(), so the transfer overlaps
+	//! with rendering of the next frame. The last frame of an
+	//! animation is written by the next paintEvent() or FlushCapture().
+	//! Disabled by default.
+	//
+	void SetAsyncCaptureReadback(bool onOff) {
+		_asyncCaptureReadback = onOff;
+	}
+
+	//! Write any frames whose readback is pending and wait for
+	//! all queued frames to be encoded. Must be called from a
+	//! current OpenGL context.
+	//! \return zero if successful
+	int FlushCapture();
+
 	//! Draw a text banner at x, y coordinates
 	//
 	void DrawText(string text, int x, int y, int size, 
@@ -268,10 +288,23 @@ private:
 	void saveGLMatrix(int timestep, ViewpointParams*);
 
 	//! Obtain the image from the gl back buffer
-	//! \param[out] data is array of rgb byte values, 3 bytes per pixel
+	//! \param[out] data is array of rgb byte values, 3 bytes per pixel,
+	//! ordered bottom row first
 	//! \return true if successful
 	bool getPixelData(unsigned char* data) const ;
 
+	//! Return the image encoder queue, creating it on first use so that
+	//! its threads are only started by visualizers that capture images
+	ImageCaptureQueue *captureQueue();
+
+	//! Start an asynchronous read of the back buffer into a pixel
+	//! buffer object, and queue the previously read frame for encoding
+	int readPixelsAsync(string filename, size_t width, size_t height);
+
+	//! Copy the frame held in pixel buffer object \p i to the encoder
+	//! queue, if one is pending
+	int flushPendingCapture(int i);
+
 	int getCurrentTimestep() const;
 
 	static void incrementPath(string& s);
@@ -290,6 +323,15 @@ private:
 	bool _imageCaptureEnabled;
 	bool _animationCaptureEnabled;
 	string _captureImageFile;
+	ImageCaptureQueue *_captureQueue;
+	bool _asyncCaptureReadback;
+	unsigned int _capturePBO[2];
+	int _capturePBOIndex;
+	struct {
+		string filename;
+		size_t width;
+		size_t height;
+	} _pendingCapture[2];
 	int _previousTimeStep;
 	int _previousFrameNum;
 	
@@ -344,6 +344,108 @@ public:
 	double missing_value
  );
 
+ //! Define a compressed variable with a bounded reconstruction error
+ //!
+ //! Rather than storing a fixed number of wavelet coefficients per block,
+ //! each block retains only as many coefficients as are needed to 
+ //! reconstruct it, at the finest level-of-detail, with an error no
+ //! greater than \p max_error at any grid point. Smooth blocks therefore
+ //! store and read far fewer coefficients than blocks with fine scale
+ //! features. The elements of \p cratios give the \em maximum number of
+ //! coefficients stored at each level-of-detail, and so bound the
+ //! fidelity of the coarser levels as for fixed ratio compression.
+ //!
+ //! Every level-of-detail carries a significance map, including the
+ //! final one, and unused coefficient storage is left unwritten. 
+ //! Defining an error bounded variable disables fill mode (see SetFill())
+ //! for the whole file, which permits the file system to avoid 
+ //! allocating that storage.
+ //!
+ //! \copydoc DefVar(
+ //!	string name, int xtype, vector <string> dimnames, 
+ //!	string wname, vector <size_t> bs, vector <size_t> cratios
+ //! )
+ //!
+ //! \param[in] max_error A non-negative maximum error. The bound can 
+ //! always be met if the smallest element of \p cratios is 1. Otherwise 
+ //! it is met where the permitted number of coefficients suffices. 
+ //! The error actually achieved is reported by InqVarErrorBound().
+ //! \param[in] relative If true, \p max_error is relative to the range
+ //! of the data values passed to each call to PutVara(). This is the
+ //! range of the variable only if it is written by a single call. 
+ //! If false, \p max_error is an absolute error.
+ //!
+ //! \sa InqVarErrorBound()
+ //
+ virtual int DefVar(
+	string name, int xtype, vector <string> dimnames, 
+	string wname, vector <size_t> bs, vector <size_t> cratios,
+	double max_error, bool relative
+ );
+
+ //! Inquire the error bound of a compressed variable
+ //!
+ //! \param[in] name The name of the variable
+ //! \param[out] max_error The error bound specified when the variable 
+ //! was defined, or -1.0 if the variable is not error bounded.
+ //! \param[out] relative True if \p max_error is a relative error
+ //! \param[out] error The largest absolute error of any block written 
+ //! to this file so far
+ //!
+ //! \sa DefVar()
+ //
+ int InqVarErrorBound(
+	string name, double &max_error, bool &relative, double &error
+ ) const;
+
+ //! Set the coefficient quantization for subsequent variable definitions
+ //!
+ //! By default the wavelet coefficients of compressed variables are 
+ //! stored with the variable's external type. If \p nbits is non-zero,
+ //! compressed variables defined by subsequent calls to DefVar() 
+ //! instead store, for each block and level-of-detail, coefficients 
+ //! uniformly quantized to \p nbits bits and entropy coded with a 
+ //! CoeffCodec. Storage for each block is sized for \p nbits bits per 
+ //! coefficient, and only the entropy coded stream is written and read. 
+ //!
+ //! The approximation coefficients are stored verbatim. Each detail
+ //! subband of a block is quantized with its own step, the subband's 
+ //! largest coefficient magnitude divided by 2^(nbits-1)-1, adding an 
+ //! error of at most half that step to each coefficient.
+ //!
+ //! For error bounded variables the error of each quantized block is 
+ //! measured after encoding, and the block is transformed again with 
+ //! a tighter bound if it is exceeded. This is best effort: after a 
+ //! few attempts the block is written as is, and the achieved error 
+ //! is recorded (see InqVarErrorBound()).
+ //!
+ //! The quantization of a variable is recorded in its attributes,
+ //! so files written without quantization remain readable.
+ //!
+ //! \param[in] nbits Quantization bit depth in the range [2..32], or 0 
+ //! to disable quantization
+ //!
+ //! \retval status A negative int is returned if \p nbits is invalid
+ //!
+ //! \sa InqVarQuantization(), CoeffCodec
+ //
+ int SetCoeffQuantization(int nbits);
+
+ //! Return the coefficient quantization bit depth set by 
+ //! SetCoeffQuantization()
+ //
+ int GetCoeffQuantization() const {return(_quant_nbits); };
+
+ //! Inquire the coefficient quantization of a variable
+ //!
+ //! \param[in] name The name of the variable
+ //! \param[out] nbits Quantization bit depth, or 0 if the variable's 
+ //! coefficients are not quantized
+ //!
+ //! \sa SetCoeffQuantization()
+ //
+ int InqVarQuantization(string name, int &nbits) const;
+
  //! \copydoc NetCDFCpp::DefVar()
  // Is this needed?
  virtual int DefVar(
@@ -706,6 +808,19 @@ public:
  //! NetCDF attribute name specifying WASP version number
  static string AttNameVersion() {return("WASP.Version");}
 
+ //! NetCDF attribute name specifying the error bound of an error
+ //! bounded variable: the bound, and a flag indicating whether the bound
+ //! is relative
+ static string AttNameErrorBound() {return("WASP.ErrorBound");}
+
+ //! NetCDF attribute name specifying the largest error of an error
+ //! bounded variable
+ static string AttNameMaxError() {return("WASP.MaxError");}
+
+ //! NetCDF attribute name specifying the coefficient quantization bit 
+ //! depth of a variable
+ static string AttNameQuantization() {return("WASP.Quantization");}
+
 
 private:
 
@@ -734,6 +849,11 @@ private:
  string _open_varname;  // name of opened variable
  nc_type _open_varxtype;  // external type of opened variable
  vector <Compressor *> _open_compressors;  // Compressor for opened variable
+ bool _open_bounded;	// opened variable is error bounded?
+ double _open_max_error;	// error bound of opened variable
+ bool _open_relative;	// error bound is relative?
+ int _open_nbits;	// coefficient quantization of opened variable
+ int _quant_nbits;	// coefficient quantization for new variables
 
 
  int _GetBlockAlignedDims(
@@ -749,6 +869,8 @@ private:
     vector <size_t> bs,
     vector <size_t> cratios,
 	int xtype,
+	bool bounded,
+	int nbits,
     vector <string> &cdimnames,
     vector <size_t> &cdims,
     vector <string> &encoded_dim_names,
@@ -759,9 +881,18 @@ private:
 
  void _get_encoding_vectors(
     string wname, vector <size_t> bs, vector <size_t> cratios, int xtype,
-    vector <size_t> &ncoeffs, vector <size_t> &encoded_dims
+    bool bounded, int nbits, vector <size_t> &ncoeffs, 
+	vector <size_t> &encoded_dims
  ) const;
 
+ int _DefVar(
+	string name, int xtype, vector <string> dimnames, 
+	string wname, vector <size_t> bs, vector <size_t> cratios,
+	bool bounded
+ );
+
+ int _update_max_error(string name, double error);
+
 
  bool _validate_compression_params(
 	string wname, vector <size_t> dims, 
@@ -19,6 +19,7 @@
 
 #include <vapor/DataMgr.h>
 #include <vapor/utils.h>
+#include <vapor/EasyThreads.h>
 #include <vapor/Renderer.h>
 
 namespace VAPoR {
@@ -64,8 +65,8 @@ protected:
 private:
 	GLuint _VAO, _VBO, _EBO;
     unsigned int _nIndices;
+	Wasp::EasyThreads *_et;
 
-	struct VertexData;
 	struct {
 		string varName;
 		string heightVarName;
@@ -84,14 +85,6 @@ private:
 	int  _buildCache();
 	bool _isCacheDirty() const;
 	void _saveCacheParams();
-	void _drawCell(
-            vector<VertexData> &vertices,
-            vector<unsigned int> &indices,
-			const float *verts,
-			const float *colors,
-			int n,
-			bool layered
-			);
 
 };
 };
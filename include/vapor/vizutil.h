@@ -1,8 +1,13 @@
 #ifndef _vizutil_h_
 #define _vizutil_h_
 
+#include <cstddef>
+#include <vector>
+
 namespace VAPoR {
 
+class Grid;
+
 //! Decompose a hexahedron into 5 tetrahedra
 //!
 //! This function takes as input the indecies of eight vertices defining
@@ -161,6 +166,119 @@ bool WachspressCoords2D(
 //
 bool InsideConvexPolygon(const double verts[], const double pt[], int n);
 
+//! Decimate a 1D, 2D, or 3D array by averaging 2x2x2 neighborhoods
+//!
+//! Each element of \p dst is the average of a 2x2x2 neighborhood of
+//! \p src. The last sample along an odd length axis is paired with 
+//! itself, so boundary neighborhoods are averaged over the samples that
+//! exist. Unused axes are given a length of 1, and contribute no terms.
+//! The inner loops have no branches so the compiler can vectorize them.
+//!
+//! \param[in] ni0 Length of the fastest varying axis of \p src
+//! \param[in] nj0 Length of the second axis of \p src, or 1
+//! \param[in] nk0 Length of the slowest varying axis of \p src, or 1
+//! \param[in] src The array to decimate
+//! \param[out] dst The decimated array, whose length along each axis
+//! is half that of \p src, rounded up
+//
+template <typename T>
+void DecimateBlock(
+	size_t ni0, size_t nj0, size_t nk0, const T *src, T *dst
+) {
+	size_t ni1 = (ni0+1) / 2;
+	size_t nj1 = (nj0+1) / 2;
+	size_t nk1 = (nk0+1) / 2;
+
+	// Number of distinct neighbors along each axis. Duplicated 
+	// neighbors at odd boundaries don't change the average
+	//
+	float w = 0.5;
+	if (nj0 > 1) w *= 0.5;
+	if (nk0 > 1) w *= 0.5;
+
+	size_t npairs = ni0 / 2;
+
+	for (size_t kk=0; kk<nk1; kk++) {
+		size_t k0 = 2*kk;
+		size_t k1 = k0+1 < nk0 ? k0+1 : k0;
+
+		for (size_t jj=0; jj<nj1; jj++) {
+			size_t j0 = 2*jj;
+			size_t j1 = j0+1 < nj0 ? j0+1 : j0;
+
+			const T *r00 = src + k0*ni0*nj0 + j0*ni0;
+			const T *r01 = src + k0*ni0*nj0 + j1*ni0;
+			const T *r10 = src + k1*ni0*nj0 + j0*ni0;
+			const T *r11 = src + k1*ni0*nj0 + j1*ni0;
+			T *d = dst + kk*ni1*nj1 + jj*ni1;
+
+			// Only the rows along axes longer than one are summed, to 
+			// match the weight
+			//
+			if (nj0 == 1 && nk0 == 1) {
+				for (size_t ii=0; ii<npairs; ii++) {
+					d[ii] = w * (r00[2*ii] + r00[2*ii+1]);
+				}
+			}
+			else if (nk0 == 1) {
+				for (size_t ii=0; ii<npairs; ii++) {
+					d[ii] = w * (
+						r00[2*ii] + r00[2*ii+1] + r01[2*ii] + r01[2*ii+1]
+					);
+				}
+			}
+			else if (nj0 == 1) {
+				for (size_t ii=0; ii<npairs; ii++) {
+					d[ii] = w * (
+						r00[2*ii] + r00[2*ii+1] + r10[2*ii] + r10[2*ii+1]
+					);
+				}
+			}
+			else {
+				for (size_t ii=0; ii<npairs; ii++) {
+					d[ii] = w * (
+						r00[2*ii] + r00[2*ii+1] + r01[2*ii] + r01[2*ii+1] +
+						r10[2*ii] + r10[2*ii+1] + r11[2*ii] + r11[2*ii+1]
+					);
+				}
+			}
+
+			// odd i boundary. Rows of unused axes alias r00
+			//
+			if (ni0 % 2) {
+				size_t i = ni0-1;
+				d[npairs] = 0.25 * (r00[i] + r01[i] + r10[i] + r11[i]);
+			}
+		}
+	}
+}
+
+//! Extract contour lines from a 2D grid
+//!
+//! For each cell of \p grid inside the box defined by \p boxMin and 
+//! \p boxMax, find where the cell's edges cross each of the values in
+//! \p contours. The crossing point is linearly interpolated between the
+//! edge's nodes. Cells with a node equal to the grid's missing value
+//! are skipped. Crossings are returned in cell and edge order, so 
+//! consecutive pairs of vertices form the line segments of a contour.
+//!
+//! \param[in] grid A 2D grid
+//! \param[in] heightGrid If not NULL, the z coordinate of each vertex is
+//! interpolated from this grid. Otherwise z is zero.
+//! \param[in] boxMin Minimum box coordinate
+//! \param[in] boxMax Maximum box coordinate
+//! \param[in] contours The contour values
+//! \param[out] vertices The x, y, and z coordinates of each crossing
+//! \param[out] contourIndex For each vertex, the index into \p contours
+//! of the value crossed
+//
+void ContourLines2D(
+	const Grid &grid, const Grid *heightGrid,
+	const std::vector <double> &boxMin, const std::vector <double> &boxMax,
+	const std::vector <double> &contours, 
+	std::vector <float> &vertices, std::vector <int> &contourIndex
+);
+
 };
 
 #endif
@@ -1,9 +1,11 @@
 #include "vapor/FileUtils.h"
 
 #ifdef WIN32
+#include <windows.h>
 #else
 #include <sys/stat.h>
 #include <libgen.h>
+#include <dirent.h>
 #endif
 
 using namespace VAPoR;
@@ -77,3 +79,34 @@ FileType FileUtils::GetFileType(const std::string &path)
     else
         return FileType::Does_Not_Exist;
 }
+
+// Returns the names of the entries in a directory, excluding "." and ".."
+//
+std::vector<std::string> FileUtils::ListDirectory(const std::string &path)
+{
+    std::vector<string> names;
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE h = FindFirstFileA((path + "\\*").c_str(), &data);
+    if (h == INVALID_HANDLE_VALUE)
+        return names;
+    do {
+        string name = data.cFileName;
+        if (name != "." && name != "..")
+            names.push_back(name);
+    } while (FindNextFileA(h, &data));
+    FindClose(h);
+#else
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+        return names;
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        string name = entry->d_name;
+        if (name != "." && name != "..")
+            names.push_back(name);
+    }
+    closedir(dir);
+#endif
+    return names;
+}
@@ -4,6 +4,7 @@ using namespace VAPoR;
 
 const std::string RayCasterParams::_lightingTag       = "LightingTag";
 const std::string RayCasterParams::_lightingCoeffsTag = "LightingCoeffTag";
+const std::string RayCasterParams::_volumeTextureBitsTag = "VolumeTextureBitsTag";
 
 
 RayCasterParams::RayCasterParams( DataMgr*                dataManager, 
@@ -67,3 +68,19 @@ void RayCasterParams::SetLightingCoeffs( const std::vector<double>& coeffs )
 {
     SetValueDoubleVec( _lightingCoeffsTag, "Coefficients for lighting effects", coeffs );
 }
+
+long RayCasterParams::GetVolumeTextureBits() const
+{
+    long bits = GetValueLong( _volumeTextureBitsTag, 32 );
+    if( bits != 8 && bits != 16 )
+        bits = 32;
+
+    return bits;
+}
+
+void RayCasterParams::SetVolumeTextureBits( long bits )
+{
+    if( bits != 8 && bits != 16 )
+        bits = 32;
+    SetValueLong( _volumeTextureBitsTag, "Bits per voxel of volume texture", bits );
+}
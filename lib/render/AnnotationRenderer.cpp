@@ -193,23 +193,27 @@ void AnnotationRenderer::DrawText()
 }
 
 void AnnotationRenderer::DrawText(vector<billboard> billboards) {
-	float txtColor[] = {1.f, 1.f, 1.f, 1.f};
-	float bgColor[] = {0.f, 0.f, 0.f, 0.f};
-	float coords[] = {67.5f,31.6f,0.f};
 
+	// Billboards are positioned in pixel coordinates, so the text for 
+	// all billboards of the same size can be drawn with a single draw
+	//
+	map <int, vector <float> > vertices;
 	for (int i=0; i<billboards.size(); i++) {
-		string text = billboards[i].text;
-		coords[0] = billboards[i].x;
-		coords[1] = billboards[i].y;
-		int size = billboards[i].size;
-		txtColor[0] = billboards[i].color[0];
-		txtColor[1] = billboards[i].color[1];
-		txtColor[2] = billboards[i].color[2];
-        
-        TextLabel label(_glManager, _fontName, size);
-        label.ForegroundColor = glm::make_vec4(txtColor);
-        label.BackgroundColor = glm::make_vec4(bgColor);
-        label.DrawText(glm::make_vec2(coords), text);
+		const billboard &b = billboards[i];
+		glm::vec4 txtColor(b.color[0], b.color[1], b.color[2], 1.f);
+
+		Font *font = _glManager->fontManager->GetFont(_fontName, b.size);
+		font->AddText(
+			vertices[b.size], glm::vec2(b.x, b.y), b.text, txtColor
+		);
+	}
+
+	glDisable(GL_DEPTH_TEST);
+
+	map <int, vector <float> >::const_iterator itr;
+	for (itr = vertices.begin(); itr != vertices.end(); ++itr) {
+		Font *font = _glManager->fontManager->GetFont(_fontName, itr->first);
+		font->DrawVertices(itr->second);
 	}
 }
 
@@ -363,6 +367,17 @@ void AnnotationRenderer::drawAxisTics(AxisAnnotation* aa) {
 	double width = aa->GetTicWidth();
 	bool latLon = aa->GetLatLonAxesEnabled();
 
+	// The axes and all of the tics share the same line state, so they are
+	// drawn as a single batch. Labels use their own GL state and are drawn
+	// once the batch has been flushed
+	//
+	vector <double> labelValues;
+	vector <double> labelPosns;
+	LegacyGL *lgl = _glManager->legacy;
+	glLineWidth(width);
+	glEnable(GL_LINE_SMOOTH);
+	lgl->BeginBatch();
+
 	_drawAxes(minTic, maxTic, origin, axisColor, width);	
 	
 	double pointOnAxis[3]; 
@@ -396,7 +411,8 @@ void AnnotationRenderer::drawAxisTics(AxisAnnotation* aa) {
 		double text = pointOnAxis[0];
 		if (latLon)
 			convertPointToLon(text);
-		renderText(text, startPosn, aa);
+		labelValues.push_back(text);
+		labelPosns.insert(labelPosns.end(), startPosn, startPosn+3);
 	}
 	
 	//Now draw tic marks for y:
@@ -421,7 +437,8 @@ void AnnotationRenderer::drawAxisTics(AxisAnnotation* aa) {
 		double text = pointOnAxis[1];
 		if (latLon)
 			convertPointToLat(text);
-		renderText(text, startPosn, aa);
+		labelValues.push_back(text);
+		labelPosns.insert(labelPosns.end(), startPosn, startPosn+3);
 	}
 
 	//Now draw tic marks for z:
@@ -441,7 +458,15 @@ void AnnotationRenderer::drawAxisTics(AxisAnnotation* aa) {
 		vsub(pointOnAxis, ticVec, startPosn);
 		vadd(pointOnAxis, ticVec, endPosn);
 		_drawTic(startPosn, endPosn, width, axisColor);
-		renderText(pointOnAxis[2], startPosn, aa);
+		labelValues.push_back(pointOnAxis[2]);
+		labelPosns.insert(labelPosns.end(), startPosn, startPosn+3);
+	}
+
+	lgl->EndBatch();
+	glDisable(GL_LINE_SMOOTH);
+
+	for (int i=0; i<labelValues.size(); i++) {
+		renderText(labelValues[i], &labelPosns[i*3], aa);
 	}
 }
 
@@ -458,8 +483,6 @@ void AnnotationRenderer::_drawAxes(
 	GL_LEGACY(glDisable(GL_LIGHTING));
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	lgl->Color4f(color[0],color[1], color[2], color[3]);
-	GL_LEGACY(glLineWidth(width));
-	glEnable(GL_LINE_SMOOTH);
 	lgl->Begin(GL_LINES);
 	lgl->Vertex3f(min[0],origin[1],origin[2]);
 	lgl->Vertex3f(max[0],origin[1],origin[2]);
@@ -468,7 +491,6 @@ void AnnotationRenderer::_drawAxes(
 	lgl->Vertex3f(origin[0],origin[1],min[2]);
 	lgl->Vertex3f(origin[0],origin[1],max[2]);
 	lgl->End();
-	glDisable(GL_LINE_SMOOTH);
 	//glEnable(GL_LIGHTING);
 	// glPopAttrib(); // TODO GL
 }
@@ -482,13 +504,10 @@ void AnnotationRenderer::_drawTic(
 	// glPushAttrib(GL_CURRENT_BIT); // TODO GL
     LegacyGL *lgl = _glManager->legacy;
 	lgl->Color4f(color[0], color[1], color[2], color[3]);
-	glLineWidth(width);
-	glEnable(GL_LINE_SMOOTH);
     lgl->Begin(GL_LINES);
 	lgl->Vertex3dv(startPosn);
 	lgl->Vertex3dv(endPosn);
 	lgl->End();
-	glDisable(GL_LINE_SMOOTH);
 	// glPopAttrib(); // TODO GL
 }
 
@@ -641,14 +660,30 @@ void AnnotationRenderer::drawAxisArrows(
     
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	float len = maxLen*0.2f;
-	lgl->Color3f(1.f,0.f,0.f);
 	GL_LEGACY(glLineWidth( 4.0 ));
 	glEnable(GL_LINE_SMOOTH);
+
+	// Draw the shafts first, then the heads, so that the batch collapses
+	// into one draw per primitive type
+	//
+	lgl->BeginBatch();
+	lgl->Color3f(1.f,0.f,0.f);
 	lgl->Begin(GL_LINES);
 	lgl->Vertex3fv(origin);
 	lgl->Vertex3f(origin[0]+len,origin[1],origin[2]);
-	
 	lgl->End();
+	lgl->Color3f(0.f,1.f,0.f);
+	lgl->Begin(GL_LINES);
+	lgl->Vertex3fv(origin);
+	lgl->Vertex3f(origin[0],origin[1]+len,origin[2]);
+	lgl->End();
+	lgl->Color3f(0.f,0.3f,1.f);
+	lgl->Begin(GL_LINES);
+	lgl->Vertex3fv(origin);
+	lgl->Vertex3f(origin[0],origin[1],origin[2]+len);
+	lgl->End();
+
+	lgl->Color3f(1.f,0.f,0.f);
 	lgl->Begin(GL_TRIANGLES);
 	lgl->Vertex3f(origin[0]+len,origin[1],origin[2]);
 	lgl->Vertex3f(origin[0]+.8*len, origin[1]+.1*len, origin[2]);
@@ -668,10 +703,6 @@ void AnnotationRenderer::drawAxisArrows(
 	lgl->End();
 
 	lgl->Color3f(0.f,1.f,0.f);
-	lgl->Begin(GL_LINES);
-	lgl->Vertex3fv(origin);
-	lgl->Vertex3f(origin[0],origin[1]+len,origin[2]);
-	lgl->End();
 	lgl->Begin(GL_TRIANGLES);
 	lgl->Vertex3f(origin[0],origin[1]+len,origin[2]);
 	lgl->Vertex3f(origin[0]+.1*len, origin[1]+.8*len, origin[2]);
@@ -689,11 +720,8 @@ void AnnotationRenderer::drawAxisArrows(
 	lgl->Vertex3f(origin[0], origin[1]+.8*len, origin[2]-.1*len);
 	lgl->Vertex3f(origin[0]+.1*len, origin[1]+.8*len, origin[2]);
 	lgl->End();
+
 	lgl->Color3f(0.f,0.3f,1.f);
-	lgl->Begin(GL_LINES);
-	lgl->Vertex3fv(origin);
-	lgl->Vertex3f(origin[0],origin[1],origin[2]+len);
-	lgl->End();
 	lgl->Begin(GL_TRIANGLES);
 	lgl->Vertex3f(origin[0],origin[1],origin[2]+len);
 	lgl->Vertex3f(origin[0]+.1*len, origin[1], origin[2]+.8*len);
@@ -711,7 +739,8 @@ void AnnotationRenderer::drawAxisArrows(
 	lgl->Vertex3f(origin[0], origin[1]-.1*len, origin[2]+.8*len);
 	lgl->Vertex3f(origin[0]+.1*len, origin[1], origin[2]+.8*len);
 	lgl->End();
-	
+	lgl->EndBatch();
+
 	glDisable(GL_LINE_SMOOTH);
 }
 
@@ -70,6 +70,77 @@ static RendererRegistrar<BarbRenderer> registrar(
 	BarbRenderer::GetClassType(), BarbParams::GetClassType()
 );
 
+namespace {
+
+// Number of floats per barb instance: start point, unit direction, 
+// length, and RGBA color
+//
+const int INSTANCE_SIZE = 11;
+
+// Number of floats per barb mesh vertex: see Barb.vert
+//
+const int MESH_VERTEX_SIZE = 7;
+
+void mesh_vertex(
+	vector <float> &mesh, float u, float b, float along, float offset,
+	float nu, float nb, float nd
+) {
+	mesh.push_back(u);
+	mesh.push_back(b);
+	mesh.push_back(along);
+	mesh.push_back(offset);
+	mesh.push_back(nu);
+	mesh.push_back(nb);
+	mesh.push_back(nd);
+}
+
+// Build the triangles of a barb of unit radius in the barb's local 
+// frame. The barb is a hexagonal tube that runs BARB_LENGTH_FACTOR of
+// the barb's length, capped by a cone of radius BARB_HEAD_FACTOR whose
+// tip is one radius past the end of the tube. The shading makes the 
+// tube look round.
+//
+void make_barb_mesh(vector <float> &mesh) {
+	mesh.clear();
+
+	const float sines[7] = {
+		0.f, (float) (sqrt(3.)/2.), (float) (sqrt(3.)/2.), 0.f, 
+		(float) (-sqrt(3.)/2.), (float ) (-sqrt(3.)/2.), 0.f
+	};
+	const float coses[7] = {1.f, 0.5, -0.5, -1., -.5, 0.5, 1.f};
+
+	const float tube = BARB_LENGTH_FACTOR;
+	const float head = BARB_HEAD_FACTOR;
+
+	for (int i = 0; i<6; i++){
+		float c0 = coses[i], s0 = sines[i];
+		float c1 = coses[i+1], s1 = sines[i+1];
+
+		// Tube sides
+		//
+		mesh_vertex(mesh, c0, s0, tube, 0.f, c0, s0, 0.f);
+		mesh_vertex(mesh, c0, s0, 0.f,  0.f, c0, s0, 0.f);
+		mesh_vertex(mesh, c1, s1, tube, 0.f, c1, s1, 0.f);
+
+		mesh_vertex(mesh, c1, s1, tube, 0.f, c1, s1, 0.f);
+		mesh_vertex(mesh, c0, s0, 0.f,  0.f, c0, s0, 0.f);
+		mesh_vertex(mesh, c1, s1, 0.f,  0.f, c1, s1, 0.f);
+
+		// Barb head. The normals at the back of the head are tilted
+		// in the direction of the barb
+		//
+		mesh_vertex(mesh, 0.f, 0.f, tube, 1.f, 0.f, 0.f, 1.f);
+		mesh_vertex(
+			mesh, head*c0, head*s0, tube, 1.f-head, 0.5*c0, 0.5*s0, 0.5
+		);
+		mesh_vertex(
+			mesh, head*c1, head*s1, tube, 1.f-head, 0.5*c1, 0.5*s1, 0.5
+		);
+	}
+}
+
+};
+
 BarbRenderer::BarbRenderer(
 	const ParamsMgr *pm, string winName, string dataSetName,
 	string instName, DataMgr *dataMgr
@@ -80,6 +151,11 @@ BarbRenderer::BarbRenderer(
 	_vectorScaleFactor = .2;
 	_maxThickness = .2;
 	_maxValue = 0.f;
+
+	_VAO = _meshVBO = _instanceVBO = 0;
+	_nMeshVertices = 0;
+	_nBarbs = 0;
+	_cacheParams.scales.clear();
 }
 
 //----------------------------------------------------------------------------
@@ -87,12 +163,53 @@ BarbRenderer::BarbRenderer(
 //----------------------------------------------------------------------------
 BarbRenderer::~BarbRenderer()
 {
+	if (_VAO) glDeleteVertexArrays(1, &_VAO);
+	if (_meshVBO) glDeleteBuffers(1, &_meshVBO);
+	if (_instanceVBO) glDeleteBuffers(1, &_instanceVBO);
+	_VAO = _meshVBO = _instanceVBO = 0;
 }
 
-// Totally unnecessary?
-//
 int BarbRenderer::_initializeGL(){
-	//_initialized = true;
+	vector <float> mesh;
+	make_barb_mesh(mesh);
+	_nMeshVertices = mesh.size() / MESH_VERTEX_SIZE;
+
+	glGenVertexArrays(1, &_VAO);
+	glBindVertexArray(_VAO);
+
+	GLsizei stride = MESH_VERTEX_SIZE * sizeof(float);
+	glGenBuffers(1, &_meshVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, _meshVBO);
+	glBufferData(
+		GL_ARRAY_BUFFER, mesh.size() * sizeof(float), mesh.data(),
+		GL_STATIC_DRAW
+	);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, NULL);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(
+		1, 3, GL_FLOAT, GL_FALSE, stride, (void *) (4 * sizeof(float))
+	);
+	glEnableVertexAttribArray(1);
+
+	// One start point, direction and color per barb
+	//
+	stride = INSTANCE_SIZE * sizeof(float);
+	glGenBuffers(1, &_instanceVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, _instanceVBO);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, NULL);
+	glVertexAttribPointer(
+		3, 4, GL_FLOAT, GL_FALSE, stride, (void *) (3 * sizeof(float))
+	);
+	glVertexAttribPointer(
+		4, 4, GL_FLOAT, GL_FALSE, stride, (void *) (7 * sizeof(float))
+	);
+	for (int i=2; i<5; i++) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	return(0);
 }
 
@@ -274,8 +391,21 @@ int BarbRenderer::_getVarGrid(
 
 int BarbRenderer::_paintGL(bool) {
     int rc = 0;
-    
-    // _saveCacheParams();
+
+	// The barbs only need to be recomputed if the data, the params, or
+	// the scaling of the scene have changed. Camera motion just redraws
+	// the cached barbs.
+	//
+	if (_isCacheDirty() || _cacheParams.scales != _getScales()) {
+		rc = _buildCache();
+		if (rc<0) return(rc);
+	}
+
+	return(_drawBarbs());
+}
+
+int BarbRenderer::_buildCache() {
+    int rc = 0;
     
 	// Set up the variable data required, while determining data 
 	// extents to use in rendering
@@ -289,7 +419,6 @@ int BarbRenderer::_paintGL(bool) {
 	// Get vector variables
 	rc = _getVectorVarGrids(ts, refLevel, lod, minExts, maxExts, varData);
 	if(rc<0) {
-    	glEndList();
 		SetErrMsg("One or more selected field variables does not exist");
 		return -1;
 	}
@@ -315,19 +444,73 @@ int BarbRenderer::_paintGL(bool) {
 	
 	_recalculateScales(varData, ts);
 
-	_setUpLightingAndColor();
-
-	// Render the barbs
+	// Compute the barbs
+	_barbInstances.clear();
 	_operateOnGrid(varData);
 
 	//Release the locks on the data
 	for (int i = 0; i<varData.size(); i++){
 		if (varData[i]) _dataMgr->UnlockGrid(varData[i]);
 	}
+
+	_nBarbs = _barbInstances.size() / INSTANCE_SIZE;
+
+	glBindBuffer(GL_ARRAY_BUFFER, _instanceVBO);
+	glBufferData(
+		GL_ARRAY_BUFFER, _barbInstances.size() * sizeof(float),
+		_barbInstances.data(), GL_STATIC_DRAW
+	);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	_barbInstances.clear();
+
+	// _recalculateScales() may have changed the params, so they're 
+	// saved last
+	//
+	_saveCacheParams();
+	_cacheParams.scales = _getScales();
     
 	return(rc);
 }
 
+int BarbRenderer::_drawBarbs() {
+	if (! _nBarbs) return(0);
+
+	SmartShaderProgram shader = 
+		_glManager->shaderManager->GetSmartShader("Barb");
+	if (! shader.IsValid()) return(-1);
+
+	BarbParams* bParams = dynamic_cast<BarbParams*>(GetActiveParams());
+	assert(bParams);
+
+	float radius = bParams->GetLineThickness() * _maxThickness;
+
+	string winName = GetVisualizer(); // GetVisualizer is not const :(
+	ViewpointParams* vpParams =  _paramsMgr->GetViewpointParams(winName);
+	bool lighting = vpParams->getNumLights() > 0;
+
+	float lightDir[3];
+	_glManager->legacy->GetLightDirection(lightDir);
+
+    MatrixManager *mm = _glManager->matrixManager;
+    mm->MatrixModeModelView();
+    mm->PushMatrix();
+	vector<double> scales = _getScales();
+	mm->Scale(1.f/scales[0], 1.f/scales[1], 1.f/scales[2]);
+
+	shader->SetUniform("P", mm->GetProjectionMatrix());
+	shader->SetUniform("MV", mm->GetModelViewMatrix());
+	shader->SetUniform("radius", radius);
+	shader->SetUniform("lightingEnabled", lighting);
+	shader->SetUniform("lightDir", glm::make_vec3(lightDir));
+
+	glBindVertexArray(_VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, _nMeshVertices, _nBarbs);
+	glBindVertexArray(0);
+
+    mm->PopMatrix();
+	return(0);
+}
+
 float BarbRenderer::_calculateDirVec(
 	const float start[3], 
 	const float end[3], 
@@ -340,275 +523,35 @@ float BarbRenderer::_calculateDirVec(
 	return len;
 }
 
-void BarbRenderer::_drawBackOfBarb(
-	const float dirVec[3], 
-	const float startVertex[3]) 
-const {
-    // TODO GL
-    /*
-	glBegin(GL_POLYGON);
-	glNormal3fv(dirVec);
-	for (int k = 0; k<6; k++){
-		glVertex3fv(startVertex+3*k);
-	}
-	glEnd();
-     */
-}
-
-void BarbRenderer::_drawCylinderSides(
-	const float nextNormal[3], 
-	const float nextVertex[3],
-	const float startNormal[3],
-	const float startVertex[3]
-) const {
-    LegacyGL *lgl = _glManager->legacy;
-    
-	lgl->Begin(GL_TRIANGLE_STRIP);
-	
-	for (int i = 0; i< 6; i++){
-			
-		lgl->Normal3fv(nextNormal+3*i);
-		lgl->Vertex3fv(nextVertex+3*i);
-			
-		lgl->Normal3fv(startNormal+3*i);
-		lgl->Vertex3fv(startVertex+3*i);
-	}
-	//repeat first two vertices to close cylinder:
-		
-	lgl->Normal3fv(nextNormal);
-	lgl->Vertex3fv(nextVertex);
-		
-	lgl->Normal3fv(startNormal);
-	lgl->Vertex3fv(startVertex);
-	
-	lgl->End();
-}
-
-
-void BarbRenderer::_drawBarbHead(
-	const float dirVec[3], 
-	const float vertexPoint[3], 
-	const float startNormal[3], 
-	const float startVertex[3]
-) const {
-    LegacyGL *lgl = _glManager->legacy;
-    
-	//Create a triangle fan from these 6 vertices.  
-	lgl->Begin(GL_TRIANGLE_FAN);
-	lgl->Normal3fv(dirVec);
-	lgl->Vertex3fv(vertexPoint);
-	for (int i = 0; i< 6; i++){
-		lgl->Normal3fv(startNormal+3*i);
-		lgl->Vertex3fv(startVertex+3*i);
-	}
-	//Repeat first point to close fan:
-	lgl->Normal3fv(startNormal);
-	lgl->Vertex3fv(startVertex);
-	lgl->End();
-}
-
-#ifdef DEBUG
-void BarbRenderer::_printBackDiameter(const float startVertex[18]) const {
-	float pointA[3] = {startVertex[0], startVertex[1], startVertex[2]};
-	float pointB[3] = {startVertex[3], startVertex[4], startVertex[5]};
-	float pointC[3] = {startVertex[6], startVertex[7], startVertex[8]};
-	float pointD[3] = {startVertex[9], startVertex[10], startVertex[11]};
-	float pointE[3] = {startVertex[12], startVertex[13], startVertex[14]};
-	float pointF[3] = {startVertex[15], startVertex[16], startVertex[17]};
-	cout << "   " << pointA[0] << "\t\t" << pointB[0] << "\t\t\t" << pointC[0];
-	cout << "\t\t" << pointD[0] << "\t\t" << pointE[0] << "\t\t" << pointF[0] << endl;
-
-	cout << "   " << pointA[1] << "\t\t" << pointB[1] << "\t\t" << pointC[1];
-	cout << "\t" << pointD[1] << "\t" << pointE[1] << "\t\t" << pointF[1] << endl;
-
-	cout << "   " << pointA[2] << "\t\t" << pointB[2] << "\t\t" << pointC[2];
-	cout << "\t\t" << pointD[2] << "\t\t" << pointE[2] << "\t\t" << pointF[2] << endl;
-	cout << "Back Diameter " << _calculateLength(pointA, pointD) << endl;
-}
-#endif
-
-//Issue OpenGL calls to draw a cylinder with orthogonal ends from 
-//one point to another.  Then put an barb head on the end
+// Append one barb to the instance list. Barbs with missing data or 
+// no length aren't drawn.
 //
-void BarbRenderer::_drawBarb(
+void BarbRenderer::_addBarb(
 	const std::vector<Grid*> variableData,
 	float startPoint[3],
 	bool doColorMapping,
 	float clut[1024]
 ) {
 	assert(variableData.size() == 5);
-    MatrixManager *mm = _glManager->matrixManager;
 
 	float endPoint[3];
+	float color[4];
 	bool missing = _defineBarb(
 		variableData, 
 		startPoint, endPoint,
-		doColorMapping, clut
+		doColorMapping, clut, color
 	);
 
 	if (missing) return;
 
-    mm->MatrixModeModelView();
-    mm->PushMatrix();
-	vector<double> scales = _getScales();
-	mm->Scale(1.f/scales[0], 1.f/scales[1], 1.f/scales[2]);
-
-	//Constants are needed for cosines and sines, at 
-	//60 degree intervals. The barb is really a hexagonal tube, 
-	//but the shading makes it look round.
-	const float sines[6] = {
-		0.f, (float) (sqrt(3.)/2.), (float) (sqrt(3.)/2.), 0.f, 
-		(float) (-sqrt(3.)/2.), (float ) (-sqrt(3.)/2.)
-	};
-	const float coses[6] = {1.f, 0.5, -0.5, -1., -.5, 0.5};
-
-	float nextPoint[3];
-	float vertexPoint[3];
-	float headCenter[3];
-	float startNormal[18];
-	float nextNormal[18];
-	float startVertex[18];
-	float nextVertex[18];
-	float testVec[3];
-	float testVec2[3];
-	
-	//Calculate an orthonormal frame
-
-	//dirVec is the barb direction
 	float dirVec[3];
 	float len = _calculateDirVec(startPoint, endPoint, dirVec);
+	if (len == 0.f) return;
 
-	//Calculate uVec, orthogonal to dirVec
-	//Not sure what bVec is.  Up direction?
-	float uVec[3], bVec[3];
-	vset(testVec, 1.,0.,0.);
-	vcross(dirVec, testVec, uVec);
-	len = vdot(uVec,uVec);
-	if (len == 0.f){
-		vset(testVec, 0.,1.,0.);
-		vcross(dirVec, testVec, uVec);
-		len = vdot(uVec, uVec);
-	} 
-	vscale(uVec, 1.f/sqrt(len));
-	vcross(uVec, dirVec, bVec);
-	
-	BarbParams* bParams = dynamic_cast<BarbParams*>(GetActiveParams());
-	assert(bParams);
-
-	float radius = bParams->GetLineThickness() * _maxThickness;
-	
-	//calculate 6 points in plane orthog to dirVec, in plane of point
-	for (int i = 0; i<6; i++){
-		//testVec and testVec2 are components of point in plane
-		vmult(uVec, coses[i], testVec);
-		vmult(bVec, sines[i], testVec2);
-
-		//Calc outward normal as a sideEffect..
-		//It is the vector sum of x,y components (norm 1)
-		vadd(testVec, testVec2, startNormal+3*i);
-
-		//stretch by radius to get current displacement
-		vmult(startNormal+3*i, radius, startVertex+3*i);
-
-		//add to current point
-		vadd(startVertex+3*i, startPoint, startVertex+3*i);
-	}
-
-#ifdef DEBUG
-	_printBackDiameter(startVertex);
-#endif
-
-	_drawBackOfBarb(dirVec, startVertex);
-
-	// The variables are located as follows:
-	//		- - - - >
-	//	   ^       ^ ^
-	// start    next end
-
-	//Calculate nextPoint and vertexPoint, for barbhead
-	for (int i = 0; i< 3; i++){
-		nextPoint[i] = (1. - BARB_LENGTH_FACTOR)*startPoint[i]+ BARB_LENGTH_FACTOR*endPoint[i];
-		//Assume a vertex angle of 45 degrees:
-		vertexPoint[i] = nextPoint[i] + dirVec[i]*radius;
-		headCenter[i] = nextPoint[i] - dirVec[i]*(BARB_HEAD_FACTOR*radius-radius); 
-	}
-			
-	//calc for endpoints:
-	for (int i = 0; i<6; i++){
-		//testVec and testVec2 are components of point in plane
-		vmult(uVec, coses[i], testVec);
-		vmult(bVec, sines[i], testVec2);
-	
-		//Calc outward normal as a sideEffect..
-		//It is the vector sum of x,y components (norm 1)
-		vadd(testVec, testVec2, nextNormal+3*i);
-
-		//stretch by radius to get current displacement
-		vmult(nextNormal+3*i, radius, nextVertex+3*i);
-
-		//add to current point
-		vadd(nextVertex+3*i, nextPoint, nextVertex+3*i);		
-	}
-
-	_drawCylinderSides(nextNormal, nextVertex, startNormal, startVertex);	
-	
-	//Now draw the barb head.  First calc 6 vertices at back of barbhead
-	//Reuse startNormal and startVertex vectors
-	//calc for endpoints:
-	for (int i = 0; i<6; i++){
-		//testVec and testVec2 are components of point in plane
-		//Can reuse them from previous (cylinder end) calculation
-		vmult(uVec, coses[i], testVec);
-		vmult(bVec, sines[i], testVec2);
-
-		//Calc outward normal as a sideEffect..
-		//It is the vector sum of x,y components (norm 1)
-		vadd(testVec, testVec2, startNormal+3*i);
-
-		//stretch by radius to get current displacement
-		vmult(startNormal+3*i, BARB_HEAD_FACTOR*radius, startVertex+3*i);
-
-		//add to current point
-		vadd(startVertex+3*i, headCenter, startVertex+3*i);
-
-		//Now tilt normals in direction of barb:
-		for (int k = 0; k<3; k++){
-			startNormal[3*i+k] = 0.5*startNormal[3*i+k] + 0.5*dirVec[k];
-		}
-	}
-
-	_drawBarbHead(dirVec, vertexPoint, startNormal, startVertex);
-
-    mm->PopMatrix();
-}
-
-void BarbRenderer::_setUpLightingAndColor() {
-    LegacyGL *lgl = _glManager->legacy;
-	string winName = GetVisualizer(); // GetVisualizer is not const :(
-	ViewpointParams* vpParams =  _paramsMgr->GetViewpointParams(winName);
-	int nLights = vpParams->getNumLights();
-	
-	float fcolor[3];
-	BarbParams* bParams = dynamic_cast<BarbParams*>(GetActiveParams());
-	assert(bParams);
-	bParams->GetConstantColor(fcolor);
-	if (nLights == 0) {
-		// glDisable(GL_LIGHTING);
-        lgl->DisableLighting();
-	}
-	else {
-		LEGACY_TODO(glShadeModel(GL_SMOOTH));
-		LEGACY_TODO(glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE,fcolor));
-		LEGACY_TODO(glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, vpParams->getExponent()));
-		//All the geometry will get a white specular color:
-		float specColor[4];
-		specColor[0]=specColor[1]=specColor[2]=0.8f;
-		specColor[3] = 1.f;
-		LEGACY_TODO(glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specColor));
-		LEGACY_TODO(glEnable(GL_COLOR_MATERIAL));
-        lgl->EnableLighting(); // glEnable(GL_LIGHTING);
-	}
-	lgl->Color3fv(fcolor);
+	_barbInstances.insert(_barbInstances.end(), startPoint, startPoint+3);
+	_barbInstances.insert(_barbInstances.end(), dirVec, dirVec+3);
+	_barbInstances.push_back(len);
+	_barbInstances.insert(_barbInstances.end(), color, color+4);
 }
 
 void BarbRenderer::_reFormatExtents(
@@ -754,7 +697,8 @@ bool BarbRenderer::_defineBarb(
 	float start[3],
 	float end[3],
 	bool doColorMapping,
-	float clut[1024]
+	float clut[1024],
+	float color[4]
 ) {
 	bool missing = false;
 	
@@ -780,9 +724,15 @@ bool BarbRenderer::_defineBarb(
 		if (val == variableData[4]->GetMissingValue()) 
 			missing=true;
 		else{
-			missing = _getColorMapping(val, clut);
+			missing = _getColorMapping(val, clut, color);
 		}
 	}
+	else {
+		BarbParams* bParams = dynamic_cast<BarbParams*>(GetActiveParams());
+		assert(bParams);
+		bParams->GetConstantColor(color);
+		color[3] = 1.f;
+	}
 	return missing;
 }
 
@@ -811,7 +761,7 @@ void BarbRenderer::_operateOnGrid(
 				start[Z] = strides[Z] * k + rakeExts[Z]; //+ zStride/2.0;
 
 				if (drawBarb) {
-					_drawBarb(
+					_addBarb(
 						variableData,
 						start,
 						doColorMapping, 
@@ -861,7 +811,9 @@ void BarbRenderer::_getMagnitudeAtPoint(
 	}
 }
 
-bool BarbRenderer::_getColorMapping(float val, float clut[256*4]) {
+bool BarbRenderer::_getColorMapping(
+	float val, float clut[256*4], float color[4]
+) {
 	bool missing = false;
 
 	MapperFunction* tf=0;
@@ -871,12 +823,10 @@ bool BarbRenderer::_getColorMapping(float val, float clut[256*4]) {
 	tf = (MapperFunction*)bParams->GetMapperFunc(colorVar);
 	assert(tf);
 
-	float mappedColor[4] = {0.,0.,0.,0.};
 	//Use the transfer function to map the data:
 	int lutIndex = tf->mapFloatToIndex(val);
 	for (int i = 0; i<4; i++)
-		mappedColor[i] = clut[4*lutIndex+i];
-    _glManager->legacy->Color4fv(mappedColor); // glColor4fv(mappedColor);
+		color[i] = clut[4*lutIndex+i];
 	return missing;
 }
 
@@ -34,6 +34,7 @@
 #include <vapor/errorcodes.h>
 #include <vapor/GetAppPath.h>
 #include <vapor/ControlExecutive.h>
+#include <vapor/vizutil.h>
 #include "vapor/ShaderManager.h"
 #include "vapor/debug.h"
 #include <glm/glm.hpp>
@@ -161,69 +162,17 @@ int ContourRenderer::_buildCache()
         return -1;
     }
     
-	double mv = grid->GetMissingValue();
-
-    Grid::ConstCellIterator it = grid->ConstCellBegin(
-		_cacheParams.boxMin, _cacheParams.boxMax
-	);
-
-    Grid::ConstCellIterator end = grid->ConstCellEnd();
-    for (; it != end; ++it)
+    vector<float> lines;
+    vector<int> contourIndex;
+    ContourLines2D(*grid, heightGrid, _cacheParams.boxMin, _cacheParams.boxMax,
+                   contours, lines, contourIndex);
+    
+    vertices.reserve(contourIndex.size());
+    for (size_t i = 0; i < contourIndex.size(); i++)
     {
-        vector<size_t> cell = *it;
-        vector<vector<size_t>> nodes;
-        grid->GetCellNodes(cell, nodes);
-        
-        vector<double> *coords = new vector<double>[nodes.size()];
-        float *values = new float[nodes.size()];
-		bool hasMissing = false;
-        for (int i = 0; i < nodes.size(); i++)
-        {
-            grid->GetUserCoordinates(nodes[i], coords[i]);
-            values[i] = grid->GetValue(coords[i]);
-			if (values[i] == mv) {
-				hasMissing = true;
-			}
-        }
-		if (hasMissing) continue;
-        
-        for (int ci = 0; ci != contours.size(); ci++)
-        {
-            for (int a=nodes.size()-1, b=0; b < nodes.size(); a++, b++)
-            {
-                if (a == nodes.size())
-                    a = 0;
-                double contour = contours[ci];
-                
-                if ((values[a] <= contour && values[b] <= contour)
-                    || (values[a] > contour && values[b] > contour))
-                    continue;
-                
-                float t = (contour - values[a])/(values[b] - values[a]);
-                float v[3];
-                v[0] = coords[a][0] + t * (coords[b][0] - coords[a][0]);
-                v[1] = coords[a][1] + t * (coords[b][1] - coords[a][1]);
-                v[2] = 0;
-                
-                if (heightGrid)
-                {
-                    float aHeight = heightGrid->GetValue(coords[a]);
-                    float bHeight = heightGrid->GetValue(coords[b]);
-                    v[2] = aHeight + t * (bHeight - aHeight);
-                }
-                
-                vertices.push_back({
-                    v[0], v[1], v[2],
-                    contourColors[ci][0],
-                    contourColors[ci][1],
-                    contourColors[ci][2],
-                    contourColors[ci][3]
-                });
-                
-            }
-        }
-        delete [] coords;
-        delete [] values;
+        const float *v = &lines[i*3];
+        const float *c = contourColors[contourIndex[i]];
+        vertices.push_back({v[0], v[1], v[2], c[0], c[1], c[2], c[3]});
     }
     
     _nVertices = vertices.size();
@@ -0,0 +1,419 @@
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cassert>
+#include <vapor/DerivedPythonVar.h>
+
+#define NPY_NO_DEPRECATED_API NPY_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+namespace {
+
+// Module in which user functions are defined
+//
+const string moduleName = "vapor_derived";
+
+// Set once the NumPy C API has been imported
+//
+bool numpyInitialized = false;
+
+};
+
+DerivedPythonVar::DerivedPythonVar(
+	string varName, string units, const std::vector <string> &inNames,
+	string script, string funcName, DataMgr *dataMgr
+) : DerivedDataVar(varName) {
+
+	_units = units;
+	_inNames = inNames;
+	_script = script;
+	_funcName = funcName;
+	_dataMgr = dataMgr;
+	_pFunc = NULL;
+}
+
+DerivedPythonVar::~DerivedPythonVar() {
+	if (_pFunc) {
+		PyGILState_STATE gstate = PyGILState_Ensure();
+		Py_DECREF(_pFunc);
+		PyGILState_Release(gstate);
+	}
+}
+
+int DerivedPythonVar::Initialize() {
+
+	if (_inNames.empty()) {
+		SetErrMsg("Derived variable %s has no inputs", _derivedVarName.c_str());
+		return(-1);
+	}
+
+	// All inputs must share the first input's mesh and dimensions so that
+	// their blocks line up with the output's
+	//
+	DC::DataVar dvar0;
+	bool ok = _dataMgr->GetDataVarInfo(_inNames[0], dvar0);
+	if (! ok) {
+		SetErrMsg("Invalid variable %s", _inNames[0].c_str());
+		return(-1);
+	}
+
+	vector <size_t> dims0, bs0;
+	int rc = _dataMgr->GetDimLensAtLevel(_inNames[0], -1, dims0, bs0);
+	if (rc<0) return(-1);
+
+	for (int i=1; i<_inNames.size(); i++) {
+		DC::DataVar dvar;
+		ok = _dataMgr->GetDataVarInfo(_inNames[i], dvar);
+		if (! ok) {
+			SetErrMsg("Invalid variable %s", _inNames[i].c_str());
+			return(-1);
+		}
+
+		vector <size_t> dims, bs;
+		rc = _dataMgr->GetDimLensAtLevel(_inNames[i], -1, dims, bs);
+		if (rc<0) return(-1);
+
+		if (dvar.GetMeshName() != dvar0.GetMeshName() ||
+			dims != dims0 || bs != bs0) {
+
+			SetErrMsg(
+				"Variables %s and %s have incompatible meshes",
+				_inNames[0].c_str(), _inNames[i].c_str()
+			);
+			return(-1);
+		}
+	}
+
+	_dataVarInfo = dvar0;
+	_dataVarInfo.SetName(_derivedVarName);
+	_dataVarInfo.SetUnits(_units);
+	_dataVarInfo.SetXType(DC::FLOAT);
+	_dataVarInfo.SetWName("");
+	_dataVarInfo.SetCRatios(vector <size_t> ());
+	_dataVarInfo.SetMaskvar("");
+
+	rc = MyPython::Instance()->Initialize();
+	if (rc<0) {
+		SetErrMsg(
+			"Failed to initialize python : %s",
+			MyPython::Instance()->PyErr().c_str()
+		);
+		return(-1);
+	}
+
+	PyGILState_STATE gstate = PyGILState_Ensure();
+
+	if (! numpyInitialized) {
+		if (_import_array() < 0) {
+			SetErrMsg(
+				"Failed to import numpy : %s",
+				MyPython::Instance()->PyErr().c_str()
+			);
+			PyGILState_Release(gstate);
+			return(-1);
+		}
+		numpyInitialized = true;
+	}
+
+	if (_pFunc) Py_DECREF(_pFunc);
+	_pFunc = MyPython::CreatePyFunc(moduleName, _funcName, _script);
+	if (! _pFunc) {
+		SetErrMsg(
+			"Failed to create python function %s : %s",
+			_funcName.c_str(), MyPython::Instance()->PyErr().c_str()
+		);
+		PyGILState_Release(gstate);
+		return(-1);
+	}
+
+	PyGILState_Release(gstate);
+
+	return(0);
+}
+
+bool DerivedPythonVar::GetBaseVarInfo(
+	DC::BaseVar &var
+) const {
+	var = _dataVarInfo;
+	return(true);
+}
+
+bool DerivedPythonVar::GetDataVarInfo(
+	DC::DataVar &var
+) const {
+	var = _dataVarInfo;
+	return(true);
+}
+
+size_t DerivedPythonVar::GetNumRefLevels() const {
+	return(_dataMgr->GetNumRefLevels(_inNames[0]));
+}
+
+int DerivedPythonVar::GetDimLensAtLevel(
+    int level, std::vector <size_t> &dims_at_level,
+    std::vector <size_t> &bs_at_level
+) const {
+	return(
+		_dataMgr->GetDimLensAtLevel(
+			_inNames[0], level, dims_at_level, bs_at_level
+		)
+	);
+}
+
+int DerivedPythonVar::OpenVariableRead(
+    size_t ts, int level, int lod
+) {
+
+	// Inputs are read through the DataMgr when a region is requested.
+	// Nothing to open here.
+	//
+	DC::FileTable::FileObject *f = new DC::FileTable::FileObject(
+		ts, _derivedVarName, level, lod
+	);
+
+	return(_fileTable.AddEntry(f));
+}
+
+int DerivedPythonVar::CloseVariable(int fd) {
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+
+	if (! f) {
+		SetErrMsg("Invalid file descriptor : %d", fd);
+		return(-1);
+	}
+
+    _fileTable.RemoveEntry(fd);
+    delete f;
+
+	return(0);
+}
+
+int DerivedPythonVar::ReadRegionBlock(
+	int fd,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+) {
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+
+	if (! f) {
+		SetErrMsg("Invalid file descriptor : %d", fd);
+		return(-1);
+	}
+
+	size_t ts = f->GetTS();
+	int level = f->GetLevel();
+	int lod = f->GetLOD();
+
+	vector <size_t> dims, dummy;
+	int rc = GetDimLensAtLevel(level, dims, dummy);
+	if (rc<0) return(-1);
+
+	// The region is block aligned and may extend past the boundary of
+	// the variable. Requesting the inputs over the clipped region
+	// yields grids covering the same blocks as the output.
+	//
+	vector <size_t> inMax = max;
+	for (int i=0; i<inMax.size(); i++) {
+		if (inMax[i] >= dims[i]) inMax[i] = dims[i]-1;
+	}
+
+	// Inputs are locked in the DataMgr's cache while the function is
+	// evaluated on their blocks
+	//
+	vector <Grid *> grids;
+	for (int i=0; i<_inNames.size(); i++) {
+		Grid *g = _dataMgr->GetVariable(
+			ts, _inNames[i], level, lod, min, inMax, true
+		);
+		if (! g) {
+			rc = -1;
+			break;
+		}
+		grids.push_back(g);
+	}
+
+	if (rc == 0) {
+		const vector <size_t> &bs = grids[0]->GetBlockSize();
+
+		size_t nblocks = 1;
+		size_t blocksize = 1;
+		for (int i=0; i<bs.size(); i++) {
+			nblocks *= (max[i] / bs[i]) - (min[i] / bs[i]) + 1;
+			blocksize *= bs[i];
+		}
+
+		for (int i=0; i<grids.size(); i++) {
+			if (grids[i]->GetBlks().size() != nblocks) {
+				SetErrMsg(
+					"Variable %s : unexpected block layout",
+					_inNames[i].c_str()
+				);
+				rc = -1;
+			}
+		}
+
+		vector <float *> inBlks(grids.size());
+		for (size_t k=0; k<nblocks && rc==0; k++) {
+			for (int i=0; i<grids.size(); i++) {
+				inBlks[i] = grids[i]->GetBlks()[k];
+			}
+			rc = _evalBlock(region + k*blocksize, inBlks, bs);
+		}
+	}
+
+	for (int i=0; i<grids.size(); i++) {
+		_dataMgr->UnlockGrid(grids[i]);
+		delete grids[i];
+	}
+
+	return(rc);
+}
+
+int DerivedPythonVar::ReadRegion(
+	int fd,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+) {
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+
+	if (! f) {
+		SetErrMsg("Invalid file descriptor : %d", fd);
+		return(-1);
+	}
+
+	vector <size_t> dims, bs;
+	int rc = GetDimLensAtLevel(f->GetLevel(), dims, bs);
+	if (rc<0) return(-1);
+
+	assert(min.size() == max.size());
+	assert(min.size() == bs.size() && min.size() <= 3);
+
+	// Values are only computed a block at a time. Read the blocks
+	// covering the region, then copy the region out of them
+	//
+	size_t b[] = {1,1,1};
+	size_t bmin[] = {0,0,0};
+	size_t lo[] = {0,0,0};
+	size_t hi[] = {0,0,0};
+	vector <size_t> blkMin, blkMax;
+	size_t nvalues = 1;
+	for (int i=0; i<bs.size(); i++) {
+		b[i] = bs[i];
+		bmin[i] = min[i] / bs[i];
+		lo[i] = min[i];
+		hi[i] = max[i];
+		blkMin.push_back(bmin[i] * bs[i]);
+		blkMax.push_back(((max[i] / bs[i]) + 1) * bs[i] - 1);
+		nvalues *= blkMax[i] - blkMin[i] + 1;
+	}
+
+	vector <float> blks(nvalues);
+	rc = ReadRegionBlock(fd, blkMin, blkMax, blks.data());
+	if (rc<0) return(-1);
+
+	size_t nbx = (blkMax[0] - blkMin[0] + 1) / b[0];
+	size_t nby = bs.size() > 1 ? (blkMax[1] - blkMin[1] + 1) / b[1] : 1;
+	size_t blocksize = b[0] * b[1] * b[2];
+
+	float *dst = region;
+	for (size_t z=lo[2]; z<=hi[2]; z++) {
+	for (size_t y=lo[1]; y<=hi[1]; y++) {
+	for (size_t x=lo[0]; x<=hi[0]; x++) {
+		size_t blk = 
+			((z/b[2] - bmin[2]) * nby + (y/b[1] - bmin[1])) * nbx + 
+			(x/b[0] - bmin[0]);
+		size_t offset = ((z%b[2]) * b[1] + (y%b[1])) * b[0] + (x%b[0]);
+		*dst++ = blks[blk*blocksize + offset];
+	}
+	}
+	}
+	return(0);
+}
+
+bool DerivedPythonVar::VariableExists(
+	size_t ts,
+	int reflevel,
+	int lod
+) const {
+
+	for (int i=0; i<_inNames.size(); i++) {
+		if (! _dataMgr->VariableExists(ts, _inNames[i], reflevel, lod)) {
+			return(false);
+		}
+	}
+	return(true);
+}
+
+int DerivedPythonVar::_evalBlock(
+	float *outBlk, const vector <float *> &inBlks, const vector <size_t> &bs
+) {
+
+	// NumPy arrays are indexed slowest varying dimension first
+	//
+	vector <npy_intp> shape;
+	for (int i=bs.size()-1; i>=0; i--) {
+		shape.push_back(bs[i]);
+	}
+
+	// The GIL is held only for the duration of a single block
+	//
+	PyGILState_STATE gstate = PyGILState_Ensure();
+
+	PyObject *pArgs = PyTuple_New(inBlks.size() + 1);
+
+	PyObject *pOut = PyArray_SimpleNewFromData(
+		shape.size(), shape.data(), NPY_FLOAT32, outBlk
+	);
+	PyTuple_SetItem(pArgs, 0, pOut);
+
+	for (int i=0; i<inBlks.size(); i++) {
+		PyObject *pIn = PyArray_SimpleNewFromData(
+			shape.size(), shape.data(), NPY_FLOAT32, inBlks[i]
+		);
+		PyArray_CLEARFLAGS((PyArrayObject *) pIn, NPY_ARRAY_WRITEABLE);
+		PyTuple_SetItem(pArgs, i+1, pIn);
+	}
+
+	int rc = 0;
+	PyObject *pValue = PyObject_CallObject(_pFunc, pArgs);
+	if (! pValue) {
+		SetErrMsg(
+			"Python function %s failed : %s",
+			_funcName.c_str(), MyPython::Instance()->PyErr().c_str()
+		);
+		rc = -1;
+	}
+	else if (pValue != Py_None && pValue != pOut) {
+
+		// Function returned its result rather than writing into the
+		// output array
+		//
+		PyArrayObject *pResult = (PyArrayObject *) PyArray_FROMANY(
+			pValue, NPY_FLOAT32, 0, 0, NPY_ARRAY_IN_ARRAY
+		);
+		if (! pResult ||
+			PyArray_SIZE(pResult) != PyArray_SIZE((PyArrayObject *) pOut)) {
+
+			SetErrMsg(
+				"Python function %s returned invalid result", _funcName.c_str()
+			);
+			if (! pResult) PyErr_Clear();
+			rc = -1;
+		}
+		else {
+			memcpy(
+				outBlk, PyArray_DATA(pResult),
+				PyArray_SIZE(pResult) * sizeof(*outBlk)
+			);
+		}
+		Py_XDECREF(pResult);
+	}
+
+	Py_XDECREF(pValue);
+	Py_DECREF(pArgs);
+
+	PyGILState_Release(gstate);
+
+	return(rc);
+}
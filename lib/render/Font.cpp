@@ -1,6 +1,7 @@
 #include "vapor/glutil.h"
 #include "vapor/Font.h"
 #include <cassert>
+#include <cstring>
 #include "vapor/ShaderManager.h"
 #include <glm/glm.hpp>
 #include "vapor/GLManager.h"
@@ -9,11 +10,24 @@ using namespace VAPoR;
 using std::string;
 using glm::vec2;
 
+// Number of floats per vertex: position and atlas coordinates in
+// pixels, and color
+#define VERTEX_SIZE 8
+
+// Maximum number of string layouts kept by a font
+#define MAX_CACHED_LAYOUTS 512
+
 Font::Font(GLManager *glManager, const std::string &path, int size, FT_Library library)
 :
 _glManager(glManager),
 _library(nullptr),
-_size(size)
+_size(size),
+_atlasTexture(0),
+_atlasWidth(256),
+_atlasHeight(64),
+_rowX(0),
+_rowY(0),
+_rowHeight(0)
 {
     if (library == nullptr) {
         assert(!FT_Init_FreeType(&_library));
@@ -26,11 +40,28 @@ _size(size)
     glGenBuffers(1, &_VBO);
     glBindVertexArray(_VAO);
     glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    glBufferData(GL_ARRAY_BUFFER, 6*4*sizeof(float), NULL, GL_STREAM_DRAW);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, VERTEX_SIZE*sizeof(float), 0);
     glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, VERTEX_SIZE*sizeof(float), (void*)(4*sizeof(float)));
+    glEnableVertexAttribArray(1);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+    
+    // Make the atlas wide enough for a row of a dozen or so glyphs
+    while (_atlasWidth < 16 * _size)
+        _atlasWidth *= 2;
+    _atlas.assign(_atlasWidth * _atlasHeight, 0);
+    
+    glGenTextures(1, &_atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, _atlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, _atlasWidth, _atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, _atlas.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 Font::~Font()
@@ -41,8 +72,7 @@ Font::~Font()
     
     glDeleteVertexArrays(1, &_VAO);
     glDeleteBuffers(1, &_VBO);
-    for (auto it = _glyphMap.begin(); it != _glyphMap.end(); ++it)
-        glDeleteTextures(1, &it->second.textureID);
+    glDeleteTextures(1, &_atlasTexture);
 }
 
 bool Font::LoadGlyph(int c)
@@ -52,32 +82,16 @@ bool Font::LoadGlyph(int c)
         return false;
     }
     
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_RED,
-        _face->glyph->bitmap.width,
-        _face->glyph->bitmap.rows,
-        0,
-        GL_RED,
-        GL_UNSIGNED_BYTE,
-        _face->glyph->bitmap.buffer
-    );
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    const FT_Bitmap &bitmap = _face->glyph->bitmap;
+    int x = 0, y = 0;
+    if (!AddToAtlas(bitmap.buffer, bitmap.width, bitmap.rows, bitmap.pitch, x, y))
+        return false;
     
     _glyphMap[c] = {
-        texture,
-        (int)_face->glyph->bitmap.width,
-        (int)_face->glyph->bitmap.rows,
+        x,
+        y,
+        (int)bitmap.width,
+        (int)bitmap.rows,
         _face->glyph->bitmap_left,
         _face->glyph->bitmap_top,
         _face->glyph->advance.x
@@ -86,6 +100,61 @@ bool Font::LoadGlyph(int c)
     return true;
 }
 
+// Copies a glyph bitmap into the next free spot of the atlas and returns
+// its position. Glyphs are separated by a pixel so that linear filtering
+// doesn't pick up their neighbors.
+//
+bool Font::AddToAtlas(const unsigned char *bitmap, int width, int height, int pitch, int &x, int &y)
+{
+    if (width + 1 > _atlasWidth)
+        return false;
+    
+    if (_rowX + width + 1 > _atlasWidth) {
+        _rowX = 0;
+        _rowY += _rowHeight + 1;
+        _rowHeight = 0;
+    }
+    while (_rowY + height + 1 > _atlasHeight)
+        GrowAtlas();
+    
+    x = _rowX;
+    y = _rowY;
+    _rowX += width + 1;
+    if (height > _rowHeight)
+        _rowHeight = height;
+    
+    if (width == 0 || height == 0)
+        return true;
+    
+    for (int j = 0; j < height; j++)
+        memcpy(&_atlas[(y + j) * _atlasWidth + x], bitmap + j * pitch, width);
+    
+    glBindTexture(GL_TEXTURE_2D, _atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, _atlasWidth);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RED, GL_UNSIGNED_BYTE, &_atlas[y * _atlasWidth + x]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// Doubles the height of the atlas. Atlas coordinates are kept in pixels
+// and only normalized by the shader, so glyphs and cached layouts remain
+// valid.
+//
+void Font::GrowAtlas()
+{
+    _atlasHeight *= 2;
+    _atlas.resize(_atlasWidth * _atlasHeight, 0);
+    
+    glBindTexture(GL_TEXTURE_2D, _atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, _atlasWidth, _atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, _atlas.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 Font::Glyph Font::GetGlyph(int c)
 {
     auto it = _glyphMap.find(c);
@@ -96,16 +165,19 @@ Font::Glyph Font::GetGlyph(int c)
     return it->second;
 }
 
-void Font::DrawText(const std::string &text, const glm::vec4 &color)
+// Returns two triangles per glyph, each vertex being a position
+// relative to the text origin and a position in the atlas
+//
+const std::vector<float> &Font::GetLayout(const std::string &text)
 {
-    SmartShaderProgram shader = _glManager->shaderManager->GetSmartShader("font");
-    shader->SetUniform("MVP", _glManager->matrixManager->GetModelViewProjectionMatrix());
-    shader->SetUniform("color", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    auto it = _layoutCache.find(text);
+    if (it != _layoutCache.end())
+        return it->second;
+    
+    if (_layoutCache.size() >= MAX_CACHED_LAYOUTS)
+        _layoutCache.clear();
+    
+    std::vector<float> &layout = _layoutCache[text];
     
     const float xStart = 0;
     const float yStart = 0;
@@ -130,22 +202,70 @@ void Font::DrawText(const std::string &text, const glm::vec4 &color)
         float y = cursorY - (ch.sizeY - ch.bearingY);
         float w = ch.sizeX;
         float h = ch.sizeY;
+        float s = ch.atlasX;
+        float t = ch.atlasY;
+        
+        cursorX += ch.advance / 64;
+        
+        if (w == 0 || h == 0)
+            continue;
         
         float vertices[6][4] = {
-            { x  , y+h,   0, 0 },
-            { x  , y  ,   0, 1 },
-            { x+w, y  ,   1, 1 },
+            { x  , y+h,   s  , t   },
+            { x  , y  ,   s  , t+h },
+            { x+w, y  ,   s+w, t+h },
             
-            { x  , y+h,   0, 0 },
-            { x+w, y  ,   1, 1 },
-            { x+w, y+h,   1, 0 }
+            { x  , y+h,   s  , t   },
+            { x+w, y  ,   s+w, t+h },
+            { x+w, y+h,   s+w, t   }
         };
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindTexture(GL_TEXTURE_2D, ch.textureID);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        
-        cursorX += ch.advance / 64;
+        layout.insert(layout.end(), &vertices[0][0], &vertices[0][0] + 6*4);
     }
+    return layout;
+}
+
+void Font::AddText(std::vector<float> &vertices, const glm::vec2 &position, const std::string &text, const glm::vec4 &color)
+{
+    const std::vector<float> &layout = GetLayout(text);
+    
+    vertices.reserve(vertices.size() + layout.size() / 4 * VERTEX_SIZE);
+    for (int i = 0; i < layout.size(); i += 4) {
+        vertices.push_back(layout[i  ] + position.x);
+        vertices.push_back(layout[i+1] + position.y);
+        vertices.push_back(layout[i+2]);
+        vertices.push_back(layout[i+3]);
+        vertices.push_back(color.r);
+        vertices.push_back(color.g);
+        vertices.push_back(color.b);
+        vertices.push_back(color.a);
+    }
+}
+
+void Font::DrawText(const std::string &text, const glm::vec4 &color)
+{
+    std::vector<float> vertices;
+    AddText(vertices, vec2(0.f), text, color);
+    DrawVertices(vertices);
+}
+
+void Font::DrawVertices(const std::vector<float> &vertices)
+{
+    if (vertices.empty())
+        return;
+    
+    SmartShaderProgram shader = _glManager->shaderManager->GetSmartShader("font");
+    shader->SetUniform("MVP", _glManager->matrixManager->GetModelViewProjectionMatrix());
+    shader->SetUniform("atlasSize", vec2(_atlasWidth, _atlasHeight));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _atlasTexture);
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    glDrawArrays(GL_TRIANGLES, 0, vertices.size() / VERTEX_SIZE);
+    
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
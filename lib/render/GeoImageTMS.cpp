@@ -4,6 +4,9 @@
 #include <cassert>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <set>
 #include <sys/stat.h>
 #ifdef WIN32
 #include <geotiff/geotiff.h>
@@ -21,6 +24,95 @@
 using namespace VAPoR;
 using namespace Wasp;
 
+namespace {
+
+// Status codes for tiles decoded by worker threads. The TIFF error
+// handler and MyBase's error messages are process global, so worker
+// threads only record a code and the calling thread reports it
+//
+enum {
+	tileOK = 0,
+	tileMissing = -1,
+	tileOpenFailed = -2,
+	tileBadSize = -3,
+	tileReadFailed = -4
+};
+
+const char *tile_status_msg(int status) {
+	switch (status) {
+	case tileMissing: return("does not exist");
+	case tileOpenFailed: return("could not be opened");
+	case tileBadSize: return("does not match the TMS tile size");
+	case tileReadFailed: return("could not be decoded");
+	default: return("could not be read");
+	}
+}
+
+// TIFF errors are reported through the tile status codes
+//
+void silent_tiff_err_handler(const char *, const char *, va_list) {}
+
+// Decode a single w x h RGBA tile. Safe to call from several threads
+// at once: only libtiff handles local to the call are used
+//
+int read_tile(const string &path, size_t w, size_t h, unsigned char *tile) {
+	if (path.empty()) return(tileMissing);
+
+	TIFF *tif = TIFFOpen(path.c_str(), "rm");
+	if (! tif) return(tileOpenFailed);
+
+	uint32 tw = 0, th = 0;
+	TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &tw);
+	TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &th);
+	if (tw != w || th != h) {
+		TIFFClose(tif);
+		return(tileBadSize);
+	}
+
+	int ok = TIFFReadRGBAImage(tif, tw, th, (uint32 *) tile, 0);
+	TIFFClose(tif);
+
+	return(ok ? tileOK : tileReadFailed);
+}
+
+// Execution thread state for parallel tile reads
+//
+class tile_read_state {
+public:
+ int _id;
+ int _nthreads;
+ const vector <string> &_paths;
+ unsigned char *_tiles;	// global (shared by all threads)
+ size_t _w;
+ size_t _h;
+ vector <int> &_status;	// one per tile
+
+ tile_read_state(
+	int id, int nthreads, const vector <string> &paths,
+	unsigned char *tiles, size_t w, size_t h, vector <int> &status
+ ) : _id(id), _nthreads(nthreads), _paths(paths), _tiles(tiles),
+	_w(w), _h(h), _status(status)
+ {}
+};
+
+void *RunTileReadThread(void *arg) {
+	tile_read_state &s = *(tile_read_state *) arg;
+
+	size_t tileSize = s._w * s._h * 4;
+	for (size_t i=s._id; i<s._paths.size(); i += s._nthreads) {
+		s._status[i] = read_tile(
+			s._paths[i], s._w, s._h, s._tiles + i*tileSize
+		);
+	}
+	return(0);
+}
+
+// Default size of the decoded tile cache
+//
+const size_t defaultCacheSize = 256 * 1024 * 1024;
+
+};
+
 
 GeoImageTMS::GeoImageTMS() 
 	: GeoImage(8, 4) {
@@ -32,6 +124,8 @@ GeoImageTMS::GeoImageTMS()
 	_tileBuf = NULL;
 	_tileBufSize = 0;
 	_geotile = NULL;
+	_cacheSize = defaultCacheSize;
+	_et = new EasyThreads(0);
 
 	// The default projection string for imagery centered at 0 degrees
 	// longitude. This string is modified (+lon_0 is edited) if a 
@@ -51,6 +145,22 @@ GeoImageTMS::~GeoImageTMS()
 		_tileBufSize = 0;
 
 	if (_geotile) delete _geotile;
+
+	if (_et) delete _et;
+}
+
+void GeoImageTMS::SetCacheSize(size_t mbytes) {
+	_cacheSize = mbytes * 1024 * 1024;
+	if (_geotile) _geotile->SetMaxTiles(_maxCachedTiles());
+}
+
+size_t GeoImageTMS::_maxCachedTiles() const {
+	if (! _geotile) return(0);
+
+	size_t w, h;
+	_geotile->GetTileSize(w, h);
+	size_t n = _cacheSize / (w*h*4);
+	return(n > 0 ? n : 1);
 }
 
 
@@ -58,6 +168,11 @@ int GeoImageTMS::Initialize(string dir, vector <double> times) {
 
 	SetDiagMsg("GeoImageTMS::Initialize(%s)", dir.c_str());
 
+	// Keep previously decoded tiles if the TMS database hasn't changed.
+	// TMS imagery is not time varying.
+	//
+	if (_geotile && dir == _dir) return(0);
+
 	if (_geotile) delete _geotile;
 	_geotile = NULL;
 	_dir = dir;
@@ -87,6 +202,7 @@ int GeoImageTMS::Initialize(string dir, vector <double> times) {
 	// longitudinal span
 	//
 	_geotile = new GeoTileMercator(w, h, 4);
+	_geotile->SetMaxTiles(_maxCachedTiles());
 
 	//
 	// Allocate space to buffer a tile
@@ -118,8 +234,15 @@ unsigned char *GeoImageTMS::GetImage(
 	//
 	// Just return the base texture 
 	//
-	int rc = _tileRead(_dir, 0, 0, 0, _texture);
-	if (rc<0) return(NULL);
+	string quadkey = _geotile->TileXYToQuadKey(0, 0, 0);
+	if (! _geotile->Touch(quadkey)) {
+		int rc = _tileRead(_dir, 0, 0, 0, _tileBuf);
+		if (rc<0) return(NULL);
+
+		rc = _geotile->Insert(quadkey, _tileBuf);
+		assert( !(rc<0));
+	}
+	memcpy(_texture, _geotile->GetTile(quadkey), size);
 
 	return(_texture);
 }
@@ -434,9 +557,14 @@ int GeoImageTMS::_getMap(
 	}
 
 
-	// Make sure tiles need for this map are loaded. If not, read
-	// and load them 
+	// Make sure tiles need for this map are loaded. Cached tiles
+	// are marked as recently used so they survive insertion of the 
+	// missing ones
 	//
+	vector <string> quadkeys;
+	vector <size_t> readX, readY;
+	vector <int> readLOD;
+
 	size_t tileY = tileY0;
 	for (size_t y=0; y<nytiles; y++) {
 
@@ -444,13 +572,11 @@ int GeoImageTMS::_getMap(
 		for (size_t x=0; x<nxtiles; x++) {
 
 			string quadkey = _geotile->TileXYToQuadKey(tileX, tileY, lod);
-			if (! _geotile->GetTile(quadkey)) {
-
-				int rc = _tileRead( _dir, tileX, tileY, lod, _tileBuf);
-				if (rc<0) return(-1);
-
-				rc = _geotile->Insert(quadkey, _tileBuf);
-				assert( !(rc<0));
+			quadkeys.push_back(quadkey);
+			if (! _geotile->Touch(quadkey)) {
+				readX.push_back(tileX);
+				readY.push_back(tileY);
+				readLOD.push_back(lod);
 			}
 			tileX = (tileX + 1) % ntiles;
 
@@ -459,8 +585,206 @@ int GeoImageTMS::_getMap(
 		tileY = (tileY + 1) % ntiles;
 	}
 
+	size_t maxTiles = _maxCachedTiles();
+	bool raisedMax = false;
+
+	if (readX.size()) {
+		size_t nrequired = readX.size();
+
+		// Threads that would be idle during the last round of reads
+		// prefetch tiles the user is likely to pan or zoom out to
+		//
+		int nthreads = _et->GetNumThreads();
+		size_t nspare = (nthreads - (nrequired % nthreads)) % nthreads;
+		_getPrefetchTiles(
+			tileX0, tileY0, nxtiles, nytiles, lod, nspare, 
+			readX, readY, readLOD
+		);
+
+		// The cache must be able to hold the entire map. The limit is
+		// restored once the map has been extracted
+		//
+		if (quadkeys.size() + readX.size() > maxTiles) {
+			_geotile->SetMaxTiles(quadkeys.size() + readX.size());
+			raisedMax = true;
+		}
+
+		int rc = _tilesRead(_dir, readX, readY, readLOD, nrequired);
+		if (rc<0) {
+			if (raisedMax) _geotile->SetMaxTiles(maxTiles);
+			return(-1);
+		}
+
+		for (size_t i=0; i<quadkeys.size(); i++) {
+			(void) _geotile->Touch(quadkeys[i]);
+		}
+	}
+
 	int rc = _geotile->GetMap(
 		pixelSW[0],pixelSW[1],pixelNE[0],pixelNE[1],lod,texture
 	);
+
+	if (raisedMax) _geotile->SetMaxTiles(maxTiles);
+
 	return(rc);
 }
+
+// Read and cache a list of tiles in parallel. The first nrequired tiles
+// must be read successfully. Any remaining tiles are prefetched, and 
+// failure to read them is ignored
+//
+int GeoImageTMS::_tilesRead(
+	string dir, const vector <size_t> &tileX, const vector <size_t> &tileY,
+	const vector <int> &lod, size_t nrequired
+) {
+	assert(tileX.size() == tileY.size() && tileX.size() == lod.size());
+
+	size_t ntiles = tileX.size();
+
+	size_t w, h;
+	_geotile->GetTileSize(w, h);
+	size_t tileSize = w*h*4;
+
+	vector <string> paths;
+	for (size_t i=0; i<ntiles; i++) {
+		paths.push_back(_tilePath(dir, tileX[i], tileY[i], lod[i]));
+		if (i < nrequired && paths[i].empty()) {
+			SetErrMsg(
+				"Tile %d %d %d does not exist", tileX[i], tileY[i], lod[i]
+			);
+			return(-1);
+		}
+	}
+
+	if (_readBuf.size() < ntiles * tileSize) _readBuf.resize(ntiles*tileSize);
+	vector <int> status(ntiles, tileOK);
+
+	// Worker threads must not touch the process global TIFF error 
+	// handler. Silence it for the duration of the reads
+	//
+	TIFFErrorHandler errHandler = TIFFSetErrorHandler(silent_tiff_err_handler);
+
+	int rc = 0;
+	int nthreads = _et->GetNumThreads();
+	size_t readBufMax = std::max(_cacheSize / 8, nthreads * tileSize);
+	if (nthreads == 1 || ntiles == 1) {
+		tile_read_state s(0, 1, paths, _readBuf.data(), w, h, status);
+		RunTileReadThread(&s);
+	}
+	else {
+		vector <void *> argvec;
+		for (int i=0; i<nthreads; i++) {
+			argvec.push_back((void *) new tile_read_state(
+				i, nthreads, paths, _readBuf.data(), w, h, status
+			));
+		}
+
+		rc = _et->ParRun(RunTileReadThread, argvec);
+
+		for (int i=0; i<argvec.size(); i++) {
+			delete (tile_read_state *) argvec[i];
+		}
+	}
+
+	TIFFSetErrorHandler(errHandler);
+
+	if (rc < 0) {
+		SetErrMsg("Error spawning threads");
+		return(-1);
+	}
+
+	// Insert prefetched tiles first so that the required ones are the 
+	// most recently used
+	//
+	for (size_t j=0; j<ntiles; j++) {
+		size_t i = (j + nrequired) % ntiles;
+
+		if (status[i] != tileOK) {
+			if (i < nrequired) {
+				SetErrMsg(
+					"Tile %d %d %d %s : %s", tileX[i], tileY[i], lod[i], 
+					tile_status_msg(status[i]), paths[i].c_str()
+				);
+				_trimReadBuf(readBufMax);
+				return(-1);
+			}
+			continue;
+		}
+
+		string quadkey = _geotile->TileXYToQuadKey(tileX[i], tileY[i], lod[i]);
+		int rc = _geotile->Insert(quadkey, _readBuf.data() + i*tileSize);
+		assert( !(rc<0));
+	}
+
+	// Large reads, e.g. the first map at a fine lod, shouldn't pin 
+	// their buffer for the life of the object
+	//
+	_trimReadBuf(readBufMax);
+
+	return(0);
+}
+
+// Release the tile read buffer if it holds more than maxBytes
+//
+void GeoImageTMS::_trimReadBuf(size_t maxBytes) {
+	if (_readBuf.size() > maxBytes) vector <unsigned char>().swap(_readBuf);
+}
+
+// Append up to maxTiles uncached tiles to the read list: the tiles at the
+// next coarser lod covering the map, followed by the ring of tiles 
+// surrounding the map at the current lod
+//
+void GeoImageTMS::_getPrefetchTiles(
+	size_t tileX0, size_t tileY0, size_t nxtiles, size_t nytiles, int lod,
+	size_t maxTiles, 
+	vector <size_t> &tileX, vector <size_t> &tileY, vector <int> &tileLOD
+) const {
+	if (! maxTiles) return;
+
+	set <string> queued;
+	for (size_t i=0; i<tileX.size(); i++) {
+		queued.insert(
+			_geotile->TileXYToQuadKey(tileX[i], tileY[i], tileLOD[i])
+		);
+	}
+
+	vector <size_t> candX, candY;
+	vector <int> candLOD;
+
+	size_t ntiles = 1 << lod;
+	if (lod > 0) {
+		for (size_t y=0; y<nytiles; y++) {
+		for (size_t x=0; x<nxtiles; x++) {
+			candX.push_back(((tileX0 + x) % ntiles) / 2);
+			candY.push_back(((tileY0 + y) % ntiles) / 2);
+			candLOD.push_back(lod-1);
+		}
+		}
+	}
+
+	if (nxtiles + 2 <= ntiles && nytiles + 2 <= ntiles) {
+		for (size_t y=0; y<nytiles+2; y++) {
+		for (size_t x=0; x<nxtiles+2; x++) {
+			if (y != 0 && y != nytiles+1 && x != 0 && x != nxtiles+1) continue;
+
+			candX.push_back((tileX0 + ntiles + x - 1) % ntiles);
+			candY.push_back((tileY0 + ntiles + y - 1) % ntiles);
+			candLOD.push_back(lod);
+		}
+		}
+	}
+
+	size_t nadded = 0;
+	for (size_t i=0; i<candX.size() && nadded < maxTiles; i++) {
+		string quadkey = _geotile->TileXYToQuadKey(
+			candX[i], candY[i], candLOD[i]
+		);
+		if (queued.count(quadkey) || _geotile->GetTile(quadkey)) continue;
+
+		queued.insert(quadkey);
+		tileX.push_back(candX[i]);
+		tileY.push_back(candY[i]);
+		tileLOD.push_back(candLOD[i]);
+		nadded++;
+	}
+}
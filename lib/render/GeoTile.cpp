@@ -15,6 +15,9 @@ GeoTile::GeoTile(
 	_tile_height = tile_height;
 	_pixel_size = pixel_size;
 	_tiles.clear();
+	_maxTiles = 0;
+	_lru.clear();
+	_lruPos.clear();
 
 	_MinLongitude = min_lon;
 	_MinLatitude = min_lat;
@@ -62,13 +65,47 @@ int GeoTile::Insert(
 		imgptr = p->second;	// tile already exists;
 	}
 	else {
+		if (_maxTiles) _evict(_maxTiles - 1);
+
 		imgptr = new unsigned char[_tile_width * _tile_height * _pixel_size];
 		_tiles[quadkey] = imgptr;
+		_lru.push_front(quadkey);
+		_lruPos[quadkey] = _lru.begin();
 	}
 	memcpy(imgptr, image, _tile_width * _tile_height * _pixel_size);
+	(void) Touch(quadkey);
 	return(0);
 }
 
+bool GeoTile::Touch(string quadkey) {
+	map <string, list <string>::iterator>::iterator p = _lruPos.find(quadkey);
+	if (p == _lruPos.end()) return(false);
+
+	_lru.splice(_lru.begin(), _lru, p->second);
+	return(true);
+}
+
+void GeoTile::SetMaxTiles(size_t maxTiles) {
+	_maxTiles = maxTiles;
+	if (_maxTiles) _evict(_maxTiles);
+}
+
+// Discard least recently used tiles until no more than maxTiles remain
+//
+void GeoTile::_evict(size_t maxTiles) {
+	while (_tiles.size() > maxTiles && ! _lru.empty()) {
+		string quadkey = _lru.back();
+		_lru.pop_back();
+		_lruPos.erase(quadkey);
+
+		map <string,unsigned char *>::iterator p = _tiles.find(quadkey);
+		if (p != _tiles.end()) {
+			if (p->second) delete [] p->second;
+			_tiles.erase(p);
+		}
+	}
+}
+
 const unsigned char *GeoTile::GetTile(
 	string quadkey
 ) const {
@@ -0,0 +1,329 @@
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+#ifdef WIN32
+#include <tiff/tiffio.h>
+#else
+#include <tiffio.h>
+#endif
+
+#include <vapor/EasyThreads.h>
+#include <vapor/jpegapi.h>
+#include "vapor/ImageCaptureQueue.h"
+
+using namespace Wasp;
+using namespace VAPoR;
+
+#include "imagewriter.hpp"
+
+namespace {
+
+enum ImageFormat {TIFF_FORMAT, JPEG_FORMAT, PNG_FORMAT};
+
+// Anything that is not a tiff or jpeg is written as png
+//
+ImageFormat getFormat(const std::string &filename)
+{
+    std::string suffix = filename.length() >= 4 ?
+        filename.substr(filename.length()-4, 4) : filename;
+
+    if (suffix == ".tif" || suffix == "tiff") return(TIFF_FORMAT);
+    if (suffix == ".jpg" || suffix == "jpeg") return(JPEG_FORMAT);
+    return(PNG_FORMAT);
+}
+
+};
+
+ImageCaptureQueue::ImageCaptureQueue(int nthreads, int maxPending)
+{
+    if (nthreads < 1) nthreads = std::min(EasyThreads::NProc(), 4);
+    if (nthreads < 1) nthreads = 1;
+    if (maxPending < 1) maxPending = 2 * nthreads;
+
+    _maxPending = maxPending;
+    _nActive = 0;
+    _shutdown = false;
+
+#ifndef WIN32
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_jobReady, NULL);
+    pthread_cond_init(&_jobDone, NULL);
+
+    // Fewer threads only cost throughput. With none at all frames are
+    // encoded synchronously
+    //
+    for (int i=0; i<nthreads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, _runWorker, this) != 0) break;
+        _threads.push_back(thread);
+    }
+#endif
+}
+
+ImageCaptureQueue::~ImageCaptureQueue()
+{
+#ifndef WIN32
+    _lock();
+    _shutdown = true;
+    _unlock();
+    pthread_cond_broadcast(&_jobReady);
+
+    // Workers drain the queue before exiting
+    //
+    for (int i=0; i<_threads.size(); i++) {
+        pthread_join(_threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&_jobDone);
+    pthread_cond_destroy(&_jobReady);
+    pthread_mutex_destroy(&_mutex);
+#endif
+
+    for (int i=0; i<_freeBuffers.size(); i++) delete [] _freeBuffers[i].first;
+    for (int i=0; i<_busyBuffers.size(); i++) delete [] _busyBuffers[i].first;
+}
+
+unsigned char *ImageCaptureQueue::GetBuffer(size_t size)
+{
+    _lock();
+
+    for (int i=0; i<_freeBuffers.size(); i++) {
+        if (_freeBuffers[i].second >= size) {
+            std::pair <unsigned char *, size_t> b = _freeBuffers[i];
+            _freeBuffers.erase(_freeBuffers.begin() + i);
+            _busyBuffers.push_back(b);
+            _unlock();
+            return(b.first);
+        }
+    }
+
+    // Nothing large enough. Drop the pool if the frame size changed
+    // so stale buffers don't accumulate
+    //
+    for (int i=0; i<_freeBuffers.size(); i++) delete [] _freeBuffers[i].first;
+    _freeBuffers.clear();
+
+    unsigned char *buf = new unsigned char[size];
+    _busyBuffers.push_back(std::make_pair(buf, size));
+    _unlock();
+    return(buf);
+}
+
+void ImageCaptureQueue::ReleaseBuffer(unsigned char *buf)
+{
+    _lock();
+
+    for (int i=0; i<_busyBuffers.size(); i++) {
+        if (_busyBuffers[i].first == buf) {
+            _freeBuffers.push_back(_busyBuffers[i]);
+            _busyBuffers.erase(_busyBuffers.begin() + i);
+            _unlock();
+            return;
+        }
+    }
+    _unlock();
+    assert(0 && "Buffer not obtained from GetBuffer()");
+}
+
+int ImageCaptureQueue::Enqueue(
+    std::string filename, size_t width, size_t height,
+    unsigned char *buf, bool bottomUp
+) {
+    Job job = {filename, width, height, buf, bottomUp};
+
+    // Python may only be called from the thread that owns the interpreter
+    //
+#ifndef WIN32
+    if (getFormat(filename) != PNG_FORMAT && _threads.size()) {
+        _lock();
+        while (_jobs.size() >= _maxPending) {
+            pthread_cond_wait(&_jobDone, &_mutex);
+        }
+        _jobs.push_back(job);
+        _unlock();
+        pthread_cond_signal(&_jobReady);
+
+        return(_reportErrors());
+    }
+#endif
+
+    _encode(job);
+    ReleaseBuffer(buf);
+    return(_reportErrors());
+}
+
+int ImageCaptureQueue::Wait()
+{
+#ifndef WIN32
+    _lock();
+    while (_jobs.size() || _nActive) {
+        pthread_cond_wait(&_jobDone, &_mutex);
+    }
+    _unlock();
+#endif
+    return(_reportErrors());
+}
+
+size_t ImageCaptureQueue::GetNumPending()
+{
+    _lock();
+    size_t n = _jobs.size() + _nActive;
+    _unlock();
+    return(n);
+}
+
+int ImageCaptureQueue::WriteImage(
+    std::string filename, size_t width, size_t height,
+    unsigned char *buf, std::string &errMsg
+) {
+    errMsg.clear();
+
+    ImageFormat format = getFormat(filename);
+
+    if (format == TIFF_FORMAT) {
+        TIFF *tiffFile = TIFFOpen(filename.c_str(), "wb");
+        if (! tiffFile) {
+            errMsg = "Error opening output Tiff file: " + filename;
+            return(-1);
+        }
+
+        // Write the whole image as a single strip rather than one
+        // scanline at a time
+        //
+        TIFFSetField(tiffFile, TIFFTAG_IMAGEWIDTH, (uint32) width);
+        TIFFSetField(tiffFile, TIFFTAG_IMAGELENGTH, (uint32) height);
+        TIFFSetField(tiffFile, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+        TIFFSetField(tiffFile, TIFFTAG_SAMPLESPERPIXEL, 3);
+        TIFFSetField(tiffFile, TIFFTAG_ROWSPERSTRIP, (uint32) height);
+        TIFFSetField(tiffFile, TIFFTAG_BITSPERSAMPLE, 8);
+        TIFFSetField(tiffFile, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+
+        tsize_t nbytes = (tsize_t) (3 * width * height);
+        tsize_t rc = TIFFWriteEncodedStrip(tiffFile, 0, buf, nbytes);
+        TIFFClose(tiffFile);
+        if (rc != nbytes) {
+            errMsg = "Error writing tiff file " + filename;
+            return(-1);
+        }
+    }
+    else if (format == JPEG_FORMAT) {
+        FILE *jpegFile = fopen(filename.c_str(), "wb");
+        if (! jpegFile) {
+            errMsg = "Error opening output Jpeg file: " + filename;
+            return(-1);
+        }
+
+        int quality = 95;
+        int rc = write_JPEG_file(jpegFile, width, height, buf, quality);
+        fclose(jpegFile);
+        if (rc) {
+            errMsg = "Error writing jpeg file " + filename;
+            return(-1);
+        }
+    }
+    else {
+        int rc = Write_PNG(filename.c_str(), width, height, buf);
+        if (rc) {
+            errMsg = "Error writing PNG file " + filename;
+            return(-1);
+        }
+    }
+    return(0);
+}
+
+void *ImageCaptureQueue::_runWorker(void *arg)
+{
+    ((ImageCaptureQueue *) arg)->_workerLoop();
+    return(0);
+}
+
+void ImageCaptureQueue::_workerLoop()
+{
+#ifndef WIN32
+    for (;;) {
+        _lock();
+        while (_jobs.empty() && ! _shutdown) {
+            pthread_cond_wait(&_jobReady, &_mutex);
+        }
+        if (_jobs.empty()) {
+            _unlock();
+            return;
+        }
+
+        Job job = _jobs.front();
+        _jobs.pop_front();
+        _nActive++;
+        _unlock();
+
+        _encode(job);
+        ReleaseBuffer(job.buf);
+
+        _lock();
+        _nActive--;
+        _unlock();
+        pthread_cond_broadcast(&_jobDone);
+    }
+#endif
+}
+
+void ImageCaptureQueue::_encode(const Job &job)
+{
+    if (job.bottomUp) _flipRows(job.buf, job.width, job.height);
+
+    std::string errMsg;
+    int rc = WriteImage(job.filename, job.width, job.height, job.buf, errMsg);
+    if (rc < 0) {
+        _lock();
+        _errors.push_back(errMsg);
+        _unlock();
+    }
+}
+
+void ImageCaptureQueue::_lock()
+{
+#ifndef WIN32
+    pthread_mutex_lock(&_mutex);
+#endif
+}
+
+void ImageCaptureQueue::_unlock()
+{
+#ifndef WIN32
+    pthread_mutex_unlock(&_mutex);
+#endif
+}
+
+// MyBase error state is static and not thread safe, so encoder threads
+// only record their errors. They're posted here on the caller's thread.
+//
+int ImageCaptureQueue::_reportErrors()
+{
+    std::vector <std::string> errors;
+    _lock();
+    errors.swap(_errors);
+    _unlock();
+
+    for (int i=0; i<errors.size(); i++) {
+        SetErrMsg("Image Capture Error; %s", errors[i].c_str());
+    }
+    return(errors.size() ? -1 : 0);
+}
+
+// glReadPixels() returns rows bottom to top; image files expect
+// top to bottom
+//
+void ImageCaptureQueue::_flipRows(
+    unsigned char *buf, size_t width, size_t height
+) {
+    size_t rowSize = 3 * width;
+    std::vector <unsigned char> tmp(rowSize);
+
+    for (size_t j = 0; j < height/2; j++) {
+        unsigned char *top = buf + rowSize * j;
+        unsigned char *bottom = buf + rowSize * (height-j-1);
+        memcpy(tmp.data(), top, rowSize);
+        memcpy(top, bottom, rowSize);
+        memcpy(bottom, tmp.data(), rowSize);
+    }
+}
@@ -1,6 +1,8 @@
 #include "vapor/glutil.h"
 #include "vapor/LegacyGL.h"
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include "vapor/GLManager.h"
 // #include <glm/gtc/matrix_transform.hpp>
@@ -9,6 +11,10 @@
 using namespace VAPoR;
 using std::vector;
 
+// Initial size of the streaming vertex buffer, in bytes
+//
+#define STREAM_BUFFER_SIZE (1024*1024)
+
 LegacyGL::LegacyGL(GLManager *glManager)
 :
 _glManager(glManager),
@@ -24,7 +30,18 @@ _initialized(false),
 _insideBeginEndBlock(false),
 _lightingEnabled(false),
 _textureEnabled(false),
-_lightDir{0}
+_lightDir{0},
+_bufferSize(0),
+_bufferOffset(0),
+_batchMode(0),
+_batchLighting(false),
+_batchLightDir{0},
+_batchDepth(0),
+_shader(NULL),
+_uniformsSet(false),
+_shaderLighting(false),
+_shaderTexture(false),
+_shaderLightDir{0}
 {}
 
 LegacyGL::~LegacyGL()
@@ -54,6 +71,9 @@ void LegacyGL::Initialize()
     glEnableVertexAttribArray(1);
     glEnableVertexAttribArray(2);
     glEnableVertexAttribArray(3);
+    _bufferSize = STREAM_BUFFER_SIZE;
+    _bufferOffset = 0;
+    glBufferData(GL_ARRAY_BUFFER, _bufferSize, NULL, GL_STREAM_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     
@@ -80,28 +100,145 @@ void LegacyGL::End()
         Initialize();
     assert(_insideBeginEndBlock);
     
-    glBindVertexArray(_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData) * _vertices.size(), _vertices.data(), GL_STREAM_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    const glm::mat4 &P = _glManager->matrixManager->GetProjectionMatrix();
+    const glm::mat4 &MV = _glManager->matrixManager->GetModelViewMatrix();
     
-    ShaderProgram *_shader = _glManager->shaderManager->GetShader("Legacy");
-    _shader->Bind();
-    _shader->SetUniform("P", _glManager->matrixManager->GetProjectionMatrix());
-    _shader->SetUniform("MV", _glManager->matrixManager->GetModelViewMatrix());
-    _shader->SetUniform("lightingEnabled", _lightingEnabled);
-    _shader->SetUniform("textureEnabled", _textureEnabled);
-    _shader->SetUniform("lightDir", glm::make_vec3(_lightDir));
-    glDrawArrays(_mode, 0, _vertices.size());
+    // Only list primitives can be concatenated without changing their
+    // meaning. Textured blocks depend on whatever texture is bound at the
+    // time so they are never held back
+    //
+    bool mergeable = _batchDepth > 0 && !_textureEnabled && (
+        _mode == GL_POINTS || _mode == GL_LINES || _mode == GL_TRIANGLES
+    );
     
-    glBindVertexArray(0);
-    _shader->UnBind();
+    if (!_batch.empty() && (
+        !mergeable ||
+        _mode != _batchMode ||
+        P != _batchP ||
+        MV != _batchMV ||
+        _lightingEnabled != _batchLighting ||
+        (_lightingEnabled && !std::equal(_lightDir, _lightDir+3, _batchLightDir))
+    )) {
+        Flush();
+    }
+    
+    if (mergeable) {
+        if (_batch.empty()) {
+            _batchMode = _mode;
+            _batchP = P;
+            _batchMV = MV;
+            _batchLighting = _lightingEnabled;
+            std::copy(_lightDir, _lightDir+3, _batchLightDir);
+        }
+        _batch.insert(_batch.end(), _vertices.begin(), _vertices.end());
+    } else {
+        Draw(_mode, P, MV, _lightingEnabled, _textureEnabled, _lightDir, _vertices);
+    }
     
     _emulateQuads = false;
     _insideBeginEndBlock = false;
     _vertices.clear();
 }
 
+void LegacyGL::BeginBatch()
+{
+    _batchDepth++;
+}
+
+void LegacyGL::EndBatch()
+{
+    assert(_batchDepth > 0);
+    if (--_batchDepth == 0)
+        Flush();
+}
+
+void LegacyGL::Flush()
+{
+    if (_batch.empty())
+        return;
+    
+    Draw(_batchMode, _batchP, _batchMV, _batchLighting, false, _batchLightDir, _batch);
+    _batch.clear();
+}
+
+void LegacyGL::Draw(
+    unsigned int mode, const glm::mat4 &P, const glm::mat4 &MV,
+    bool lighting, bool texture, const float *lightDir,
+    const vector<VertexData> &vertices
+) {
+    if (vertices.empty())
+        return;
+    
+    size_t size = sizeof(VertexData) * vertices.size();
+    
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    
+    // Append to the ring buffer. When it is full the storage is orphaned so
+    // the driver can hand back fresh memory without waiting on draws that
+    // still read from the old contents
+    //
+    if (size > _bufferSize) {
+        while (_bufferSize < size)
+            _bufferSize *= 2;
+        glBufferData(GL_ARRAY_BUFFER, _bufferSize, NULL, GL_STREAM_DRAW);
+        _bufferOffset = 0;
+    } else if (_bufferOffset + size > _bufferSize) {
+        glBufferData(GL_ARRAY_BUFFER, _bufferSize, NULL, GL_STREAM_DRAW);
+        _bufferOffset = 0;
+    }
+    
+    void *ptr = glMapBufferRange(
+        GL_ARRAY_BUFFER, _bufferOffset, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+    );
+    if (ptr) {
+        memcpy(ptr, vertices.data(), size);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, _bufferOffset, size, vertices.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    // Uniforms are program state, so only the ones that changed since the
+    // last draw need to be sent
+    //
+    ShaderProgram *shader = _glManager->shaderManager->GetShader("Legacy");
+    if (shader != _shader) {
+        _shader = shader;
+        _uniformsSet = false;
+    }
+    
+    shader->Bind();
+    if (!_uniformsSet || P != _shaderP) {
+        shader->SetUniform("P", P);
+        _shaderP = P;
+    }
+    if (!_uniformsSet || MV != _shaderMV) {
+        shader->SetUniform("MV", MV);
+        _shaderMV = MV;
+    }
+    if (!_uniformsSet || lighting != _shaderLighting) {
+        shader->SetUniform("lightingEnabled", lighting);
+        _shaderLighting = lighting;
+    }
+    if (!_uniformsSet || texture != _shaderTexture) {
+        shader->SetUniform("textureEnabled", texture);
+        _shaderTexture = texture;
+    }
+    if (!_uniformsSet || !std::equal(lightDir, lightDir+3, _shaderLightDir)) {
+        shader->SetUniform("lightDir", glm::make_vec3(lightDir));
+        std::copy(lightDir, lightDir+3, _shaderLightDir);
+    }
+    _uniformsSet = true;
+    
+    glDrawArrays(mode, _bufferOffset / sizeof(VertexData), vertices.size());
+    _bufferOffset += size;
+    
+    glBindVertexArray(0);
+    shader->UnBind();
+}
+
 void LegacyGL::Vertex(glm::vec2 v)
 {
     Vertex2f(v.x, v.y);
@@ -222,5 +359,12 @@ void LegacyGL::LightDirectionfv(const float *f)
     _lightDir[2] = dir.z;
 }
 
+void LegacyGL::GetLightDirection(float *f) const
+{
+    f[0] = _lightDir[0];
+    f[1] = _lightDir[1];
+    f[2] = _lightDir[2];
+}
+
 void LegacyGL::EnableTexture()  { _textureEnabled = true;  }
 void LegacyGL::DisableTexture() { _textureEnabled = false; }
@@ -1,8 +1,10 @@
 #include <vapor/glutil.h>
 #include <vapor/RayCaster.h>
+#include <vapor/GLManager.h>
 #include <iostream>
-#include <fstream>
 #include <sstream>
+#include <cfloat>
+#include <algorithm>
 
 //
 // OpenGL debug output
@@ -49,6 +51,17 @@ RayCaster::RayCaster( const ParamsMgr*    pm,
     _volumeTextureId             = 0;
     _missingValueTextureId       = 0;
     _colorMapTextureId           = 0;
+    _macroCellTextureId          = 0;
+    _opacityPrefixTextureId      = 0;
+    _volumeTextureFormat         = 0;
+    _missingValueTextureFormat   = 0;
+    _macroCellTextureFormat      = 0;
+    for( int i = 0; i < 3; i++ )
+    {
+        _volumeTextureDims[i]       = 0;
+        _missingValueTextureDims[i] = 0;
+        _macroCellTextureDims[i]    = 0;
+    }
     _frameBufferId               = 0;
     _depthBufferId               = 0;
 
@@ -67,6 +80,8 @@ RayCaster::RayCaster( const ParamsMgr*    pm,
     GLint viewport[4];
     glGetIntegerv( GL_VIEWPORT, viewport );
     std::memcpy( _currentViewport, viewport, 4 * sizeof(GLint) );
+
+    _et = new Wasp::EasyThreads( 0 );
 }
 
 // Destructor
@@ -98,6 +113,16 @@ RayCaster::~RayCaster()
         glDeleteTextures( 1, &_colorMapTextureId );
         _colorMapTextureId = 0;
     }
+    if( _macroCellTextureId )
+    {
+        glDeleteTextures( 1, &_macroCellTextureId );
+        _macroCellTextureId = 0;
+    }
+    if( _opacityPrefixTextureId )
+    {
+        glDeleteTextures( 1, &_opacityPrefixTextureId );
+        _opacityPrefixTextureId = 0;
+    }
 
     // delete buffers
     if( _frameBufferId )
@@ -129,20 +154,17 @@ RayCaster::~RayCaster()
     }
 
     // delete shader programs
-    if( _1stPassShaderId )
-    {
-        glDeleteProgram( _1stPassShaderId );
-        _1stPassShaderId = 0;
-    }
-    if( _2ndPassShaderId )
+    for( size_t i = 0; i < _shaderPrograms.size(); i++ )
+        delete _shaderPrograms[i];
+    _shaderPrograms.clear();
+    _1stPassShaderId = 0;
+    _2ndPassShaderId = 0;
+    _3rdPassShaderId = 0;
+
+    if( _et )
     {
-        glDeleteProgram( _2ndPassShaderId );
-        _2ndPassShaderId = 0;
-    }
-    if( _3rdPassShaderId )
-    {
-        glDeleteProgram( _3rdPassShaderId );
-        _3rdPassShaderId = 0;
+        delete _et;
+        _et = nullptr;
     }
 }
 
@@ -157,9 +179,14 @@ RayCaster::UserCoordinates::UserCoordinates()
     bottomFace = nullptr;
     dataField  = nullptr;
     missingValueMask = nullptr;
+    quantizedField   = nullptr;
+    macroCellField   = nullptr;
+    dataBits         = 32;
+    hasMissingValue  = false;
     for( int i = 0; i < 3; i++ )
     {
         dims[i]   = 0;
+        macroDims[i] = 0;
         boxMin[i] = 0;
         boxMax[i] = 0;
     }
@@ -168,6 +195,7 @@ RayCaster::UserCoordinates::UserCoordinates()
     myVariableName     = "";
     myRefinementLevel  = -1;
     myCompressionLevel = -1;
+    myDataBits         = 32;
 }
 
 // Destructor
@@ -213,6 +241,16 @@ RayCaster::UserCoordinates::~UserCoordinates()
         delete[] missingValueMask;
         missingValueMask = nullptr;
     }
+    if( quantizedField )
+    {
+        delete[] quantizedField;
+        quantizedField = nullptr;
+    }
+    if( macroCellField )
+    {
+        delete[] macroCellField;
+        macroCellField = nullptr;
+    }
 }
 
 StructuredGrid* 
@@ -242,7 +280,8 @@ bool RayCaster::UserCoordinates::IsUpToDate( const RayCasterParams* params,
     if( ( myCurrentTimeStep  != params->GetCurrentTimestep()  )  ||
         ( myVariableName     != params->GetVariableName()     )  ||
         ( myRefinementLevel  != params->GetRefinementLevel()  )  ||
-        ( myCompressionLevel != params->GetCompressionLevel() )     )
+        ( myCompressionLevel != params->GetCompressionLevel() )  ||
+        ( myDataBits         != params->GetVolumeTextureBits() )     )
     {
         return false;
     }
@@ -273,13 +312,133 @@ bool RayCaster::UserCoordinates::IsUpToDate( const RayCasterParams* params,
     return true;
 }
         
+namespace {
+
+//
+// A slab of z planes of a grid to be converted into a volume texture 
+//   by one thread.
+//
+struct volume_conversion_state
+{
+    const StructuredGrid* grid;
+    size_t                offset;          // first vertex of this slab
+    size_t                length;          // num. of vertices of this slab
+    float                 minValue;
+    float                 valueRange1o;    // 1.0 / (max value - min value)
+    bool                  hasMissing;
+    float                 missingValue;
+    unsigned int          codeMax;         // 0 == store floats
+    float*                dataField;
+    unsigned char*        missingValueMask;
+    unsigned char*        quantizedField;
+};
+
+template <typename T>
+void quantize_slab( volume_conversion_state& s, StructuredGrid::ConstIterator& valItr )
+{
+    T*    codes = reinterpret_cast<T*>( s.quantizedField ) + s.offset;
+    float scale = float(s.codeMax - 1) * s.valueRange1o;
+    for( size_t i = 0; i < s.length; i++ )
+    {
+        float dataValue = float(*valItr);
+        if( s.hasMissing && dataValue == s.missingValue )
+            codes[ i ] = 0;
+        else
+        {
+            float code  = 1.0f + (dataValue - s.minValue) * scale + 0.5f;
+            code        = code < 1.0f ? 1.0f : code;
+            code        = code > float(s.codeMax) ? float(s.codeMax) : code;
+            codes[ i ]  = T(code);
+        }
+        ++valItr;
+    }
+}
+
+void *RunVolumeConversionThread( void* arg )
+{
+    volume_conversion_state& s = *(volume_conversion_state *) arg;
+    if( s.length == 0 )
+        return 0;
+
+    StructuredGrid::ConstIterator valItr = s.grid->cbegin();
+    valItr += (long) s.offset;
+
+    if( s.codeMax > 255 )
+        quantize_slab<unsigned short>( s, valItr );
+    else if( s.codeMax > 0 )
+        quantize_slab<unsigned char>( s, valItr );
+    else
+    {
+        float* field = s.dataField + s.offset;
+        for( size_t i = 0; i < s.length; i++ )
+        {
+            float dataValue = float(*valItr);
+            if( s.hasMissing && dataValue == s.missingValue )
+            {
+                field[ i ]                          = 0.0f;
+                s.missingValueMask[ s.offset + i ]  = 127;
+            }
+            else
+            {
+                field[ i ]                          = (dataValue - s.minValue) * s.valueRange1o;
+                if( s.hasMissing )
+                    s.missingValueMask[ s.offset + i ] = 0;
+            }
+            ++valItr;
+        }
+    }
+
+    return 0;
+}
+
+//
+// Find the range of a box of voxels [lo, hi] in field, which holds either
+//   floats with a separate missing value mask, or codes where 0 is missing.
+//
+template <typename T>
+void macro_cell_range( const T*             field,
+                       const unsigned char* mask,
+                       bool                 zeroIsMissing,
+                       size_t               dimX,
+                       size_t               planeSize,
+                       const size_t         lo[3],
+                       const size_t         hi[3],
+                       float                range[2],
+                       bool&                allMissing )
+{
+    range[0]   =  FLT_MAX;
+    range[1]   = -FLT_MAX;
+    allMissing = true;
+    for( size_t z = lo[2]; z <= hi[2]; z++ )
+        for( size_t y = lo[1]; y <= hi[1]; y++ )
+        {
+            size_t offset = z * planeSize + y * dimX;
+            for( size_t x = lo[0]; x <= hi[0]; x++ )
+            {
+                // Missing values still get interpolated by their 
+                //   neighbors, so they count towards the range.
+                float val  = float(field[ offset + x ]);
+                range[0]   = val < range[0] ? val : range[0];
+                range[1]   = val > range[1] ? val : range[1];
+                if( zeroIsMissing ? field[ offset + x ] != 0 
+                                  : ( !mask || mask[ offset + x ] == 0 ) )
+                    allMissing = false;
+            }
+        }
+}
+
+};  // End of anonymous namespace
+
 bool RayCaster::UserCoordinates::UpdateCoordinates( const RayCasterParams* params,
-                                                          DataMgr*         dataMgr )
+                                                          DataMgr*         dataMgr,
+                                                          Wasp::EasyThreads* et )
 {
     myCurrentTimeStep  = params->GetCurrentTimestep();
     myVariableName     = params->GetVariableName();
     myRefinementLevel  = params->GetRefinementLevel();
     myCompressionLevel = params->GetCompressionLevel();
+    myDataBits         = params->GetVolumeTextureBits();
+    dataBits           = myDataBits;
 
     /* update member variables */
     StructuredGrid*       grid = this->GetCurrentGrid( params, dataMgr );
@@ -382,63 +541,139 @@ bool RayCaster::UserCoordinates::UpdateCoordinates( const RayCasterParams* param
             bottomFace[ idx++  ] = (float)buf[2];
         }
 
-    // Save the data field values and missing values
+    // Save the data field values and missing values. 
+    //   Quantized volumes fold missing values into code 0 instead of a mask.
     size_t numOfVertices = dims[0] * dims[1] * dims[2];
     if( dataField )
-        delete[] dataField;
-    dataField = new float[ numOfVertices ];
-    if( !dataField )
     {
-        delete grid;
-        return false;
+        delete[] dataField;
+        dataField = nullptr;
     }
     if( missingValueMask )
     {
         delete[] missingValueMask;
         missingValueMask = nullptr;
     }
-    StructuredGrid::ConstIterator valItr = grid->cbegin();          // Iterator for data field values
-    float valueRange1o                   = 1.0f / (valueRange[1] - valueRange[0]);
+    if( quantizedField )
+    {
+        delete[] quantizedField;
+        quantizedField = nullptr;
+    }
 
-    if( grid->HasMissingData() )
+    if( dataBits == 32 )
     {
-        float missingValue = grid->GetMissingValue();
-        missingValueMask   = new unsigned char[ numOfVertices ];
-        if( !missingValueMask )
-        {
-            delete grid;
-            return false;
-        }
-        float dataValue;
-        for( size_t i = 0; i < numOfVertices; i++ )
-        {
-            dataValue       = float(*valItr);
-            if( dataValue == missingValue )
-            {
-                dataField[ i ]        = 0.0f;
-                missingValueMask[ i ] = 127;
-            }
-            else
-            {
-                dataField[ i ]        = (dataValue - valueRange[0]) * valueRange1o;
-                missingValueMask[ i ] = 0;
-            }
-            ++valItr;
-        }
+        dataField = new float[ numOfVertices ];
+        if( grid->HasMissingData() )
+            missingValueMask = new unsigned char[ numOfVertices ];
     }
-    else    // No missing value!
+    else
+        quantizedField = new unsigned char[ numOfVertices * (dataBits / 8) ];
+
+    // Convert the grid in parallel, one slab of z planes per thread
+    volume_conversion_state state;
+    state.grid             = grid;
+    state.minValue         = valueRange[0];
+    state.valueRange1o     = 1.0f / (valueRange[1] - valueRange[0]);
+    hasMissingValue        = grid->HasMissingData();
+    state.hasMissing       = hasMissingValue;
+    state.missingValue     = grid->GetMissingValue();
+    state.codeMax          = CodeMax();
+    state.dataField        = dataField;
+    state.missingValueMask = missingValueMask;
+    state.quantizedField   = quantizedField;
+    if( state.codeMax > 0 && valueRange[1] <= valueRange[0] )
+        state.valueRange1o = 0.0f;          // constant field, every value gets code 1
+
+    int nslabs   = (int)dims[2];
+    int nthreads = et ? et->GetNumThreads() : 1;
+    if( nthreads < 1 || nslabs < nthreads )
+        nthreads = 1;
+    size_t planeSize = dims[0] * dims[1];
+
+    std::vector<volume_conversion_state> states( nthreads, state );
+    std::vector<void*>                   argvec;
+    for( int i = 0; i < nthreads; i++ )
     {
-        for( size_t i = 0; i < numOfVertices; i++ )
-        {
-            dataField[ i ] = (float(*valItr) - valueRange[0]) * valueRange1o;
-            ++valItr;
-        }
+        int offset, length;
+        Wasp::EasyThreads::Decompose( nslabs, nthreads, i, &offset, &length );
+        states[i].offset = planeSize * offset;
+        states[i].length = planeSize * length;
+        argvec.push_back( (void*) &states[i] );
     }
+    if( nthreads == 1 )
+        RunVolumeConversionThread( &states[0] );
+    else if( et->ParRun( RunVolumeConversionThread, argvec ) < 0 )
+    {
+        delete grid;
+        return false;
+    }
+
+    UpdateMacroCells();
 
     delete grid;
     return true;
 }
 
+void RayCaster::UserCoordinates::UpdateMacroCells()
+{
+    for( int i = 0; i < 3; i++ )
+        macroDims[i] = (dims[i] + MacroCellSize - 1) / MacroCellSize;
+    size_t numOfCells = macroDims[0] * macroDims[1] * macroDims[2];
+
+    if( macroCellField )
+        delete[] macroCellField;
+    macroCellField = new float[ numOfCells * 2 ];
+
+    size_t planeSize = dims[0] * dims[1];
+    float  codeMax1o = dataBits == 32 ? 1.0f : 1.0f / float(CodeMax() - 1);
+    size_t idx       = 0;
+    size_t lo[3], hi[3];
+    for( size_t cz = 0; cz < macroDims[2]; cz++ )
+    {
+        // Voxels [lo, hi] along each axis contribute to this macro cell 
+        lo[2] = cz * MacroCellSize > 0 ? cz * MacroCellSize - 1 : 0;
+        hi[2] = std::min( (cz + 1) * MacroCellSize, dims[2] - 1 );
+        for( size_t cy = 0; cy < macroDims[1]; cy++ )
+        {
+            lo[1] = cy * MacroCellSize > 0 ? cy * MacroCellSize - 1 : 0;
+            hi[1] = std::min( (cy + 1) * MacroCellSize, dims[1] - 1 );
+            for( size_t cx = 0; cx < macroDims[0]; cx++ )
+            {
+                lo[0] = cx * MacroCellSize > 0 ? cx * MacroCellSize - 1 : 0;
+                hi[0] = std::min( (cx + 1) * MacroCellSize, dims[0] - 1 );
+
+                float range[2];
+                bool  allMissing;
+                if( dataBits == 32 )
+                    macro_cell_range( dataField, missingValueMask, false, 
+                                      dims[0], planeSize, lo, hi, range, allMissing );
+                else 
+                {
+                    if( dataBits == 16 )
+                        macro_cell_range( reinterpret_cast<unsigned short*>( quantizedField ),
+                                          nullptr, true, dims[0], planeSize, 
+                                          lo, hi, range, allMissing );
+                    else
+                        macro_cell_range( quantizedField, nullptr, true, 
+                                          dims[0], planeSize, lo, hi, range, allMissing );
+
+                    // Decode to normalized values, as the shaders do
+                    range[0] = (range[0] - 1.0f) * codeMax1o;
+                    range[1] = (range[1] - 1.0f) * codeMax1o;
+                }
+
+                if( allMissing )
+                {
+                    range[0] = 1.0f;
+                    range[1] = 0.0f;
+                }
+                macroCellField[ idx++ ] = range[0];
+                macroCellField[ idx++ ] = range[1];
+            }
+        }
+    }
+}
+
 int RayCaster::_initializeGL()
 {
 #ifdef Darwin
@@ -506,28 +741,10 @@ int RayCaster::_paintGL( bool fast )
     /* Gather user coordinates */
     if( !_userCoordinates.IsUpToDate( params, _dataMgr ) )
     {
-        _userCoordinates.UpdateCoordinates( params, _dataMgr );
+        _userCoordinates.UpdateCoordinates( params, _dataMgr, _et );
 
         /* Also attach the new data to 3D textures */
-        glBindTexture( GL_TEXTURE_3D, _volumeTextureId );
-        glTexImage3D(  GL_TEXTURE_3D, 0, GL_R32F,    _userCoordinates.dims[0], 
-                       _userCoordinates.dims[1],     _userCoordinates.dims[2], 
-                       0, GL_RED, GL_FLOAT,          _userCoordinates.dataField );
-
-        // If there is missing value, upload the mask to texture. Otherwise, leave it empty.
-        if( _userCoordinates.missingValueMask )     // Has missing value!
-        {
-            // Adjust alignment for GL_R8UI format. Stupid OpenGL parameter.
-            glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
-            glBindTexture( GL_TEXTURE_3D, _missingValueTextureId );
-            glTexImage3D(  GL_TEXTURE_3D, 0, GL_R8UI,   _userCoordinates.dims[0],
-                           _userCoordinates.dims[1],    _userCoordinates.dims[2],
-                           0,                           GL_RED_INTEGER,
-                           GL_UNSIGNED_BYTE,            _userCoordinates.missingValueMask );
-            glPixelStorei( GL_UNPACK_ALIGNMENT, 4 ); // Restore default alignment.
-        }
-
-        glBindTexture( GL_TEXTURE_3D, 0 );
+        _updateVolumeTextures();
     }
 
     /* Gather the color map */
@@ -554,6 +771,17 @@ int RayCaster::_paintGL( bool fast )
     glBindTexture( GL_TEXTURE_1D, _colorMapTextureId );
     glTexImage1D(  GL_TEXTURE_1D, 0, GL_RGBA32F,     _colorMap.size()/4,
                    0, GL_RGBA,       GL_FLOAT,       _colorMap.data() );
+
+    // Running sum of opacities of the color map, so that shaders can tell 
+    //   whether a whole value range maps to fully transparent colors.
+    size_t numOfColors = _colorMap.size() / 4;
+    _opacityPrefixSum.resize( numOfColors + 1 );
+    _opacityPrefixSum[0] = 0.0f;
+    for( size_t i = 0; i < numOfColors; i++ )
+        _opacityPrefixSum[ i + 1 ] = _opacityPrefixSum[ i ] + _colorMap[ i * 4 + 3 ];
+    glBindTexture( GL_TEXTURE_1D, _opacityPrefixTextureId );
+    glTexImage1D(  GL_TEXTURE_1D, 0, GL_R32F,        _opacityPrefixSum.size(),
+                   0, GL_RED,        GL_FLOAT,       _opacityPrefixSum.data() );
     glBindTexture( GL_TEXTURE_1D, 0 );
 
     glBindFramebuffer( GL_FRAMEBUFFER, _frameBufferId );
@@ -618,6 +846,81 @@ int RayCaster::_paintGL( bool fast )
     return 0;
 }
 
+namespace {
+
+//
+// Upload a 3D texture. The texture storage is reused when its format and 
+//   dimensions are unchanged, and reallocated otherwise.
+//
+void uploadTexture3D( GLuint        textureId,
+                      GLint         internalFormat,
+                      GLenum        format,
+                      GLenum        type,
+                      const size_t  dims[3],
+                      const void*   data,
+                      GLint&        currentFormat,
+                      size_t        currentDims[3] )
+{
+    glBindTexture( GL_TEXTURE_3D, textureId );
+    if( currentFormat  == internalFormat &&
+        currentDims[0] == dims[0]        &&
+        currentDims[1] == dims[1]        &&
+        currentDims[2] == dims[2] )
+    {
+        glTexSubImage3D( GL_TEXTURE_3D, 0, 0, 0, 0, dims[0], dims[1], dims[2], 
+                         format, type, data );
+    }
+    else
+    {
+        glTexImage3D( GL_TEXTURE_3D, 0, internalFormat, dims[0], dims[1], dims[2], 
+                      0, format, type, data );
+        currentFormat = internalFormat;
+        std::memcpy( currentDims, dims, 3 * sizeof(size_t) );
+    }
+}
+
+};  // End of anonymous namespace
+
+void RayCaster::_updateVolumeTextures()
+{
+    // 8- and 16-bit rows are not always 4-byte aligned
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    if( _userCoordinates.dataBits == 16 )
+        uploadTexture3D( _volumeTextureId,            GL_R16,     GL_RED,
+                         GL_UNSIGNED_SHORT,           _userCoordinates.dims, 
+                         _userCoordinates.quantizedField,
+                         _volumeTextureFormat,        _volumeTextureDims );
+    else if( _userCoordinates.dataBits == 8 )
+        uploadTexture3D( _volumeTextureId,            GL_R8,      GL_RED,
+                         GL_UNSIGNED_BYTE,            _userCoordinates.dims, 
+                         _userCoordinates.quantizedField,
+                         _volumeTextureFormat,        _volumeTextureDims );
+    else
+        uploadTexture3D( _volumeTextureId,            GL_R32F,    GL_RED,
+                         GL_FLOAT,                    _userCoordinates.dims, 
+                         _userCoordinates.dataField,
+                         _volumeTextureFormat,        _volumeTextureDims );
+
+    // If there is missing value, upload the mask to texture. Otherwise, leave it empty.
+    //   Quantized volumes carry missing values in the volume texture itself.
+    if( _userCoordinates.missingValueMask )     // Has missing value!
+        uploadTexture3D( _missingValueTextureId,      GL_R8UI,    GL_RED_INTEGER,
+                         GL_UNSIGNED_BYTE,            _userCoordinates.dims,
+                         _userCoordinates.missingValueMask,
+                         _missingValueTextureFormat,  _missingValueTextureDims );
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 ); // Restore default alignment.
+
+    // Min and max values of each macro cell, used to skip empty space.
+    uploadTexture3D( _macroCellTextureId,             GL_RG32F,   GL_RG,
+                     GL_FLOAT,                        _userCoordinates.macroDims,
+                     _userCoordinates.macroCellField,
+                     _macroCellTextureFormat,         _macroCellTextureDims );
+
+    glBindTexture( GL_TEXTURE_3D, 0 );
+}
+
 void RayCaster::_initializeFramebufferTextures()
 {
     /* Create an Frame Buffer Object for the back side of the volume. */
@@ -711,6 +1014,30 @@ void RayCaster::_initializeFramebufferTextures()
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
+    /* Generate and configure 3D texture: _macroCellTextureId */
+    textureUnit =  5;
+    glGenTextures( 1, &_macroCellTextureId );
+    glActiveTexture( GL_TEXTURE0 + textureUnit );
+    glBindTexture( GL_TEXTURE_3D, _macroCellTextureId );
+
+    /* Configure _macroCellTextureId */
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    /* Generate and configure 1D texture: _opacityPrefixTextureId */
+    textureUnit =  6;
+    glGenTextures( 1, &_opacityPrefixTextureId );
+    glActiveTexture( GL_TEXTURE0 + textureUnit );
+    glBindTexture( GL_TEXTURE_1D, _opacityPrefixTextureId );
+
+    /* Configure _opacityPrefixTextureId */
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+
     /* Bind the default textures */
     glBindTexture(GL_TEXTURE_1D, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -879,11 +1206,17 @@ void RayCaster::_load3rdPassUniforms( const GLfloat*   MVP,
     uniformLocation = glGetUniformLocation( _3rdPassShaderId, "colorMapTexture" );
     glUniform1i( uniformLocation, textureUnit );
 
+    uniformLocation = glGetUniformLocation( _3rdPassShaderId, "volumeCodeMax" );
+    glUniform1i( uniformLocation, (GLint)_userCoordinates.CodeMax() );
+
     uniformLocation = glGetUniformLocation( _3rdPassShaderId, "hasMissingValue" );
     // If there is missing value, pass in missingValueMaskTexture as well.
-    //   Otherwise, leave it empty.
-    if( _userCoordinates.missingValueMask == nullptr )
+    //   Otherwise, leave it empty. Quantized volumes mark missing values
+    //   with code 0 in the volume texture instead.
+    if( !_userCoordinates.hasMissingValue )
         glUniform1i( uniformLocation, 0 );      // Set to false
+    else if( _userCoordinates.missingValueMask == nullptr )
+        glUniform1i( uniformLocation, 1 );      // Set to true
     else
     {
         glUniform1i( uniformLocation, 1 );      // Set to true
@@ -893,6 +1226,22 @@ void RayCaster::_load3rdPassUniforms( const GLfloat*   MVP,
         uniformLocation = glGetUniformLocation( _3rdPassShaderId, "missingValueMaskTexture" );
         glUniform1i( uniformLocation, textureUnit );
     }
+
+    // Textures used for empty space skipping
+    textureUnit = 5;
+    glActiveTexture( GL_TEXTURE0 + textureUnit );
+    glBindTexture( GL_TEXTURE_3D, _macroCellTextureId );
+    uniformLocation = glGetUniformLocation( _3rdPassShaderId, "macroCellTexture" );
+    glUniform1i( uniformLocation, textureUnit );
+
+    textureUnit = 6;
+    glActiveTexture( GL_TEXTURE0 + textureUnit );
+    glBindTexture( GL_TEXTURE_1D, _opacityPrefixTextureId );
+    uniformLocation = glGetUniformLocation( _3rdPassShaderId, "opacityPrefixTexture" );
+    glUniform1i( uniformLocation, textureUnit );
+
+    uniformLocation = glGetUniformLocation( _3rdPassShaderId, "macroCellSize" );
+    glUniform1f( uniformLocation, float(UserCoordinates::MacroCellSize) );
 }
     
 void RayCaster::_3rdPassSpecialHandling( bool fast )
@@ -1025,90 +1374,16 @@ void RayCaster::_renderTriangleStrips() const
 GLuint RayCaster::_compileShaders(const char* vertex_file_path, 
                                   const char* fragment_file_path)
 {
-    // Create the shaders
-    GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-    GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Read the Vertex Shader code from the file
-    std::string VertexShaderCode;
-    std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-    if(VertexShaderStream.is_open()){
-        std::stringstream sstr;
-        sstr << VertexShaderStream.rdbuf();
-        VertexShaderCode = sstr.str();
-        VertexShaderStream.close();
-    }else{
-        printf("Impossible to open %s. Are you in the right directory ?\n", vertex_file_path);
-        getchar();
-        return 0;
-    }
-
-    // Read the Fragment Shader code from the file
-    std::string FragmentShaderCode;
-    std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-    if(FragmentShaderStream.is_open()){
-        std::stringstream sstr;
-        sstr << FragmentShaderStream.rdbuf();
-        FragmentShaderCode = sstr.str();
-        FragmentShaderStream.close();
-    }
-
-    GLint Result = GL_FALSE;
-    int InfoLogLength;
-
-    // Compile Vertex Shader
-    printf("Compiling shader : %s\n", vertex_file_path);
-    char const * VertexSourcePointer = VertexShaderCode.c_str();
-    glShaderSource(VertexShaderID, 1, &VertexSourcePointer , nullptr);
-    glCompileShader(VertexShaderID);
-
-    // Check Vertex Shader
-    glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(VertexShaderID, InfoLogLength, nullptr, &VertexShaderErrorMessage[0]);
-        printf("%s\n", &VertexShaderErrorMessage[0]);
-    }
-
-    // Compile Fragment Shader
-    printf("Compiling shader : %s\n", fragment_file_path);
-    char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-    glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , nullptr);
-    glCompileShader(FragmentShaderID);
-
-    // Check Fragment Shader
-    glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(FragmentShaderID, InfoLogLength, nullptr, &FragmentShaderErrorMessage[0]);
-        printf("%s\n", &FragmentShaderErrorMessage[0]);
-    }
+    std::vector<std::string> paths;
+    paths.push_back( vertex_file_path );
+    paths.push_back( fragment_file_path );
 
-    // Link the program
-    printf("Linking program\n");
-    GLuint ProgramID = glCreateProgram();
-    glAttachShader(ProgramID, VertexShaderID);
-    glAttachShader(ProgramID, FragmentShaderID);
-    glLinkProgram(ProgramID);
-
-    // Check the program
-    glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-    glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> ProgramErrorMessage(InfoLogLength+1);
-        glGetProgramInfoLog(ProgramID, InfoLogLength, nullptr, &ProgramErrorMessage[0]);
-        printf("%s\n", &ProgramErrorMessage[0]);
-    }
-    
-    glDetachShader(ProgramID, VertexShaderID);
-    glDetachShader(ProgramID, FragmentShaderID);
-    
-    glDeleteShader(VertexShaderID);
-    glDeleteShader(FragmentShaderID);
+    ShaderProgram* program = _glManager->shaderManager->CompileNewProgramFromFiles( paths );
+    if( program == nullptr )
+        return 0;
 
-    return ProgramID;
+    _shaderPrograms.push_back( program );
+    return program->GetID();
 }
     
 void RayCaster::_getMVPMatrix( GLfloat* MVP ) const
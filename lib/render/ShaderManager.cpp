@@ -1,6 +1,17 @@
 #include "vapor/glutil.h"
 #include "vapor/ShaderManager.h"
 #include "vapor/FileUtils.h"
+#include <cstdio>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <iomanip>
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 
 using namespace VAPoR;
 
@@ -40,6 +51,102 @@ bool ShaderManager::_wasFileModified(const std::string &path) const
     return false;
 }
 
+// Magic number at the start of program binary cache files
+//
+static const char BinaryCacheMagic[4] = {'V', 'P', 'G', 'B'};
+
+std::string ShaderManager::_getBinaryCachePath(const std::string &name, const std::vector<std::string> &paths) const
+{
+    if (_binaryCacheDirectory.empty() || !ShaderProgram::IsBinarySupported())
+        return "";
+    
+    vector<string> keys;
+    for (auto it = paths.begin(); it != paths.end(); ++it)
+        keys.push_back(ReadShaderSource(*it));
+    const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (int i = 0; i < 3; i++) {
+        const char *str = (const char *)glGetString(strings[i]);
+        keys.push_back(str ? str : "");
+    }
+    
+    // 64 bit FNV-1a. Each key is followed by a separator so that
+    // moving text between files changes the hash
+    //
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        for (size_t i = 0; i < it->length(); i++) {
+            hash ^= (unsigned char)(*it)[i];
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    }
+    
+    std::ostringstream ss;
+    ss << _binaryCacheDirectory << PATH_SEPARATOR << name << "-";
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+    return ss.str();
+}
+
+ShaderProgram *ShaderManager::_loadCachedProgram(const std::string &path) const
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return nullptr;
+    
+    char magic[4];
+    uint32_t format, size;
+    vector<char> data;
+    bool ok =
+        fread(magic, sizeof(magic), 1, f) == 1 &&
+        std::equal(magic, magic+4, BinaryCacheMagic) &&
+        fread(&format, sizeof(format), 1, f) == 1 &&
+        fread(&size, sizeof(size), 1, f) == 1;
+    if (ok) {
+        data.resize(size);
+        ok = size > 0 && fread(data.data(), size, 1, f) == 1;
+    }
+    fclose(f);
+    if (!ok)
+        return nullptr;
+    
+    ShaderProgram *program = new ShaderProgram;
+    if (program->LoadBinary(format, data.data(), data.size()) < 0) {
+        delete program;
+        return nullptr;
+    }
+    return program;
+}
+
+void ShaderManager::_saveCachedProgram(const std::string &path, const ShaderProgram *program) const
+{
+    unsigned int format;
+    vector<char> data;
+    if (program->GetBinary(&format, &data) < 0)
+        return;
+    
+    // Several processes may share a cache directory, so write to a private
+    // file and move it into place
+    //
+    std::ostringstream tmpPath;
+    tmpPath << path << "." << getpid() << ".tmp";
+    
+    FILE *f = fopen(tmpPath.str().c_str(), "wb");
+    if (!f)
+        return;
+    uint32_t format32 = format;
+    uint32_t size = data.size();
+    bool ok =
+        fwrite(BinaryCacheMagic, sizeof(BinaryCacheMagic), 1, f) == 1 &&
+        fwrite(&format32, sizeof(format32), 1, f) == 1 &&
+        fwrite(&size, sizeof(size), 1, f) == 1 &&
+        fwrite(data.data(), size, 1, f) == 1;
+    ok = fclose(f) == 0 && ok;
+    
+    if (!ok || rename(tmpPath.str().c_str(), path.c_str()) != 0)
+        remove(tmpPath.str().c_str());
+}
+
 ShaderProgram *ShaderManager::GetShader(const std::string &name)
 {
 #if SHADER_AUTORELOAD
@@ -63,28 +170,132 @@ SmartShaderProgram ShaderManager::GetSmartShader(const std::string &name)
     return SmartShaderProgram(GetShader(name));
 }
 
+ShaderProgram *ShaderManager::_buildProgram(const std::string &name, const std::vector<std::string> &paths) const
+{
+    const string cachePath = _getBinaryCachePath(name, paths);
+    
+    ShaderProgram *program = nullptr;
+    if (!cachePath.empty())
+        program = _loadCachedProgram(cachePath);
+    if (program)
+        return program;
+    
+    program = new ShaderProgram;
+    for (auto it = paths.begin(); it != paths.end(); ++it)
+        program->AddShader(CompileNewShaderFromFile(*it));
+    program->Link();
+    if (!program->WasLinkingSuccessful()) {
+        SetErrMsg("Failed to link shader:\n%s", program->GetLog().c_str());
+        delete program;
+        return nullptr;
+    }
+    if (!cachePath.empty())
+        _saveCachedProgram(cachePath, program);
+    return program;
+}
+
 int ShaderManager::LoadResourceByKey(const std::string &name)
 {
     if (HasResource(name)) {
         assert(!"Shader already loaded");
         return -1;
     }
-    ShaderProgram *program = new ShaderProgram;
     const vector<string> paths = _getSourceFilePaths(name);
-    for (auto it = paths.begin(); it != paths.end(); ++it) {
-        program->AddShader(CompileNewShaderFromFile(*it));
+    for (auto it = paths.begin(); it != paths.end(); ++it)
         _modifiedTimes[*it] = FileUtils::GetFileModifiedTime(*it);
+    
+    ShaderProgram *program = _buildProgram(name, paths);
+    if (!program)
+        return -1;
+    AddResource(name, program);
+    return 1;
+}
+
+ShaderProgram *ShaderManager::CompileNewProgramFromFiles(const std::vector<std::string> &paths) const
+{
+    if (paths.empty()) {
+        SetErrMsg("No shader source files");
+        return nullptr;
     }
-    program->Link();
-    if (!program->WasLinkingSuccessful()) {
-        SetErrMsg("Failed to link shader:\n%s", program->GetLog().c_str());
-        delete program;
+    
+    // Cache entries are named after the first source file
+    //
+    string name = FileUtils::Basename(paths[0]);
+    name = name.substr(0, name.find_last_of('.'));
+    
+    return _buildProgram(name, paths);
+}
+
+std::string ShaderManager::ReadShaderSource(const std::string &path)
+{
+    const string source = FileUtils::ReadFileToString(path);
+    const size_t slash = path.find_last_of("/\\");
+    const string dir = slash == string::npos ? "." : path.substr(0, slash);
+    
+    std::istringstream in(source);
+    std::ostringstream out;
+    string line;
+    while (std::getline(in, line)) {
+        std::istringstream words(line);
+        string directive, name;
+        words >> directive >> name;
+        if (directive != "#include" || name.empty()) {
+            out << line << "\n";
+            continue;
+        }
+        if (name.length() > 2 && (name[0] == '"' || name[0] == '<'))
+            name = name.substr(1, name.length()-2);
+        
+        // Includes are not nested, so there is no need to guard
+        // against recursion. A missing file is left for the GLSL
+        // compiler to report
+        //
+        const string candidates[] = {
+            dir + PATH_SEPARATOR + "includes" + PATH_SEPARATOR + name,
+            dir + PATH_SEPARATOR + ".." + PATH_SEPARATOR + "includes" + PATH_SEPARATOR + name
+        };
+        bool found = false;
+        for (int i = 0; i < 2 && !found; i++) {
+            if (FileUtils::IsRegularFile(candidates[i])) {
+                out << FileUtils::ReadFileToString(candidates[i]) << "\n";
+                found = true;
+            }
+        }
+        if (!found)
+            out << line << "\n";
+    }
+    return out.str();
+}
+
+int ShaderManager::SetBinaryCacheDirectory(const std::string &path)
+{
+    if (!path.empty() && !FileUtils::IsDirectory(path)) {
+        SetErrMsg("Shader cache directory \"%s\" does not exist", path.c_str());
         return -1;
     }
-    AddResource(name, program);
+    _binaryCacheDirectory = path;
     return 1;
 }
 
+int ShaderManager::PrecompileShaders()
+{
+    int rc = 1;
+    const vector<string> files = FileUtils::ListDirectory(_resourceDirectory);
+    for (auto it = files.begin(); it != files.end(); ++it) {
+        if (it->length() <= 5 || it->substr(it->length()-5) != ".vert")
+            continue;
+        
+        const string name = it->substr(0, it->length()-5);
+        const string fragPath = _resourceDirectory + PATH_SEPARATOR + name + ".frag";
+        if (HasResource(name) || !FileUtils::IsRegularFile(fragPath))
+            continue;
+        
+        if (!GetResource(name))
+            rc = -1;
+    }
+    return rc;
+}
+
 Shader *ShaderManager::CompileNewShaderFromFile(const std::string &path)
 {
     unsigned int shaderType = GetShaderTypeFromPath(path);
@@ -97,7 +308,7 @@ Shader *ShaderManager::CompileNewShaderFromFile(const std::string &path)
         return nullptr;
     }
     Shader *shader = new Shader(shaderType);
-    int compilationSuccess = shader->CompileFromSource(FileUtils::ReadFileToString(path));
+    int compilationSuccess = shader->CompileFromSource(ReadShaderSource(path));
     if (compilationSuccess < 0) {
         SetErrMsg("Shader \"%s\" failed to compile", FileUtils::Basename(path).c_str());
         delete shader;
@@ -112,5 +323,7 @@ unsigned int ShaderManager::GetShaderTypeFromPath(const std::string &path)
     if (ext == "vert") return GL_VERTEX_SHADER;
     if (ext == "frag") return GL_FRAGMENT_SHADER;
     if (ext == "geom") return GL_GEOMETRY_SHADER;
+    if (ext == ".vgl") return GL_VERTEX_SHADER;
+    if (ext == ".fgl") return GL_FRAGMENT_SHADER;
     return GL_INVALID_ENUM;
 }
@@ -10,7 +10,7 @@ using namespace VAPoR;
 ShaderProgram::Policy ShaderProgram::UniformNotFoundPolicy = ShaderProgram::Policy::Relaxed;
 
 ShaderProgram::ShaderProgram()
-: _linked(false), _successStatus(false) {}
+: _id(0), _linked(false), _successStatus(false) {}
 
 ShaderProgram::~ShaderProgram()
 {
@@ -34,6 +34,8 @@ int ShaderProgram::Link()
         }
         glAttachShader(_id, (*it)->GetID());
     }
+    if (IsBinarySupported())
+        glProgramParameteri(_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(_id);
     glGetProgramiv(_id, GL_LINK_STATUS, &_successStatus);
     _linked = true;
@@ -88,6 +90,52 @@ int ShaderProgram::AddShaderFromSource(unsigned int type, const char *source)
     return ret;
 }
 
+int ShaderProgram::LoadBinary(unsigned int format, const void *data, size_t size)
+{
+    if (_linked) {
+        SetErrMsg("Program already linked");
+        return -1;
+    }
+    _id = glCreateProgram();
+    assert(_id);
+    glProgramBinary(_id, format, data, size);
+    glGetProgramiv(_id, GL_LINK_STATUS, &_successStatus);
+    if (!_successStatus) {
+        glDeleteProgram(_id);
+        _id = 0;
+        return -1;
+    }
+    _linked = true;
+    return 1;
+}
+
+int ShaderProgram::GetBinary(unsigned int *format, std::vector<char> *data) const
+{
+    if (!_linked || !_successStatus || !IsBinarySupported())
+        return -1;
+    
+    int length = 0;
+    glGetProgramiv(_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return -1;
+    
+    data->resize(length);
+    GLenum binaryFormat;
+    glGetProgramBinary(_id, length, &length, &binaryFormat, data->data());
+    data->resize(length);
+    *format = binaryFormat;
+    return length > 0 ? 1 : -1;
+}
+
+bool ShaderProgram::IsBinarySupported()
+{
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return false;
+    int nFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+    return nFormats > 0;
+}
+
 /*
 bool ShaderProgram::AddShaderFromFile(unsigned int type, const std::string path)
 {
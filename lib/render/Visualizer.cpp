@@ -23,6 +23,7 @@
 #include <vector>
 #include <cmath>
 #include <cassert>
+#include <cstring>
 #ifdef WIN32
 #include <tiff/tiffio.h>
 #else
@@ -47,8 +48,6 @@
 #include "vapor/GLManager.h"
 #include "vapor/LegacyGL.h"
 
-#include "imagewriter.hpp"
-
 
 using namespace VAPoR;
 bool Visualizer::_regionShareFlag = true;
@@ -58,6 +57,19 @@ bool Visualizer::_regionShareFlag = true;
  */
 GLenum attach_points[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7, GL_COLOR_ATTACHMENT8, GL_COLOR_ATTACHMENT9, GL_COLOR_ATTACHMENT10, GL_COLOR_ATTACHMENT11, GL_COLOR_ATTACHMENT12, GL_COLOR_ATTACHMENT13, GL_COLOR_ATTACHMENT14, GL_COLOR_ATTACHMENT15};
 
+namespace {
+
+// Offscreen contexts (e.g. OSMesa) are usually single buffered, in which
+// case the rendered image is in the front buffer
+//
+GLenum colorReadBuffer() {
+	GLboolean doubleBuffered = GL_TRUE;
+	glGetBooleanv(GL_DOUBLEBUFFER, &doubleBuffered);
+	return(doubleBuffered ? GL_BACK : GL_FRONT);
+}
+
+};
+
 Visualizer::Visualizer(
 	const ParamsMgr *pm, const DataStatus *dataStatus, string winName
 ) {
@@ -75,6 +87,10 @@ Visualizer::Visualizer(
 
 	_imageCaptureEnabled = false;
 	_animationCaptureEnabled = false;
+	_captureQueue = NULL;
+	_asyncCaptureReadback = false;
+	_capturePBO[0] = _capturePBO[1] = 0;
+	_capturePBOIndex = 0;
 	
 	
 	_renderOrder.clear();
@@ -102,6 +118,11 @@ Visualizer::~Visualizer()
 #ifdef	VAPOR3_0_0_ALPHA
 	_manipHolder.clear();
 #endif
+
+	// Blocks until all queued frames are written
+	//
+	if (_captureQueue) delete _captureQueue;
+	if (_capturePBO[0]) glDeleteBuffers(2, _capturePBO);
 	
 }
 
@@ -303,6 +324,13 @@ int Visualizer::paintEvent(bool fast)
 		captureImage(_captureImageFile);
 		incrementPath(_captureImageFile);
 	}
+	else
+	{
+		// Write the final frame of an asynchronously read animation
+		//
+		flushPendingCapture(_capturePBOIndex);
+		flushPendingCapture(1 - _capturePBOIndex);
+	}
     GL_ERR_BREAK();
     if(printOpenGLError())
         return -1;
@@ -773,89 +801,102 @@ int Visualizer:: captureImage(string filename)
 
 	//Turn off the single capture flag
 	_imageCaptureEnabled = false;
-	string suffix = filename.substr(filename.length()-4, 4);  // it assumes fixed length of all suffix...   
-	
-	FILE* jpegFile = NULL;
-	TIFF* tiffFile = NULL;
-	if (suffix == ".tif" || suffix == "tiff" )
-    {
-		tiffFile = TIFFOpen((const char*)filename.c_str(), "wb");
-		if (!tiffFile) {
-			SetErrMsg("Image Capture Error: Error opening output Tiff file: %s",(const char*)filename.c_str());
-			return -1;
-		}
-	} 
-    else if (suffix == ".jpg" || suffix == "jpeg" ) 
-    {
-		jpegFile = fopen((const char*)filename.c_str(), "wb");
-		if (!jpegFile) {
-			SetErrMsg("Image Capture Error: Error opening output Jpeg file: %s",(const char*)filename.c_str());
-			return -1;
-		}
+
+	if (_asyncCaptureReadback && _animationCaptureEnabled) {
+		return(readPixelsAsync(filename, width, height));
 	}
-    else // write png files
-    {
-         // The Write_PNG() function handles fopen et al. by itself.
-         // Here we assume the filename is absolutely valid.
-    }
-	//Get the image buffer 
-	unsigned char* buf = new unsigned char[3*width*height];
+
+	//Get a recycled image buffer from the encoder queue
+	unsigned char* buf = captureQueue()->GetBuffer(3*width*height);
 	//Use openGL to fill the buffer:
 	if(!getPixelData(buf)) {
 		SetErrMsg("Image Capture Error; error obtaining GL data");
-		delete [] buf;
+		captureQueue()->ReleaseBuffer(buf);
 		return -1;
 	}
 	
-	//Now call the Jpeg or tiff library to compress and write the file
+	//Hand the buffer to the encoder threads to compress and write the
+	//file. A single image capture must be on disk when we return.
 	//
-    if( suffix == ".tif" || suffix == "tiff" ) //capture the tiff file, one scanline at a time
-    { 
-		uint32 imagelength = (uint32) width;
-		uint32 imagewidth = (uint32) height;
-		assert(tiffFile);
-		TIFFSetField(tiffFile, TIFFTAG_IMAGELENGTH, imagelength);
-		TIFFSetField(tiffFile, TIFFTAG_IMAGEWIDTH, imagewidth);
-		TIFFSetField(tiffFile, TIFFTAG_PLANARCONFIG, 1);
-		TIFFSetField(tiffFile, TIFFTAG_SAMPLESPERPIXEL, 3);
-		TIFFSetField(tiffFile, TIFFTAG_ROWSPERSTRIP, 8);
-		TIFFSetField(tiffFile, TIFFTAG_BITSPERSAMPLE, 8);
-		TIFFSetField(tiffFile, TIFFTAG_PHOTOMETRIC, 2);
-		for (int row = 0; row < imagelength; row++){
-			int rc = TIFFWriteScanline(tiffFile, buf+row*3*imagewidth, row);
-			if (rc != 1){
-				SetErrMsg("Image Capture Error; Error writing tiff file %s",
-				(const char*)filename.c_str());
-				break;
-			}
-		}
-		TIFFClose(tiffFile);
+	int rc = captureQueue()->Enqueue(filename, width, height, buf, true);
+	if (! _animationCaptureEnabled) {
+		if (captureQueue()->Wait() < 0) rc = -1;
 	}
-	else if( suffix == ".jpg" || suffix == "jpeg" )
-    {
-		int quality = 95;
-		int rc = write_JPEG_file(jpegFile, width, height, buf, quality);
-        fclose( jpegFile );
-		if (rc){
-			SetErrMsg("Image Capture Error; Error writing jpeg file %s",
-				(const char*)filename.c_str());
-            delete[] buf;
-			return -1;
-		} 
-	} 
-    else  // PNG
-    {
-        int rc = Write_PNG( filename.c_str(), width, height, buf );
-		if (rc) {
-			SetErrMsg("Image Capture Error; Error writing PNG file %s", 
-                      (const char*)filename.c_str());
-            delete[] buf;
-			return -1;
-		}
-    }
+	return rc;
+}
 
-	delete [] buf;
-	return 0;
+ImageCaptureQueue *Visualizer::captureQueue()
+{
+	if (! _captureQueue) _captureQueue = new ImageCaptureQueue();
+	return(_captureQueue);
+}
+
+int Visualizer::readPixelsAsync(string filename, size_t width, size_t height)
+{
+	if (! _capturePBO[0]) glGenBuffers(2, _capturePBO);
+
+	 // Must clear previous errors first.
+	while(glGetError() != GL_NO_ERROR);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, _capturePBO[_capturePBOIndex]);
+	glBufferData(GL_PIXEL_PACK_BUFFER, 3*width*height, NULL, GL_STREAM_READ);
+
+	glReadBuffer(colorReadBuffer());
+	glDisable(GL_SCISSOR_TEST);
+	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (glGetError() != GL_NO_ERROR) {
+		SetErrMsg("Image Capture Error; error obtaining GL data");
+		return -1;
+	}
+
+	_pendingCapture[_capturePBOIndex].filename = filename;
+	_pendingCapture[_capturePBOIndex].width = width;
+	_pendingCapture[_capturePBOIndex].height = height;
+
+	// The other buffer holds the previous frame, whose transfer has
+	// had a whole frame to complete
+	//
+	_capturePBOIndex = 1 - _capturePBOIndex;
+	return(flushPendingCapture(_capturePBOIndex));
+}
+
+int Visualizer::flushPendingCapture(int i)
+{
+	if (_pendingCapture[i].filename.empty()) return 0;
+
+	string filename = _pendingCapture[i].filename;
+	size_t width = _pendingCapture[i].width;
+	size_t height = _pendingCapture[i].height;
+	_pendingCapture[i].filename.clear();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, _capturePBO[i]);
+	unsigned char *src = (unsigned char *) glMapBuffer(
+		GL_PIXEL_PACK_BUFFER, GL_READ_ONLY
+	);
+	if (! src) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		SetErrMsg("Image Capture Error; error mapping GL pixel buffer");
+		return -1;
+	}
+
+	unsigned char *buf = captureQueue()->GetBuffer(3*width*height);
+	memcpy(buf, src, 3*width*height);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return(captureQueue()->Enqueue(filename, width, height, buf, true));
+}
+
+int Visualizer::FlushCapture()
+{
+	int rc = 0;
+	if (flushPendingCapture(_capturePBOIndex) < 0) rc = -1;
+	if (flushPendingCapture(1 - _capturePBOIndex) < 0) rc = -1;
+	if (_captureQueue && _captureQueue->Wait() < 0) rc = -1;
+	return rc;
 }
 
 //Produce an array based on current contents of the (back) buffer
@@ -869,7 +910,7 @@ bool Visualizer::getPixelData(unsigned char* data) const {
 	 // Must clear previous errors first.
 	while(glGetError() != GL_NO_ERROR);
 
-	glReadBuffer(GL_BACK);
+	glReadBuffer(colorReadBuffer());
 	glDisable(GL_SCISSOR_TEST);
 
 	// Calling pack alignment ensures that we can grab the any size window
@@ -877,16 +918,8 @@ bool Visualizer::getPixelData(unsigned char* data) const {
 	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
 	if (glGetError() != GL_NO_ERROR)
 		return false;
-	//Unfortunately gl reads these in the reverse order that jpeg expects, so
-	//Now we need to swap top and bottom!
-	unsigned char val;
-	for (int j = 0; j< height/2; j++){
-		for (int i = 0; i<width*3; i++){
-			val = data[i+width*3*j];
-			data[i+width*3*j] = data[i+width*3*(height-j-1)];
-			data[i+width*3*(height-j-1)] = val;
-		}
-	}
+	//GL returns rows in the reverse order that jpeg expects. The
+	//encoder queue swaps top and bottom off of the render thread.
 	
 	return true;
 		
@@ -21,6 +21,8 @@
 #include <sstream>
 #include <string>
 #include <iterator>
+#include <climits>
+#include <algorithm>
 
 #include <vapor/glutil.h>    // Must be included first!!!
 
@@ -37,13 +39,404 @@
 #include "vapor/debug.h"
 
 using namespace VAPoR;
+using namespace Wasp;
+
+namespace {
+
+// Parameters for mapping data values to vertex colors
+//
+struct color_map {
+ float _mv;
+ bool _useSingleColor;
+ float _constantColor[4];
+ const float *_lut;
+ size_t _n;	// number of RGBA entries in _lut
+ double _min, _max;
+};
+
+void map_color(const color_map &cm, float dataValue, float *rgba) {
+	if (dataValue == cm._mv) {
+		rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0.0;
+	}
+	else if (cm._useSingleColor) {
+		for (int i=0; i<4; i++) rgba[i] = cm._constantColor[i];
+	}
+	else {
+		int index = (dataValue - cm._min) / (cm._max - cm._min) * (cm._n - 1);
+		if (index < 0) {
+			index = 0;
+		}
+		if (index >= cm._n) {
+			index = cm._n-1;
+		}
+		for (int i=0; i<4; i++) rgba[i] = cm._lut[4*index+i];
+	}
+}
+
+// Execution thread state for building the wireframe of a structured
+// grid. Each thread handles a range of slabs of nodes along the slowest
+// varying axis. The first pass computes the vertices and counts the 
+// edges. The second pass writes the edges.
+//
+class wireframe_state {
+public:
+ const Grid *_grid;
+ const Grid *_heightGrid;
+ float _defaultZ;
+ const color_map *_cm;
+ int _ndims;
+ long _min[3];	// node bounds of the visited cells
+ long _max[3];
+ long _slab0;	// first slab, relative to _min
+ long _nslabs;
+ int _pass;
+ float *_coords;	// 3 per vertex
+ float *_colors;	// 4 per vertex
+ unsigned int *_indices;	// 2 per edge
+ size_t _offset;	// first edge written in second pass
+ size_t _nedges;	// edges counted in first pass
+
+ // The visited cells are those with all of their nodes inside of
+ // [_min, _max]
+ //
+ bool visited(long i, long j, long k) const {
+	if (i < _min[0] || j < _min[1]) return(false);
+	if (i >= _max[0] || j >= _max[1]) return(false);
+	if (_ndims < 3) return(k == 0);
+	return(k >= _min[2] && k < _max[2]);
+ }
+
+ // Edges are drawn if any of the cells sharing them were visited
+ //
+ bool edge(int axis, long i, long j, long k) const {
+	long di = axis != 0;
+	long dj = axis != 1;
+	long dk = _ndims == 3 && axis != 2;
+	for (long kk=k-dk; kk<=k; kk++) {
+	for (long jj=j-dj; jj<=j; jj++) {
+	for (long ii=i-di; ii<=i; ii++) {
+		if (visited(ii, jj, kk)) return(true);
+	}
+	}
+	}
+	return(false);
+ }
+};
+
+void *RunWireFrameThread(void *arg) {
+	wireframe_state &s = *(wireframe_state *) arg;
+
+	long nx = s._max[0] - s._min[0] + 1;
+	long ny = s._max[1] - s._min[1] + 1;
+	long nz = s._max[2] - s._min[2] + 1;
+	long stride[] = {1, nx, nx*ny};
+	int slowest = s._ndims - 1;
+
+	long kmin = s._min[2];
+	long kmax = s._max[2];
+	long jmin = s._min[1];
+	long jmax = s._max[1];
+	if (slowest == 2) {
+		kmin += s._slab0;
+		kmax = kmin + s._nslabs - 1;
+	}
+	else {
+		jmin += s._slab0;
+		jmax = jmin + s._nslabs - 1;
+	}
+
+	vector <size_t> node(s._ndims);
+	vector <double> coord;
+	unsigned int *indices = s._indices + 2 * s._offset;
+	size_t nedges = 0;
+
+	for (long k=kmin; k<=kmax; k++) {
+	for (long j=jmin; j<=jmax; j++) {
+	for (long i=s._min[0]; i<=s._max[0]; i++) {
+		long v = (i-s._min[0]) + (j-s._min[1]) * nx + (k-s._min[2]) * nx*ny;
+
+		if (s._pass == 0) {
+			node[0] = i;
+			node[1] = j;
+			if (s._ndims == 3) node[2] = k;
+
+			s._grid->GetUserCoordinates(node, coord);
+
+			float *xyz = s._coords + 3*v;
+			xyz[0] = coord[0];
+			xyz[1] = coord[1];
+			if (coord.size() == 3) {
+				xyz[2] = coord[2];
+			}
+			else if (s._heightGrid) {
+				xyz[2] = s._heightGrid->AccessIJK(i,j);
+			}
+			else {
+				xyz[2] = s._defaultZ;
+			}
+
+			map_color(*s._cm, s._grid->AccessIJK(i,j,k), s._colors + 4*v);
+		}
+
+		long n[] = {nx, ny, nz};
+		long ijk[] = {i - s._min[0], j - s._min[1], k - s._min[2]};
+		for (int axis=0; axis<s._ndims; axis++) {
+			if (ijk[axis] + 1 >= n[axis]) continue;
+			if (! s.edge(axis, i, j, k)) continue;
+
+			if (s._pass == 1) {
+				*indices++ = v;
+				*indices++ = v + stride[axis];
+			}
+			nedges++;
+		}
+	}
+	}
+	}
+
+	if (s._pass == 0) s._nedges = nedges;
+	return(0);
+}
+
+int run_wireframe_threads(EasyThreads *et, vector <wireframe_state> &states) {
+	if (states.size() == 1) {
+		RunWireFrameThread(&states[0]);
+		return(0);
+	}
+
+	vector <void *> argvec;
+	for (int i=0; i<states.size(); i++) {
+		argvec.push_back((void *) &states[i]);
+	}
+	return(et->ParRun(RunWireFrameThread, argvec));
+}
+
+// Build the wireframe of a structured grid. The vertices are the nodes 
+// of the visited cells, computed once each, and each edge is drawn once.
+//
+int build_structured_mesh(
+	EasyThreads *et, const Grid *grid, const Grid *heightGrid,
+	const color_map &cm, float defaultZ,
+	const vector <double> &boxMin, const vector <double> &boxMax,
+	vector <float> &coords, vector <float> &colors, 
+	vector <unsigned int> &indices
+) {
+	const vector <size_t> &cdims = grid->GetCellDimensions();
+	int ndims = cdims.size();
+	assert(ndims == 2 || ndims == 3);
+
+	// Find the index bounds of the cells that intersect the box: the 
+	// bounds of the nodes inside the box, expanded by one cell on each 
+	// side, plus the cells containing the box corners (the box may be 
+	// smaller than a cell). Cells straddling the box faces are thus 
+	// included, the GL clipping planes trim them to the box.
+	//
+	long cmin[] = {0, 0, 0};
+	long cmax[] = {0, 0, 0};
+	for (int i=0; i<ndims; i++) {
+		cmin[i] = LONG_MAX;
+		cmax[i] = -1;
+	}
+
+	Grid::ConstNodeIterator it = grid->ConstNodeBegin(boxMin, boxMax);
+	Grid::ConstNodeIterator end = grid->ConstNodeEnd();
+	for (; it != end; ++it) {
+		const vector <size_t> &node = *it;
+
+		for (int i=0; i<ndims; i++) {
+			if ((long) node[i] - 1 < cmin[i]) cmin[i] = (long) node[i] - 1;
+			if ((long) node[i] > cmax[i]) cmax[i] = node[i];
+		}
+	}
+
+	int nbox = boxMin.size();
+	vector <double> corner(nbox);
+	vector <size_t> cell;
+	for (int n=0; n < (1 << nbox); n++) {
+		for (int i=0; i<nbox; i++) {
+			corner[i] = (n & (1 << i)) ? boxMax[i] : boxMin[i];
+		}
+		if (! grid->GetIndicesCell(corner, cell)) continue;
+
+		for (int i=0; i<ndims; i++) {
+			if ((long) cell[i] < cmin[i]) cmin[i] = cell[i];
+			if ((long) cell[i] > cmax[i]) cmax[i] = cell[i];
+		}
+	}
+
+	for (int i=0; i<ndims; i++) {
+		if (cmin[i] < 0) cmin[i] = 0;
+		if (cmax[i] >= (long) cdims[i]) cmax[i] = (long) cdims[i] - 1;
+	}
+	for (int i=0; i<ndims; i++) {
+		if (cmax[i] < cmin[i]) return(0);
+	}
+
+	wireframe_state s;
+	s._grid = grid;
+	s._heightGrid = heightGrid;
+	s._defaultZ = defaultZ;
+	s._cm = &cm;
+	s._ndims = ndims;
+	for (int i=0; i<3; i++) {
+		s._min[i] = cmin[i];
+		s._max[i] = i < ndims ? cmax[i] + 1 : cmax[i];
+	}
+	s._pass = 0;
+	s._offset = 0;
+	s._nedges = 0;
+
+	size_t nverts = 1;
+	for (int i=0; i<3; i++) nverts *= s._max[i] - s._min[i] + 1;
+	coords.resize(3 * nverts);
+	colors.resize(4 * nverts);
+	s._coords = coords.data();
+	s._colors = colors.data();
+	s._indices = NULL;
+
+	int nslabs = s._max[ndims-1] - s._min[ndims-1] + 1;
+	int nthreads = et ? et->GetNumThreads() : 1;
+	if (nthreads < 1 || nslabs == 1) nthreads = 1;
+
+	vector <wireframe_state> states(nthreads, s);
+	for (int i=0; i<nthreads; i++) {
+		int offset, length;
+		EasyThreads::Decompose(nslabs, nthreads, i, &offset, &length);
+		states[i]._slab0 = offset;
+		states[i]._nslabs = length;
+	}
+
+	// First pass computes vertices and counts edges, so that the index 
+	// buffer can be sized exactly before the second pass fills it
+	//
+	int rc = run_wireframe_threads(et, states);
+	if (rc < 0) return(-1);
+
+	size_t nedges = 0;
+	for (int i=0; i<nthreads; i++) {
+		states[i]._offset = nedges;
+		nedges += states[i]._nedges;
+	}
+	indices.resize(2 * nedges);
+
+	for (int i=0; i<nthreads; i++) {
+		states[i]._pass = 1;
+		states[i]._indices = indices.data();
+	}
+	return(run_wireframe_threads(et, states));
+}
+
+// Return true if the bounds of a cell's node coordinates overlap the 
+// box. Only the axes common to the box and the coordinates are tested.
+//
+bool cell_overlaps_box(
+	const vector <vector <double> > &nodeCoords,
+	const vector <double> &boxMin, const vector <double> &boxMax
+) {
+	if (nodeCoords.empty()) return(false);
+
+	int n = std::min(nodeCoords[0].size(), boxMin.size());
+	for (int i=0; i<n; i++) {
+		double min = nodeCoords[0][i];
+		double max = nodeCoords[0][i];
+		for (int j=1; j<nodeCoords.size(); j++) {
+			min = std::min(min, nodeCoords[j][i]);
+			max = std::max(max, nodeCoords[j][i]);
+		}
+		if (max < boxMin[i] || min > boxMax[i]) return(false);
+	}
+	return(true);
+}
+
+// Build the wireframe of any other grid. Vertices are shared by the 
+// cells that use them, but edges are drawn once for each cell. Cells 
+// whose bounds overlap the box are drawn, so that cells straddling 
+// the box faces are included; the GL clipping planes trim them.
+//
+void build_mesh(
+	const Grid *grid, const Grid *heightGrid,
+	const color_map &cm, float defaultZ,
+	const vector <double> &boxMin, const vector <double> &boxMax,
+	vector <float> &coords, vector <float> &colors, 
+	vector <unsigned int> &indices
+) {
+	const vector <size_t> &ndims = grid->GetNodeDimensions();
+	size_t nnodes = 1;
+	for (int i=0; i<ndims.size(); i++) nnodes *= ndims[i];
+
+	const unsigned int unused = ~0u;
+	vector <unsigned int> vertexIndex(nnodes, unused);
+
+	bool layered = grid->GetTopologyDim() == 3;
+	vector <vector <size_t> > nodes;
+	vector <unsigned int> cellVerts;
+
+	vector <vector <double> > nodeCoords;
+
+	Grid::ConstCellIterator it = grid->ConstCellBegin();
+	Grid::ConstCellIterator end = grid->ConstCellEnd();
+	for (; it != end; ++it) {
+		grid->GetCellNodes(*it, nodes);
+
+		nodeCoords.resize(nodes.size());
+		for (int i=0; i<nodes.size(); i++) {
+			grid->GetUserCoordinates(nodes[i], nodeCoords[i]);
+		}
+		if (! cell_overlaps_box(nodeCoords, boxMin, boxMax)) continue;
+
+		cellVerts.clear();
+		for (int i=0; i<nodes.size(); i++) {
+			size_t offset = Wasp::LinearizeCoords(nodes[i], ndims);
+
+			if (vertexIndex[offset] == unused) {
+				vertexIndex[offset] = coords.size() / 3;
+
+				const vector <double> &coord = nodeCoords[i];
+				coords.push_back(coord[0]);
+				coords.push_back(coord[1]);
+				if (coord.size() == 3) {
+					coords.push_back(coord[2]);
+				}
+				else if (heightGrid) {
+					coords.push_back(heightGrid->AccessIndex(nodes[i]));
+				}
+				else {
+					coords.push_back(defaultZ);
+				}
+
+				float rgba[4];
+				map_color(cm, grid->AccessIndex(nodes[i]), rgba);
+				colors.insert(colors.end(), rgba, rgba+4);
+			}
+			cellVerts.push_back(vertexIndex[offset]);
+		}
+
+		// If layered the nodes are ordered bottom face first, then top face
+		//
+		int n = cellVerts.size();
+		int count = layered ? n/2 : n;
+		for (int i=0; i<count; i++) {
+			indices.push_back(cellVerts[i]);
+			indices.push_back(cellVerts[(i+1)%count]);
+		}
+
+		if (! layered) continue;
+
+		for (int i=0; i<count; i++) {
+			indices.push_back(cellVerts[i + count]);
+			indices.push_back(cellVerts[((i+1)%count) + count]);
+		}
+
+		// Edges between top and bottom face
+		//
+		for (int i=0; i<count; i++) {
+			indices.push_back(cellVerts[i]);
+			indices.push_back(cellVerts[i + count]);
+		}
+	}
+}
 
-#pragma pack(push, 4)
-struct WireFrameRenderer::VertexData {
-    float x, y, z;
-    float r, g, b, a;
 };
-#pragma pack(pop)
 
 static RendererRegistrar<WireFrameRenderer> registrar(
 	WireFrameRenderer::GetClassType(), WireFrameParams::GetClassType()
@@ -57,7 +450,10 @@ WireFrameRenderer::WireFrameRenderer(
 	pm, winName, dataSetName, WireFrameParams::GetClassType(),
 	WireFrameRenderer::GetClassType(), instName, dataMgr),
     _VAO(0), _VBO(0), _EBO(0)
-{}
+{
+    _nIndices = 0;
+    _et = new EasyThreads(0);
+}
 
 WireFrameRenderer::~WireFrameRenderer()
 {
@@ -65,6 +461,7 @@ WireFrameRenderer::~WireFrameRenderer()
     if (_VBO) glDeleteBuffers(1, &_VBO);
     if (_EBO) glDeleteBuffers(1, &_EBO);
     _VAO = _VBO = _EBO = 0;
+    if (_et) delete _et;
 }
 
 void WireFrameRenderer::_saveCacheParams()
@@ -114,53 +511,6 @@ bool WireFrameRenderer::_isCacheDirty() const
     return false;
 }
 
-void WireFrameRenderer::_drawCell(
-    vector<VertexData> &vertices,
-    vector<unsigned int> &indices,
-	const float *verts,
-	const float *colors,
-	int n,
-	bool layered
-) {
-
-	// glVertexPointer(3, GL_FLOAT, 0, verts);
-	// glColorPointer(4, GL_FLOAT, 0, colors);
-    
-    int baseIndex = vertices.size();
-    for (int i = 0; i < n; i++) {
-        vertices.push_back({
-            verts[3*i], verts[3*i+1], verts[3*i+2],
-            colors[4*i], colors[4*i+1], colors[4*i+2], colors[4*i+3]
-        });
-    }
-
-	int count = layered ? n/2 : n;
-	for (int i=0; i<count; i++) {
-		// indices[i] = i;
-        indices.push_back(baseIndex + i);
-        indices.push_back(baseIndex + ((i+1)%count));
-	}
-
-	if (! layered) return;
-    
-	// if layered the coordinates are ordered bottom face first, then top face
-	//
-	for (int i=0; i<count; i++) {
-		// indices[i] = i + count;
-        indices.push_back(baseIndex + i + count);
-        indices.push_back(baseIndex + ((i+1)%count) + count);
-	}
-    
-	// Now draw edges between top and bottom face
-	//
-	for (int i=0; i<count; i++) {
-		// indices[2*i+0] = i;
-		// indices[2*i+1] = i + count;
-        indices.push_back(baseIndex + i);
-        indices.push_back(baseIndex + i + count);
-	}
-}
-
 int WireFrameRenderer::_buildCache()
 {
     WireFrameParams* rParams = (WireFrameParams*)GetActiveParams();
@@ -191,102 +541,60 @@ int WireFrameRenderer::_buildCache()
         }
     }
     
-    vector<VertexData> vertices;
-    vector<unsigned int> indices;
-    
-    double mv = grid->GetMissingValue();
-    
-#if 0    // VAPOR_3_1_0
-    
-    // Performance of the bounding box version of the Cell iterator
-    // is too slow. So we render the entire grid and use clipping planes
-    // to restrict the displayed region
+    color_map cm;
+    cm._mv = grid->GetMissingValue();
+    cm._useSingleColor = _cacheParams.useSingleColor;
+    for (int i=0; i<3; i++) {
+        cm._constantColor[i] = _cacheParams.constantColor[i];
+    }
+    cm._constantColor[3] = _cacheParams.constantOpacity;
+    cm._lut = _cacheParams.tf_lut.data();
+    cm._n = _cacheParams.tf_lut.size() >> 2;
+    cm._min = _cacheParams.tf_minmax[0];
+    cm._max = _cacheParams.tf_minmax[1];
+
+    float defaultZ = _getDefaultZ(_dataMgr, _cacheParams.ts);
+
+    // Vertices are stored once per node: all of the positions, followed
+    // by all of the colors
     //
-    Grid::ConstCellIterator it = grid->ConstCellBegin(
-                                                      _cacheParams.boxMin, _cacheParams.boxMax
-                                                      );
-#else
-    Grid::ConstCellIterator it = grid->ConstCellBegin();
-#endif
-    
-    
-    size_t nverts = grid->GetMaxVertexPerCell();
-    bool layered = grid->GetTopologyDim() == 3;
-    
-    float *coordsArray = new float[nverts*3];
-    float *colorsArray = new float[nverts*4];
-    Grid::ConstCellIterator end = grid->ConstCellEnd();
+    vector<float> coords;
+    vector<float> colors;
+    vector<unsigned int> indices;
     
-    float defaultZ = _getDefaultZ(_dataMgr, _cacheParams.ts);
-    for (; it != end; ++it)
-    {
-        vector <vector<size_t> > nodes;
-        grid->GetCellNodes(*it, nodes);
-        
-        for (int i = 0; i < nodes.size(); i++)
-        {
-            vector <double> coord;
-            grid->GetUserCoordinates(nodes[i], coord);
-            
-            coordsArray[3*i+0] = coord[0];
-            coordsArray[3*i+1] = coord[1];
-            
-            if (coord.size() == 3) {
-                coordsArray[3*i+2] = coord[2];
-            }
-            else if (heightGrid) {
-                coordsArray[3*i+2] = heightGrid->AccessIndex(nodes[i]);
-            }
-            else {
-                coordsArray[3*i+2] = defaultZ;
-            }
-            
-            float dataValue = grid->AccessIndex(nodes[i]);
-            if (dataValue == mv) {
-                colorsArray[4*i+0] = 0.0;
-                colorsArray[4*i+1] = 0.0;
-                colorsArray[4*i+2] = 0.0;
-                colorsArray[4*i+3] = 0.0;
-            }
-            else if (_cacheParams.useSingleColor) {
-                colorsArray[4*i+0] = _cacheParams.constantColor[0];
-                colorsArray[4*i+1] = _cacheParams.constantColor[1];
-                colorsArray[4*i+2] = _cacheParams.constantColor[2];
-                colorsArray[4*i+3] = _cacheParams.constantOpacity;
-            }
-            else {
-                size_t n = _cacheParams.tf_lut.size() >> 2;
-                int index = (dataValue - _cacheParams.tf_minmax[0]) /
-                (_cacheParams.tf_minmax[1] - _cacheParams.tf_minmax[0]) *
-                (n - 1);
-                if (index < 0) {
-                    index = 0;
-                }
-                if (index >= n) {
-                    index = n-1;
-                }
-                colorsArray[4*i+0] = _cacheParams.tf_lut[4*index+0];
-                colorsArray[4*i+1] = _cacheParams.tf_lut[4*index+1];
-                colorsArray[4*i+2] = _cacheParams.tf_lut[4*index+2];
-                colorsArray[4*i+3] = _cacheParams.tf_lut[4*index+3];
-                
-            }
-        }
-        
-        _drawCell(vertices, indices, coordsArray, colorsArray, nodes.size(), layered);
+    int rc = 0;
+    if (dynamic_cast<StructuredGrid *>(grid)) {
+        rc = build_structured_mesh(
+            _et, grid, heightGrid, cm, defaultZ,
+            _cacheParams.boxMin, _cacheParams.boxMax, coords, colors, indices
+        );
+    }
+    else {
+        build_mesh(
+            grid, heightGrid, cm, defaultZ,
+            _cacheParams.boxMin, _cacheParams.boxMax, coords, colors, indices
+        );
     }
-    
-    
-    delete [] coordsArray;
-    delete [] colorsArray;
     
     if (grid) delete grid;
     if (heightGrid) delete heightGrid;
+
+    if (rc < 0) {
+        SetErrMsg("Error spawning threads");
+        return(-1);
+    }
     
+    size_t coordsSize = coords.size() * sizeof(float);
+    size_t colorsSize = colors.size() * sizeof(float);
+
     _nIndices = indices.size();
     glBindVertexArray(_VAO);
     glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(VertexData), vertices.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, coordsSize + colorsSize, NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, coordsSize, coords.data());
+    glBufferSubData(GL_ARRAY_BUFFER, coordsSize, colorsSize, colors.data());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, (void*)coordsSize);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_DYNAMIC_DRAW);
     glBindVertexArray(0);
@@ -327,9 +635,9 @@ int WireFrameRenderer::_initializeGL()
     glGenBuffers(1, &_VBO);
     glGenBuffers(1, &_EBO);
     glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), NULL);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (void*)offsetof(struct VertexData, r));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, NULL);
     glEnableVertexAttribArray(1);
     glBindVertexArray(0);
     return 0;
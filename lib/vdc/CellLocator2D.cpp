@@ -0,0 +1,310 @@
+#include <cassert>
+#include <cmath>
+#include <cfloat>
+#include <vapor/vizutil.h>
+#include <vapor/CellLocator2D.h>
+
+using namespace std;
+using namespace VAPoR;
+
+CellLocator2D::CellLocator2D(const Grid &xg, const Grid &yg) {
+	_built = false;
+	Build(xg, yg);
+}
+
+CellLocator2D::CellLocator2D(
+	const Grid &xg, const Grid &yg,
+	const int *vertexOnFace, size_t nfaces, size_t maxVertexPerFace,
+	int missingID, long nodeOffset
+) {
+	_built = false;
+	Build(
+		xg, yg, vertexOnFace, nfaces, maxVertexPerFace, missingID, nodeOffset
+	);
+}
+
+void CellLocator2D::Build(const Grid &xg, const Grid &yg) {
+	std::call_once(_once, [&]() {_buildStructured(xg, yg);});
+}
+
+void CellLocator2D::Build(
+	const Grid &xg, const Grid &yg,
+	const int *vertexOnFace, size_t nfaces, size_t maxVertexPerFace,
+	int missingID, long nodeOffset
+) {
+	std::call_once(_once, [&]() {
+		_buildUnstructured(
+			xg, yg, vertexOnFace, nfaces, maxVertexPerFace, missingID,
+			nodeOffset
+		);
+	});
+}
+
+void CellLocator2D::_buildStructured(const Grid &xg, const Grid &yg) {
+	assert(xg.GetDimensions() == yg.GetDimensions());
+	assert(xg.GetDimensions().size() == 2);
+
+	_copyCoords(xg, yg);
+
+	vector <size_t> dims = xg.GetDimensions();
+	size_t nx = dims[0];
+	size_t ny = dims[1];
+
+	_cellStart.push_back(0);
+	for (size_t j=0; j+1<ny; j++) {
+	for (size_t i=0; i+1<nx; i++) {
+		_cellNodes.push_back(j*nx + i);
+		_cellNodes.push_back(j*nx + i+1);
+		_cellNodes.push_back((j+1)*nx + i+1);
+		_cellNodes.push_back((j+1)*nx + i);
+		_cellStart.push_back(_cellNodes.size());
+	}
+	}
+
+	_buildBins();
+	_built = true;
+}
+
+void CellLocator2D::_buildUnstructured(
+	const Grid &xg, const Grid &yg,
+	const int *vertexOnFace, size_t nfaces, size_t maxVertexPerFace,
+	int missingID, long nodeOffset
+) {
+	assert(xg.GetDimensions() == yg.GetDimensions());
+
+	_copyCoords(xg, yg);
+
+	_cellStart.push_back(0);
+	for (size_t face=0; face<nfaces; face++) {
+		const int *ptr = vertexOnFace + (face * maxVertexPerFace);
+		size_t start = _cellNodes.size();
+
+		for (size_t i=0; i<maxVertexPerFace; i++) {
+			if (ptr[i] == missingID) break;
+
+			long vertex = ptr[i] + nodeOffset;
+			if (vertex < 0) break;
+
+			_cellNodes.push_back(vertex);
+		}
+
+		// Faces that aren't polygons, or that have too many vertices,
+		// can never contain a point
+		//
+		size_t n = _cellNodes.size() - start;
+		if (n < 3 || n > MaxNodes) _cellNodes.resize(start);
+
+		_cellStart.push_back(_cellNodes.size());
+	}
+
+	_buildBins();
+	_built = true;
+}
+
+bool CellLocator2D::Locate(
+	double x, double y, size_t &cell, size_t nodes[], double lambda[],
+	int &nnodes
+) const {
+	assert(_built);
+	nnodes = 0;
+
+	// Rejects NaN coordinates too
+	//
+	if (! (x >= _minx && x <= _maxx && y >= _miny && y <= _maxy)) {
+		return(false);
+	}
+
+	size_t bx = (size_t) ((x - _minx) * _binScaleX);
+	size_t by = (size_t) ((y - _miny) * _binScaleY);
+	if (bx >= _nbx) bx = _nbx - 1;
+	if (by >= _nby) by = _nby - 1;
+
+	size_t bin = by * _nbx + bx;
+	double pt[] = {x, y};
+
+	for (size_t i=_binStart[bin]; i<_binStart[bin+1]; i++) {
+		if (_insideCell(_binCells[i], pt, nodes, lambda, nnodes)) {
+			cell = _binCells[i];
+			return(true);
+		}
+	}
+	return(false);
+}
+
+size_t CellLocator2D::Locate(
+	size_t n, const double *x, const double *y, long *cells,
+	size_t *nodes, double *lambda, int *nnodes
+) const {
+
+	size_t count = 0;
+	long prev = -1;
+	for (size_t i=0; i<n; i++) {
+		size_t *inodes = nodes + i*MaxNodes;
+		double *ilambda = lambda + i*MaxNodes;
+		double pt[] = {x[i], y[i]};
+
+		// Queries are often coherent, so try the last cell found first
+		//
+		if (prev >= 0 && _insideCell(prev, pt, inodes, ilambda, nnodes[i])) {
+			cells[i] = prev;
+			count++;
+			continue;
+		}
+
+		size_t cell;
+		if (Locate(x[i], y[i], cell, inodes, ilambda, nnodes[i])) {
+			cells[i] = prev = cell;
+			count++;
+		}
+		else {
+			cells[i] = -1;
+			nnodes[i] = 0;
+		}
+	}
+	return(count);
+}
+
+void CellLocator2D::_copyCoords(const Grid &xg, const Grid &yg) {
+
+	vector <size_t> dims = xg.GetDimensions();
+	size_t nelem = 1;
+	for (int i=0; i<dims.size(); i++) nelem *= dims[i];
+
+	_x.resize(nelem);
+	_y.resize(nelem);
+
+	Grid::ConstIterator xitr = xg.cbegin();
+	Grid::ConstIterator yitr = yg.cbegin();
+	for (size_t i=0; i<nelem; ++i, ++xitr, ++yitr) {
+		_x[i] = *xitr;
+		_y[i] = *yitr;
+	}
+}
+
+// Compute the bounding box of each cell, and bin the cells into a uniform
+// grid with about one cell per bin. Bin contents are stored in a single
+// array, indexed by _binStart
+//
+void CellLocator2D::_buildBins() {
+	size_t ncells = GetNumCells();
+
+	_minx = _miny = DBL_MAX;
+	_maxx = _maxy = -DBL_MAX;
+	_bbox.assign(ncells * 4, 0.0);
+
+	size_t nvalid = 0;
+	for (size_t c=0; c<ncells; c++) {
+		float *bb = &_bbox[c*4];
+		bb[0] = bb[2] = FLT_MAX;
+		bb[1] = bb[3] = -FLT_MAX;
+
+		for (size_t i=_cellStart[c]; i<_cellStart[c+1]; i++) {
+			float x = _x[_cellNodes[i]];
+			float y = _y[_cellNodes[i]];
+			if (x < bb[0]) bb[0] = x;
+			if (x > bb[1]) bb[1] = x;
+			if (y < bb[2]) bb[2] = y;
+			if (y > bb[3]) bb[3] = y;
+		}
+		if (bb[0] > bb[1] || bb[2] > bb[3]) continue;
+
+		// WachspressCoords2D() accepts points within a small tolerance
+		// of a cell's edges. Pad the bounding box so that such points
+		// aren't rejected before it is called
+		//
+		float padx = 0.01 * (bb[1] - bb[0]);
+		float pady = 0.01 * (bb[3] - bb[2]);
+		bb[0] -= padx;
+		bb[1] += padx;
+		bb[2] -= pady;
+		bb[3] += pady;
+
+		if (bb[0] < _minx) _minx = bb[0];
+		if (bb[1] > _maxx) _maxx = bb[1];
+		if (bb[2] < _miny) _miny = bb[2];
+		if (bb[3] > _maxy) _maxy = bb[3];
+		nvalid++;
+	}
+
+	if (! nvalid) {
+		_minx = _miny = 1.0;
+		_maxx = _maxy = 0.0;
+		_nbx = _nby = 1;
+		_binScaleX = _binScaleY = 0.0;
+		_binStart.assign(2, 0);
+		_binCells.clear();
+		return;
+	}
+
+	double w = _maxx - _minx;
+	double h = _maxy - _miny;
+	double aspect = (w > 0.0 && h > 0.0) ? w / h : 1.0;
+
+	_nbx = (size_t) sqrt((double) nvalid * aspect);
+	if (_nbx < 1 || w <= 0.0) _nbx = 1;
+	_nby = nvalid / _nbx;
+	if (_nby < 1 || h <= 0.0) _nby = 1;
+
+	_binScaleX = w > 0.0 ? _nbx / w : 0.0;
+	_binScaleY = h > 0.0 ? _nby / h : 0.0;
+
+	// Count cells per bin, then fill
+	//
+	for (int pass=0; pass<2; pass++) {
+		if (pass == 0) {
+			_binStart.assign(_nbx * _nby + 1, 0);
+		}
+		vector <size_t> next(_binStart.begin(), _binStart.end() - 1);
+
+		for (size_t c=0; c<ncells; c++) {
+			const float *bb = &_bbox[c*4];
+			if (bb[0] > bb[1] || bb[2] > bb[3]) continue;
+
+			size_t bx0 = (size_t) ((bb[0] - _minx) * _binScaleX);
+			size_t bx1 = (size_t) ((bb[1] - _minx) * _binScaleX);
+			size_t by0 = (size_t) ((bb[2] - _miny) * _binScaleY);
+			size_t by1 = (size_t) ((bb[3] - _miny) * _binScaleY);
+			if (bx1 >= _nbx) bx1 = _nbx - 1;
+			if (by1 >= _nby) by1 = _nby - 1;
+			if (bx0 > bx1) bx0 = bx1;
+			if (by0 > by1) by0 = by1;
+
+			for (size_t by=by0; by<=by1; by++) {
+			for (size_t bx=bx0; bx<=bx1; bx++) {
+				size_t bin = by * _nbx + bx;
+				if (pass == 0) _binStart[bin+1]++;
+				else _binCells[next[bin]++] = c;
+			}
+			}
+		}
+
+		if (pass == 0) {
+			for (size_t i=0; i<_nbx * _nby; i++) {
+				_binStart[i+1] += _binStart[i];
+			}
+			_binCells.resize(_binStart[_nbx * _nby]);
+		}
+	}
+}
+
+bool CellLocator2D::_insideCell(
+	size_t cell, const double pt[2], size_t nodes[], double lambda[],
+	int &nnodes
+) const {
+	const float *bb = &_bbox[cell*4];
+	if (pt[0] < bb[0] || pt[0] > bb[1] || pt[1] < bb[2] || pt[1] > bb[3]) {
+		return(false);
+	}
+
+	double verts[2*MaxNodes];
+	int n = 0;
+	for (size_t i=_cellStart[cell]; i<_cellStart[cell+1]; i++, n++) {
+		nodes[n] = _cellNodes[i];
+		verts[n*2+0] = _x[_cellNodes[i]];
+		verts[n*2+1] = _y[_cellNodes[i]];
+	}
+	if (n < 3) return(false);
+
+	nnodes = n;
+	return(WachspressCoords2D(verts, pt, n, lambda));
+}
@@ -16,12 +16,14 @@ void CurvilinearGrid::_curvilinearGrid(
 	const RegularGrid &yrg,
 	const RegularGrid &zrg,
 	const vector <double> &zcoords,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator
 ) {
 	_zcoords.clear();
 	_minu.clear();
 	_maxu.clear();
 	_kdtree = kdtree;
+	_locator = locator;
 	_xrg = xrg;
 	_yrg = yrg;
 	_zrg = zrg;
@@ -38,7 +40,8 @@ CurvilinearGrid::CurvilinearGrid(
 	const RegularGrid &xrg,
 	const RegularGrid &yrg,
 	const vector <double> &zcoords,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator
  ) : StructuredGrid(dims, bs, blks) {
 
 	assert(dims.size() == 2 || dims.size() == 3);
@@ -52,7 +55,7 @@ CurvilinearGrid::CurvilinearGrid(
 	assert(kdtree->GetDimensions().size() == 2);
 	assert(zcoords.size() == 0 || zcoords.size() == dims[2]);
 
-	_curvilinearGrid(xrg, yrg, RegularGrid(), zcoords, kdtree);
+	_curvilinearGrid(xrg, yrg, RegularGrid(), zcoords, kdtree, locator);
 }
 
 CurvilinearGrid::CurvilinearGrid(
@@ -62,7 +65,8 @@ CurvilinearGrid::CurvilinearGrid(
 	const RegularGrid &xrg,
 	const RegularGrid &yrg,
 	const RegularGrid &zrg,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator
  ) : StructuredGrid(dims, bs, blks) {
 
 	assert(dims.size() == 3);
@@ -76,7 +80,7 @@ CurvilinearGrid::CurvilinearGrid(
 	assert(zrg.GetDimensions().size() == 3);
 	assert(kdtree->GetDimensions().size() == 2);
 
-	_curvilinearGrid(xrg, yrg, zrg, vector <double> (), kdtree);
+	_curvilinearGrid(xrg, yrg, zrg, vector <double> (), kdtree, locator);
 
 	_terrainFollowing = true;
 }
@@ -87,7 +91,8 @@ CurvilinearGrid::CurvilinearGrid(
 	const vector <float *> &blks,
 	const RegularGrid &xrg,
 	const RegularGrid &yrg,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator
  ) : StructuredGrid(dims, bs, blks) {
 
 	assert(dims.size() == 2);
@@ -100,7 +105,7 @@ CurvilinearGrid::CurvilinearGrid(
 	assert(yrg.GetDimensions().size() == 2);
 	assert(kdtree->GetDimensions().size() == 2);
 
-	_curvilinearGrid(xrg, yrg, RegularGrid(), vector <double> (), kdtree);
+	_curvilinearGrid(xrg, yrg, RegularGrid(), vector <double> (), kdtree, locator);
 }
 
 
@@ -324,6 +329,75 @@ void CurvilinearGrid::GetEnclosingRegion(
 }
 
 
+bool CurvilinearGrid::_getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+) const {
+
+	vector <size_t> dims = GetDimensions();
+
+	min = vector <size_t> (dims.size(), 0);
+	max = dims;
+	for (int i=0; i<dims.size(); i++) {
+		if (! dims[i]) return(false);
+		max[i]--;
+	}
+
+	// Nodes within the bounds must still be tested, but the bounds are
+	// found by scanning only the horizontal coordinates
+	//
+	exact = false;
+
+	double xmin = minu.size() > 0 ? minu[0] : -DBL_MAX;
+	double xmax = maxu.size() > 0 ? maxu[0] : DBL_MAX;
+	double ymin = minu.size() > 1 ? minu[1] : -DBL_MAX;
+	double ymax = maxu.size() > 1 ? maxu[1] : DBL_MAX;
+
+	size_t imin = dims[0];
+	size_t imax = 0;
+	size_t jmin = dims[1];
+	size_t jmax = 0;
+	for (size_t j=0; j<dims[1]; j++) {
+	for (size_t i=0; i<dims[0]; i++) {
+		double x = _xrg.AccessIJK(i,j,0);
+		double y = _yrg.AccessIJK(i,j,0);
+		if (x < xmin || x > xmax || y < ymin || y > ymax) continue;
+
+		if (i < imin) imin = i;
+		if (i > imax) imax = i;
+		if (j < jmin) jmin = j;
+		if (j > jmax) jmax = j;
+	}
+	}
+
+	// No nodes inside box
+	//
+	if (imin > imax) {
+		min[0] = 1;
+		max[0] = 0;
+		return(true);
+	}
+
+	min[0] = imin;
+	max[0] = imax;
+	min[1] = jmin;
+	max[1] = jmax;
+
+	if (dims.size() < 3 || minu.size() < 3 || maxu.size() < 3) return(true);
+
+	if (_terrainFollowing) {
+		_layerIndexRange(_zrg, minu[2], maxu[2], min, max);
+	}
+	else if (
+		_zcoords.size() == dims[2] && 
+		(_zcoords.size() == 1 || _zcoords.front() < _zcoords.back())
+	) {
+		_sortedIndexRange(_zcoords, minu[2], maxu[2], min[2], max[2]);
+	}
+
+	return(true);
+}
+
 void CurvilinearGrid::GetUserCoordinates(
 	const std::vector <size_t> &indices,
 	std::vector <double> &coords
@@ -893,6 +967,14 @@ bool CurvilinearGrid::_insideGridHelperTerrain(
 // zwgt[0] == 1.0, and zwgt[1] == 0.0. If the point is outside of the
 // grid the values of 'lambda', and 'zwgt' are not defined
 //
+// The locator is shared by all grids on the same mesh, and is built by
+// the first one that's queried
+//
+const CellLocator2D *CurvilinearGrid::_getLocator() const {
+	_locator->Build(_xrg, _yrg);
+	return(_locator);
+}
+
 bool CurvilinearGrid::_insideGrid(
 	double x, double y, double z,
 	size_t &i, size_t &j, size_t &k,
@@ -902,6 +984,27 @@ bool CurvilinearGrid::_insideGrid(
 	for (int l=0; l<2; l++) zwgt[l] = 0.0;
 	i = j = k = 0;
 
+	vector <size_t> dims = StructuredGrid::GetDimensions();
+
+	if (_locator) {
+		size_t cell;
+		size_t nodes[CellLocator2D::MaxNodes];
+		double lambdav[CellLocator2D::MaxNodes];
+		int nlambda;
+
+		bool inside = _getLocator()->Locate(
+			x, y, cell, nodes, lambdav, nlambda
+		);
+		if (! inside) return(false);
+		assert(nlambda == 4);
+
+		for (int l=0; l<4; l++) lambda[l] = lambdav[l];
+		i = cell % (dims[0]-1);
+		j = cell / (dims[0]-1);
+
+		return(_insideGridVertical(x, y, z, i, j, k, zwgt));
+	}
+
 	vector <float> coordu;
 	coordu.push_back(x);
 	coordu.push_back(y);
@@ -913,8 +1016,6 @@ bool CurvilinearGrid::_insideGrid(
 	_kdtree->Nearest(coordu, indices);
 	assert(indices.size() == 2);
 
-	vector <size_t> dims = StructuredGrid::GetDimensions();
-
 	// Now visit each quadrilateral that shares a vertex with the returned
 	// grid indeces. Use Wachspress coordinates to determine if point is 
 	// inside a quad. 
@@ -954,6 +1055,17 @@ bool CurvilinearGrid::_insideGrid(
 		return(false);
 	}
 
+	return(_insideGridVertical(x, y, z, i, j, k, zwgt));
+}
+
+// Find the vertical interpolation weights for a point whose horizontal
+// cell, (i,j), is known
+//
+bool CurvilinearGrid::_insideGridVertical(
+	double x, double y, double z,
+	size_t i, size_t j, size_t &k,
+	double zwgt[2]
+) const {
 	if (GetGeometryDim() == 2) {
 		zwgt[0] = 1.0;
 		zwgt[1] = 0.0;
@@ -966,6 +1078,5 @@ bool CurvilinearGrid::_insideGrid(
 	else {
 		return(_insideGridHelperStretched(z, k, zwgt));
 	}
-
 }
 
@@ -754,6 +754,33 @@ template int DC::_getVarTemplate<float>(size_t ts, string varname, int level, in
 template int DC::_getVarTemplate<int>  (size_t ts, string varname, int level, int lod, int   *data);
 
 
+int DC::readTimeSeries(
+	string varname, int level, int lod, size_t ts0, size_t ts1,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+) {
+	assert(min.size() == max.size());
+
+	if (ts0 > ts1) {
+		SetErrMsg("Invalid time step range : %d, %d", ts0, ts1);
+		return(-1);
+	}
+
+	size_t n = 1;
+	for (int i=0; i<min.size(); i++) {
+		n *= max[i] - min[i] + 1;
+	}
+
+	for (size_t ts = ts0; ts <= ts1; ts++) {
+		int fd = OpenVariableRead(ts, varname, level, lod);
+		if (fd<0) return(-1);
+
+		int rc = ReadRegion(fd, min, max, region + (ts - ts0) * n);
+		(void) CloseVariable(fd);
+		if (rc<0) return(-1);
+	}
+	return(0);
+}
+
 bool DC::GetVarDimensions(
 	string varname, bool spatial,
 	vector <DC::Dimension> &dimensions
@@ -964,6 +991,30 @@ vector <size_t> DC::GetCRatios(string varname) const {
 	return(var.GetCRatios());
 }
 
+bool DC::GetErrorBound(
+	string varname, double &max_error, bool &relative
+) const {
+	max_error = -1.0;
+	relative = false;
+
+	DC::BaseVar var;
+	bool status = GetBaseVarInfo(varname, var);
+	if (! status) return(false);
+
+	Attribute att;
+	if (! var.IsCompressed() || ! var.GetAttribute("ErrorBound", att)) {
+		return(false);
+	}
+
+	vector <double> bound;
+	att.GetValues(bound);
+	if (bound.size() != 2) return(false);
+
+	max_error = bound[0];
+	relative = bound[1] != 0.0;
+	return(true);
+}
+
 bool DC::GetVarCoordVars(
 	string varname, bool spatial, std::vector<string> &coord_vars
 ) const {
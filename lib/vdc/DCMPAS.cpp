@@ -235,6 +235,21 @@ namespace {
 
 	}
 
+	// Return the offset of the spatial index bin containing the point
+	// (lon, lat), given in radians
+	//
+	size_t index_bin(double lon, double lat, size_t nlon, size_t nlat) {
+		if (lon > M_PI) lon -= 2*M_PI;
+
+		int i = (int) ((lon + M_PI) / (2*M_PI) * nlon);
+		int j = (int) ((lat + M_PI*0.5) / M_PI * nlat);
+
+		i = std::min(std::max(i, 0), (int) nlon-1);
+		j = std::min(std::max(j, 0), (int) nlat-1);
+
+		return(j * nlon + i);
+	}
+
 	bool isEdgeVariable (NetCDFCollection *ncdfc, string varname) {
 		vector <string> v = ncdfc->GetSpatialDimNames(varname);
 
@@ -258,6 +273,8 @@ DCMPAS::DCMPAS() {
 	_cellVars.clear();
 	_pointVars.clear();
 	_edgeVars.clear();
+	_indexNLon = 0;
+	_indexNLat = 0;
 
 }
 
@@ -583,112 +600,255 @@ int DCMPAS::_getVar(size_t ts, string varname, T *buf) {
 	if (fd<0) return(fd);
 
 	int rc = _ncdfc->Read(buf, fd);
-	if (rc<0) return(fd);
-	
+	if (rc<0) {
+		_ncdfc->Close(fd);
+		return(-1);
+	}
 
 	return(_ncdfc->Close(fd));
 }
 
 
-// Read the MPAS nEdgesOnCell auxiliary variable and store it for
-// use later
+// Return a time-invariant variable (coordinate or connectivity), reading
+// it on the first request. Data are returned in native NetCDF order and
+// units
 //
-int DCMPAS::_read_nEdgesOnCell(size_t ts) {
+template <class T>
+const T *DCMPAS::_getStaticVar(string varname) {
 
-	DC::Dimension dimension;
-	bool ok = GetDimension(nCellsDimName, dimension);
-	if (! ok) {
-		SetErrMsg(
-			"Invalid MPAS auxiliary variable: %s",
-			nEdgesOnCellVarName.c_str()
-		);
-		return(-1);
+	map <string, Wasp::SmartBuf>::iterator itr = _staticVarsMap.find(varname);
+	if (itr != _staticVarsMap.end()) {
+		return((const T *) itr->second.GetBuf());
 	}
 
-    int *buf = (int *) _nEdgesOnCellBuf.Alloc(
-        dimension.GetLength() * sizeof(*buf)
-    );
+	vector <size_t> dims = _ncdfc->GetSpatialDims(varname);
+	if (dims.empty()) {
+		SetErrMsg("Invalid MPAS variable: %s", varname.c_str());
+		return(NULL);
+	}
 
-	int fd = _ncdfc->OpenRead(ts, nEdgesOnCellVarName);
-	if (fd<0) return(fd);
+	T *buf = (T *) _staticVarsMap[varname].Alloc(vproduct(dims) * sizeof(*buf));
 
-	int rc = _ncdfc->Read(buf, fd);
-	if (rc<0) return(fd);
-	
+	int rc = _getVar(0, varname, buf);
+	if (rc<0) {
+		_staticVarsMap.erase(varname);
+		return(NULL);
+	}
 
-	return(_ncdfc->Close(fd));
+	return(buf);
 }
 
-// Read a floating point variable (data or coordinate) into a SmartBuf
+// Bin cell and vertex locations into a coarse lat-lon grid, recording
+// for each bin the range of indices that fall inside it. MPAS meshes
+// are usually ordered along a space filling curve, so these ranges
+// tend to be compact
 //
-int DCMPAS::_readVarToSmartBuf(
-	size_t ts, string varname, Wasp::SmartBuf &smartBuf
+int DCMPAS::_buildSpatialIndex() {
+
+	if (! _indexCellMin.empty()) return(0);
+
+	const float *latCell = _getStaticVar<float>(latCellVarName);
+	const float *lonCell = _getStaticVar<float>(lonCellVarName);
+	const float *latVertex = _getStaticVar<float>(latVertexVarName);
+	const float *lonVertex = _getStaticVar<float>(lonVertexVarName);
+	if (! latCell || ! lonCell || ! latVertex || ! lonVertex) return(-1);
+
+	size_t nCells = vproduct(_ncdfc->GetSpatialDims(lonCellVarName));
+	size_t nVertices = vproduct(_ncdfc->GetSpatialDims(lonVertexVarName));
+
+	// Aim for a few dozen cells per bin
+	//
+	size_t nbins = (size_t) sqrt((double) nCells / 32.0);
+	if (nbins < 1) nbins = 1;
+	if (nbins > 720) nbins = 720;
+
+	_indexNLat = nbins;
+	_indexNLon = 2 * nbins;
+
+	size_t n = _indexNLon * _indexNLat;
+	_indexCellMin.assign(n, nCells);
+	_indexCellMax.assign(n, 0);
+	_indexVertexMin.assign(n, nVertices);
+	_indexVertexMax.assign(n, 0);
+
+	for (size_t i=0; i<nCells; i++) {
+		size_t bin = index_bin(lonCell[i], latCell[i], _indexNLon, _indexNLat);
+		_indexCellMin[bin] = min(_indexCellMin[bin], i);
+		_indexCellMax[bin] = max(_indexCellMax[bin], i);
+	}
+
+	for (size_t i=0; i<nVertices; i++) {
+		size_t bin = index_bin(lonVertex[i], latVertex[i], _indexNLon, _indexNLat);
+		_indexVertexMin[bin] = min(_indexVertexMin[bin], i);
+		_indexVertexMax[bin] = max(_indexVertexMax[bin], i);
+	}
+
+	return(0);
+}
+
+int DCMPAS::GetIndexExtents(
+	double lonMin, double latMin, double lonMax, double latMax,
+	size_t &cellMin, size_t &cellMax, size_t &vertexMin, size_t &vertexMax
 ) {
-	vector <size_t> dims;
-	bool ok = GetVarDimLens(varname, true, dims);
-	assert(ok);
+	cellMin = cellMax = vertexMin = vertexMax = 0;
 
-	size_t n = vproduct(dims);
-	float *buf = (float *) smartBuf.Alloc(n * sizeof (*buf));
+	if (! _ncdfc) {
+		SetErrMsg("Data set not initialized");
+		return(-1);
+	}
 
-	int fd = _ncdfc->OpenRead(ts, varname);
-	if (fd<0) return(fd);
+	int rc = _buildSpatialIndex();
+	if (rc<0) return(-1);
 
-	int rc = _ncdfc->Read(buf, fd);
-	if (rc<0) return(fd);
+	// Bins are indexed by cell and vertex centers. Grow the box by
+	// one bin so that elements straddling its boundary are included
+	//
+	double dlon = 360.0 / (double) _indexNLon;
+	double dlat = 180.0 / (double) _indexNLat;
 
-	return(_ncdfc->Close(fd));
+	int ilon0 = (int) floor((lonMin + 180.0) / dlon) - 1;
+	int ilon1 = (int) floor((lonMax + 180.0) / dlon) + 1;
+	int ilat0 = (int) floor((latMin + 90.0) / dlat) - 1;
+	int ilat1 = (int) floor((latMax + 90.0) / dlat) + 1;
+
+	ilat0 = max(ilat0, 0);
+	ilat1 = min(ilat1, (int) _indexNLat - 1);
+	if (ilon1 - ilon0 + 1 >= (int) _indexNLon) {
+		ilon0 = 0;
+		ilon1 = _indexNLon - 1;
+	}
+
+	size_t nCells = vproduct(_ncdfc->GetSpatialDims(lonCellVarName));
+	size_t nVertices = vproduct(_ncdfc->GetSpatialDims(lonVertexVarName));
+
+	cellMin = nCells;
+	vertexMin = nVertices;
+	for (int j=ilat0; j<=ilat1; j++) {
+	for (int i=ilon0; i<=ilon1; i++) {
+
+		// Longitude is periodic
+		//
+		int ii = (i + (int) _indexNLon) % (int) _indexNLon;
+		size_t bin = j * _indexNLon + ii;
+
+		cellMin = min(cellMin, _indexCellMin[bin]);
+		cellMax = max(cellMax, _indexCellMax[bin]);
+		vertexMin = min(vertexMin, _indexVertexMin[bin]);
+		vertexMax = max(vertexMax, _indexVertexMax[bin]);
+	}
+	}
+
+	if (cellMin > cellMax || vertexMin > vertexMax) {
+		SetErrMsg("No cells in region");
+		cellMin = cellMax = vertexMin = vertexMax = 0;
+		return(-1);
+	}
+
+	return(0);
 }
 
-// Read the longitude coordinates for cell and vertices. Need these
-// to split the periodic mesh
-//
-int DCMPAS::_readCoordinates(size_t ts) {
+int DCMPAS::ReadLatLonRegion(
+	int fd, double lonMin, double latMin, double lonMax, double latMax,
+	vector <size_t> &min, vector <size_t> &max, vector <float> &region
+) {
+	min.clear();
+	max.clear();
+	region.clear();
+
+    MPASFileObject *w = (MPASFileObject *) _fileTable.GetEntry(fd);
+
+    if (! w) {
+        SetErrMsg("Invalid file descriptor : %d", fd);
+        return(-1);
+    }
+	string varname = w->GetVarname();
+
+	vector <string> dimnames;
+	vector <size_t> dims;
+	bool ok = GetVarDimNames(varname, true, dimnames);
+	if (ok) ok = GetVarDimLens(varname, true, dims);
+	if (! ok) {
+		SetErrMsg("Undefined variable name : %s", varname.c_str());
+		return(-1);
+	}
+
+	if (dimnames.empty() ||
+		(dimnames[0] != nCellsDimName && dimnames[0] != nVerticesDimName)) {
+
+		SetErrMsg("Not a horizontal variable : %s", varname.c_str());
+		return(-1);
+	}
+
+	size_t cellMin, cellMax, vertexMin, vertexMax;
+	int rc = GetIndexExtents(
+		lonMin, latMin, lonMax, latMax, cellMin, cellMax, vertexMin, vertexMax
+	);
+	if (rc<0) return(-1);
+
+	// Horizontal extents from the spatial index, remaining dimensions
+	// in their entirety
+	//
+	for (int i=0; i<dims.size(); i++) {
+		min.push_back(0);
+		max.push_back(dims[i]-1);
+	}
+	if (dimnames[0] == nCellsDimName) {
+		min[0] = cellMin;
+		max[0] = cellMax;
+	}
+	else {
+		min[0] = vertexMin;
+		max[0] = vertexMax;
+	}
 
-	int rc = _readVarToSmartBuf(ts, lonCellVarName, _lonCellSmartBuf);
-	if (rc<0) return(rc);
+	size_t n = 1;
+	for (int i=0; i<min.size(); i++) n *= max[i] - min[i] + 1;
+	region.resize(n);
 
-	rc = _readVarToSmartBuf(ts, lonVertexVarName, _lonVertexSmartBuf);
-	if (rc<0) return(rc);
+	rc = _readRegionTemplate(fd, min, max, region.data());
+	if (rc<0) {
+		min.clear();
+		max.clear();
+		region.clear();
+		return(-1);
+	}
 
 	return(0);
 }
-	
+
 // MPAS uses an auxiliary array (the variable nEdgesOnCelll) to 
 // indicate the number of elements (edges or vertices) in
 // multi-dimensional arrays with varying dimension lengths. But DC uses 
 // a padding flag: -1. So using nEdgesOnCell we pad the fixed size
 // DC connectivity array with -1.
 //
-void DCMPAS::_addMissingFlag(int *data) const {
-
-	int *nEdgesOnCell = (int *) _nEdgesOnCellBuf.GetBuf();
-
-	DC::Dimension dimension;
-	bool ok = GetDimension(nCellsDimName, dimension);
-	assert(ok);
-
-	size_t nCells = dimension.GetLength();
-
-	ok = GetDimension(maxEdgesDimName, dimension);
-	assert(ok);
+int DCMPAS::_addMissingFlag(
+	const vector <size_t> &min, const vector <size_t> &max, int *data
+) {
 
-	size_t nMaxEdges = dimension.GetLength();
+	const int *nEdgesOnCell = _getStaticVar<int>(nEdgesOnCellVarName);
+	if (! nEdgesOnCell) return(-1);
 
-	// Add padding
+	// Add padding to the cells in the region
 	//
-	for (size_t j=0; j<nCells; j++) {
-		for (int i=nEdgesOnCell[j]; i<nMaxEdges; i++) {
-			data[j*nMaxEdges + i] = -1;
+	size_t n = max[0] - min[0] + 1;
+	for (size_t j=min[1]; j<=max[1]; j++) {
+		size_t i0 = std::max((size_t) nEdgesOnCell[j], min[0]);
+		for (size_t i=i0; i<=max[0]; i++) {
+			data[(j-min[1])*n + (i-min[0])] = -1;
 		}
 	}
+	return(0);
 }
 
 // MPAS data on sphere is periodic. But we're projecting the geographic
 // data to Cartesian coordinates. We need split the cells that straddle
 // the split location, here chose to be 180 (-180) degrees
 //
-void DCMPAS::_splitOnBoundary(string varname, int *connData) const {
+int DCMPAS::_splitOnBoundary(
+	string varname,
+	const vector <size_t> &min, const vector <size_t> &max, int *connData
+) {
 
 	vector <size_t> connDims;
 	bool ok = GetVarDimLens(varname, true, connDims);
@@ -706,15 +866,19 @@ void DCMPAS::_splitOnBoundary(string varname, int *connData) const {
 	ok = GetVarDimLens(lonCellVarName, true, lonCellDims);
 	assert(ok && lonCellDims.size() == 1);
 
-	float *lonBuf1 = NULL; 
-	float *lonBuf2 = NULL; 
+	const float *lonVertex = _getStaticVar<float>(lonVertexVarName);
+	const float *lonCell = _getStaticVar<float>(lonCellVarName);
+	if (! lonVertex || ! lonCell) return(-1);
+
+	const float *lonBuf1 = NULL; 
+	const float *lonBuf2 = NULL; 
 	if (connDims[1] == lonVertexDims[0]) {
-		lonBuf1 = (float *) _lonVertexSmartBuf.GetBuf();
-		lonBuf2 = (float *) _lonCellSmartBuf.GetBuf();
+		lonBuf1 = lonVertex;
+		lonBuf2 = lonCell;
 	}
 	else if (connDims[1] == lonCellDims[0]) {
-		lonBuf1 = (float *) _lonCellSmartBuf.GetBuf();
-		lonBuf2 = (float *) _lonVertexSmartBuf.GetBuf();
+		lonBuf1 = lonCell;
+		lonBuf2 = lonVertex;
 	}
 	else {
 		assert(0);
@@ -730,15 +894,18 @@ void DCMPAS::_splitOnBoundary(string varname, int *connData) const {
 	// are 0.0 .. 2*M_PI, as
 	// per the MPAS Mesh Specification, Version 1.0 (Oct. 8, 2015) document.
 	//
-	int n = connDims[0];
-	for (size_t j = 0; j<connDims[1]; j++) {
+	// Only the rows in the region are examined
+	//
+	size_t n = max[0] - min[0] + 1;
+	for (size_t j = min[1]; j<=max[1]; j++) {
+		int *row = connData + (j-min[1]) * n;
 		double lon1 = lonBuf1[j];
 
 		// Ha ha. despite MPAS documentation longitude may run -pi to pi
 		//
 		if (lon1 > M_PI) lon1 -= 2*M_PI;
-		for (size_t i=0; i<n && connData[j*n+i] >= 0; i++) {
-			size_t index = connData[j*n+i] - 1;	// Arrg. Index starts from 1!!
+		for (size_t i=0; i<n && row[i] >= 0; i++) {
+			size_t index = row[i] - 1;	// Arrg. Index starts from 1!!
 			double lon2 = lonBuf2[index];
 
 			// Ha ha. despite MPAS documentation longitude may run -pi to pi
@@ -748,10 +915,11 @@ void DCMPAS::_splitOnBoundary(string varname, int *connData) const {
 			// Ugh. Test for cell stradling -pi and pi
 			//
 			if (fabs(lon1-lon2) > M_PI * 0.5) {
-				connData[j*n+i] = -2;
+				row[i] = -2;
 			}
 		}
 	}
+	return(0);
 }
 	
 int DCMPAS::openVariableRead(
@@ -767,16 +935,6 @@ int DCMPAS::openVariableRead(
 	else {
 		aux = _ncdfc->OpenRead(ts, varname);
 		derivedFlag = false;
-
-		// Special handling for some auxiliary variables
-		//
-		if (varname == verticesOnCellVarName) {
-			if (_read_nEdgesOnCell(ts) < 0) return(-1);
-		}
-
-		if (is_connectivity_var(varname)) {
-			if (_readCoordinates(ts) < 0) return(-1);
-		}
 	}
 
 	MPASFileObject *w = new MPASFileObject(
@@ -830,10 +988,15 @@ int DCMPAS::_readRegionTransposed(
 	float *buf = new float[vproduct(ncdf_count)];
 
 	int rc = _ncdfc->Read(ncdf_start, ncdf_count, buf, aux);
-	if (rc<0) return(-1);
+	if (rc<0) {
+		delete [] buf;
+		return(-1);
+	}
 
 	Wasp::Transpose(buf, region, ncdf_count[1], ncdf_count[0]);
 
+	delete [] buf;
+
 	return(0);
 }
 
@@ -844,55 +1007,73 @@ int DCMPAS::_readRegionEdgeVariable(
 	assert(min.size() == 2);
 	assert(min.size() == max.size());
 
-	vector <size_t> dims = _ncdfc->GetDims(edgesOnVertexVarName);
-	int *edgesOnVertex =  new int[vproduct(dims)];
-	int rc = _getVar(w->GetTS(), edgesOnVertexVarName, edgesOnVertex);
-	if (rc<0) {
-		delete [] edgesOnVertex;
-		return(-1);
-	}
+	const int *edgesOnVertex = _getStaticVar<int>(edgesOnVertexVarName);
+	if (! edgesOnVertex) return(-1);
 
+	vector <size_t> dims = _ncdfc->GetDims(edgesOnVertexVarName);
 	size_t vertexDegree = dims[1];
 	assert(vertexDegree == 3);
 
-	string varname = w->GetVarname();
+	// Find the range of edges adjacent to the requested vertices so
+	// that only that part of the edge variable is read. Vertices on
+	// the boundary of a non-periodic mesh have missing edges, marked
+	// with 0
+	//
+	int offset = -1;	// indexing in MPAS starts from 1
+	long edgeMin = -1;
+	long edgeMax = -1;
+	for (size_t i=min[0]; i<=max[0]; i++) {
+	for (size_t k=0; k<vertexDegree; k++) {
+		long eidx = edgesOnVertex[i*vertexDegree + k] + offset;
+		if (eidx < 0) continue;
+		if (edgeMin < 0 || eidx < edgeMin) edgeMin = eidx;
+		if (edgeMax < 0 || eidx > edgeMax) edgeMax = eidx;
+	}
+	}
+	if (edgeMin < 0) {
+		SetErrMsg("Invalid connectivity : %s", edgesOnVertexVarName.c_str());
+		return(-1);
+	}
 
 	// Don't need to reverse dims because we have to do a tranpose anyway
 	//
-	dims = _ncdfc->GetSpatialDims(varname);
-	float *edgeVariable =  new float[vproduct(dims)];
+	vector <size_t> edgeStart, edgeEnd;
+	edgeStart.push_back(edgeMin);
+	edgeStart.push_back(min[1]);
+	edgeEnd.push_back(edgeMax);
+	edgeEnd.push_back(max[1]);
 
+	size_t ne = edgeMax - edgeMin + 1;
+	size_t nx = max[0] - min[0] + 1;
+	size_t ny = max[1] - min[1] + 1;
 
-	vector <size_t> minAll, maxAll;
-	for (int i=0; i<dims.size(); i++) {
-		minAll.push_back(0);
-		maxAll.push_back(dims[i]-1);
-	}
-		
-	rc = _readRegionTransposed(w, minAll, maxAll, edgeVariable);
+	float *edgeVariable =  new float[ne * ny];
+
+	int rc = _readRegionTransposed(w, edgeStart, edgeEnd, edgeVariable);
 	if (rc<0) {
-		delete [] edgesOnVertex;
 		delete [] edgeVariable;
 		return(-1);
 	}
 
-
-	float wgt = 1.0 / (float) vertexDegree;
-	for (size_t j=min[1]; j<=max[1]; j++) {
+	// Average over the edges that exist
+	//
+	for (size_t j=0; j<ny; j++) {
 	for (size_t i=min[0], ii=0; i<= max[0]; i++, ii++) {
+		const int *edges = edgesOnVertex + i*vertexDegree;
+
+		float sum = 0.0;
+		int n = 0;
+		for (size_t k=0; k<vertexDegree; k++) {
+			long eidx = edges[k] + offset;
+			if (eidx < 0) continue;
+			sum += edgeVariable[j*ne + eidx - edgeMin];
+			n++;
+		}
 
-		size_t vidx0 = edgesOnVertex[i*vertexDegree + 0] - 1;
-		size_t vidx1 = edgesOnVertex[i*vertexDegree + 1] - 1;
-		size_t vidx2 = edgesOnVertex[i*vertexDegree + 2] - 1;
-
-		region[ii] = 
-			edgeVariable[j*dims[0] + vidx0] * wgt + 
-			edgeVariable[j*dims[0] + vidx1] * wgt + 
-			edgeVariable[j*dims[0] + vidx2] * wgt;
+		region[j*nx + ii] = n ? sum / (float) n : 0.0;
 	}
 	}
 
-	delete [] edgesOnVertex;
 	delete [] edgeVariable;
 
 
@@ -958,11 +1139,13 @@ int DCMPAS::_readRegionTemplate(
 	// Special handling for some auxiliary variables
 	//
 	if (varname == verticesOnCellVarName) {
-		_addMissingFlag((int *) region);
+		rc = _addMissingFlag(min, max, (int *) region);
+		if (rc<0) return(-1);
 	}
 
 	if (is_connectivity_var(varname)) {
-		_splitOnBoundary(varname, (int *) region);
+		rc = _splitOnBoundary(varname, min, max, (int *) region);
+		if (rc<0) return(-1);
 	}
 
 	return(0);
@@ -1605,7 +1788,7 @@ bool DCMPAS::_isDataVar(string varname) const {
 
 
 DCMPAS::DerivedCoordVertFromCell::DerivedCoordVertFromCell(
-	string derivedVarName, string derivedDimName, DC *dc, string inName,
+	string derivedVarName, string derivedDimName, DCMPAS *dc, string inName,
 	string cellsOnVertexName
 
 ) : DerivedCoordVar(
@@ -1705,118 +1888,92 @@ int DCMPAS::DerivedCoordVertFromCell::CloseVariable(int fd) {
 }
 
 
-float *DCMPAS::DerivedCoordVertFromCell::_getCellData() {
-
-	// Dimensions of input (cell) grid: 
-	//
-	vector <size_t> inDims, inBS;
-	int rc = _dc->GetDimLensAtLevel(_inName, -1, inDims, inBS);
-	if (rc<0) return(NULL);
-
-	vector <size_t> inMin, inMax;
-	for (int i=0; i<inDims.size(); i++) {
-		inMin.push_back(0);
-		inMax.push_back(inDims[i]-1);
-	}
-
-	float *buf = new float[vproduct(inDims)];
+int DCMPAS::DerivedCoordVertFromCell::ReadRegion(
+	int fd,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+) {
 
-	rc = _getVar(_dc, 0, _inName, -1, -1, inMin, inMax, buf);
-	if (rc<0) {
-		delete [] buf;
-		return(NULL);
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+	if (! f) {
+		SetErrMsg("Invalid file descriptor : %d", fd);
+		return(-1);
 	}
 
-	return(buf);
-}
-
-int *DCMPAS::DerivedCoordVertFromCell::_getCellsOnVertex(
-	size_t i0, size_t i1, int &vertexDegree
-) {
-	vertexDegree = 0;
+	// Connectivity is static and cached by the DCMPAS class
+	//
+	const int *cellsOnVertex = _dc->_getStaticVar<int>(_cellsOnVertexName);
+	if (! cellsOnVertex) return(-1);
 
 	vector <size_t> dims;
 	bool ok = _dc->GetVarDimLens(_cellsOnVertexName, true, dims);
 	if (!ok) {
 		SetErrMsg("Undefined variable name : %s", _cellsOnVertexName.c_str());
-		return(NULL);
+		return(-1);
 	}
+	size_t vertexDegree = dims[0];
 
-	int fd = _dc->OpenVariableRead(0, _cellsOnVertexName, 0, 0);
-
-	vertexDegree = dims[0];
-
-	int *buf = new int[(i1-i0+1) * vertexDegree];
+	// only handle triangles for dual mesh
+	//
+	assert(vertexDegree == 3);	
 
-	vector <size_t> min, max;
-	min.push_back(0);
-	min.push_back(i0);
-	max.push_back(vertexDegree-1);
-	max.push_back(i1);
+	size_t ny = min.size() >= 2 ? max[1] - min[1] + 1 : 1;
+	size_t nx = min.size() >= 1 ? max[0] - min[0] + 1 : 1;
 
-	int rc = _dc->ReadRegion(fd, min,  max, buf);
-	if (rc<0) {
-		delete [] buf;
-		return(NULL);
+	// Find the range of cells surrounding the requested vertices. Only
+	// that part of the cell grid is read.
+	//
+	int offset = -1;	// indexing in MPAS starts from 1
+	long cellMin = -1;
+	long cellMax = -1;
+	for (size_t i=min[0]; i<=max[0]; i++) {
+	for (size_t k=0; k<vertexDegree; k++) {
+		long cidx = cellsOnVertex[i*vertexDegree + k] + offset;
+		if (cidx < 0) continue;
+		if (cellMin < 0 || cidx < cellMin) cellMin = cidx;
+		if (cellMax < 0 || cidx > cellMax) cellMax = cidx;
+	}
+	}
+	if (cellMin < 0) {
+		SetErrMsg("Invalid connectivity : %s", _cellsOnVertexName.c_str());
+		return(-1);
 	}
 
-	_dc->CloseVariable(fd);
-
-	return(buf);
-}
-
-
-int DCMPAS::DerivedCoordVertFromCell::ReadRegion(
-	int fd,
-    const vector <size_t> &min, const vector <size_t> &max, float *region
-) {
-
-	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
-
-	string varname = f->GetVarname();
-
-
-	float *cellData = _getCellData();
-	if (! cellData) return(-1);
+	vector <size_t> inMin = min;
+	vector <size_t> inMax = max;
+	inMin[0] = cellMin;
+	inMax[0] = cellMax;
+	size_t nc = cellMax - cellMin + 1;
 
-	int vertexDegree;
-	int *cellsOnVertex = _getCellsOnVertex(min[0], max[0], vertexDegree);
+	float *cellData = new float[nc * ny];
 
-	// only handle triangles for dual mesh
-	//
-	assert(vertexDegree == 3);	
-
-	if (! cellsOnVertex) {
+	int rc = _getVar(_dc, f->GetTS(), _inName, -1, -1, inMin, inMax, cellData);
+	if (rc<0) {
 		delete [] cellData;
 		return(-1);
 	}
 
-	size_t ny = min.size() >= 2 ? max[1] - min[1] + 1 : 1;
-	size_t nx = min.size() >= 1 ? max[0] - min[0] + 1 : 1;
-
-
-	// Interpolation weights. Assume interpolated sample is at geometric
-	// center of triangle
+	// Interpolated sample is at geometric center of the triangle. 
+	// Vertices on the boundary of a non-periodic mesh have fewer than 
+	// three cells
 	//
-	float wgt0 = 1.0 / 3.0;
-	float wgt1 = 1.0 / 3.0;
-	float wgt2 = 1.0 / 3.0;
-
-	int offset = -1;	// indexing in MPAS starts from -1
 	for (size_t j=0; j<ny; j++) {
 	for (size_t i=0; i<nx; i++) {
-		float v0 = cellData[j*nx + cellsOnVertex[i*vertexDegree + 0] + offset];
-		float v1 = cellData[j*nx + cellsOnVertex[i*vertexDegree + 1] + offset];
-		float v2 = cellData[j*nx + cellsOnVertex[i*vertexDegree + 2] + offset];
-
+		const int *cells = cellsOnVertex + (min[0] + i) * vertexDegree;
+
+		float sum = 0.0;
+		int n = 0;
+		for (size_t k=0; k<vertexDegree; k++) {
+			long cidx = cells[k] + offset;
+			if (cidx < 0) continue;
+			sum += cellData[j*nc + cidx - cellMin];
+			n++;
+		}
 		
-		region[j*nx+i] = v0*wgt0 + v1*wgt1 + v2*wgt2;
+		region[j*nx+i] = n ? sum / (float) n : 0.0;
 	}
 	}
 
-
 	delete [] cellData;
-	delete [] cellsOnVertex;
 
 	return(0);
 }
@@ -465,6 +465,48 @@ int DCWRF::_readRegionTemplate(
     return(_ncdfc->Read(ncdf_start, ncdf_count, region, aux));
 }
 
+int DCWRF::readTimeSeries(
+	string varname, int level, int lod, size_t ts0, size_t ts1,
+    const vector <size_t> &min, const vector <size_t> &max, float *region
+) {
+	assert(min.size() == max.size());
+
+	if (_dvm.IsCoordVar(varname)) {
+		return(DC::readTimeSeries(
+			varname, level, lod, ts0, ts1, min, max, region
+		));
+	}
+
+	if (ts0 > ts1) {
+		SetErrMsg("Invalid time step range : %d, %d", ts0, ts1);
+		return(-1);
+	}
+	if (ts0 >= _ncdfc->GetNumTimeSteps() || ts1 >= _ncdfc->GetNumTimeSteps()) {
+		SetErrMsg("Time step out of range : %d, %d", ts0, ts1);
+		return(-1);
+	}
+
+	vector <size_t> timesteps;
+	for (size_t ts = ts0; ts <= ts1; ts++) {
+		timesteps.push_back(_derivedTime->TimeLookup(ts));
+	}
+
+	vector <size_t> ncdf_start = min;
+	reverse(ncdf_start.begin(), ncdf_start.end());
+
+	vector <size_t> ncdf_max = max;
+	reverse(ncdf_max.begin(), ncdf_max.end());
+
+	vector <size_t> ncdf_count;
+	for (int i=0; i<ncdf_start.size(); i++) {
+		ncdf_count.push_back(ncdf_max[i] - ncdf_start[i] + 1);
+	}
+
+	return(_ncdfc->ReadTimeSeries(
+		timesteps, varname, ncdf_start, ncdf_count, region
+	));
+}
+
 bool DCWRF::variableExists(
 	size_t ts, string varname, int, int 
 ) const {
@@ -6,6 +6,7 @@
 #include <cfloat>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <type_traits>
 #include <vapor/GeoUtil.h>
 #include <vapor/VDCNetCDF.h>
@@ -14,6 +15,7 @@
 #include <vapor/DCMPAS.h>
 #include <vapor/DerivedVar.h>
 #include <vapor/DataMgr.h>
+#include <vapor/vizutil.h>
 #ifdef WIN32
 #include <float.h>
 #endif
@@ -66,142 +68,41 @@ vector <size_t> decimate_dims(const vector <size_t> &dims, int l) {
 	return(new_dims);
 }
 
-// Decimate a 1D array with simple averaging. 
+// Execution thread state for parallel decimation. Each thread decimates
+// a contiguous range of blocks
 //
 template <typename T>
-void decimate1d(
-	const vector <size_t> &src_bs, const T *src, T *dst
-) {
-	assert(src_bs.size() == 1);
-
-	vector <size_t> dst_bs;
-	for (int i=0; i<src_bs.size(); i++) {
-		dst_bs.push_back(decimate_length(src_bs[i]));
-	}
-
-	size_t ni0 = src_bs[0];
-
-	size_t ni1 = dst_bs[0];
-
-	for (size_t i=0; i<ni1; i++) {
-		dst[i] = 0.0;
-	}
-
-	// Perform in-place 4-node averaging, handling odd boundary cases
-	//
-	for (size_t i=0, ii=0; i<ni0; i++) {
-		float iwgt = 0.5;
-		if (i==ni0-1 && ni0 % 2) iwgt = 1.0;	// odd i boundary
-		float w = iwgt;
-
-		assert(w <= 1.0);
-
-		dst[ii] += w * src[i];
-		if (i % 2) ii++;
-	}
-}
-
-template <typename T>
-void decimate2d(
-	const vector <size_t> &src_bs, const T *src, T *dst
-) {
-	assert(src_bs.size() == 2);
-
-	vector <size_t> dst_bs;
-	for (int i=0; i<src_bs.size(); i++) {
-		dst_bs.push_back(decimate_length(src_bs[i]));
-	}
-
-	size_t ni0 = src_bs[0];
-	size_t nj0 = src_bs[1];
-
-	size_t ni1 = dst_bs[0];
-	size_t nj1 = dst_bs[1];
-
-	for (size_t j=0; j<nj1; j++) {
-	for (size_t i=0; i<ni1; i++) {
-		dst[j*ni1 + i] = 0.0;
-	}
-	}
-
-	// Perform in-place 4-node averaging, handling odd boundary cases
-	//
-	for (size_t j=0, jj=0; j<nj0; j++) {
-		float jwgt = 0.0;
-		if (j==nj0-1 && nj0 % 2) jwgt = 0.25;	// odd j boundary
-
-		for (size_t i=0, ii=0; i<ni0; i++) {
-			float iwgt = 0.25;
-			if (i==ni0-1 && ni0 % 2) iwgt = 0.5;	// odd i boundary
-			float w = iwgt + jwgt;
-
-			assert(w <= 1.0);
-
-			dst[jj*ni1 + ii] += w * src[j*ni0 + i];
-			if (i % 2) ii++;
-		}
-		if (j % 2) jj++;
-	}
-}
-
+class decimate_state {
+public:
+ size_t _ni0, _nj0, _nk0;
+ const T *_src;
+ T *_dst;
+ size_t _src_block_size;
+ size_t _dst_block_size;
+ size_t _offset;
+ size_t _nblocks;
+};
 
 template <typename T>
-void decimate3d(
-	const vector <size_t> &src_bs, const T *src, T *dst
-) {
-	assert(src_bs.size() == 3);
-
-	vector <size_t> dst_bs;
-	for (int i=0; i<src_bs.size(); i++) {
-		dst_bs.push_back(decimate_length(src_bs[i]));
-	}
-
-	size_t ni0 = src_bs[0];
-	size_t nj0 = src_bs[1];
-	size_t nk0 = src_bs[2];
-
-	size_t ni1 = dst_bs[0];
-	size_t nj1 = dst_bs[1];
-	size_t nk1 = dst_bs[2];
-
-	for (size_t k=0; k<nk1; k++) {
-	for (size_t j=0; j<nj1; j++) {
-	for (size_t i=0; i<ni1; i++) {
-		dst[k*ni1*nj1 + j*ni1 + i] = 0.0;
-	}
-	}
-	}
-
-	// Perform in-place 8-node averaging, handling odd boundary cases
-	//
-	for (size_t k=0, kk=0; k<nk0; k++) {
-		float kwgt = 0.0;
-		if (k==nk0-1 && nk0 % 2) kwgt = 0.125;	// odd k boundary
-
-		for (size_t j=0, jj=0; j<nj0; j++) {
-			float jwgt = 0.0;
-			if (j==nj0-1 && nj0 % 2) jwgt = 0.125;	// odd j boundary
-
-			for (size_t i=0, ii=0; i<ni0; i++) {
-				float iwgt = 0.125;
-				if (i==ni0-1 && ni0 % 2) iwgt = 0.25;	// odd i boundary
-				float w = iwgt + jwgt + kwgt;
-
-				assert(w <= 1.0);
+void *RunDecimateThread(void *arg) {
+	decimate_state <T> &s = *(decimate_state <T> *) arg;
 
-				dst[kk*ni1*nj1 + jj*ni1 + ii] += w * src[k*ni0*nj0 + j*ni0 + i];
-				if (i % 2) ii++;
-			}
-			if (j % 2) jj++;
-		}
-		if (k % 2) kk++;
+	const T *src = s._src + s._offset * s._src_block_size;
+	T *dst = s._dst + s._offset * s._dst_block_size;
+	for (size_t i=0; i<s._nblocks; i++) {
+		DecimateBlock(s._ni0, s._nj0, s._nk0, src, dst);
+		src += s._src_block_size;
+		dst += s._dst_block_size;
 	}
+	return(0);
 }
 
-// Perform decimation of a 1D, 2D, or 3D blocked array
+// Perform decimation of a 1D, 2D, or 3D blocked array. Blocks are
+// divided among the threads of 'et'
 //
 template <typename T>
-void decimate(
+int decimate(
+	EasyThreads *et,
 	const vector <size_t> &bmin, const vector <size_t> &bmax, 
 	const vector <size_t> &src_bs, const T *src, T *dst
 ) {
@@ -210,40 +111,45 @@ void decimate(
 	assert(src_bs.size() >= 1 && src_bs.size() <= 3);
 
 	vector <size_t> dst_bs;
+	size_t nblocks = 1;
 	for (int i=0; i<src_bs.size(); i++) {
 		dst_bs.push_back(decimate_length(src_bs[i]));
+		nblocks *= bmax[i] - bmin[i] + 1;
+	}
+
+	decimate_state <T> s;
+	s._ni0 = src_bs[0];
+	s._nj0 = src_bs.size() > 1 ? src_bs[1] : 1;
+	s._nk0 = src_bs.size() > 2 ? src_bs[2] : 1;
+	s._src = src;
+	s._dst = dst;
+	s._src_block_size = vproduct(src_bs);
+	s._dst_block_size = vproduct(dst_bs);
+	s._offset = 0;
+	s._nblocks = nblocks;
+
+	int nthreads = et ? et->GetNumThreads() : 1;
+	if (nthreads <= 1 || nblocks == 1) {
+		RunDecimateThread<T>(&s);
+		return(0);
 	}
 
-	size_t src_block_size = vproduct(src_bs);
-	size_t dst_block_size = vproduct(dst_bs);
-
-	if (src_bs.size() == 1) {
-		for (int i=bmin[0]; i<= bmax[0]; i++) {
-			decimate1d(src_bs, src, dst);
-			src += src_block_size;
-			dst += dst_block_size;
-		}
+	vector <decimate_state <T> > states(nthreads, s);
+	vector <void *> argvec;
+	for (int i=0; i<nthreads; i++) {
+		int offset, length;
+		EasyThreads::Decompose(nblocks, nthreads, i, &offset, &length);
+		states[i]._offset = offset;
+		states[i]._nblocks = length;
+		argvec.push_back((void *) &states[i]);
 	}
-	else if (src_bs.size() == 2) {
-		for (int j=bmin[1]; j<= bmax[1]; j++) {
-		for (int i=bmin[0]; i<= bmax[0]; i++) {
-			decimate2d(src_bs, src, dst);
-			src += src_block_size;
-			dst += dst_block_size;
-		}
-		}
-	}
-	else {
-		for (int k=bmin[2]; k<= bmax[2]; k++) {
-		for (int j=bmin[1]; j<= bmax[1]; j++) {
-		for (int i=bmin[0]; i<= bmax[0]; i++) {
-			decimate3d(src_bs, src, dst);
-			src += src_block_size;
-			dst += dst_block_size;
-		}
-		}
-		}
+
+	int rc = et->ParRun(RunDecimateThread<T>, argvec);
+	if (rc < 0) {
+		MyBase::SetErrMsg("Error spawning threads");
+		return(-1);
 	}
+	return(0);
 }
 
 
@@ -328,6 +234,10 @@ void coord_setup_helper(
 };
 
 
+vector <DataMgr *> DataMgr::_instances;
+unsigned long DataMgr::_accessClock = 0;
+std::recursive_mutex DataMgr::_cacheMutex;
+
 DataMgr::DataMgr(
 	string format,
 	size_t mem_size,
@@ -349,6 +259,13 @@ DataMgr::DataMgr(
 
 	_blk_mem_mgr = NULL;
 
+	{
+		std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
+		_instances.push_back(this);
+	}
+
+	_et = new EasyThreads(_nthreads);
+
 	_PipeLines.clear();
 
 	_regionsList.clear();
@@ -372,9 +289,21 @@ DataMgr::~DataMgr(
 
 
 	Clear();
-	if (_blk_mem_mgr) delete _blk_mem_mgr;
 
-	_blk_mem_mgr = NULL;
+	{
+		std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
+
+		if (_blk_mem_mgr) delete _blk_mem_mgr;
+
+		_blk_mem_mgr = NULL;
+
+		_instances.erase(
+			std::find(_instances.begin(), _instances.end(), this)
+		);
+	}
+
+	if (_et) delete _et;
+	_et = NULL;
 
 	vector <string> names = _dvm.GetDataVarNames();
 	for (int i=0; i<names.size(); i++) {
@@ -741,7 +670,8 @@ size_t DataMgr::GetNumRefLevels(string varname) const {
 
 	if (varname == "") return 1;
 
-	if (IsVariableDerived(varname)) return(1);
+	DerivedVar *dvar = _getDerivedVar(varname);
+	if (dvar) return(dvar->GetNumRefLevels());
 
 	return(_dc->GetNumRefLevels(varname));
 }
@@ -756,9 +686,19 @@ vector <size_t> DataMgr::GetCRatios(string varname) const {
 	return (var.GetCRatios());
 }
 
+bool DataMgr::GetErrorBound(
+	string varname, double &max_error, bool &relative
+) const {
+	assert(_dc);
+
+	return(_dc->GetErrorBound(varname, max_error, relative));
+}
+
 Grid *DataMgr::GetVariable (
 	size_t ts, string varname, int level, int lod, bool lock
 ) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	SetDiagMsg(
 		"DataMgr::GetVariable(%d,%s,%d,%d,%d, %d)",
 		ts,varname.c_str(), level, lod, lock
@@ -785,6 +725,8 @@ Grid *DataMgr::GetVariable (
 	size_t ts, string varname, int level, int lod,
     vector <double> min, vector <double> max, bool lock
 ) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	assert(min.size() == max.size());
 
 	SetDiagMsg(
@@ -1340,6 +1282,8 @@ Grid *DataMgr::GetVariable(
 	vector <size_t> max,
 	bool	lock
 ) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	assert(min.size() == max.size());
 
 	SetDiagMsg(
@@ -1378,10 +1322,94 @@ Grid *DataMgr::GetVariable(
 	return(rg);
 }
 
+int DataMgr::GetTimeSeries(
+	size_t ts0, size_t ts1, string varname, int level, int lod,
+	vector <size_t> min, vector <size_t> max, vector <float> &data
+) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
+	assert(min.size() == max.size());
+
+	SetDiagMsg(
+		"DataMgr::GetTimeSeries(%d, %d, %s, %d, %d, %s, %s)",
+		ts0, ts1, varname.c_str(), level, lod, 
+		vector_to_string(min).c_str(), vector_to_string(max).c_str()
+	);
+
+	data.clear();
+
+	if (ts1 < ts0) {
+		SetErrMsg("Invalid time step range : %d, %d", ts0, ts1);
+		return(-1);
+	}
+
+	int rc = _level_correction(varname, level);
+	if (rc<0) return(-1);
+
+	rc = _lod_correction(varname, lod);
+	if (rc<0) return(-1);
+
+	vector <size_t> dims_at_level;
+	vector <size_t> bs_at_level;
+	rc = DataMgr::GetDimLensAtLevel(
+		varname, level, dims_at_level, bs_at_level
+	);
+	if (rc<0) return(-1);
+
+	while (min.size() > dims_at_level.size()) {
+		min.pop_back();
+		max.pop_back();
+	}
+
+	size_t n = 1;
+	for (int i=0; i<dims_at_level.size(); i++) {
+		if (i >= min.size() || min[i] > max[i] || max[i] >= dims_at_level[i]) {
+			SetErrMsg(
+				"Invalid region for variable %s : %s, %s", varname.c_str(),
+				vector_to_string(min).c_str(), vector_to_string(max).c_str()
+			);
+			return(-1);
+		}
+		n *= max[i] - min[i] + 1;
+	}
+	data.resize((ts1 - ts0 + 1) * n);
+
+	DerivedVar *derivedVar = _getDerivedVar(varname);
+	if (! derivedVar) {
+		rc = _dc->ReadTimeSeries(
+			varname, level, lod, ts0, ts1, min, max, data.data()
+		);
+		if (rc<0) data.clear();
+		return(rc);
+	}
+
+	// Derived variables are computed a time step at a time. Their
+	// ReadRegion() computes the covering blocks and copies out the
+	// region
+	//
+	for (size_t ts = ts0; ts <= ts1; ts++) {
+		int fd = _openVariableRead(ts, varname, level, lod);
+		if (fd<0) {
+			data.clear();
+			return(-1);
+		}
+
+		rc = _readRegion(fd, min, max, data.data() + (ts - ts0) * n);
+		(void) _closeVariable(fd);
+		if (rc<0) {
+			data.clear();
+			return(-1);
+		}
+	}
+	return(0);
+}
+
 int DataMgr::GetVariableExtents(
     size_t ts, string varname, int level,
     vector <double> &min , vector <double> &max
 ) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	min.clear();
 	max.clear();
 
@@ -1427,6 +1455,8 @@ int DataMgr::GetDataRange(
 	int lod,
 	vector <double> &range
 ) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	SetDiagMsg("DataMgr::GetDataRange(%d,%s)", ts, varname.c_str());
 	range.clear();
 
@@ -1499,6 +1529,7 @@ int DataMgr::GetDimLensAtLevel(
 #ifdef	VAPOR3_0_0_ALPHA
 
 int	DataMgr::NewPipeline(PipeLine *pipeline) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
 
 	//
 	// Delete any pipeline stage with the same name as the new one. This
@@ -1581,6 +1612,7 @@ int	DataMgr::NewPipeline(PipeLine *pipeline) {
 }
 
 void	DataMgr::RemovePipeline(string name) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
 
 	vector <PipeLine *>::iterator itr;
 	for (itr = _PipeLines.begin(); itr != _PipeLines.end(); itr++) {
@@ -1643,6 +1675,8 @@ vector <string> DataMgr::_get_var_dependencies(string varname) const {
 bool DataMgr::VariableExists(
     size_t ts, string varname, int level, int lod
 ) const {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	if (varname.empty()) return (false);
 
     // disable error reporting
@@ -1738,18 +1772,59 @@ bool DataMgr::IsVariableDerived(string name) const {
 	return(_getDerivedVar(name) != NULL);
 }
 
+int DataMgr::AddDerivedVar(DerivedDataVar *derivedVar) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
+	assert(_dc);
+
+	string name = derivedVar->GetName();
+
+	if (IsVariableNative(name) || IsVariableDerived(name)) {
+		SetErrMsg("Variable %s already exists", name.c_str());
+		return(-1);
+	}
+
+	int rc = derivedVar->Initialize();
+	if (rc<0) {
+		SetErrMsg("Failed to initialize derived data variable %s", name.c_str());
+		return(-1);
+	}
+
+	_dvm.AddDataVar(derivedVar);
+
+	return(0);
+}
+
+void DataMgr::RemoveDerivedVar(string varname) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
+	DerivedDataVar *derivedVar = _getDerivedDataVar(varname);
+	if (! derivedVar) return;
+
+	_free_var(varname);
+	_varInfoCache.PurgeVariable(varname);
+
+	_dvm.RemoveVar(derivedVar);
+	delete derivedVar;
+}
+
 void	DataMgr::Clear() {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
 
 	_PipeLines.clear();
 
-	list <region_t>::iterator itr;
-	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
-		const region_t &region = *itr;
+	{
+		std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
 
-		if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
-			
+		list <region_t>::iterator itr;
+		for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
+			const region_t &region = *itr;
+
+			if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
+				
+		}
+		_regionsList.clear();
 	}
-	_regionsList.clear();
 
 	vector <string> hash = _varInfoCache.GetVoidPtrHash();
 	for (int i=0; i<hash.size(); i++) {
@@ -1768,6 +1843,8 @@ void	DataMgr::Clear() {
 void	DataMgr::UnlockGrid(
 	const Grid *rg
 ) {
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	SetDiagMsg("DataMgr::UnlockGrid()");
 	const vector <float *> &blks = rg->GetBlks();
 	if (blks.size()) _unlock_blocks(blks[0]);
@@ -1828,6 +1905,7 @@ T	*DataMgr::_get_region_from_cache(
 	const vector <size_t> &bmax,
 	bool	lock
 ) {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
 
 	list <region_t>::iterator itr;
 	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
@@ -1844,6 +1922,7 @@ T	*DataMgr::_get_region_from_cache(
 			region.lock_counter += lock ? 1 : 0;
 
 			// Move region to front of list
+			region.stamp = ++_accessClock;
 			region_t tmp_region = region;
 			_regionsList.erase(itr);
 			_regionsList.push_back(tmp_region);
@@ -1866,8 +1945,12 @@ T *DataMgr::_get_region_from_fs(
 	const vector <size_t> &bmax, bool lock
 ) {
 
+	// Lock the region while it's being read. Derived variables may
+	// request their inputs from this DataMgr, which could otherwise
+	// evict the region before it's filled
+	//
 	T *blks = (T *) _alloc_region(
-		ts, varname, level, lod, bmin, bmax, bs, sizeof(T), lock, false
+		ts, varname, level, lod, bmin, bmax, bs, sizeof(T), true, false
 	);
 	if (! blks) return(NULL);
 
@@ -1891,16 +1974,22 @@ T *DataMgr::_get_region_from_fs(
 	}
 
 	int fd = _openVariableRead(ts, varname, level, lod);
-    if (fd < 0) return(NULL);
+    if (fd < 0) {
+		_unlock_blocks(blks);
+		_free_region(ts,varname ,level,lod,bmin,bmax);
+		return(NULL);
+	}
 
 	int rc = _readRegionBlock(fd, min, max, blks);
     if (rc < 0) {
+		_unlock_blocks(blks);
 		_free_region(ts,varname ,level,lod,bmin,bmax);
 		_closeVariable(fd); 
 		return(NULL);
 	}
 
 	rc = _closeVariable(fd); 
+	if (! lock) _unlock_blocks(blks);
 	if (rc<0) return(NULL);
 
 	SetDiagMsg("DataMgr::GetGrid() - data read from fs\n");
@@ -1931,14 +2020,20 @@ T *DataMgr::_get_region(
 	);
 	if (! blks ) {
 
-		// If level not available we recursively decimate
+		// If level not available we recursively decimate. The 
+		// synthesized region is cached like any other, but marked
+		// as derived so that it is evicted before regions read from
+		// disk
 		//
 		if (level < -nlevels) {
 			level++;
 
+			// Lock the finer region so that it isn't evicted to make
+			// room for the decimated one
+			//
 			blks = _get_region<T>(
 				ts, varname, level, nlevels, lod, nlods,
-				bs, bmin, bmax, false
+				bs, bmin, bmax, true
 			);
 			if (blks) {
 				vector <size_t> bs_at_level = decimate_dims(bs, -level - 1);
@@ -1946,11 +2041,20 @@ T *DataMgr::_get_region(
 
 				T *newblks = (T *) _alloc_region(
 					ts, varname, level-1, lod, bmin, bmax, bs_at_level_m1, 
-					sizeof(T), false, false
+					sizeof(T), lock, false, true
 				);
-				if (! newblks) return(NULL);
-
-				decimate(bmin, bmax, bs_at_level, blks, newblks); 
+				if (! newblks) {
+					_unlock_blocks(blks);
+					return(NULL);
+				}
+
+				int rc = decimate(_et, bmin, bmax, bs_at_level, blks, newblks); 
+				_unlock_blocks(blks);
+				if (rc<0) {
+					if (lock) _unlock_blocks(newblks);
+					_free_region(ts, varname, level-1, lod, bmin, bmax);
+					return(NULL);
+				}
 				return(newblks);
 			}
 		} 
@@ -2042,8 +2146,11 @@ void	*DataMgr::_alloc_region(
 	vector <size_t> bs,
 	int element_sz,
 	bool	lock,
-	bool fill
+	bool fill,
+	bool derived
 ) {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
+
 	assert(bmin.size() == bmax.size());
 	assert(bmin.size() == bs.size());
 
@@ -2088,6 +2195,9 @@ void	*DataMgr::_alloc_region(
 	region.bmin = bmin;
 	region.bmax = bmax;
 	region.lock_counter = lock ? 1 : 0;
+	region.derived = derived;
+	region.nblks = nblocks;
+	region.stamp = ++_accessClock;
 	region.blks = blks;
 
 	_regionsList.push_back(region);
@@ -2103,6 +2213,7 @@ void	DataMgr::_free_region(
 	vector <size_t> bmin,
 	vector <size_t> bmax
 ) {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
 
 	list <region_t>::iterator itr;
 	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
@@ -2129,6 +2240,7 @@ void	DataMgr::_free_region(
 
 
 void	DataMgr::_free_var(string varname) {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
 
 	list <region_t>::iterator itr;
 	for(itr = _regionsList.begin(); itr!=_regionsList.end(); ) {
@@ -2149,16 +2261,44 @@ void	DataMgr::_free_var(string varname) {
 
 bool	DataMgr::_free_lru(
 ) {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
+
+	// Each instance's list is ordered from least to most recently 
+	// used, so the first unlocked region of each list is that instance's 
+	// eviction candidate. The pool is shared, so free the oldest 
+	// candidate across all instances. Derived regions are freed first 
+	// since they can be rebuilt without going to disk
+	//
+	for (int pass=0; pass<2; pass++) {
+		DataMgr *victim = NULL;
+		list <region_t>::iterator victimItr;
+
+		for (int i=0; i<_instances.size(); i++) {
+			DataMgr *dm = _instances[i];
+
+			list <region_t>::iterator itr;
+			for(itr = dm->_regionsList.begin(); itr!=dm->_regionsList.end(); itr++) {
+				const region_t &region = *itr;
+
+				if (region.lock_counter == 0 && (pass || region.derived)) {
+					if (! victim || region.stamp < victimItr->stamp) {
+						victim = dm;
+						victimItr = itr;
+					}
+					break;
+				}
+			}
+		}
 
-	// The least recently used region is at the front of the list
-	//
-	list <region_t>::iterator itr;
-	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
-		const region_t &region = *itr;
-
-		if (region.lock_counter == 0) {
-			if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
-			_regionsList.erase(itr);
+		if (victim) {
+			if (victim != this) {
+				SetDiagMsg(
+					"DataMgr::_free_lru() - evicting %s from another DataMgr",
+					victimItr->varname.c_str()
+				);
+			}
+			if (victimItr->blks) _blk_mem_mgr->FreeMem(victimItr->blks);
+			victim->_regionsList.erase(victimItr);
 			return(true);
 		}
 	}
@@ -2166,6 +2306,27 @@ bool	DataMgr::_free_lru(
 	// nothing to free
 	return(false);
 }
+
+size_t DataMgr::GetMemUsage() const {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
+
+	size_t nblks = 0;
+	list <region_t>::const_iterator itr;
+	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
+		nblks += itr->nblks;
+	}
+	return(nblks * BlkMemMgr::GetBlkSize());
+}
+
+size_t DataMgr::GetTotalMemUsage() {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
+
+	size_t size = 0;
+	for (int i=0; i<_instances.size(); i++) {
+		size += _instances[i]->GetMemUsage();
+	}
+	return(size);
+}
 	
 
 #ifdef	VAPOR3_0_0_ALPHA
@@ -2415,6 +2576,8 @@ vector <string> DataMgr::_get_native_variables() const {
 #ifdef	VAPOR3_0_0_ALPHA
 
 void DataMgr::PurgeVariable(string varname){
+	std::lock_guard <std::recursive_mutex> guard(_mutex);
+
 	_free_var(varname);
 	_VarInfoCache.PurgeVariable(varname);
 }
@@ -2642,6 +2805,29 @@ void DataMgr::VarInfoCache::PurgeVoidPtr(
 	_cacheVoidPtr.erase(itr);
 }
 
+void DataMgr::VarInfoCache::PurgeVariable(string varname) {
+
+	// Variable names appear in the hash as ":name:" (see _make_hash())
+	//
+	string match = ":" + varname + ":";
+
+	map <string, vector <size_t> >::iterator itr1 = _cacheSize_t.begin();
+	while (itr1 != _cacheSize_t.end()) {
+		if (itr1->first.find(match) != string::npos) {
+			_cacheSize_t.erase(itr1++);
+		}
+		else ++itr1;
+	}
+
+	map <string, vector <double> >::iterator itr2 = _cacheDouble.begin();
+	while (itr2 != _cacheDouble.end()) {
+		if (itr2->first.find(match) != string::npos) {
+			_cacheDouble.erase(itr2++);
+		}
+		else ++itr2;
+	}
+}
+
 DataMgr::BlkExts::BlkExts() {
 	_bmin.clear();
 	_bmax.clear();
@@ -3133,6 +3319,7 @@ int DataMgr::_find_bounding_grid(
 void	DataMgr::_unlock_blocks(
 	const void *blks
 ) {
+	std::lock_guard <std::recursive_mutex> cacheGuard(_cacheMutex);
 
 	list <region_t>::iterator itr;
 	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
@@ -3427,7 +3614,14 @@ int DataMgr::_readRegionBlock(
 	DerivedVar *derivedVar = _getDerivedVar(_openVarName);
 	if (derivedVar) {
 		assert ((std::is_same<T,float>::value) == true);
-		return(derivedVar->ReadRegionBlock(fd, min, max, (float *) region));
+
+		// Derived variables may read their inputs through this DataMgr,
+		// which changes the open variable
+		//
+		string openVarName = _openVarName;
+		int rc = derivedVar->ReadRegionBlock(fd, min, max, (float *) region);
+		_openVarName = openVarName;
+		return(rc);
 	}
 
 	return(_dc->ReadRegionBlock(fd, min, max, region));
@@ -3440,7 +3634,10 @@ int DataMgr::_readRegion(
 
 	DerivedVar *derivedVar = _getDerivedVar(_openVarName);
 	if (derivedVar) {
-		return(derivedVar->ReadRegion(fd, min, max, region));
+		string openVarName = _openVarName;
+		int rc = derivedVar->ReadRegion(fd, min, max, region);
+		_openVarName = openVarName;
+		return(rc);
 	}
 
 	return(_dc->ReadRegion(fd, min, max, region));
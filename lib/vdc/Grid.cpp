@@ -347,48 +347,120 @@ Grid::ConstNodeIteratorBoxSG::ConstNodeIteratorBoxSG(
 	const std::vector <double> &minu, const std::vector <double> &maxu
 ) : ConstNodeIteratorSG(g, true), _pred(minu, maxu) {
 
-	_coordItr = g->ConstCoordBegin();
+	_g = g;
+	_exact = false;
+	_min = vector <size_t> (_dims.size(), 0);
+	_max = _dims;
+	for (int i=0; i<_max.size(); i++) {
+		if (_max[i]) _max[i]--;
+	}
+
+	if (! _index.size()) return;
+
+	// Restrict iteration to the index space bounds of the box, if the
+	// grid can compute them
+	//
+	vector <size_t> min, max;
+	bool exact;
+	if (
+		g->_getNodeIndexBox(minu, maxu, min, max, exact) && 
+		min.size() == _dims.size() && max.size() == _dims.size()
+	) {
+		_min = min;
+		_max = max;
+		_exact = exact;
+	}
+
+	for (int i=0; i<_dims.size(); i++) {
+		if (_dims[i] == 0 || _min[i] > _max[i] || _max[i] >= _dims[i]) {
+			_index = _lastIndex;
+			return;
+		}
+	}
+	_index = _min;
 
 	// Advance to first node inside box
 	//
-	if (! _pred(*_coordItr)) {
+	if (! _inside()) {
 		next();
 	}
 }
 
 Grid::ConstNodeIteratorBoxSG::ConstNodeIteratorBoxSG(
 	const ConstNodeIteratorBoxSG &rhs
-) : ConstNodeIteratorSG() {
-	_coordItr = rhs._coordItr;
+) : ConstNodeIteratorSG(rhs) {
 	_pred = rhs._pred;
+	_g = rhs._g;
+	_min = rhs._min;
+	_max = rhs._max;
+	_exact = rhs._exact;
 }
 
 Grid::ConstNodeIteratorBoxSG::ConstNodeIteratorBoxSG(
 ) : ConstNodeIteratorSG() {
 
+	_g = NULL;
+	_exact = false;
+}
+
+// Step to the next node in the index space bounds. Returns false,
+// leaving the iterator at the end, if there are no more nodes
+//
+bool Grid::ConstNodeIteratorBoxSG::_advance() {
+
+	for (int i=0; i<_index.size(); i++) {
+		if (_index[i] < _max[i]) {
+			_index[i]++;
+			return(true);
+		}
+		_index[i] = _min[i];
+	}
+	_index = _lastIndex;
+	return(false);
+}
+
+bool Grid::ConstNodeIteratorBoxSG::_inside() {
+	if (_exact) return(true);
+
+	_g->GetUserCoordinates(_index, _coords);
+	return(_pred(_coords));
 }
 
 
 void Grid::ConstNodeIteratorBoxSG::next() {
 
-	do {
-		ConstNodeIteratorSG::next();
-		++_coordItr;
-	} while (_index != _lastIndex && ! _pred(*_coordItr));
+	if (! _index.size() || _index == _lastIndex) return;
+
+	while (_advance() && ! _inside()) {}
 }
 
 void Grid::ConstNodeIteratorBoxSG::next(const long &offset) {
 
-	_coordItr += offset;
+	if (! _index.size() || _index == _lastIndex) return;
 
-	while (_index != _lastIndex && ! _pred(*_coordItr)) {
-		ConstNodeIteratorSG::next();
-		++_coordItr;
+	// Offset is relative to the nodes within the index space bounds
+	//
+	long maxIndexL = Wasp::LinearizeCoords(_max, _min, _max);
+	long newIndexL = Wasp::LinearizeCoords(_index, _min, _max) + offset;
+	if (newIndexL < 0) {
+		newIndexL = 0;
+	}
+	if (newIndexL > maxIndexL) {
+		_index = _lastIndex;
+		return;
+	}
+
+	_index = Wasp::VectorizeCoords(newIndexL, _min, _max);
+	for (int i=0; i<_index.size(); i++) _index[i] += _min[i];
+
+	if (! _inside()) {
+		next();
 	}
 }
 
 
 
+
 Grid::ConstCellIteratorSG::ConstCellIteratorSG(
 	const Grid *g, bool begin
 ) : ConstCellIteratorAbstract() {
@@ -458,15 +530,15 @@ void Grid::ConstCellIteratorSG::next(const long &offset) {
 
 bool Grid::ConstCellIteratorBoxSG::_cellInsideBox(
 	const std::vector <size_t> &cindices
-) const {
-	vector <std::vector <size_t> > nodes;
-	bool status = _g->GetCellNodes(cindices, nodes);
+) {
+	if (_exact) return(true);
+
+	bool status = _g->GetCellNodes(cindices, _nodes);
 	if (! status) return(false);
 
-	for (int i=0; i<nodes.size(); i++) {
-		vector <double> coords;
-		_g->GetUserCoordinates(nodes[i], coords);
-		if (!_pred(coords)) return (false);
+	for (int i=0; i<_nodes.size(); i++) {
+		_g->GetUserCoordinates(_nodes[i], _coords);
+		if (!_pred(_coords)) return (false);
 	}
 
 	return(true);
@@ -477,79 +549,129 @@ Grid::ConstCellIteratorBoxSG::ConstCellIteratorBoxSG(
 	const std::vector <double> &minu, const std::vector <double> &maxu
 ) : ConstCellIteratorSG(g, true), _pred(minu, maxu) {
 
-#ifdef	VAPOR3_0_0
-	// Advance to first node inside box
+	_g = g;
+	_exact = false;
+	_min = vector <size_t> (_dims.size(), 0);
+	_max = _dims;
+	for (int i=0; i<_max.size(); i++) {
+		if (_max[i]) _max[i]--;
+	}
+
+	if (! _index.size()) return;
+
+	// A cell is inside the box only if all of its nodes are, so the 
+	// index space bounds of the cells are given by those of the nodes. 
+	// Only applies when the cells are formed from adjacent nodes
 	//
-	_coordItr = g->ConstCoordBegin();
+	vector <size_t> min, max;
+	bool exact;
+	const vector <size_t> &ndims = g->GetNodeDimensions();
+	bool structured = ndims.size() == _dims.size();
+	for (int i=0; i<_dims.size() && structured; i++) {
+		if (ndims[i] != _dims[i] + 1) structured = false;
+	}
+
+	if (
+		structured && 
+		g->_getNodeIndexBox(minu, maxu, min, max, exact) &&
+		min.size() == _dims.size() && max.size() == _dims.size()
+	) {
+		for (int i=0; i<_dims.size(); i++) {
+			if (max[i] <= min[i]) {
+				_index = _lastIndex;
+				return;
+			}
+			_min[i] = min[i];
+			_max[i] = max[i] - 1;
+		}
+		_exact = exact;
+	}
 
-	if (! _pred(*_coordItr)) {
-		next();
+	for (int i=0; i<_dims.size(); i++) {
+		if (_dims[i] == 0 || _min[i] > _max[i] || _max[i] >= _dims[i]) {
+			_index = _lastIndex;
+			return;
+		}
 	}
-#else
-	_g = g;
+	_index = _min;
 
-	// Advance to first node inside box
+	// Advance to first cell inside box
 	//
 	if (! _cellInsideBox(_index)) {
 		next();
 	}
-#endif
 }
 
 Grid::ConstCellIteratorBoxSG::ConstCellIteratorBoxSG(
 	const ConstCellIteratorBoxSG &rhs
-) : ConstCellIteratorSG() {
+) : ConstCellIteratorSG(rhs) {
 
-#ifdef	VAPOR3_0_0
-	_coordItr = rhs._coordItr;
-#endif
 	_pred = rhs._pred;
+	_g = rhs._g;
+	_min = rhs._min;
+	_max = rhs._max;
+	_exact = rhs._exact;
 }
 
 Grid::ConstCellIteratorBoxSG::ConstCellIteratorBoxSG(
 ) : ConstCellIteratorSG() {
 
+	_g = NULL;
+	_exact = false;
+}
+
+// Step to the next cell in the index space bounds. Returns false,
+// leaving the iterator at the end, if there are no more cells
+//
+bool Grid::ConstCellIteratorBoxSG::_advance() {
+
+	for (int i=0; i<_index.size(); i++) {
+		if (_index[i] < _max[i]) {
+			_index[i]++;
+			return(true);
+		}
+		_index[i] = _min[i];
+	}
+	_index = _lastIndex;
+	return(false);
 }
 
 
 void Grid::ConstCellIteratorBoxSG::next() {
 
-#ifdef	VAPOR3_0_0
-	do {
-		ConstCellIteratorSG::next();
-		++_coordItr;
-	} while (! _pred(*_coordItr) && _index != _lastIndex);
-#else
-	do {
-		ConstCellIteratorSG::next();
-	} while (! _cellInsideBox(_index) && _index != _lastIndex);
-#endif
+	if (! _index.size() || _index == _lastIndex) return;
+
+	while (_advance() && ! _cellInsideBox(_index)) {}
 }
 
 void Grid::ConstCellIteratorBoxSG::next(const long &offset) {
 
+	if (! _index.size() || _index == _lastIndex) return;
 
-#ifdef	VAPOR3_0_0
-	_coordItr += offset;
-	while (! _pred(*_coordItr) && _index != _lastIndex) {
-		ConstCellIteratorSG::next();
-		++_coordItr;
+	// Offset is relative to the cells within the index space bounds
+	//
+	long maxIndexL = Wasp::LinearizeCoords(_max, _min, _max);
+	long newIndexL = Wasp::LinearizeCoords(_index, _min, _max) + offset;
+	if (newIndexL < 0) {
+		newIndexL = 0;
+	}
+	if (newIndexL > maxIndexL) {
+		_index = _lastIndex;
+		return;
 	}
 
-#else 
+	_index = Wasp::VectorizeCoords(newIndexL, _min, _max);
+	for (int i=0; i<_index.size(); i++) _index[i] += _min[i];
 
-	long count = offset;
-	while (! _cellInsideBox(_index) && _index != _lastIndex && count > 0) {
-		ConstCellIteratorSG::next();
-		count--;
+	if (! _cellInsideBox(_index)) {
+		next();
 	}
-#endif
-
 }
 
 
 
 
+
 //
 //
 // Iterators
@@ -577,6 +699,11 @@ Grid::ForwardIterator<T>::ForwardIterator (
 
 	_index = vector <size_t> (3, 0);
 	_end_index = vector <size_t> (3, 0);
+	_min3d = vector <size_t> (3, 0);
+	_max3d = vector <size_t> (3, 0);
+	_exact = minu.empty();
+	_xb = 0;
+	_itr = nullptr;
 
 	if(_ndims < 1) return;
 
@@ -586,12 +713,42 @@ Grid::ForwardIterator<T>::ForwardIterator (
 		return;
 	}
 
-	_coordItr = rg->ConstCoordBegin();
-	_xb = 0;
-	_itr = &_blks[0][0];
+	for (int i=0; i<3; i++) {
+		if (! _dims3d[i]) {
+			_index = _end_index;
+			return;
+		}
+		_max3d[i] = _dims3d[i] - 1;
+	}
+
+	// Restrict iteration to the index space bounds of the box, if the 
+	// grid can compute them and the grid is sampled at its nodes
+	//
+	vector <size_t> min, max;
+	bool exact;
+	if (
+		! minu.empty() && 
+		rg->GetNodeDimensions() == rg->GetDimensions() &&
+		rg->_getNodeIndexBox(minu, maxu, min, max, exact) &&
+		min.size() == _ndims && max.size() == _ndims
+	) {
+		for (int i=0; i<_ndims; i++) {
+			if (min[i] > max[i] || max[i] > _max3d[i]) {
+				_index = _end_index;
+				return;
+			}
+			_min3d[i] = min[i];
+			_max3d[i] = max[i];
+		}
+		_exact = exact;
+	}
 
+	_coordItr = rg->ConstCoordBegin();
+	_index = _min3d;
+	if (_linearIndex(_index)) _coordItr += _linearIndex(_index);
+	_setItr();
 
-	if (! _pred(*_coordItr)) {
+	if (! _exact && ! _pred(*_coordItr)) {
 		operator++();
 	}
 }
@@ -610,6 +767,9 @@ Grid::ForwardIterator<T>::ForwardIterator(ForwardIterator<T> &&rhs) {
 	_xb = rhs._xb;
 	_itr = rhs._itr; rhs._itr = nullptr;
 	_pred = rhs._pred;
+	_min3d = rhs._min3d;
+	_max3d = rhs._max3d;
+	_exact = rhs._exact;
 }
 
 template <class T>
@@ -625,6 +785,9 @@ Grid::ForwardIterator<T>::ForwardIterator() {
 	_xb = 0;
 	_itr = nullptr;
 	//_pred = xx;
+	_min3d = {0,0,0};
+	_max3d = {0,0,0};
+	_exact = true;
 }
 
 template <class T>
@@ -635,68 +798,69 @@ Grid::ForwardIterator<T>
 	return(*this);
 }
 
+// Point _itr at the element given by _index
+//
+template <class T> 
+void Grid::ForwardIterator<T>::_setItr() {
+
+	size_t x = _index[0] % _bs3d[0];
+	size_t xb = _index[0] / _bs3d[0];
+	size_t y = _index[1] % _bs3d[1];
+	size_t yb = _index[1] / _bs3d[1];
+	size_t z = _index[2] % _bs3d[2];
+	size_t zb = _index[2] / _bs3d[2];
+
+	float *blk = _blks[zb*_bdims3d[0]*_bdims3d[1] + yb*_bdims3d[0] + xb];
+	_itr = &blk[z*_bs3d[0]*_bs3d[1] + y*_bs3d[0] + x];
+	_xb = x;
+}
 
 
 template <class T> 
 Grid::ForwardIterator<T>
 &Grid::ForwardIterator<T>::operator++() {
 
-	if (! _blks.size()) return(*this);
+	if (! _blks.size() || _index == _end_index) return(*this);
 
-	size_t xb = 0;
-	size_t yb = 0;
-	size_t zb = 0;
-	size_t x = 0;
-	size_t y = 0;
-	size_t z = 0;
 	do {
 
-		_xb++;
-		_itr++;
-		_index[0]++;
-		++_coordItr;
+		// Fast path: next element along the fastest varying axis is 
+		// in the same block
+		//
+		if (_index[0] < _max3d[0]) {
+			_xb++;
+			_itr++;
+			_index[0]++;
+			++_coordItr;
 
-		if (_xb < _bs3d[0] && _index[0]<_dims3d[0]) {
-
-			if (_pred(*_coordItr)) {
-				return(*this);
-			}
+			if (_xb >= _bs3d[0]) _setItr();
 
 			continue;
 		}
 
-		_xb = 0;
-		if (_index[0] >= _dims3d[0]) {
-			if (_index == _end_index) {
-				return(*this);	// last element
-			}
-			_index[0] = _xb = 0;
+		size_t oldIndexL = _linearIndex(_index);
+
+		_index[0] = _min3d[0];
+		if (_index[1] < _max3d[1]) {
 			_index[1]++;
 		}
-
-		if (_index[1] >= _dims3d[1]) {
-			if (_index == _end_index) {
+		else {
+			_index[1] = _min3d[1];
+			if (_index[2] < _max3d[2]) {
+				_index[2]++;
+			}
+			else {
+				_index = _end_index;
 				return(*this);	// last element
 			}
-			_index[1] = 0;
-			_index[2]++;
-		}
-
-		if (_index == _end_index) {
-			return(*this);	// last element
 		}
 
-		x = _index[0] % _bs3d[0];
-		xb = _index[0] / _bs3d[0];
-		y = _index[1] % _bs3d[1];
-		yb = _index[1] / _bs3d[1];
-		z = _index[2] % _bs3d[2];
-		zb = _index[2] / _bs3d[2];
-
-		float *blk = _blks[zb*_bdims3d[0]*_bdims3d[1] + yb*_bdims3d[0] + xb];
-		_itr = &blk[z*_bs3d[0]*_bs3d[1] + y*_bs3d[0] + x];
+		long delta = _linearIndex(_index) - oldIndexL;
+		if (delta == 1) ++_coordItr;
+		else _coordItr += delta;
+		_setItr();
 
-	} while (_index != _end_index && ! _pred(*_coordItr));
+	} while (! _exact && ! _pred(*_coordItr));
 
 	return(*this);
 }
@@ -715,13 +879,12 @@ template <class T>
 Grid::ForwardIterator<T> &Grid::ForwardIterator<T>::
 operator+=(const long int &offset) {
 
-	if (! _blks.size()) return(*this);
+	if (! _blks.size() || _index == _end_index) return(*this);
 
-	vector <size_t> maxIndex;
-	for (int i=0; i<_dims3d.size(); i++) maxIndex.push_back(_dims3d[i]-1);
-
-	long maxIndexL = Wasp::LinearizeCoords(maxIndex, _dims3d);
-	long newIndexL = Wasp::LinearizeCoords(_index, _dims3d) + offset;
+	// Offset is relative to the elements within the index space bounds
+	//
+	long maxIndexL = Wasp::LinearizeCoords(_max3d, _min3d, _max3d);
+	long newIndexL = Wasp::LinearizeCoords(_index, _min3d, _max3d) + offset;
 	if (newIndexL < 0) {
 		newIndexL = 0;
 	}
@@ -730,77 +893,16 @@ operator+=(const long int &offset) {
 		return(*this);
 	}
 
-	_index = Wasp::VectorizeCoords(newIndexL, _dims3d);
-
-	size_t xb = 0;
-	size_t yb = 0;
-	size_t zb = 0;
-	size_t x = 0;
-	size_t y = 0;
-	size_t z = 0;
-
-	_xb = xb = _index[0] / _bs3d[0];
-	yb = _index[1] / _bs3d[1];
-	zb = _index[2] / _bs3d[2];
-
-	x = _index[0] % _bs3d[0];
-	y = _index[1] % _bs3d[1];
-	z = _index[2] % _bs3d[2];
-
-	float *blk = _blks[zb*_bdims3d[0]*_bdims3d[1] + yb*_bdims3d[0] + xb];
-	_itr = &blk[z*_bs3d[0]*_bs3d[1] + y*_bs3d[0] + x];
+	size_t oldIndexL = _linearIndex(_index);
 
-	_coordItr += offset;
-
-	while (_index != _end_index && ! _pred(*_coordItr)) {
-
-		_xb++;
-		_itr++;
-		_index[0]++;
-		++_coordItr;
-
-		if (_xb < _bs3d[0] && _index[0]<_dims3d[0]) {
-
-			if (_pred(*_coordItr)) {
-				return(*this);
-			}
-
-			continue;
-		}
-
-		_xb = 0;
-		if (_index[0] >= _dims3d[0]) {
-			if (_index == _end_index) {
-				return(*this);	// last element
-			}
-			_index[0] = _xb = 0;
-			_index[1]++;
-		}
-
-		if (_index[1] >= _dims3d[1]) {
-			if (_index == _end_index) {
-				return(*this);	// last element
-			}
-			_index[1] = 0;
-			_index[2]++;
-		}
-
-		if (_index == _end_index) {
-			return(*this);	// last element
-		}
-
-		xb = _index[0] / _bs3d[0];
-		yb = _index[1] / _bs3d[1];
-		zb = _index[2] / _bs3d[2];
-
-		x = _index[0] % _bs3d[0];
-		y = _index[1] % _bs3d[1];
-		z = _index[2] % _bs3d[2];
-
-		float *blk = _blks[zb*_bdims3d[0]*_bdims3d[1] + yb*_bdims3d[0] + xb];
-		_itr = &blk[z*_bs3d[0]*_bs3d[1] + y*_bs3d[0] + x];
+	_index = Wasp::VectorizeCoords(newIndexL, _min3d, _max3d);
+	for (int i=0; i<3; i++) _index[i] += _min3d[i];
 
+	_coordItr += (long) _linearIndex(_index) - (long) oldIndexL;
+	_setItr();
 
+	if (! _exact && ! _pred(*_coordItr)) {
+		operator++();
 	}
 
 	return(*this);
@@ -817,6 +919,7 @@ operator+(const long int &offset) const {
 }
 
 
+
 // Need this so that template definitions can be made in .cpp file, not .h file
 //
 template class Grid::ForwardIterator<Grid>;
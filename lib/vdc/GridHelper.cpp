@@ -136,18 +136,13 @@ using namespace VAPoR;
 using namespace Wasp;
 
 
-const KDTreeRG *GridHelper::_getKDTree2D(
+string GridHelper::_getMeshKey(
 	size_t ts,
 	int level,
-	int lod,
     const vector <DC::CoordVar> &cvarsinfo, 
-	const Grid &xg,
-	const Grid &yg,
 	const vector <size_t> &bmin,
 	const vector <size_t> &bmax
-) {
-	assert(cvarsinfo.size() >= 2);
-	assert(xg.GetDimensions() == yg.GetDimensions());
+) const {
 
 	vector <string> varnames;
 	for (int i=0; i<cvarsinfo.size(); i++) {
@@ -177,7 +172,23 @@ const KDTreeRG *GridHelper::_getKDTree2D(
 	oss << ":";
 	oss << vector_to_string(bmax);
 
-	string key = oss.str();
+	return(oss.str());
+}
+
+const KDTreeRG *GridHelper::_getKDTree2D(
+	size_t ts,
+	int level,
+	int lod,
+    const vector <DC::CoordVar> &cvarsinfo, 
+	const Grid &xg,
+	const Grid &yg,
+	const vector <size_t> &bmin,
+	const vector <size_t> &bmax
+) {
+	assert(cvarsinfo.size() >= 2);
+	assert(xg.GetDimensions() == yg.GetDimensions());
+
+	string key = _getMeshKey(ts, level, cvarsinfo, bmin, bmax);
 
 	KDTreeRG *kdtree = _kdtreeCache.get(key);
 	if (kdtree) {
@@ -193,6 +204,31 @@ const KDTreeRG *GridHelper::_getKDTree2D(
 	return(kdtree);
 }
 
+CellLocator2D *GridHelper::_getCellLocator2D(
+	size_t ts,
+	int level,
+    const vector <DC::CoordVar> &cvarsinfo, 
+	const vector <size_t> &bmin,
+	const vector <size_t> &bmax
+) {
+	assert(cvarsinfo.size() >= 2);
+
+	string key = _getMeshKey(ts, level, cvarsinfo, bmin, bmax);
+
+	CellLocator2D *locator = _locatorCache.get(key);
+	if (locator) {
+		return(locator);
+	}
+
+	locator = new CellLocator2D();
+	
+	CellLocator2D *oldlocator = _locatorCache.put(key, locator);
+	if (oldlocator) {
+		delete oldlocator;
+	}
+	return(locator);
+}
+
 RegularGrid *GridHelper::_make_grid_regular(
 	const vector <size_t> &dims,
     const vector <float *> &blkvec,
@@ -408,6 +444,10 @@ CurvilinearGrid *GridHelper::_make_grid_curvilinear(
 		ts, level, lod, cvarsinfo, xrg, yrg, bmin, bmax
 	);
 
+	CellLocator2D *locator = _getCellLocator2D(
+		ts, level, cvarsinfo, bmin, bmax
+	);
+
 	if (dims.size() == 3 && cvarsinfo[2].GetDimNames().size() == 3) {
 
 		// Terrain following vertical
@@ -423,7 +463,7 @@ CurvilinearGrid *GridHelper::_make_grid_curvilinear(
 		RegularGrid zrg(dims, bs, zcblkptrs, minu, maxu);
 
 		return (new CurvilinearGrid(
-			dims, bs, blkptrs, xrg, yrg, zrg, kdtree
+			dims, bs, blkptrs, xrg, yrg, zrg, kdtree, locator
 		));
 
 	}
@@ -435,7 +475,7 @@ CurvilinearGrid *GridHelper::_make_grid_curvilinear(
 		for (int i=0; i<dims[2]; i++) zcoords.push_back(blkvec[3][i]);
 
 		return (new CurvilinearGrid(
-			dims, bs, blkptrs, xrg, yrg, zcoords, kdtree
+			dims, bs, blkptrs, xrg, yrg, zcoords, kdtree, locator
 		));
 	}
 	else {
@@ -443,7 +483,8 @@ CurvilinearGrid *GridHelper::_make_grid_curvilinear(
 		// 2D
 		//
 		return (new CurvilinearGrid(
-			dims, bs, blkptrs, xrg, yrg, vector <double> (), kdtree
+			dims, bs, blkptrs, xrg, yrg, vector <double> (), kdtree,
+			locator
 		));
 
 	}
@@ -554,11 +595,15 @@ UnstructuredGrid2D *GridHelper::_make_grid_unstructured2d(
 		ts, level, lod, cvarsinfo, xug, yug, bmin, bmax
 	);
 
+	CellLocator2D *locator = _getCellLocator2D(
+		ts, level, cvarsinfo, bmin, bmax
+	);
+
 	UnstructuredGrid2D *g = new UnstructuredGrid2D(
 		vertexDims, faceDims, edgeDims, bs, blkptrs, 
 		vertexOnFace, faceOnVertex, faceOnFace, location,
 		maxVertexPerFace, maxFacePerVertex,
-		xug, yug, zug, kdtree
+		xug, yug, zug, kdtree, locator
 	);
 	g->SetNodeOffset(vertexOffset);
 	g->SetCellOffset(faceOffset);
@@ -866,6 +911,12 @@ GridHelper::~GridHelper() {
 	while ((kdtree = _kdtreeCache.remove_lru()) != NULL) {
 		delete kdtree;
 	}
+
+	CellLocator2D *locator;
+
+	while ((locator = _locatorCache.remove_lru()) != NULL) {
+		delete locator;
+	}
 }
 
 
@@ -363,6 +363,48 @@ void LayeredGrid::SetInterpolationOrder(int order) {
     _interpolationOrder = order;
 }
 
+bool LayeredGrid::_getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+) const {
+
+	vector <size_t> dims = GetDimensions();
+	assert(dims.size() == 3);
+
+	min = vector <size_t> (dims.size(), 0);
+	max = dims;
+	for (int i=0; i<dims.size(); i++) {
+		if (! dims[i]) return(false);
+		max[i]--;
+	}
+
+	// Horizontal coordinates are regularly spaced, and their range is exact
+	//
+	for (int i=0; i<2 && i<minu.size() && i<maxu.size(); i++) {
+		if (dims[i] > 1 && ! (_delta[i] > 0.0)) return(false);
+
+		_regularIndexRange(
+			_minu[i], _delta[i], dims[i], minu[i], maxu[i], min[i], max[i]
+		);
+		if (min[i] > max[i]) {
+			exact = true;
+			return(true);
+		}
+	}
+
+	exact = true;
+	if (minu.size() < 3 || maxu.size() < 3) return(true);
+
+	// The vertical coordinate varies with every node. Trim layers lying
+	// entirely above or below the box. Nodes in the remaining layers must 
+	// still be tested.
+	//
+	_layerIndexRange(_rg, minu[2], maxu[2], min, max);
+	exact = false;
+
+	return(true);
+}
+
 void LayeredGrid::GetUserCoordinates(
 	const std::vector <size_t> &indices,
 	std::vector <double> &coords
@@ -549,7 +591,9 @@ LayeredGrid::ConstCoordItrLayered::ConstCoordItrLayered(
     if (! begin) {
         _index[_dims.size()-1] = _dims[_dims.size()-1];
 		_zCoordItr = lg->_rg.cend();
+		return;
     }
+	_coords[2] = *_zCoordItr; 
 }
 
 
@@ -577,7 +621,7 @@ void LayeredGrid::ConstCoordItrLayered::next() {
 
 	_index[0]++;
 	++_zCoordItr;
-	_coords[0] += _delta[0];
+	_coords[0] = _index[0] * _delta[0] + _minu[0];
 	if (_index[0] < _dims[0]) {
 		_coords[2] = *_zCoordItr; 
 		return;
@@ -586,7 +630,7 @@ void LayeredGrid::ConstCoordItrLayered::next() {
 	_index[0] = 0;
 	_coords[0] = _minu[0];
 	_index[1]++;
-	_coords[1] += _delta[1];
+	_coords[1] = _index[1] * _delta[1] + _minu[1];
 
 	if (_index[1] < _dims[1]) {
 		_coords[2] = *_zCoordItr; 
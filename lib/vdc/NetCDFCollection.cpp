@@ -1,7 +1,21 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <utility>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <climits>
+#include <set>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 #include <netcdf.h>
 #include <vapor/NetCDFCollection.h>
 
@@ -40,8 +54,172 @@ bool readOK(vector <size_t> dims, size_t start[], size_t count[]) {
 	return(true);
 }
 
+//
+// Metadata catalog support. A catalog holds, for each file it has seen
+// in one data directory, the file's modification time and size, and the
+// metadata needed to initialize a NetCDFSimple for it without opening
+// the file. Values are stored in native byte order
+//
+const uint32_t CatalogMagic = 0x43434e56;	// "VNCC"
+const uint32_t CatalogVersion = 1;
+
+typedef struct {
+	int64_t _mtime;
+	int64_t _size;
+	string _metadata;	// NetCDFSimple metadata, then time coordinates
+} catalog_entry_t;
+
+typedef map <string, catalog_entry_t> catalog_t;	// keyed by absolute path
+
+bool file_stat(const string &path, int64_t &mtime, int64_t &size) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) return(false);
+
+	mtime = st.st_mtime;
+	size = st.st_size;
+	return(true);
+}
+
+string absolute_path(const string &path) {
+#ifdef WIN32
+	char buf[_MAX_PATH];
+	if (_fullpath(buf, path.c_str(), _MAX_PATH)) return(buf);
+#else
+	char buf[PATH_MAX];
+	if (realpath(path.c_str(), buf)) return(buf);
+#endif
+	return(path);
+}
+
+// One catalog per data directory, named by a hash of the directory path
+//
+string catalog_path(const string &catalogDir, const string &abspath) {
+	string dir = abspath.substr(0, abspath.find_last_of("/\\") + 1);
+
+	// 64 bit FNV-1a
+	//
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i=0; i<dir.length(); i++) {
+		hash ^= (unsigned char) dir[i];
+		hash *= 1099511628211ULL;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.ncc", (unsigned long long) hash);
+	return(catalogDir + "/" + name);
+}
+
+void read_catalog(const string &path, catalog_t &catalog) {
+	catalog.clear();
+
+	ifstream is(path.c_str(), ios::in | ios::binary);
+	if (! is) return;
+
+	uint32_t magic, version;
+	uint64_t n;
+	if (! NetCDFSimple::ReadValue(is, magic)) return;
+	if (magic != CatalogMagic) return;
+	if (! NetCDFSimple::ReadValue(is, version)) return;
+	if (version != CatalogVersion) return;
+	if (! NetCDFSimple::ReadValue(is, n)) return;
+
+	for (uint64_t i=0; i<n; i++) {
+		string file;
+		catalog_entry_t entry;
+		if (
+			! NetCDFSimple::ReadString(is, file) ||
+			! NetCDFSimple::ReadValue(is, entry._mtime) ||
+			! NetCDFSimple::ReadValue(is, entry._size) ||
+			! NetCDFSimple::ReadString(is, entry._metadata)
+		) {
+			catalog.clear();	// truncated or corrupt
+			return;
+		}
+		catalog[file] = entry;
+	}
+}
+
+// Several processes may share a catalog directory, so write to a 
+// private file and move it into place
+//
+void write_catalog(const string &path, const catalog_t &catalog) {
+	ostringstream tmppath;
+	tmppath << path << "." << getpid() << ".tmp";
+
+	ofstream os(tmppath.str().c_str(), ios::out | ios::binary | ios::trunc);
+	if (! os) return;
+
+	NetCDFSimple::WriteValue(os, CatalogMagic);
+	NetCDFSimple::WriteValue(os, CatalogVersion);
+	NetCDFSimple::WriteValue(os, (uint64_t) catalog.size());
+	catalog_t::const_iterator itr;
+	for (itr = catalog.begin(); itr != catalog.end(); ++itr) {
+		NetCDFSimple::WriteString(os, itr->first);
+		NetCDFSimple::WriteValue(os, itr->second._mtime);
+		NetCDFSimple::WriteValue(os, itr->second._size);
+		NetCDFSimple::WriteString(os, itr->second._metadata);
+	}
+	os.close();
+
+	if (! os.good()) {
+		remove(tmppath.str().c_str());
+		return;
+	}
+#ifdef WIN32
+	remove(path.c_str());	// rename() won't replace an existing file
+#endif
+	if (rename(tmppath.str().c_str(), path.c_str()) != 0) {
+		remove(tmppath.str().c_str());
+	}
+}
+
+// Initialize netcdf from scanned metadata, and return the values of the
+// time coordinate variables. Returns false if the metadata can't be
+// parsed, or lacks a time coordinate variable that the file contains
+//
+bool load_metadata(
+	const string &file, const string &metadata,
+	const vector <string> &time_coordvars, NetCDFSimple *netcdf,
+	map <string, vector <double> > &tcvValues
+) {
+	tcvValues.clear();
+
+	istringstream is(metadata);
+	if (netcdf->LoadMetadata(file, is) < 0) return(false);
+
+	uint64_t n;
+	if (! NetCDFSimple::ReadValue(is, n)) return(false);
+	for (uint64_t i=0; i<n; i++) {
+		string name;
+		uint64_t ntimes;
+		if (! NetCDFSimple::ReadString(is, name)) return(false);
+		if (! NetCDFSimple::ReadValue(is, ntimes)) return(false);
+		if (ntimes > (1u << 30)) return(false);
+
+		vector <double> &times = tcvValues[name];
+		times.resize(ntimes);
+		for (uint64_t t=0; t<ntimes; t++) {
+			if (! NetCDFSimple::ReadValue(is, times[t])) return(false);
+		}
+	}
+
+	const vector <NetCDFSimple::Variable> &variables = netcdf->GetVariables();
+	for (int i=0; i<time_coordvars.size(); i++) {
+		if (tcvValues.find(time_coordvars[i]) != tcvValues.end()) continue;
+
+		for (int j=0; j<variables.size(); j++) {
+			if (variables[j].GetName() == time_coordvars[i]) return(false);
+		}
+	}
+	return(true);
+}
+
 };
 
+string NetCDFCollection::_catalogDirectory;
+size_t NetCDFCollection::_maxOpenFiles = 64;
+size_t NetCDFCollection::_chunkSizeHint = 4*1024*1024;
+
 NetCDFCollection::NetCDFCollection() {
 	_variableList.clear();
 	_staggeredDims.clear();
@@ -52,6 +230,7 @@ NetCDFCollection::NetCDFCollection() {
 	_timesMap.clear();
 	_ovr_table.clear();
 	_ncdfmap.clear();
+	_openFiles.clear();
 	_failedVars.clear();
 }
 
@@ -61,17 +240,24 @@ NetCDFCollection::~NetCDFCollection() {
 
 void NetCDFCollection::ReInitialize() {
 
+	//
+	// Close open variables before deleting the files they refer to.
+	// Close() erases from _ovr_table, so collect the descriptors first
+	//
+	vector <int> fds;
+	std::map <int, fileHandle>::iterator itr1;
+	for (itr1 = _ovr_table.begin(); itr1 != _ovr_table.end(); ++itr1) {
+		fds.push_back(itr1->first);
+	}
+	for (int i=0; i<fds.size(); i++) {
+		(void) NetCDFCollection::Close(fds[i]);
+	}
+
 	map <string, NetCDFSimple *>::iterator itr;
 	for (itr = _ncdfmap.begin(); itr != _ncdfmap.end(); ++itr) {
 		delete itr->second;
 	}
 
-	std::map <int, fileHandle>::iterator itr1;
-	for (itr1 = _ovr_table.begin(); itr1 != _ovr_table.end(); ++itr1) {
-		int fd = itr1->first;
-		(void) NetCDFCollection::Close(fd);
-	}
-
 	_variableList.clear();
 	_staggeredDims.clear();
 	_dimNames.clear();
@@ -81,6 +267,7 @@ void NetCDFCollection::ReInitialize() {
 	_timesMap.clear();
 	_ovr_table.clear();
 	_ncdfmap.clear();
+	_openFiles.clear();
 	_failedVars.clear();
 }
 
@@ -92,25 +279,26 @@ int NetCDFCollection::Initialize(
 	
 	ReInitialize();
 
+	//
+	// Gather the metadata and time coordinates of every file, once
+	//
+	map <string, map <string, vector <double> > > tcvValues;
+	int rc = _ScanFiles(files, time_coordvars, tcvValues);
+	if (rc<0) return(-1);
+
 	//
 	// Build a hash table to map a variable's time dimension
 	// to its time coordinates
 	//
 	int file_org; // case 1, 2, 3 (3a or 3b)
-	int rc = NetCDFCollection::_InitializeTimesMap(
-		files, time_dimnames, time_coordvars, _timesMap, _times, file_org
+	rc = NetCDFCollection::_InitializeTimesMap(
+		files, time_dimnames, time_coordvars, tcvValues, _timesMap, _times, 
+		file_org
 	);
 	if (rc<0) return(-1);
 		
 	for (int i=0; i<files.size(); i++) {
-		NetCDFSimple *netcdf = new NetCDFSimple();
-		_ncdfmap[files[i]] = netcdf;
-
-		rc = netcdf->Initialize(files[i]);
-		if (rc<0) {
-			SetErrMsg("NetCDFSimple::Initialize(%s)", files[i].c_str());
-			return(-1);
-		}
+		NetCDFSimple *netcdf = _ncdfmap[files[i]];
 
 		//
 		// Get dimension names and lengths 
@@ -775,6 +963,9 @@ int NetCDFCollection::OpenRead(size_t ts, string varname) {
 	);
 	
 	fh._ncdfptr = _ncdfmap[path];
+	if (! fh._ncdfptr->IsFileOpen()) {
+		fh._ncdfptr->SetChunkSizeHint(_chunkSizeHint);
+	}
 	fh._fd = fh._ncdfptr->OpenRead(varinfo);
 	if (fh._fd<0) {
 		SetErrMsg(
@@ -783,6 +974,8 @@ int NetCDFCollection::OpenRead(size_t ts, string varname) {
 		);
 		return(-1);
 	}
+	_TouchFile(fh._ncdfptr);
+	_TrimOpenFiles();
 
     _ovr_table[fd] = fh;
 	return(fd);
@@ -951,9 +1144,147 @@ int NetCDFCollection::ReadNative(int *data, int fd) {
 	return(NetCDFCollection::ReadNative(start, count, data, fd));
 }
 
+//
+// Create a NetCDFSimple for each file in _ncdfmap, and read the values of
+// any time coordinate variables the files contain. Metadata is restored 
+// from catalogs when possible; otherwise the file is scanned, and the 
+// catalog updated.
+//
+// N.B. the scan is serial: the netCDF library is not thread safe
+//
+int NetCDFCollection::_ScanFiles(
+	const vector <string> &files, const vector <string> &time_coordvars,
+	map <string, map <string, vector <double> > > &tcvValues
+) {
+	tcvValues.clear();
+
+	map <string, catalog_t> catalogs;	// keyed by catalog path
+	set <string> modified;				// catalogs that need writing
+
+	for (int i=0; i<files.size(); i++) {
+		if (_ncdfmap.find(files[i]) != _ncdfmap.end()) continue;
+
+		NetCDFSimple *netcdf = new NetCDFSimple();
+		_ncdfmap[files[i]] = netcdf;
+
+		//
+		// Look for an up to date catalog entry
+		//
+		catalog_t *catalog = NULL;
+		string abspath;
+		int64_t mtime, size;
+		if (! _catalogDirectory.empty() && file_stat(files[i], mtime, size)) {
+			abspath = absolute_path(files[i]);
+			string catpath = catalog_path(_catalogDirectory, abspath);
+			if (catalogs.find(catpath) == catalogs.end()) {
+				read_catalog(catpath, catalogs[catpath]);
+			}
+			catalog = &catalogs[catpath];
+
+			catalog_t::const_iterator itr = catalog->find(abspath);
+			if (
+				itr != catalog->end() && 
+				itr->second._mtime == mtime && itr->second._size == size
+			) {
+				bool enable = EnableErrMsg(false);
+				bool ok = load_metadata(
+					files[i], itr->second._metadata, time_coordvars, netcdf,
+					tcvValues[files[i]]
+				);
+				(void) EnableErrMsg(enable); 
+				if (ok) continue;
+				SetErrCode(0);
+			}
+		}
+
+		//
+		// No catalog entry, or a stale one: scan the file
+		//
+		catalog_entry_t entry;
+		int rc = _ScanFile(files[i], time_coordvars, entry._metadata);
+		if (rc<0) return(-1);
+
+		if (! load_metadata(
+			files[i], entry._metadata, time_coordvars, netcdf, 
+			tcvValues[files[i]]
+		)) {
+			SetErrMsg("NetCDFSimple::LoadMetadata(%s)", files[i].c_str());
+			return(-1);
+		}
+
+		if (catalog) {
+			entry._mtime = mtime;
+			entry._size = size;
+			(*catalog)[abspath] = entry;
+			modified.insert(catalog_path(_catalogDirectory, abspath));
+		}
+	}
+
+	set <string>::const_iterator itr;
+	for (itr = modified.begin(); itr != modified.end(); ++itr) {
+		write_catalog(*itr, catalogs[*itr]);
+	}
+
+	return(0);
+}
+
+//
+// Read the metadata of a file, and the values of any of the time 
+// coordinate variables it contains, and serialize them into metadata
+//
+int NetCDFCollection::_ScanFile(
+	string file, const vector <string> &time_coordvars, string &metadata
+) const {
+	metadata.clear();
+
+	NetCDFSimple netcdf;
+	int rc = netcdf.Initialize(file);
+	if (rc<0) {
+		SetErrMsg("NetCDFSimple::Initialize(%s)", file.c_str());
+		return(-1);
+	}
+
+	ostringstream os;
+	rc = netcdf.SaveMetadata(os);
+	if (rc<0) return(-1);
+
+	const vector <NetCDFSimple::Variable> &variables = netcdf.GetVariables();
+	vector <int> indices;
+	for (int i=0; i<time_coordvars.size(); i++) {
+		int index = _get_var_index(variables, time_coordvars[i]);
+		if (index >= 0) indices.push_back(index);
+	}
+
+	NetCDFSimple::WriteValue(os, (uint64_t) indices.size());
+	for (int i=0; i<indices.size(); i++) {
+		const NetCDFSimple::Variable &variable = variables[indices[i]];
+
+		float *buf= _Get1DVar(&netcdf, variable);
+		if (! buf) {
+			SetErrMsg(	
+				"Failed to read time coordinate variable \"%s\"",
+				variable.GetName().c_str()
+			);
+			return(-1);
+		}
+
+		size_t timedimlen = netcdf.DimLen(variable.GetDimNames()[0]);
+		NetCDFSimple::WriteString(os, variable.GetName());
+		NetCDFSimple::WriteValue(os, (uint64_t) timedimlen);
+		for (size_t t=0; t<timedimlen; t++) {
+			NetCDFSimple::WriteValue(os, (double) buf[t]);
+		}
+		delete [] buf;
+	}
+
+	metadata = os.str();
+	return(0);
+}
+
 int NetCDFCollection::_InitializeTimesMap(
 	const vector <string> &files, const vector <string> &time_dimnames, 
 	const vector <string> &time_coordvars, 
+	const map <string, map <string, vector <double> > > &tcvValues,
 	map <string, vector <double> > &timesMap, 
 	vector <double> &times, int &file_org
 ) const {
@@ -975,7 +1306,7 @@ int NetCDFCollection::_InitializeTimesMap(
 	else {
 		file_org = 3;
 		rc = _InitializeTimesMapCase3(
-			files, time_dimnames, time_coordvars, timesMap
+			files, time_dimnames, time_coordvars, tcvValues, timesMap
 		);
 	}
 	if (rc<0) return(rc);
@@ -1029,13 +1360,7 @@ int NetCDFCollection::_InitializeTimesMapCase1(
 	//
 
 	for (int i=0; i<files.size(); i++) {
-		NetCDFSimple *netcdf = new NetCDFSimple();
-
-		int rc = netcdf->Initialize(files[i]);
-		if (rc<0) {
-			SetErrMsg("NetCDFSimple::Initialize(%s)", files[i].c_str());
-			return(-1);
-		}
+		const NetCDFSimple *netcdf = _ncdfmap.find(files[i])->second;
 
 		const vector <NetCDFSimple::Variable> &variables = netcdf->GetVariables();
 
@@ -1060,7 +1385,6 @@ int NetCDFCollection::_InitializeTimesMapCase1(
 
 			currentTime[varname] += 1.0;
 		}
-		delete netcdf;
 	}
 	return(0);
 }
@@ -1082,13 +1406,7 @@ int NetCDFCollection::_InitializeTimesMapCase2(
 	//
 
 	for (int i=0; i<files.size(); i++) {
-		NetCDFSimple *netcdf = new NetCDFSimple();
-
-		int rc = netcdf->Initialize(files[i]);
-		if (rc<0) {
-			SetErrMsg("NetCDFSimple::Initialize(%s)", files[i].c_str());
-			return(-1);
-		}
+		const NetCDFSimple *netcdf = _ncdfmap.find(files[i])->second;
 
 		const vector <NetCDFSimple::Variable> &variables = netcdf->GetVariables();
 
@@ -1125,7 +1443,6 @@ int NetCDFCollection::_InitializeTimesMapCase2(
 
 			timesMap[key] = times;
 		}
-		delete netcdf;
 	}
 	return(0);
 }
@@ -1133,6 +1450,7 @@ int NetCDFCollection::_InitializeTimesMapCase2(
 int NetCDFCollection::_InitializeTimesMapCase3(
 	const vector <string> &files, const vector <string> &time_dimnames, 
 	const vector <string> &time_coordvars,
+	const map <string, map <string, vector <double> > > &tcvValues,
 	map <string, vector <double> > &timesMap
 ) const {
 	timesMap.clear();
@@ -1149,16 +1467,15 @@ int NetCDFCollection::_InitializeTimesMapCase3(
 	}
 
 	for (int i=0; i<files.size(); i++) {
-		NetCDFSimple *netcdf = new NetCDFSimple();
-
-		int rc = netcdf->Initialize(files[i]);
-		if (rc<0) return(-1);
+		const NetCDFSimple *netcdf = _ncdfmap.find(files[i])->second;
+		const map <string, vector <double> > &fileTimes = 
+			tcvValues.find(files[i])->second;
 
 		const vector <NetCDFSimple::Variable> &variables = netcdf->GetVariables();
 
 		//
 		// For each TCV see if it exists in current file, if so
-		// read it and add times to timesMap
+		// add its times, read by _ScanFiles(), to timesMap
 		//
 		for (int j=0; j<time_coordvars.size(); j++) {
 			int index = _get_var_index(variables, time_coordvars[j]);
@@ -1169,24 +1486,9 @@ int NetCDFCollection::_InitializeTimesMapCase3(
 
 			tcvcount[time_coordvars[j]] += 1; 
 
-			// Read TCV
-			float *buf= _Get1DVar(netcdf, variables[index]);
-			if (! buf) {
-				SetErrMsg(	
-					"Failed to read time coordinate variable \"%s\"",
-					time_coordvars[j].c_str()
-				);
-				return(-1);
-			}
-
 			string timedim = variables[index].GetDimNames()[0];
-			size_t timedimlen = netcdf->DimLen(timedim);
-
-			vector <double> times;
-			for (int t=0; t<timedimlen; t++) {
-				times.push_back(buf[t]);
-			}
-			delete [] buf;
+			const vector <double> &times = 
+				fileTimes.find(time_coordvars[j])->second;
 
 			//
 			// The hash key for timesMap is the file plus the
@@ -1209,8 +1511,6 @@ int NetCDFCollection::_InitializeTimesMapCase3(
 				}
 			}
 		}
-
-		delete netcdf;
 	}
 
 	//
@@ -1793,9 +2093,147 @@ int NetCDFCollection::Close(int fd) {
 	if (fh._linebuf) delete [] fh._linebuf;
 
 	_ovr_table.erase(itr);
+
+	// A file held open past the limit by its open variables may be
+	// closable now
+	//
+	_TrimOpenFiles();
 	return(rc);
 }
 
+int NetCDFCollection::ReadTimeSeries(
+	const vector <size_t> &timesteps, string varname,
+	const vector <size_t> &start, const vector <size_t> &count, float *data
+) {
+	assert(start.size() == count.size());
+
+	size_t nelements = 1;
+	for (int i=0; i<count.size(); i++) nelements *= count[i];
+
+	//
+	// Derived and staggered variables aren't stored as they are read. 
+	// Fall back to reading them one time step at a time
+	//
+	map <string,TimeVaryingVar>::const_iterator p = _variableList.find(varname);
+	if (IsDerivedVar(varname) || p == _variableList.end() || 
+		IsStaggeredVar(varname)) {
+
+		for (size_t i=0; i<timesteps.size(); i++) {
+			int fd = OpenRead(timesteps[i], varname);
+			if (fd<0) return(-1);
+
+			int rc = Read(start, count, data + i*nelements, fd);
+			(void) Close(fd);
+			if (rc<0) return(-1);
+		}
+		return(0);
+	}
+	const TimeVaryingVar &tvvars = p->second;
+
+	NetCDFSimple::Variable varinfo;
+	tvvars.GetVariableInfo(varinfo);
+
+	bool has_time_dim = 
+		tvvars.GetTimeVarying() && ! tvvars.GetTimeDimName().empty();
+
+	size_t mystart[NC_MAX_VAR_DIMS];
+	size_t mycount[NC_MAX_VAR_DIMS];
+	int idx = has_time_dim ? 1 : 0;
+	for (int i=0; i<start.size(); i++) {
+		mystart[idx+i] = start[i];
+		mycount[idx+i] = count[i];
+	}
+
+	//
+	// Locate the file and record holding each time step
+	//
+	vector <string> files(timesteps.size());
+	vector <size_t> records(timesteps.size());
+	for (size_t i=0; i<timesteps.size(); i++) {
+		double time;
+		int rc = GetTime(timesteps[i], time);
+		if (rc<0) return(-1);
+
+		size_t var_ts;
+		rc = tvvars.GetTimeStep(time, var_ts);
+		if (rc<0) return(-1);
+
+		tvvars.GetFile(var_ts, files[i]);
+		records[i] = tvvars.GetLocalTimeStep(var_ts);
+	}
+
+	size_t i = 0;
+	while (i < timesteps.size()) {
+
+		// Repeated records, e.g. from a variable that isn't time varying,
+		// are copied rather than read again
+		//
+		if (i>0 && files[i] == files[i-1] && records[i] == records[i-1]) {
+			std::copy(
+				data + (i-1)*nelements, data + i*nelements, 
+				data + i*nelements
+			);
+			i++;
+			continue;
+		}
+
+		// Read a run of consecutive records from one file
+		//
+		size_t nrecs = 1;
+		while (has_time_dim && i+nrecs < timesteps.size() && 
+			files[i+nrecs] == files[i] && 
+			records[i+nrecs] == records[i] + nrecs) {
+
+			nrecs++;
+		}
+
+		NetCDFSimple *netcdf = _ncdfmap[files[i]];
+		if (! netcdf->IsFileOpen()) {
+			netcdf->SetChunkSizeHint(_chunkSizeHint);
+		}
+		int fd = netcdf->OpenRead(varinfo);
+		if (fd<0) return(-1);
+		_TouchFile(netcdf);
+
+		if (has_time_dim) {
+			mystart[0] = records[i];
+			mycount[0] = nrecs;
+		}
+		int rc = netcdf->Read(mystart, mycount, data + i*nelements, fd);
+		(void) netcdf->Close(fd);
+		_TrimOpenFiles();
+		if (rc<0) return(-1);
+
+		i += nrecs;
+	}
+	return(0);
+}
+
+void NetCDFCollection::_TouchFile(NetCDFSimple *netcdf) {
+	list <NetCDFSimple *>::iterator itr;
+	itr = find(_openFiles.begin(), _openFiles.end(), netcdf);
+	if (itr == _openFiles.begin() && itr != _openFiles.end()) return;
+
+	if (itr != _openFiles.end()) _openFiles.erase(itr);
+	_openFiles.push_front(netcdf);
+}
+
+void NetCDFCollection::_TrimOpenFiles() {
+	if (! _maxOpenFiles) return;
+
+	list <NetCDFSimple *>::iterator itr = _openFiles.end();
+	while (_openFiles.size() > _maxOpenFiles && itr != _openFiles.begin()) {
+		--itr;
+		NetCDFSimple *netcdf = *itr;
+		if (netcdf->HasOpenVariables()) continue;
+
+		// Failure to close leaks a handle at worst; don't fail the read
+		//
+		(void) netcdf->CloseFile();
+		itr = _openFiles.erase(itr);
+	}
+}
+
 void NetCDFCollection::InstallDerivedVar(
 	string varname, DerivedVar *derivedVar
 ) {
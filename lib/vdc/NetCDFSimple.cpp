@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cassert>
+#include <cstdint>
 #include <netcdf.h>
 #include <vapor/NetCDFSimple.h>
 
@@ -7,6 +8,92 @@ using namespace VAPoR;
 using namespace Wasp;
 using namespace std;
 
+namespace {
+
+// Helpers for SaveMetadata() and LoadMetadata()
+//
+template <class T> void write_vector(ostream &os, const vector <T> &v) {
+	NetCDFSimple::WriteValue(os, (uint64_t) v.size());
+	for (size_t i=0; i<v.size(); i++) NetCDFSimple::WriteValue(os, v[i]);
+}
+
+template <class T> bool read_vector(istream &is, vector <T> &v) {
+	uint64_t n;
+	if (! NetCDFSimple::ReadValue(is, n)) return(false);
+	if (n > (1u << 30)) return(false);	// corrupt
+
+	v.resize(n);
+	for (size_t i=0; i<v.size(); i++) {
+		if (! NetCDFSimple::ReadValue(is, v[i])) return(false);
+	}
+	return(true);
+}
+
+void write_strings(ostream &os, const vector <string> &v) {
+	NetCDFSimple::WriteValue(os, (uint64_t) v.size());
+	for (size_t i=0; i<v.size(); i++) NetCDFSimple::WriteString(os, v[i]);
+}
+
+bool read_strings(istream &is, vector <string> &v) {
+	uint64_t n;
+	if (! NetCDFSimple::ReadValue(is, n)) return(false);
+	if (n > (1u << 30)) return(false);	// corrupt
+
+	v.resize(n);
+	for (size_t i=0; i<v.size(); i++) {
+		if (! NetCDFSimple::ReadString(is, v[i])) return(false);
+	}
+	return(true);
+}
+
+template <class T> void write_atts(
+	ostream &os, const vector <pair <string, T> > &atts
+) {
+	NetCDFSimple::WriteValue(os, (uint64_t) atts.size());
+	for (size_t i=0; i<atts.size(); i++) {
+		NetCDFSimple::WriteString(os, atts[i].first);
+		write_vector(os, atts[i].second);
+	}
+}
+
+template <class T> bool read_atts(
+	istream &is, vector <pair <string, vector <T> > > &atts
+) {
+	uint64_t n;
+	if (! NetCDFSimple::ReadValue(is, n)) return(false);
+	if (n > (1u << 30)) return(false);	// corrupt
+
+	atts.resize(n);
+	for (size_t i=0; i<atts.size(); i++) {
+		if (! NetCDFSimple::ReadString(is, atts[i].first)) return(false);
+		if (! read_vector(is, atts[i].second)) return(false);
+	}
+	return(true);
+}
+
+void write_str_atts(ostream &os, const vector <pair <string, string> > &atts) {
+	NetCDFSimple::WriteValue(os, (uint64_t) atts.size());
+	for (size_t i=0; i<atts.size(); i++) {
+		NetCDFSimple::WriteString(os, atts[i].first);
+		NetCDFSimple::WriteString(os, atts[i].second);
+	}
+}
+
+bool read_str_atts(istream &is, vector <pair <string, string> > &atts) {
+	uint64_t n;
+	if (! NetCDFSimple::ReadValue(is, n)) return(false);
+	if (n > (1u << 30)) return(false);	// corrupt
+
+	atts.resize(n);
+	for (size_t i=0; i<atts.size(); i++) {
+		if (! NetCDFSimple::ReadString(is, atts[i].first)) return(false);
+		if (! NetCDFSimple::ReadString(is, atts[i].second)) return(false);
+	}
+	return(true);
+}
+
+};
+
 NetCDFSimple::NetCDFSimple() {
 	_ncid = -1;
 	_ovr_table.clear();
@@ -32,6 +119,23 @@ NetCDFSimple::~NetCDFSimple() {
 	}
 }
 
+int NetCDFSimple::CloseFile() {
+	if (_ncid == -1) return(0);
+
+	if (! _ovr_table.empty()) {
+		SetErrMsg("Can't close %s : variables are open", _path.c_str());
+		return(-1);
+	}
+
+	int rc = nc_close(_ncid);
+	_ncid = -1;
+	if (rc != 0) {
+		SetErrMsg("nc_close(%s) : %s", _path.c_str(), nc_strerror(rc));
+		return(-1);
+	}
+	return(0);
+}
+
 int NetCDFSimple::Initialize(string path)
 {
 	_dimnames.clear();
@@ -152,11 +256,140 @@ int NetCDFSimple::Initialize(string path)
 	return(0);
 }
 
+void NetCDFSimple::WriteString(ostream &os, const string &s) {
+	WriteValue(os, (uint64_t) s.size());
+	os.write(s.data(), s.size());
+}
+
+bool NetCDFSimple::ReadString(istream &is, string &s) {
+	uint64_t n;
+	if (! ReadValue(is, n)) return(false);
+	if (n > (1u << 30)) return(false);	// corrupt
+
+	s.resize(n);
+	return(n == 0 || (bool) is.read(&s[0], n));
+}
+
+int NetCDFSimple::SaveMetadata(ostream &os) const {
+
+	write_strings(os, _dimnames);
+	write_vector(os, _dims);
+	write_strings(os, _unlimited_dimnames);
+	write_atts(os, _flt_atts);
+	write_atts(os, _int_atts);
+	write_str_atts(os, _str_atts);
+
+	WriteValue(os, (uint64_t) _variables.size());
+	for (int i=0; i<_variables.size(); i++) {
+		const Variable &var = _variables[i];
+		WriteString(os, var.GetName());
+		write_strings(os, var.GetDimNames());
+		WriteValue(os, (int32_t) var.GetVarID());
+		WriteValue(os, (int32_t) var.GetXType());
+
+		// GetAttType() reports the representation the attribute is 
+		// stored with, which is all that is needed to restore it
+		//
+		vector <pair <string, vector <double> > > flt_atts;
+		vector <pair <string, vector <long> > > int_atts;
+		vector <pair <string, string> > str_atts;
+		vector <string> attnames = var.GetAttNames();
+		for (int j=0; j<attnames.size(); j++) {
+			int type = var.GetAttType(attnames[j]);
+			if (type == NC_DOUBLE) {
+				vector <double> values;
+				var.GetAtt(attnames[j], values);
+				flt_atts.push_back(make_pair(attnames[j], values));
+			}
+			else if (type == NC_INT64) {
+				vector <long> values;
+				var.GetAtt(attnames[j], values);
+				int_atts.push_back(make_pair(attnames[j], values));
+			}
+			else {
+				string values;
+				var.GetAtt(attnames[j], values);
+				str_atts.push_back(make_pair(attnames[j], values));
+			}
+		}
+		write_atts(os, flt_atts);
+		write_atts(os, int_atts);
+		write_str_atts(os, str_atts);
+	}
+
+	if (! os.good()) {
+		SetErrMsg("Failed to write metadata for %s", _path.c_str());
+		return(-1);
+	}
+	return(0);
+}
+
+int NetCDFSimple::LoadMetadata(string path, istream &is) {
+	_dimnames.clear();
+	_dims.clear();
+	_unlimited_dimnames.clear();
+	_flt_atts.clear();
+	_int_atts.clear();
+	_str_atts.clear();
+	_variables.clear();
+	_path = path;
+
+	uint64_t nvars = 0;
+	bool ok = 
+		read_strings(is, _dimnames) &&
+		read_vector(is, _dims) &&
+		read_strings(is, _unlimited_dimnames) &&
+		read_atts(is, _flt_atts) &&
+		read_atts(is, _int_atts) &&
+		read_str_atts(is, _str_atts) &&
+		ReadValue(is, nvars) && 
+		_dims.size() == _dimnames.size() &&
+		nvars < (1u << 30);
+
+	for (uint64_t i=0; ok && i<nvars; i++) {
+		string name;
+		vector <string> dimnames;
+		int32_t varid, xtype;
+		vector <pair <string, vector <double> > > flt_atts;
+		vector <pair <string, vector <long> > > int_atts;
+		vector <pair <string, string> > str_atts;
+
+		ok = 
+			ReadString(is, name) &&
+			read_strings(is, dimnames) &&
+			ReadValue(is, varid) &&
+			ReadValue(is, xtype) &&
+			read_atts(is, flt_atts) &&
+			read_atts(is, int_atts) &&
+			read_str_atts(is, str_atts);
+		if (! ok) break;
+
+		Variable var(name, dimnames, varid, xtype);
+		for (int j=0; j<flt_atts.size(); j++) {
+			var.SetAtt(flt_atts[j].first, flt_atts[j].second);
+		}
+		for (int j=0; j<int_atts.size(); j++) {
+			var.SetAtt(int_atts[j].first, int_atts[j].second);
+		}
+		for (int j=0; j<str_atts.size(); j++) {
+			var.SetAtt(str_atts[j].first, str_atts[j].second);
+		}
+		_variables.push_back(var);
+	}
+
+	if (! ok) {
+		SetErrMsg("Invalid metadata for %s", path.c_str());
+		return(-1);
+	}
+	return(0);
+}
+
 int NetCDFSimple::OpenRead(
 	const NetCDFSimple::Variable &variable
 ) {
 	//
-	// If _ncid is not valid open the NetCDF file
+	// If _ncid is not valid open the NetCDF file. It may have been
+	// closed by CloseFile() since the last read
 	//
 	if (_ncid == -1) {
 		size_t chsz = _chsz;
@@ -276,6 +276,34 @@ void    RegularGrid::GetEnclosingRegion(
 
 }
 
+bool RegularGrid::_getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+) const {
+
+	const vector <size_t> &dims = GetDimensions();
+
+	min = vector <size_t> (dims.size(), 0);
+	max = dims;
+	for (int i=0; i<dims.size(); i++) {
+		if (! dims[i]) return(false);
+		max[i]--;
+	}
+
+	// Coordinates along each axis are independent, so the range is exact
+	//
+	for (int i=0; i<dims.size() && i<minu.size() && i<maxu.size(); i++) {
+		if (dims[i] > 1 && ! (_delta[i] > 0.0)) return(false);
+
+		_regularIndexRange(
+			_minu[i], _delta[i], dims[i], minu[i], maxu[i], min[i], max[i]
+		);
+	}
+	exact = true;
+
+	return(true);
+}
+
 void RegularGrid::GetUserCoordinates(
 	const std::vector <size_t> &indices,
 	std::vector <double> &coords
@@ -429,7 +457,7 @@ RegularGrid::ConstCoordItrRG::ConstCoordItrRG() : ConstCoordItrAbstract() {
 void RegularGrid::ConstCoordItrRG::next() {
 
 	_index[0]++;
-	_coords[0] += _delta[0];
+	_coords[0] = _index[0] * _delta[0] + _minu[0];
 	if (_index[0] < _dims[0]) {
 		return;
 	}
@@ -437,7 +465,7 @@ void RegularGrid::ConstCoordItrRG::next() {
 	_index[0] = 0;
 	_coords[0] = _minu[0];
 	_index[1]++;
-	_coords[1] += _delta[1];
+	_coords[1] = _index[1] * _delta[1] + _minu[1];
 
 	if (_index[1] < _dims[1]) {
 		return;
@@ -450,7 +478,7 @@ void RegularGrid::ConstCoordItrRG::next() {
 	_index[1] = 0;
 	_coords[1] = _minu[1];
 	_index[2]++;
-	_coords[2] += _delta[2];
+	_coords[2] = _index[2] * _delta[2] + _minu[2];
 }
 
 void RegularGrid::ConstCoordItrRG::next(const long &offset) {
@@ -474,7 +502,7 @@ void RegularGrid::ConstCoordItrRG::next(const long &offset) {
     _index = Wasp::VectorizeCoords(newIndexL, _dims);
 
 	for (int i=0; i<_dims.size(); i++) {
-		_coords[i] = i * _delta[i] + _minu[i];
+		_coords[i] = _index[i] * _delta[i] + _minu[i];
 	}
 
 }
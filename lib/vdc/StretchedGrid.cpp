@@ -175,6 +175,39 @@ void StretchedGrid::GetEnclosingRegion(
 }
 
 
+bool StretchedGrid::_getNodeIndexBox(
+	const std::vector <double> &minu, const std::vector <double> &maxu,
+	std::vector <size_t> &min, std::vector <size_t> &max, bool &exact
+) const {
+
+	const vector <size_t> &dims = GetDimensions();
+
+	min = vector <size_t> (dims.size(), 0);
+	max = dims;
+	for (int i=0; i<dims.size(); i++) {
+		if (! dims[i]) return(false);
+		max[i]--;
+	}
+
+	const vector <double> *coords[] = {&_xcoords, &_ycoords, &_zcoords};
+
+	// Coordinates along each axis are independent, so the range is exact
+	//
+	for (int i=0; i<dims.size() && i<minu.size() && i<maxu.size(); i++) {
+		const vector <double> &u = *coords[i];
+		if (u.size() != dims[i]) return(false);
+
+		// Binary search requires increasing coordinates
+		//
+		if (u.size() > 1 && ! (u.front() < u.back())) return(false);
+
+		_sortedIndexRange(u, minu[i], maxu[i], min[i], max[i]);
+	}
+	exact = true;
+
+	return(true);
+}
+
 void StretchedGrid::GetUserCoordinates(
 	const std::vector <size_t> &indices,
 	std::vector <double> &coords
@@ -2,6 +2,7 @@
 #include <vector>
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include <time.h>
 #ifdef  Darwin
 #include <mach/mach_time.h>
@@ -213,6 +214,90 @@ void StructuredGrid::ClampCoord(std::vector <double> &coords) const {
 	}
 }
 
+void StructuredGrid::_regularIndexRange(
+	double origin, double delta, size_t n, double umin, double umax,
+	size_t &lo, size_t &hi
+) {
+	lo = 1;
+	hi = 0;
+	if (! n || ! (umin <= umax)) return;
+
+	if (n == 1) {
+		if (origin >= umin && origin <= umax) lo = hi = 0;
+		return;
+	}
+	assert(delta > 0.0);
+
+	double l = ceil((umin - origin) / delta);
+	double h = floor((umax - origin) / delta);
+	if (l < 0.0) l = 0.0;
+	if (h > (double) (n-1)) h = (double) (n-1);
+	if (l > h) return;
+
+	lo = (size_t) l;
+	hi = (size_t) h;
+
+	// Correct for round off. The coordinates are computed the same way 
+	// they are by GetUserCoordinates() so that the range is exact
+	//
+	while (lo > 0 && (lo-1) * delta + origin >= umin) lo--;
+	while (lo <= hi && lo * delta + origin < umin) lo++;
+	while (hi+1 < n && (hi+1) * delta + origin <= umax) hi++;
+	while (hi >= lo && hi * delta + origin > umax) {
+		if (hi == 0) {
+			lo = 1;
+			return;
+		}
+		hi--;
+	}
+}
+
+void StructuredGrid::_sortedIndexRange(
+	const vector <double> &u, double umin, double umax,
+	size_t &lo, size_t &hi
+) {
+	lo = 1;
+	hi = 0;
+	if (! u.size() || ! (umin <= umax)) return;
+
+	size_t end = upper_bound(u.begin(), u.end(), umax) - u.begin();
+	lo = lower_bound(u.begin(), u.end(), umin) - u.begin();
+	if (lo >= end) {
+		lo = 1;
+		return;
+	}
+	hi = end - 1;
+}
+
+void StructuredGrid::_layerIndexRange(
+	const Grid &zg, double zmin, double zmax,
+	vector <size_t> &min, vector <size_t> &max
+) {
+	assert(min.size() == 3 && max.size() == 3);
+
+	for (int pass=0; pass<2; pass++) {
+		while (min[2] <= max[2]) {
+			size_t k = pass == 0 ? min[2] : max[2];
+
+			bool outside = true;
+			for (size_t j=min[1]; j<=max[1] && outside; j++) {
+			for (size_t i=min[0]; i<=max[0] && outside; i++) {
+				double z = zg.AccessIJK(i,j,k);
+				if (z >= zmin && z <= zmax) outside = false;
+			}
+			}
+			if (! outside) break;
+
+			if (pass == 0) min[2]++;
+			else if (max[2] == 0) {
+				min[2] = 1;
+				break;
+			}
+			else max[2]--;
+		}
+	}
+}
+
 namespace VAPoR {
 std::ostream &operator<<(std::ostream &o, const StructuredGrid &sg)
 {
@@ -34,12 +34,14 @@ UnstructuredGrid2D::UnstructuredGrid2D(
     const UnstructuredGridCoordless &xug,
     const UnstructuredGridCoordless &yug,
     const UnstructuredGridCoordless &zug,
-	const KDTreeRG *kdtree
+	const KDTreeRG *kdtree,
+	CellLocator2D *locator
 ) : UnstructuredGrid(
 		vertexDims, faceDims, edgeDims, bs, blks, 2,
 		vertexOnFace, faceOnVertex, faceOnFace, location, 
 		maxVertexPerFace, maxFacePerVertex
-	), _xug(xug), _yug(yug), _zug(zug), _kdtree(kdtree) {
+	), _xug(xug), _yug(yug), _zug(zug), _kdtree(kdtree),
+	_locator(locator) {
 
 	assert(xug.GetDimensions() == GetDimensions());
 	assert(yug.GetDimensions() == GetDimensions());
@@ -52,6 +54,17 @@ UnstructuredGrid2D::UnstructuredGrid2D(
 
 }
 
+// The locator is shared by all grids on the same mesh, and is built by
+// the first one that's queried
+//
+const CellLocator2D *UnstructuredGrid2D::_getLocator() const {
+	_locator->Build(
+		_xug, _yug, _vertexOnFace, GetCellDimensions()[0], _maxVertexPerFace,
+		GetMissingID(), GetNodeOffset()
+	);
+	return(_locator);
+}
+
 size_t UnstructuredGrid2D::GetGeometryDim() const {
 	return(_zug.GetDimensions().size() == 0 ? 2 : 3);
 }
@@ -256,6 +269,28 @@ float UnstructuredGrid2D::GetValueLinear (
 	vector <double> cCoords = coords;
 	ClampCoord(cCoords);
 
+	long offset = GetNodeOffset();
+
+	// The cell locator avoids the heap allocations below
+	//
+	if (_locator && _location == NODE) {
+		size_t face;
+		size_t nodes[CellLocator2D::MaxNodes];
+		double lambda[CellLocator2D::MaxNodes];
+		int nlambda;
+
+		bool inside = _getLocator()->Locate(
+			cCoords[0], cCoords[1], face, nodes, lambda, nlambda
+		);
+		if (! inside) return (GetMissingValue());
+
+		double value = 0;
+		for (int i=0; i<nlambda; i++) {
+			value += AccessIJK(nodes[i], 0, 0) * lambda[i];
+		}
+		return((float) value);
+	}
+
 	double *lambda = new double[_maxVertexPerFace];
 	int nlambda;
 	size_t face;
@@ -276,7 +311,6 @@ float UnstructuredGrid2D::GetValueLinear (
 	const int *ptr = _vertexOnFace + (face * _maxVertexPerFace);
 
 	double value = 0;
-	long offset = GetNodeOffset();
 	for (int i=0; i<nlambda; i++) {
 		value += AccessIJK(*ptr + offset, 0, 0) * lambda[i];
 		ptr++;
@@ -287,6 +321,63 @@ float UnstructuredGrid2D::GetValueLinear (
 	return((float) value);
 }
 
+void UnstructuredGrid2D::GetValues(
+	size_t n, const double *x, const double *y, float *values
+) const {
+
+	vector <double> coords(2);
+
+	if (! _locator || _location != NODE || ! GetBlks().size() || 
+		GetInterpolationOrder() == 0) {
+
+		for (size_t i=0; i<n; i++) {
+			coords[0] = x[i];
+			coords[1] = y[i];
+			values[i] = GetValue(coords);
+		}
+		return;
+	}
+
+	// Locate points in batches small enough for the cell indices and
+	// weights to live on the stack
+	//
+	const size_t batch = 64;
+	double xb[batch], yb[batch];
+	long cells[batch];
+	size_t nodes[batch * CellLocator2D::MaxNodes];
+	double lambda[batch * CellLocator2D::MaxNodes];
+	int nnodes[batch];
+
+	for (size_t i0=0; i0<n; i0+=batch) {
+		size_t nb = n - i0 < batch ? n - i0 : batch;
+
+		for (size_t i=0; i<nb; i++) {
+			coords[0] = x[i0+i];
+			coords[1] = y[i0+i];
+			ClampCoord(coords);
+			xb[i] = coords[0];
+			yb[i] = coords[1];
+		}
+
+		_getLocator()->Locate(nb, xb, yb, cells, nodes, lambda, nnodes);
+
+		for (size_t i=0; i<nb; i++) {
+			if (cells[i] < 0) {
+				values[i0+i] = GetMissingValue();
+				continue;
+			}
+
+			const size_t *inodes = nodes + i*CellLocator2D::MaxNodes;
+			const double *ilambda = lambda + i*CellLocator2D::MaxNodes;
+			double value = 0;
+			for (int j=0; j<nnodes[i]; j++) {
+				value += AccessIJK(inodes[j], 0, 0) * ilambda[j];
+			}
+			values[i0+i] = (float) value;
+		}
+	}
+}
+
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -422,6 +513,22 @@ bool UnstructuredGrid2D::_insideGridNodeCentered(
 
 	assert(coords.size() == 2);
 
+	if (_locator) {
+		size_t nodev[CellLocator2D::MaxNodes];
+		double lambdav[CellLocator2D::MaxNodes];
+
+		bool inside = _getLocator()->Locate(
+			coords[0], coords[1], face_index, nodev, lambdav, nlambda
+		);
+		if (! inside) return(false);
+
+		for (int i=0; i<nlambda; i++) {
+			nodes.push_back(nodev[i]);
+			lambda[i] = lambdav[i];
+		}
+		return(true);
+	}
+
 	double pt[] = {coords[0], coords[1]};
 
 	// Find the indices for the nearest grid point in the plane
@@ -86,6 +86,10 @@ VDC::VDC() {
 	_cratios.push_back(10);
 	_cratios.push_back(1);
 
+	_maxError = -1.0;
+	_relativeError = false;
+	_quantNBits = 0;
+
 	_periodic.clear();
 	for (int i=0; i<3; i++) _periodic.push_back(false);
 
@@ -161,6 +165,15 @@ int VDC::SetCompressionBlock(
 	return(0);
 }
 
+int VDC::SetCoeffQuantization(int nbits) {
+	if (nbits != 0 && (nbits < 2 || nbits > 32)) {
+		SetErrMsg("Invalid quantization bit depth : %d", nbits);
+		return(-1);
+	}
+	_quantNBits = nbits;
+	return(0);
+}
+
 void VDC::GetCompressionBlock(
     vector <size_t> &bs, string &wname,
     vector <size_t> &cratios
@@ -576,6 +589,23 @@ int VDC::_DefineDataVar(
 		);
 	}
 
+	// The error bound is recorded as an attribute so that it persists
+	// until the variable is defined in its data files
+	//
+	if (compressed && _maxError >= 0.0) {
+		vector <double> bound;
+		bound.push_back(_maxError);
+		bound.push_back(_relativeError ? 1.0 : 0.0);
+		_dataVars[varname].SetAttribute(
+			Attribute("ErrorBound", DOUBLE, bound)
+		);
+	}
+	if (compressed && _quantNBits) {
+		_dataVars[varname].SetAttribute(
+			Attribute("Quantization", INT32, vector <int> (1, _quantNBits))
+		);
+	}
+
 	return(0);
 }
 
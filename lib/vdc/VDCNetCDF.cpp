@@ -1907,10 +1907,39 @@ int VDCNetCDF::_DefBaseVar(
 		bs.pop_back();
 	}
 	reverse(bs.begin(), bs.end());	// NetCDF order
-	int rc = wasp->DefVar(
-		var.GetName(), vdc_xtype2ncdf_xtype(var.GetXType()), 
-		dimnames, var.GetWName(), bs, var.GetCRatios()
-	);
+
+	// Compressed variables may carry an error bound or a coefficient 
+	// quantization. See VDC::SetErrorBound() and 
+	// VDC::SetCoeffQuantization()
+	//
+	Attribute bound_att;
+	vector <double> bound;
+	if (! var.GetWName().empty() && var.GetAttribute("ErrorBound", bound_att)) {
+		bound_att.GetValues(bound);
+	}
+
+	Attribute quant_att;
+	vector <int> quant;
+	if (! var.GetWName().empty() && var.GetAttribute("Quantization", quant_att)) {
+		quant_att.GetValues(quant);
+	}
+
+	int rc = wasp->SetCoeffQuantization(quant.size() == 1 ? quant[0] : 0);
+	if (rc<0) return(-1);
+
+	if (bound.size() == 2) {
+		rc = wasp->DefVar(
+			var.GetName(), vdc_xtype2ncdf_xtype(var.GetXType()), 
+			dimnames, var.GetWName(), bs, var.GetCRatios(),
+			bound[0], bound[1] != 0.0
+		);
+	}
+	else {
+		rc = wasp->DefVar(
+			var.GetName(), vdc_xtype2ncdf_xtype(var.GetXType()), 
+			dimnames, var.GetWName(), bs, var.GetCRatios()
+		);
+	}
 	if (rc<0) return(-1);
 
 	// 
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <cassert>
 #include <vapor/vizutil.h>
+#include <vapor/Grid.h>
 
 namespace {
 
@@ -264,13 +265,18 @@ bool VAPoR::WachspressCoords2D(
 			i1 = (curr+1) % n;
 		}
 
-		double w;
-		if (verts[i0*2] != verts[i1*2]) {
-			w = 1.0-((pt[0]-verts[i0*2])/(verts[i1*2]-verts[i0*2]));
-		}
-		else {
-			w = 1.0-((pt[1]-verts[i0*2+1])/(verts[i1*2+1]-verts[i0*2+1]));
-		}
+		// Project the point onto the edge. Using a single axis is 
+		// ill-conditioned for edges that are nearly parallel to the
+		// other axis
+		//
+		double ex = verts[i1*2] - verts[i0*2];
+		double ey = verts[i1*2+1] - verts[i0*2+1];
+		double len2 = ex*ex + ey*ey;
+		if (len2 == 0.0) return(false);
+
+		double w = 1.0 - (
+			((pt[0]-verts[i0*2])*ex + (pt[1]-verts[i0*2+1])*ey) / len2
+		);
 
 		lambda[i0] = w;
 		lambda[i1] = 1.0 - w;
@@ -314,5 +320,61 @@ bool VAPoR::InsideConvexPolygon(
 	return(false);
 }
 
+void VAPoR::ContourLines2D(
+	const Grid &grid, const Grid *heightGrid,
+	const std::vector <double> &boxMin, const std::vector <double> &boxMax,
+	const std::vector <double> &contours, 
+	std::vector <float> &vertices, std::vector <int> &contourIndex
+) {
+	vertices.clear();
+	contourIndex.clear();
+
+	float mv = grid.GetMissingValue();
+
+	std::vector <std::vector <size_t> > nodes;
+	std::vector <std::vector <double> > coords;
+	std::vector <float> values;
 
+	Grid::ConstCellIterator it = grid.ConstCellBegin(boxMin, boxMax);
+	Grid::ConstCellIterator end = grid.ConstCellEnd();
+	for (; it != end; ++it) {
+		grid.GetCellNodes(*it, nodes);
 
+		int n = nodes.size();
+		coords.resize(n);
+		values.resize(n);
+
+		bool hasMissing = false;
+		for (int i=0; i<n; i++) {
+			grid.GetUserCoordinates(nodes[i], coords[i]);
+			values[i] = grid.GetValue(coords[i]);
+			if (values[i] == mv) hasMissing = true;
+		}
+		if (hasMissing) continue;
+
+		for (int ci=0; ci<contours.size(); ci++) {
+			double contour = contours[ci];
+
+			for (int a=n-1, b=0; b<n; a++, b++) {
+				if (a == n) a = 0;
+
+				if ((values[a] <= contour && values[b] <= contour) ||
+					(values[a] > contour && values[b] > contour)) continue;
+
+				float t = (contour - values[a]) / (values[b] - values[a]);
+
+				float z = 0.0;
+				if (heightGrid) {
+					float aHeight = heightGrid->GetValue(coords[a]);
+					float bHeight = heightGrid->GetValue(coords[b]);
+					z = aHeight + t * (bHeight - aHeight);
+				}
+
+				vertices.push_back(coords[a][0] + t*(coords[b][0]-coords[a][0]));
+				vertices.push_back(coords[a][1] + t*(coords[b][1]-coords[a][1]));
+				vertices.push_back(z);
+				contourIndex.push_back(ci);
+			}
+		}
+	}
+}
@@ -0,0 +1,499 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <vapor/CoeffCodec.h>
+
+using namespace VAPoR;
+
+namespace {
+
+// Coding modes recorded in the stream header
+//
+const unsigned char RICE_MODE = 0;
+const unsigned char PACKED_MODE = 1;
+
+const unsigned char MAGIC = 0x51;
+
+// Quotients this large are escaped and followed by the value in
+// 'nbits' bits
+//
+const int ESCAPE = 24;
+
+// Rice parameter statistics are halved after this many values so the
+// coder tracks local changes in coefficient magnitude
+//
+const uint64_t RESET = 64;
+
+void put_uint(unsigned char *p, uint64_t v, int nbytes) {
+	for (int i=0; i<nbytes; i++) {
+		p[i] = (unsigned char) (v & 0xff);
+		v >>= 8;
+	}
+}
+
+uint64_t get_uint(const unsigned char *p, int nbytes) {
+	uint64_t v = 0;
+	for (int i=nbytes-1; i>=0; i--) {
+		v = (v << 8) | p[i];
+	}
+	return(v);
+}
+
+inline uint64_t zigzag(int64_t q) {
+	return((uint64_t) ((q << 1) ^ (q >> 63)));
+}
+
+inline int64_t unzigzag(uint64_t u) {
+	return((int64_t) (u >> 1) ^ -((int64_t) (u & 1)));
+}
+
+inline int rice_param(uint64_t a, uint64_t n, int kmax) {
+	int k = 0;
+	while (k < kmax && (n << k) < a) k++;
+	return(k);
+}
+
+inline int trailing_ones(uint64_t v) {
+#ifdef __GNUC__
+	return(~v ? __builtin_ctzll(~v) : 64);
+#else
+	int n = 0;
+	while (n < 64 && (v & 1)) {
+		v >>= 1;
+		n++;
+	}
+	return(n);
+#endif
+}
+
+// Writes bit fields least significant bit first
+//
+class BitWriter {
+public:
+ BitWriter(unsigned char *p) : _p(p), _acc(0), _nacc(0) {}
+
+ // n <= 32
+ //
+ void Put(uint64_t v, int n) {
+	_acc |= v << _nacc;
+	_nacc += n;
+	while (_nacc >= 8) {
+		*_p++ = (unsigned char) (_acc & 0xff);
+		_acc >>= 8;
+		_nacc -= 8;
+	}
+ }
+
+ unsigned char *Flush() {
+	if (_nacc) *_p++ = (unsigned char) (_acc & 0xff);
+	_acc = 0;
+	_nacc = 0;
+	return(_p);
+ }
+
+ const unsigned char *Ptr() const {return(_p); };
+
+private:
+ unsigned char *_p;
+ uint64_t _acc;
+ int _nacc;
+};
+
+class BitReader {
+public:
+ BitReader(const unsigned char *p, const unsigned char *end) :
+	_p(p), _end(end), _acc(0), _nacc(0) {}
+
+ // n <= 32. Returns false if the stream is exhausted
+ //
+ bool Get(int n, uint64_t &v) {
+	_refill();
+	if (_nacc < n) return(false);
+	v = n ? _acc & (~(uint64_t) 0 >> (64-n)) : 0;
+	_acc = n < 64 ? _acc >> n : 0;
+	_nacc -= n;
+	return(true);
+ }
+
+ // Count up to 'max' one bits, consuming the terminating zero if
+ // fewer than 'max' ones are found
+ //
+ bool Unary(int max, int &q) {
+	_refill();
+	uint64_t acc = _nacc < 64 ? _acc | (~(uint64_t) 0 << _nacc) : _acc;
+	q = trailing_ones(acc);
+	if (q >= max) {
+		q = max;
+		if (_nacc < max) return(false);
+		_acc >>= max;
+		_nacc -= max;
+		return(true);
+	}
+	if (q >= _nacc) return(false);
+	_acc >>= q+1;
+	_nacc -= q+1;
+	return(true);
+ }
+
+private:
+ const unsigned char *_p;
+ const unsigned char *_end;
+ uint64_t _acc;
+ int _nacc;
+
+ void _refill() {
+	while (_nacc <= 56 && _p < _end) {
+		_acc |= (uint64_t) *_p++ << _nacc;
+		_nacc += 8;
+	}
+ }
+};
+
+inline double dequantize(int64_t q, double step, double dummy) {
+	return(q * step);
+}
+
+inline long dequantize(int64_t q, double step, long dummy) {
+	return((long) floor(q * step + 0.5));
+}
+
+// Verbatim (subband 0) coefficients are stored as 64 bit words
+//
+inline uint64_t to_verbatim(double v) {
+	uint64_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return(bits);
+}
+
+inline uint64_t to_verbatim(long v) {
+	return((uint64_t) (int64_t) v);
+}
+
+inline void from_verbatim(uint64_t bits, double &v) {
+	memcpy(&v, &bits, sizeof(v));
+}
+
+inline void from_verbatim(uint64_t bits, long &v) {
+	v = (long) (int64_t) bits;
+}
+
+inline int band_of(const unsigned char *bands, size_t i) {
+	return(bands ? bands[i] : 1);
+}
+
+// Stream layout:
+//
+//	bytes 0-3	stream length
+//	byte 4		coding mode
+//	byte 5		bit depth
+//	byte 6		MAGIC
+//	byte 7		number of subbands, nbands
+//	bytes 8-15	number of verbatim coefficients, napprox
+//
+// followed by the step sizes of subbands 1..nbands-1 as 32 bit floats,
+// napprox verbatim coefficients as 64 bit words, and the Rice coded or
+// packed quantized values of the remaining coefficients
+//
+const size_t STEP_SZ = 4;
+const size_t VERBATIM_SZ = 8;
+
+template <class T>
+void encode_template(
+	const T *src, const unsigned char *bands, int nbands, size_t n, 
+	int nbits, std::vector <long> &qvec, std::vector <double> &steps,
+	unsigned char *dst, size_t &nbytes
+) {
+	const int64_t qmax = ((int64_t) 1 << (nbits-1)) - 1;
+
+	if (! bands) nbands = 2;
+	assert(nbands >= 1 && nbands <= 255);
+
+	// Largest magnitude in each detail subband
+	//
+	steps.assign(nbands, 0.0);
+	size_t napprox = 0;
+	for (size_t i=0; i<n; i++) {
+		int b = band_of(bands, i);
+		assert(b < nbands);
+		if (b == 0) {
+			napprox++;
+			continue;
+		}
+		double a = fabs((double) src[i]);
+		if (a > steps[b]) steps[b] = a;
+	}
+
+	for (int b=1; b<nbands; b++) {
+		double maxabs = steps[b];
+		double step = maxabs / (double) qmax;
+
+		// Integer coefficients that already fit are stored losslessly
+		//
+		if (std::numeric_limits<T>::is_integer && maxabs <= (double) qmax) {
+			step = 1.0;
+		}
+
+		// Quantize with the step as stored
+		//
+		steps[b] = (double) (float) step;
+	}
+
+	qvec.resize(n);
+	for (size_t i=0; i<n; i++) {
+		int b = band_of(bands, i);
+		double step = steps[b];
+
+		int64_t q = 0;
+		if (b != 0 && step > 0.0) {
+			q = (int64_t) floor(src[i] / step + 0.5);
+			if (q > qmax) q = qmax;
+			if (q < -qmax) q = -qmax;
+		}
+		qvec[i] = (long) q;
+	}
+
+	unsigned char *ptr = dst + CoeffCodec::GetHeaderSize();
+	for (int b=1; b<nbands; b++) {
+		float step = (float) steps[b];
+		uint32_t stepbits;
+		memcpy(&stepbits, &step, sizeof(stepbits));
+		put_uint(ptr, stepbits, STEP_SZ);
+		ptr += STEP_SZ;
+	}
+	for (size_t i=0; i<n; i++) {
+		if (band_of(bands, i) != 0) continue;
+		put_uint(ptr, to_verbatim(src[i]), VERBATIM_SZ);
+		ptr += VERBATIM_SZ;
+	}
+
+	size_t packed_size = CoeffCodec::GetMaxEncodedSize(
+		n, nbits, nbands, napprox
+	);
+
+	// Rice code the quantized values, abandoning the attempt if the
+	// result grows larger than a fixed width packing
+	//
+	unsigned char mode = RICE_MODE;
+	BitWriter rice(ptr);
+	uint64_t a = 16;
+	uint64_t cnt = 1;
+	for (size_t i=0; i<n; i++) {
+		if (band_of(bands, i) == 0) continue;
+
+		if ((size_t) (rice.Ptr() - dst) + 8 > packed_size) {
+			mode = PACKED_MODE;
+			break;
+		}
+		uint64_t u = zigzag(qvec[i]);
+		int k = rice_param(a, cnt, nbits);
+		uint64_t q = u >> k;
+		if (q < ESCAPE) {
+			rice.Put((((uint64_t) 1) << q) - 1, q+1);
+			rice.Put(u & ((((uint64_t) 1) << k) - 1), k);
+		}
+		else {
+			rice.Put((((uint64_t) 1) << ESCAPE) - 1, ESCAPE);
+			rice.Put(u, nbits);
+		}
+
+		a += u;
+		cnt++;
+		if (cnt == RESET) {
+			a >>= 1;
+			cnt >>= 1;
+		}
+	}
+	unsigned char *end = rice.Flush();
+	if ((size_t) (end - dst) > packed_size) mode = PACKED_MODE;
+
+	if (mode == PACKED_MODE) {
+		BitWriter packed(ptr);
+		for (size_t i=0; i<n; i++) {
+			if (band_of(bands, i) == 0) continue;
+			packed.Put(zigzag(qvec[i]), nbits);
+		}
+		end = packed.Flush();
+	}
+	nbytes = end - dst;
+
+	put_uint(dst, nbytes, 4);
+	dst[4] = mode;
+	dst[5] = (unsigned char) nbits;
+	dst[6] = MAGIC;
+	dst[7] = (unsigned char) nbands;
+	put_uint(dst+8, napprox, 8);
+}
+
+template <class T>
+int decode_template(
+	const unsigned char *src, size_t srclen, const unsigned char *bands,
+	T *dst, size_t n
+) {
+	size_t nbytes;
+	int rc = CoeffCodec::GetEncodedSize(src, nbytes);
+	if (rc<0) return(-1);
+
+	if (nbytes > srclen) {
+		CoeffCodec::SetErrMsg("Truncated coefficient stream");
+		return(-1);
+	}
+
+	unsigned char mode = src[4];
+	int nbits = src[5];
+	int nbands = src[7];
+	size_t napprox = get_uint(src+8, 8);
+
+	const unsigned char *end = src + nbytes;
+	const unsigned char *ptr = src + CoeffCodec::GetHeaderSize();
+	if (napprox > n ||
+		(size_t) (end - ptr) < (nbands-1)*STEP_SZ + napprox*VERBATIM_SZ) {
+
+		CoeffCodec::SetErrMsg("Invalid coefficient stream");
+		return(-1);
+	}
+
+	std::vector <double> steps(nbands, 0.0);
+	for (int b=1; b<nbands; b++) {
+		uint32_t stepbits = (uint32_t) get_uint(ptr, STEP_SZ);
+		float step;
+		memcpy(&step, &stepbits, sizeof(step));
+		steps[b] = step;
+		ptr += STEP_SZ;
+	}
+
+	const unsigned char *verbatim = ptr;
+	const unsigned char *verbatim_end = ptr + napprox*VERBATIM_SZ;
+
+	BitReader reader(verbatim_end, end);
+
+	T dummy = 0;
+	uint64_t a = 16;
+	uint64_t cnt = 1;
+	for (size_t i=0; i<n; i++) {
+		int b = band_of(bands, i);
+		if (b >= nbands) {
+			CoeffCodec::SetErrMsg("Coefficient stream subband mismatch");
+			return(-1);
+		}
+
+		if (b == 0) {
+			if (verbatim >= verbatim_end) {
+				CoeffCodec::SetErrMsg("Coefficient stream subband mismatch");
+				return(-1);
+			}
+			from_verbatim(get_uint(verbatim, VERBATIM_SZ), dst[i]);
+			verbatim += VERBATIM_SZ;
+			continue;
+		}
+
+		uint64_t u;
+		if (mode == PACKED_MODE) {
+			if (! reader.Get(nbits, u)) {
+				CoeffCodec::SetErrMsg("Truncated coefficient stream");
+				return(-1);
+			}
+			dst[i] = dequantize(unzigzag(u), steps[b], dummy);
+			continue;
+		}
+
+		int k = rice_param(a, cnt, nbits);
+
+		int q;
+		bool ok = reader.Unary(ESCAPE, q);
+		if (ok && q < ESCAPE) {
+			ok = reader.Get(k, u);
+			u |= (uint64_t) q << k;
+		}
+		else if (ok) {
+			ok = reader.Get(nbits, u);
+		}
+		if (! ok) {
+			CoeffCodec::SetErrMsg("Truncated coefficient stream");
+			return(-1);
+		}
+
+		dst[i] = dequantize(unzigzag(u), steps[b], dummy);
+
+		a += u;
+		cnt++;
+		if (cnt == RESET) {
+			a >>= 1;
+			cnt >>= 1;
+		}
+	}
+
+	if (verbatim != verbatim_end) {
+		CoeffCodec::SetErrMsg("Coefficient stream subband mismatch");
+		return(-1);
+	}
+	return(0);
+}
+
+};
+
+CoeffCodec::CoeffCodec(int nbits) {
+	if (nbits < 2) nbits = 2;
+	if (nbits > 32) nbits = 32;
+	_nbits = nbits;
+}
+
+size_t CoeffCodec::GetMaxEncodedSize(
+	size_t n, int nbits, int nbands, size_t napprox
+) {
+	assert(napprox <= n);
+	assert(nbands >= 1);
+
+	return(
+		GetHeaderSize() + (nbands-1)*STEP_SZ + napprox*VERBATIM_SZ +
+		(((n-napprox) * nbits + 7) / 8)
+	);
+}
+
+int CoeffCodec::GetEncodedSize(const unsigned char *header, size_t &nbytes) {
+	nbytes = 0;
+
+	if (header[6] != MAGIC ||
+		(header[4] != RICE_MODE && header[4] != PACKED_MODE) ||
+		! IsValidNumBits(header[5]) || header[7] < 1) {
+
+		SetErrMsg("Invalid coefficient stream header");
+		return(-1);
+	}
+
+	nbytes = get_uint(header, 4);
+	if (nbytes < GetHeaderSize()) {
+		SetErrMsg("Invalid coefficient stream header");
+		return(-1);
+	}
+	return(0);
+}
+
+void CoeffCodec::Encode(
+	const double *src, const unsigned char *bands, int nbands, size_t n,
+	unsigned char *dst, size_t &nbytes
+) {
+	encode_template(src, bands, nbands, n, _nbits, _qvec, _steps, dst, nbytes);
+}
+
+void CoeffCodec::Encode(
+	const long *src, const unsigned char *bands, int nbands, size_t n,
+	unsigned char *dst, size_t &nbytes
+) {
+	encode_template(src, bands, nbands, n, _nbits, _qvec, _steps, dst, nbytes);
+}
+
+int CoeffCodec::Decode(
+	const unsigned char *src, size_t srclen, const unsigned char *bands,
+	double *dst, size_t n
+) const {
+	return(decode_template(src, srclen, bands, dst, n));
+}
+
+int CoeffCodec::Decode(
+	const unsigned char *src, size_t srclen, const unsigned char *bands,
+	long *dst, size_t n
+) const {
+	return(decode_template(src, srclen, bands, dst, n));
+}
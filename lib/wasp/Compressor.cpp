@@ -3,6 +3,8 @@
 //
 #include <cstring>
 #include <algorithm>
+#include <functional>
+#include <cassert>
 #include <iostream>
 #include <cmath>
 #include <vapor/Compressor.h>
@@ -18,7 +20,7 @@ void Compressor::_Compressor(
 
 	_dims.clear();
 	_nlevels = 0;
-	_indexvec.clear();
+	_magvec.clear();
 	_nx = 1;
 	_ny = 1;
 	_nz = 1;
@@ -89,7 +91,7 @@ void Compressor::_Compressor(
 		_LLen = _nlevels+2;
 		computeL(_nx, _nlevels, _L);
 	}
-	_indexvec.reserve(_CLen);
+	_magvec.reserve(_CLen);
 
 }
 
@@ -125,26 +127,103 @@ Compressor::~Compressor() {
 }
 
 
+namespace {
+
 //
-// Comparision functions for the C++ Std Lib sort function
+// Select the coefficients C[numkeep..clen-1] with the largest magnitudes
+// and distribute them among one or more levels: the lens[0] largest
+// go to level 0, the next lens[1] largest to level 1, and so on. The
+// selected coefficients of each level are copied to dst_arr, in
+// order of increasing index, and their locations recorded in
+// the level's significance map.
 //
-inline bool my_compare_f(const void * x1, const void * x2) {
-	return(fabsf(* (float *) x1) > fabsf(* (float *) x2));
-}
+// Rather than sorting all of the coefficients, nth_element() is used
+// to find the magnitude threshold of each level. A single pass
+// over the coefficients then emits every level. Ties at a threshold
+// are broken by coefficient index. mags is scratch space.
+//
+template <class T>
+int select_coeffs(
+	const T *C,
+	size_t numkeep,
+	size_t clen,
+	const vector <size_t> &lens,
+	T *dst_arr,
+	const vector <SignificanceMap *> &sigmaps,
+	vector <double> &mags
+) {
+	size_t nlevels = lens.size();
+	size_t n = clen - numkeep;
+
+	vector <size_t> cumlens(nlevels);	// # coeffs in levels 0..j
+	vector <T *> dsts(nlevels);
+	for (size_t j=0, sum=0; j<nlevels; j++) {
+		dsts[j] = dst_arr + sum;
+		sum += lens[j];
+		cumlens[j] = sum;
+	}
+	if (! nlevels || cumlens[nlevels-1] == 0) return(0);
+	assert(cumlens[nlevels-1] <= n);
 
-inline bool my_compare_d(const void * x1, const void * x2) {
-	return(fabs(* (double *) x1) > fabs(* (double *) x2));
-}
+	mags.resize(n);
+	for (size_t i=0; i<n; i++) mags[i] = fabs((double) C[numkeep+i]);
 
-inline bool my_compare_i(const void * x1, const void * x2) {
-	return(abs(* (int *) x1) > abs(* (int *) x2));
-}
+	// thresholds[j] is the magnitude of the cumlens[j]'th largest
+	// coefficient. Levels with no coefficients before them are inactive.
+	//
+	vector <double> thresholds(nlevels, 0.0);
+	vector <bool> active(nlevels, false);
+	vector <double>::iterator first = mags.begin();
+	for (size_t j=0; j<nlevels; j++) {
+		if (cumlens[j] == 0) continue;
+
+		active[j] = true;
+		vector <double>::iterator nth = mags.begin() + cumlens[j] - 1;
+		if (nth >= first) {
+			nth_element(first, nth, mags.end(), greater <double> ());
+			first = nth + 1;
+		}
+		thresholds[j] = *nth;
+	}
 
-inline bool my_compare_l(const void * x1, const void * x2) {
-	return(labs(* (long *) x1) > labs(* (long *) x2));
-}
+	// Number of coefficients at each threshold that belong to the top
+	// cumlens[j]
+	//
+	vector <size_t> need(nlevels, 0);
+	for (size_t j=0; j<nlevels; j++) {
+		if (! active[j]) continue;
+		size_t ngreater = 0;
+		for (size_t i=0; i<n; i++) {
+			if (mags[i] > thresholds[j]) ngreater++;
+		}
+		need[j] = cumlens[j] - ngreater;
+	}
 
-namespace {
+	vector <size_t> tieSeen(nlevels, 0);
+	for (size_t idx=numkeep; idx<clen; idx++) {
+		double m = fabs((double) C[idx]);
+
+		size_t level = nlevels;
+		for (size_t j=0; j<nlevels; j++) {
+			if (! active[j]) continue;
+
+			if (m > thresholds[j]) {
+				if (level == nlevels) level = j;
+				break;
+			}
+			if (m == thresholds[j]) {
+				if (level == nlevels && tieSeen[j] < need[j]) level = j;
+				tieSeen[j]++;
+			}
+		}
+		if (level == nlevels) continue;
+
+		*(dsts[level]++) = C[idx];
+		int rc = sigmaps[level]->Set(idx);
+		if (rc<0) return(-1);
+	}
+	return(0);
+}
 
 template <class T>
 int compress_template(
@@ -158,8 +237,7 @@ int compress_template(
 	SignificanceMap *sigmap,
 	const vector <size_t> &dims,
 	size_t nlevels,
-	vector <void *> indexvec,
-	bool my_compare(const void *, const void *)
+	vector <double> &mags
 ) {
 
 	if (! C) {
@@ -207,9 +285,8 @@ int compress_template(
 	
 	sigmap->Clear();
 
-	// Data has been transformed. Now we need to sort it and find
-	// the threshold value. Note: we don't actually move the data. We
-	// sort an index array that references the data array.
+	// Data has been transformed. Now we need to find the largest
+	// coefficients. Note: we don't actually move the data.
 
 	for (size_t i = 0; i<dst_arr_len; i++) dst_arr[i] = 0.0;
 
@@ -226,23 +303,14 @@ int compress_template(
 		dst_arr_len -= numkeep;
 	}
 
-	indexvec.clear();
-	for (size_t i=numkeep; i<clen; i++) indexvec.push_back(&C[i]);
-    sort(indexvec.begin(), indexvec.end(), my_compare);
-
-
 	// Copy coefficients that are larger than the threshold to
 	// the destination array. Record their location in the significance
 	// map.
 	//
-
-	sort(indexvec.begin(), indexvec.begin()+dst_arr_len);
-	for (size_t idx = numkeep, i = 0; idx<clen && i<dst_arr_len; idx++) {
-		const T *cptr =  (T *) indexvec[i];
-		dst_arr[i++] = *cptr;
-		sigmap->Set(cptr - C);
-	}
-	return(0);
+	return(select_coeffs(
+		C, numkeep, clen, vector <size_t> (1, dst_arr_len), dst_arr,
+		vector <SignificanceMap *> (1, sigmap), mags
+	));
 }
 };
 
@@ -255,7 +323,7 @@ int Compressor::Compress(
 
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (float *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_f
+		_L, sigmap, _dims, _nlevels, _magvec
 	);
 }
 
@@ -268,7 +336,7 @@ int Compressor::Compress(
 
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (double *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_d
+		_L, sigmap, _dims, _nlevels, _magvec
 	);
 }
 
@@ -281,7 +349,7 @@ int Compressor::Compress(
 
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (int *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_i
+		_L, sigmap, _dims, _nlevels, _magvec
 	);
 }
 
@@ -294,7 +362,7 @@ int Compressor::Compress(
 
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (long *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_l
+		_L, sigmap, _dims, _nlevels, _magvec
 	);
 }
 
@@ -432,6 +500,54 @@ int Compressor::Decompress(
 } 
 
 namespace {
+
+// Copy the approximation coefficients and the largest detail
+// coefficients of C to dst_arr, partitioned among the collections
+// given by lens. The total of lens must be at least numkeep.
+//
+template <class T>
+int partition_coeffs(
+	const T *C,
+	size_t clen,
+	size_t numkeep,
+	vector <size_t> lens,
+	T *dst_arr,
+	vector <SignificanceMap> &sigmaps,
+	vector <double> &mags
+) {
+	for (int i=0; i<sigmaps.size(); i++) {
+		int rc = sigmaps[i].Reshape(clen);
+		if (rc<0) return(-1);
+		sigmaps[i].Clear();
+	}
+
+	size_t tlen = 0;
+	for (int i=0; i<lens.size(); i++) tlen += lens[i];
+
+	for (size_t i = 0; i<tlen; i++) dst_arr[i] = 0.0;
+
+	if (numkeep) {
+		// If numkeep>0, copy approximation coeffs. verbatim
+		//
+		for (size_t idx = 0; idx<numkeep; idx++) {
+			int rc = sigmaps[0].Set(idx);
+			if (rc<0) return(-1);
+			dst_arr[idx] = C[idx];
+		}
+		if (numkeep == tlen) return(0);
+		dst_arr += numkeep;
+		lens[0] -= numkeep;
+	}
+
+	//
+	// Partition the coefficients by magnitude among the levels
+	//
+	vector <SignificanceMap *> sigmapptrs;
+	for (int j=0; j<sigmaps.size(); j++) sigmapptrs.push_back(&sigmaps[j]);
+
+	return(select_coeffs(C, numkeep, clen, lens, dst_arr, sigmapptrs, mags));
+}
+
 template <class T>
 int decompose_template(
 	Compressor *cmp,
@@ -444,8 +560,7 @@ int decompose_template(
 	vector <SignificanceMap> &sigmaps,
 	const vector <size_t> &dims,
 	size_t nlevels,
-	vector <void *> indexvec,
-	bool my_compare(const void *, const void *)
+	vector <double> &mags
 ) {
 	if (! C) {
 		Compressor::SetErrMsg("Invalid state");
@@ -498,52 +613,188 @@ int decompose_template(
 		return(-1);
 	} 
 
-	for (int i=0; i<sigmaps.size(); i++) {
-		rc = sigmaps[i].Reshape(clen);
-		if (rc<0) return(-1);
-		sigmaps[i].Clear();
+	return(partition_coeffs(
+		C, clen, numkeep, my_dst_arr_lens, dst_arr, sigmaps, mags
+	));
+}
+
+// Keep the k largest coefficients of the transform saved in 'saved',
+// filling the collections given by max_lens in order. If 'error' is
+// not NULL the maximum absolute error of the reconstruction from the
+// retained coefficients is returned in it. Selection overwrites
+// C, so it's restored from the saved copy each time.
+//
+template <class T>
+int select_k(
+	Compressor *cmp,
+	const T *src_arr,
+	size_t n,
+	T *C,
+	const T *saved,
+	size_t clen,
+	size_t numkeep,
+	const vector <size_t> &max_lens,
+	size_t k,
+	T *dst_arr,
+	vector <SignificanceMap> &sigmaps,
+	vector <double> &mags,
+	T *recon,
+	double *error
+) {
+	vector <size_t> lens(max_lens.size());
+	for (int i=0; i<lens.size(); i++) {
+		lens[i] = min(k, max_lens[i]);
+		k -= lens[i];
 	}
 
-	// Data has been transformed. Now we need to sort it and find
-	// the threshold value. Note: we don't actually move the data. We
-	// sort an index array that references the data array.
+	for (size_t i=0; i<clen; i++) C[i] = saved[i];
 
-	for (size_t i = 0; i<tlen; i++) dst_arr[i] = 0.0;
+	int rc = partition_coeffs(C, clen, numkeep, lens, dst_arr, sigmaps, mags);
+	if (rc<0 || ! error) return(rc);
 
-	if (numkeep) {
-		// If numkeep>0, copy approximation coeffs. verbatim
-		//
-		for (size_t idx = 0; idx<numkeep; idx++) {
-			rc = sigmaps[0].Set(idx);
-			if (rc<0) return(-1);
-			dst_arr[idx] = C[idx];
-		}
-		if (numkeep == tlen) return(0);
-		dst_arr += numkeep;
-		my_dst_arr_lens[0] -= numkeep;
+	rc = cmp->Reconstruct(dst_arr, recon, sigmaps, -1);
+	if (rc<0) return(rc);
+
+	*error = 0.0;
+	for (size_t i=0; i<n; i++) {
+		double e = fabs((double) recon[i] - (double) src_arr[i]);
+		if (e > *error) *error = e;
 	}
+	return(0);
+}
 
+template <class T>
+int decompose_bounded_template(
+	Compressor *cmp,
+	const T *src_arr, 
+	T *dst_arr, 
+	const vector <size_t> &dst_arr_lens,
+	T *C,
+	size_t clen,
+	size_t *L,
+	vector <SignificanceMap> &sigmaps,
+	const vector <size_t> &dims,
+	size_t nlevels,
+	vector <double> &mags,
+	T *saved,
+	T *recon,
+	double max_error,
+	double &error
+) {
+	error = 0.0;
+
+	if (! C) {
+		Compressor::SetErrMsg("Invalid state");
+		return(-1);
+	}
+
+	if (sigmaps.size() != dst_arr_lens.size() || sigmaps.size() < 1) {
+		Compressor::SetErrMsg("Invalid parameter");
+		return(-1);
+	}
+
+	size_t tlen = 0; // maximum # of coefficients to retain
+	for (int i=0; i<dst_arr_lens.size(); i++) {
+		tlen += dst_arr_lens[i];
+	}
+	if (tlen > clen) {
+		Compressor::SetErrMsg("Invalid decomposition");
+		return(-1);
+	}
+		
+	if ((dims.size() < 1)  || (dims.size() > 3)) {
+		Compressor::SetErrMsg("Invalid array shape");
+		return(-1);
+	}
+
+	size_t numkeep = 0;
+	int rc = 0;
+	if (dims.size() == 3) {
+		if (cmp->KeepAppOnOff()) numkeep = L[0]*L[1]*L[2];
+		rc = cmp->wavedec3(src_arr, dims[0], dims[1], dims[2], nlevels, C, L);
+	}
+	else if (dims.size() == 2) {
+		if (cmp->KeepAppOnOff()) numkeep = L[0]*L[1];
+		rc = cmp->wavedec2(src_arr, dims[0], dims[1], nlevels, C, L);
+	}
+	else if (dims.size() == 1) {
+		if (cmp->KeepAppOnOff()) numkeep = L[0];
+		rc = cmp->wavedec( src_arr, dims[0], nlevels, C, L);
+	}
+	if (rc<0) return(-1);
+
+	if (dst_arr_lens[0] < numkeep) {
+		Compressor::SetErrMsg("Invalid decomposition - not enougth coefficients");
+		return(-1);
+	} 
+
+	size_t n = 1;
+	for (int i=0; i<dims.size(); i++) n *= dims[i];
+
+	for (size_t i=0; i<clen; i++) saved[i] = C[i];
+
+	// Initial guess: the coefficients larger than the error bound. Grow
+	// geometrically until the bound is met, then narrow the gap
+	// between the largest failing and smallest passing counts.
 	//
-	// sort the **indecies** of the coefficients based on the 
-	// coefficient's magnitude
-	//
-	indexvec.clear();
-	for (size_t i=numkeep; i<clen; i++)  indexvec.push_back(&C[i]); 
-    sort(indexvec.begin(), indexvec.end(), my_compare);
+	size_t k = numkeep;
+	for (size_t i=numkeep; i<clen; i++) {
+		if (fabs((double) C[i]) > max_error) k++;
+	}
+	if (k > tlen) k = tlen;
 
-	
-	vector <void *>::iterator itr = indexvec.begin();
-	for (int j = 0, idx=0; j<my_dst_arr_lens.size(); j++) {
-		sort(itr, itr+my_dst_arr_lens[j]);	// sort coefficient's indecies
-		itr += my_dst_arr_lens[j];
-		for (int i = 0; i<my_dst_arr_lens[j]; i++, idx++) {
-			const T *cptr =  (T *) indexvec[idx];
-			dst_arr[i] = *cptr;
-			sigmaps[j].Set(cptr - C);
+	double kerror = 0.0;
+	size_t klo = numkeep;	// largest count known to fail (or minimum)
+	size_t khi = tlen;	// smallest count known to pass
+	double khierror = -1.0;
+
+	for (;;) {
+		rc = select_k(
+			cmp, src_arr, n, C, saved, clen, numkeep, dst_arr_lens, k,
+			dst_arr, sigmaps, mags, recon, &kerror
+		);
+		if (rc<0) return(-1);
+
+		if (kerror <= max_error || k == tlen) {
+			khi = k;
+			khierror = kerror;
+			break;
 		}
-		dst_arr += my_dst_arr_lens[j];
+		klo = k;
+		k = min(tlen, max(k+1, 2*k));
+	}
+
+	const int max_bisections = 4;
+	bool current = true;	// dst_arr and sigmaps hold the khi selection
+	for (int i=0; i<max_bisections && khi - klo > 1; i++) {
+		k = klo + (khi - klo) / 2;
+
+		rc = select_k(
+			cmp, src_arr, n, C, saved, clen, numkeep, dst_arr_lens, k,
+			dst_arr, sigmaps, mags, recon, &kerror
+		);
+		if (rc<0) return(-1);
+
+		if (kerror <= max_error) {
+			khi = k;
+			khierror = kerror;
+			current = true;
+		}
+		else {
+			klo = k;
+			current = false;
+		}
+	}
+
+	if (! current) {
+		rc = select_k(
+			cmp, src_arr, n, C, saved, clen, numkeep, dst_arr_lens, khi,
+			dst_arr, sigmaps, mags, recon, NULL
+		);
+		if (rc<0) return(-1);
 	}
 
+	error = khierror;
 	return(0);
 }
 
@@ -638,7 +889,7 @@ int Compressor::Decompose(
 ) {
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (float *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_f
+		_L, sigmaps, _dims, _nlevels, _magvec
 	);
 }
 
@@ -648,7 +899,7 @@ int Compressor::Decompose(
 ) {
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (double *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_d
+		_L, sigmaps, _dims, _nlevels, _magvec
 	);
 }
 
@@ -658,7 +909,7 @@ int Compressor::Decompose(
 ) {
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (int *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_i
+		_L, sigmaps, _dims, _nlevels, _magvec
 	);
 }
 
@@ -668,7 +919,59 @@ int Compressor::Decompose(
 ) {
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (long *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_l
+		_L, sigmaps, _dims, _nlevels, _magvec
+	);
+}
+
+int Compressor::Decompose( 
+	const float *src_arr, float *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap> &sigmaps, double max_error, double &error
+) {
+	_savevec.resize(_CLen);
+	_reconvec.resize(_nx*_ny*_nz);
+	return decompose_bounded_template(
+		this, src_arr, dst_arr, dst_arr_lens, (float *) _C, _CLen,
+		_L, sigmaps, _dims, _nlevels, _magvec, (float *) _savevec.data(),
+		(float *) _reconvec.data(), max_error, error
+	);
+}
+
+int Compressor::Decompose( 
+	const double *src_arr, double *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap> &sigmaps, double max_error, double &error
+) {
+	_savevec.resize(_CLen);
+	_reconvec.resize(_nx*_ny*_nz);
+	return decompose_bounded_template(
+		this, src_arr, dst_arr, dst_arr_lens, (double *) _C, _CLen,
+		_L, sigmaps, _dims, _nlevels, _magvec, (double *) _savevec.data(),
+		(double *) _reconvec.data(), max_error, error
+	);
+}
+
+int Compressor::Decompose( 
+	const int *src_arr, int *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap> &sigmaps, double max_error, double &error
+) {
+	_savevec.resize(_CLen);
+	_reconvec.resize(_nx*_ny*_nz);
+	return decompose_bounded_template(
+		this, src_arr, dst_arr, dst_arr_lens, (int *) _C, _CLen,
+		_L, sigmaps, _dims, _nlevels, _magvec, (int *) _savevec.data(),
+		(int *) _reconvec.data(), max_error, error
+	);
+}
+
+int Compressor::Decompose( 
+	const long *src_arr, long *dst_arr, const vector <size_t> &dst_arr_lens,
+	vector <SignificanceMap> &sigmaps, double max_error, double &error
+) {
+	_savevec.resize(_CLen);
+	_reconvec.resize(_nx*_ny*_nz);
+	return decompose_bounded_template(
+		this, src_arr, dst_arr, dst_arr_lens, (long *) _C, _CLen,
+		_L, sigmaps, _dims, _nlevels, _magvec, (long *) _savevec.data(),
+		(long *) _reconvec.data(), max_error, error
 	);
 }
 
@@ -779,6 +1082,28 @@ size_t Compressor::GetMinCompression() const {
 	return(0);
 }
 
+int Compressor::GetSubbands(vector <unsigned char> &bands) const {
+	bands.clear();
+
+	// _L holds the dimensions of the approximation coefficients, 
+	// followed by those of each detail subband
+	//
+	size_t ndims = _dims.size();
+	size_t nbands = GetNumSubbands();
+	assert(nbands <= 255);
+
+	const size_t *lptr = _L;
+	for (size_t b=0; b<nbands; b++) {
+		size_t n = 1;
+		for (size_t i=0; i<ndims; i++) n *= *lptr++;
+
+		bands.insert(bands.end(), n, (unsigned char) b);
+	}
+	assert(bands.size() == _CLen);
+
+	return((int) nbands);
+}
+
 bool Compressor::CompressionInfo(
 	vector <size_t> dims, const string wavename, 
 	bool keepapp, size_t &nlevels, size_t &maxcratio
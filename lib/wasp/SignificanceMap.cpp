@@ -449,6 +449,34 @@ size_t SignificanceMap::GetMapSize(
 
 }
 
+int SignificanceMap::GetNumEntries(
+	const unsigned char *map, size_t &num_entries
+) {
+	num_entries = 0;
+
+	if (map[0] != 'c' || map[1] != 'c' || map[2] != 'c' ||
+		map[3] > VDF_VERSION) {
+
+		SetErrMsg("Invalid significance map - bogus header");
+		return(-1);
+	}
+
+	unsigned long LSBTest = 1;
+	bool do_swapbytes = false;
+	if (! (*(char *) &LSBTest)) {
+		// swap to MSBFirst
+		do_swapbytes = true;
+	}
+
+	unsigned char *cptr = (unsigned char *) &num_entries;
+    for (int i=0; i<sizeof(num_entries); i++) {
+		cptr[i] = map[4+i];
+    }
+	if (do_swapbytes) swapbytes(&num_entries, 1);
+
+	return(0);
+}
+
 size_t SignificanceMap::GetMapSize(size_t num_entries) const {
 
 	return(GetMapSize(_dimsVec, num_entries));
@@ -2,10 +2,15 @@
 #include <sstream>
 #include <sstream>
 #include <iterator>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <sys/stat.h>
 #include "vapor/utils.h"
 #include "vapor/MatWaveBase.h"
 #include "vapor/Compressor.h"
+#include "vapor/CoeffCodec.h"
 #include "vapor/WASP.h"
 
 using namespace VAPoR;
@@ -233,6 +238,11 @@ public:
  unsigned char *_maps;	// private (not shared)
  int _level;
  bool _unblock_flag; // unblock the data after reconstruction?
+ bool _bounded;	// variable is error bounded?
+ double _max_error;	// absolute error bound for writes, if bounded
+ double _error;	// largest error of blocks written by this thread
+ int _nbits;	// coefficient quantization bit depth, or 0 if not quantized
+ void *_writer;	// shared block_writer for compressed writes, or NULL
  static int _status;	// error indicator
 
  thread_state(
@@ -253,12 +263,61 @@ public:
 	_compressors(compressors), _data(data), _data_type(data_type), 
 	_mask(mask), _block(block), _coeffs(coeffs), _block_type(block_type),
 	_xtype(xtype), _maps(maps), _level(level),
-	_unblock_flag(unblock_flag)
+	_unblock_flag(unblock_flag), _bounded(false), _max_error(0.0),
+	_error(0.0), _nbits(0), _writer(NULL)
  {_status = 0;}
 
 };
 int thread_state::_status = 0;
 
+// Number of words of type 'xtype' used to store the 'n' wavelet 
+// coefficients of compression level 'level'. Quantized coefficients 
+// (nbits > 0) are stored as a CoeffCodec byte stream packed into words 
+// of the variable's type. The approximation coefficients are all 
+// retained by the first level, where the codec stores them verbatim.
+// 'cmp' is only used if 'nbits' is non-zero.
+//
+size_t coeff_slot_size(
+	size_t n, int nbits, int xtype, int level, const Compressor *cmp
+) {
+	if (! nbits) return(n);
+
+	size_t napprox = level == 0 ? min(n, cmp->GetMinCompression()) : 0;
+
+	size_t wsize = NetCDFCpp::SizeOf(xtype);
+	size_t nbytes = CoeffCodec::GetMaxEncodedSize(
+		n, nbits, cmp->GetNumSubbands(), napprox
+	);
+	return((nbytes + wsize - 1) / wsize);
+}
+
+// Size in bytes of storage for a block's encoded coefficients
+//
+size_t codebuf_size(const thread_state &s) {
+	size_t n = 0;
+	for (int i=0; i<s._ncoeffs.size(); i++) {
+		n += coeff_slot_size(
+			s._ncoeffs[i], s._nbits, s._xtype, i, s._compressors[0]
+		);
+	}
+	return(n * NetCDFCpp::SizeOf(s._xtype));
+}
+
+// Size in bytes of storage for a block's encoded significance maps
+//
+size_t maps_buf_size(const thread_state &s) {
+	size_t n = 0;
+	for (int i=0; i<s._ncoeffs.size(); i++) {
+		n += s._encoded_dims[i];
+		n -= coeff_slot_size(
+			s._ncoeffs[i], s._nbits, s._xtype, i, s._compressors[0]
+		);
+	}
+	n -= BLK_HDR_SZ;
+	return(n * NetCDFCpp::SizeOf(s._xtype));
+}
+
+
 
 
 // Convert voxel coordinates, 'vcoords', to block coordinates, 'bcoords', 
@@ -736,6 +795,14 @@ void UnBlock(
 // ncoeffs : vector describing partitioning of coefficients in 'coeffs'
 // encoded_dims : vector describing dimension of encoded block at
 // each compression level.
+// datarange : min and max data value in 'block'
+// max_error : absolute error bound. Ignored unless 'bounded' is true.
+// bounded : if true only as many coefficients as are needed to
+// satisfy 'max_error' are retained.
+// error : maximum absolute reconstruction error, if 'bounded' is true
+// nstore : number of coefficients retained at each compression level
+// nbits : coefficient quantization bit depth, or 0 if not quantized
+// sigmaps : significance map of each compression level
 //
 template <class T>
 int DecomposeBlock(
@@ -746,14 +813,54 @@ int DecomposeBlock(
 	unsigned char *maps,
 	int xtype,
 	vector <size_t> ncoeffs,
-	vector <size_t> encoded_dims
-	
+	vector <size_t> encoded_dims,
+	int nbits,
+	const T *datarange,
+	bool bounded,
+	double max_error,
+	double &error,
+	vector <size_t> &nstore,
+	vector <SignificanceMap> &sigmaps
 ) {
+	error = 0.0;
+	nstore = ncoeffs;
 
-	vector <SignificanceMap> sigmaps(ncoeffs.size());
+	sigmaps.resize(ncoeffs.size());
 
-	int rc = cmp->Decompose(block, coeffs, ncoeffs, sigmaps);
-	if (rc<0) return(-1);
+	int rc;
+	if (bounded) {
+
+		// Measure the error of the reconstruction that readers will
+		// perform, which clamps to the block's data range. The
+		// compressor's clamp settings are restored afterwards
+		//
+		bool clamp_min_flag = cmp->ClampMinOnOff();
+		bool clamp_max_flag = cmp->ClampMaxOnOff();
+		double clamp_min = cmp->ClampMin();
+		double clamp_max = cmp->ClampMax();
+
+		cmp->ClampMinOnOff() = true;
+		cmp->ClampMaxOnOff() = true;
+		cmp->ClampMin() = (double) datarange[0];
+		cmp->ClampMax() = (double) datarange[1];
+
+		rc = cmp->Decompose(block, coeffs, ncoeffs, sigmaps, max_error, error);
+
+		cmp->ClampMinOnOff() = clamp_min_flag;
+		cmp->ClampMaxOnOff() = clamp_max_flag;
+		cmp->ClampMin() = clamp_min;
+		cmp->ClampMax() = clamp_max;
+
+		if (rc<0) return(-1);
+
+		for (int i=0; i<ncoeffs.size(); i++) {
+			nstore[i] = sigmaps[i].GetNumSignificant();
+		}
+	}
+	else {
+		rc = cmp->Decompose(block, coeffs, ncoeffs, sigmaps);
+		if (rc<0) return(-1);
+	}
 
 	//
 	// Extract signficance maps from 'sigmaps' and copy them to 'maps'
@@ -761,9 +868,10 @@ int DecomposeBlock(
 	unsigned char *mapptr = maps;
 	for (int i=0; i<ncoeffs.size(); i++) {
 		size_t dimlen = i==0 ? encoded_dims[i]-BLK_HDR_SZ : encoded_dims[i]; 
+		size_t nslot = coeff_slot_size(ncoeffs[i], nbits, xtype, i, cmp);
 
-		if (dimlen != ncoeffs[i]) {	// last map not stored
-			size_t sz = NetCDFCpp::SizeOf(xtype) * (dimlen-ncoeffs[i]);
+		if (dimlen != nslot) {	// last map not stored
+			size_t sz = NetCDFCpp::SizeOf(xtype) * (dimlen-nslot);
 
 			memset(mapptr, 0, sz);
 			sigmaps[i].GetMap(mapptr);
@@ -774,55 +882,40 @@ int DecomposeBlock(
 	return(0);
 }
 
-// Apply inverse wavelet transfor to a block of data
+// Extract the significance maps of a block
 //
 // cmp : Compressor for wavelet transform
-// coeffs : storage for transformed coefficients
-// maps : storage for encoded significance maps
-// ncoeffs : vector describing partitioning of coefficients in 'coeffs'
+// maps : encoded significance maps for each compression level
+// xtype : external type of variable
+// ncoeffs : vector describing partitioning of coefficients 
 // encoded_dims : vector describing dimension of encoded block at
 // each compression level.
-// block : block of data
-// n : num elements in 'block'
-// level : reconstruction level in wavelet hierarchy
+// nbits : coefficient quantization bit depth, or 0 if not quantized
+// sigmaps : significance map of each compression level
 //
-template <class T>
-int ReconstructBlock(
-	Compressor *cmp,
-	const T *coeffs,
-	const T *datarange,
+int ExtractSigMaps(
+	const Compressor *cmp,
 	const unsigned char *maps,
 	int xtype,
 	vector <size_t> ncoeffs,
 	vector <size_t> encoded_dims,
-	T *block,
-	size_t n,
-	int level 
+	int nbits,
+	vector <SignificanceMap> &sigmaps
 ) {
+	sigmaps.resize(ncoeffs.size());
 
-	// Clamp reconstructed values to original data range
-	//
-	cmp->ClampMinOnOff() = true;
-	cmp->ClampMaxOnOff() = true;
-	cmp->ClampMin() = (double) datarange[0];
-	cmp->ClampMax() = (double) datarange[1];
-
-	vector <SignificanceMap> sigmaps(ncoeffs.size());
-
-	// 
-	// Extract encoded significance maps
-	//
 	const unsigned char *mapptr = maps;
 	bool reconstruct_map = false;
 	for (int i=0; i<ncoeffs.size(); i++) {
 
 		size_t dimlen = i==0 ? encoded_dims[i]-BLK_HDR_SZ : encoded_dims[i]; 
+		size_t nslot = coeff_slot_size(ncoeffs[i], nbits, xtype, i, cmp);
 
-		if (dimlen != ncoeffs[i]) {	// last map not stored
+		if (dimlen != nslot) {	// last map not stored
 			int rc = sigmaps[i].SetMap(mapptr);
 			if (rc<0) return(-1);
 
-			size_t sz = NetCDFCpp::SizeOf(xtype) * (dimlen - ncoeffs[i]);
+			size_t sz = NetCDFCpp::SizeOf(xtype) * (dimlen - nslot);
 			mapptr += sz;
 		}
 		else {
@@ -839,7 +932,10 @@ int ReconstructBlock(
 
 		// Edge case for when sigmap isn't stored at all
 		//
-		if (ncoeffs.size() == 1 && encoded_dims[0]-BLK_HDR_SZ == ncoeffs[0]) {
+		if (ncoeffs.size() == 1 && 
+			encoded_dims[0]-BLK_HDR_SZ == 
+			coeff_slot_size(ncoeffs[0], nbits, xtype, 0, cmp)) {
+
 			sigmaps[0].Reshape(ncoeffs[0]);
 			for (int i=0; i<ncoeffs[0]; i++) {
 				sigmaps[0].Set(i);
@@ -854,6 +950,36 @@ int ReconstructBlock(
 			sigmaps[ncoeffs.size()-1].Invert();
 		}
 	}
+	return(0);
+}
+
+// Apply inverse wavelet transfor to a block of data
+//
+// cmp : Compressor for wavelet transform
+// coeffs : storage for transformed coefficients
+// datarange : min and max data value in 'block'
+// sigmaps : significance maps returned by ExtractSigMaps()
+// block : block of data
+// n : num elements in 'block'
+// level : reconstruction level in wavelet hierarchy
+//
+template <class T>
+int ReconstructBlock(
+	Compressor *cmp,
+	const T *coeffs,
+	const T *datarange,
+	vector <SignificanceMap> &sigmaps,
+	T *block,
+	size_t n,
+	int level 
+) {
+
+	// Clamp reconstructed values to original data range
+	//
+	cmp->ClampMinOnOff() = true;
+	cmp->ClampMaxOnOff() = true;
+	cmp->ClampMin() = (double) datarange[0];
+	cmp->ClampMax() = (double) datarange[1];
 
 	int rc = cmp->Reconstruct(coeffs, block, sigmaps, level);
 	if (rc<0) return(-1);
@@ -861,6 +987,235 @@ int ReconstructBlock(
 	return(0);
 }
 
+// Subband of each coefficient stored for a compression level, in
+// the order of the level's significance map
+//
+// sigmap : significance map of the compression level
+// bands : subband of each wavelet coefficient. See 
+// Compressor::GetSubbands()
+// level_bands : subband of each of the level's coefficients
+//
+int get_level_bands(
+	SignificanceMap &sigmap, const vector <unsigned char> &bands,
+	vector <unsigned char> &level_bands
+) {
+	size_t nsig = sigmap.GetNumSignificant();
+	level_bands.resize(nsig);
+
+	sigmap.GetNextEntryRestart();
+	for (size_t j=0; j<nsig; j++) {
+		size_t idx;
+		if (sigmap.GetNextEntry(&idx) <= 0 || idx >= bands.size()) {
+			SignificanceMap::SetErrMsg("Invalid significance map");
+			return(-1);
+		}
+		level_bands[j] = bands[idx];
+	}
+	sigmap.GetNextEntryRestart();
+	return(0);
+}
+
+// Quantize and encode the transformed coefficients of a block
+//
+// codec : coefficient codec
+// cmp : Compressor used to transform the block
+// coeffs : transformed coefficients for each compression level
+// ncoeffs : vector describing partitioning of coefficients in 'coeffs'
+// nstore : number of coefficients at each compression level to encode
+// sigmaps : significance map of each compression level
+// bands : subband of each wavelet coefficient. See 
+// Compressor::GetSubbands()
+// xtype : external type of variable
+// codebuf : storage for encoded coefficients. The stream for each 
+// compression level is padded to a whole number of words of type 'xtype'
+// and begins at the offset of the level's coefficient storage.
+// codewords : number of words occupied by each level's stream
+//
+template <class T>
+int EncodeBlock(
+	CoeffCodec *codec,
+	const Compressor *cmp,
+	const T *coeffs,
+	vector <size_t> ncoeffs,
+	const vector <size_t> &nstore,
+	vector <SignificanceMap> &sigmaps,
+	const vector <unsigned char> &bands,
+	int xtype,
+	unsigned char *codebuf,
+	vector <size_t> &codewords
+) {
+    unsigned long LSBTest = 1;
+    bool do_swapbytes = false;
+    if (! (*(char *) &LSBTest)) {
+        // swap to MSBFirst
+        do_swapbytes = true;
+    }
+
+	size_t wsize = NetCDFCpp::SizeOf(xtype);
+	int nbits = codec->GetNumBits();
+
+	vector <unsigned char> level_bands;
+	codewords.clear();
+	for (int i=0; i<ncoeffs.size(); i++) {
+		size_t nslot = coeff_slot_size(ncoeffs[i], nbits, xtype, i, cmp);
+
+		size_t nbytes = 0;
+		if (nstore[i]) {
+			int rc = get_level_bands(sigmaps[i], bands, level_bands);
+			if (rc<0) return(rc);
+			assert(level_bands.size() == nstore[i]);
+
+			codec->Encode(
+				coeffs, level_bands.data(), cmp->GetNumSubbands(), nstore[i],
+				codebuf, nbytes
+			);
+		}
+
+		size_t nwords = (nbytes + wsize - 1) / wsize;
+		assert(nwords <= nslot);
+		memset(codebuf + nbytes, 0, nwords*wsize - nbytes);
+
+		if (do_swapbytes) swapbytes((void *) codebuf, wsize, nwords);
+
+		codewords.push_back(nwords);
+
+		coeffs += ncoeffs[i];
+		codebuf += nslot * wsize;
+	}
+	return(0);
+}
+
+// Decode coefficients encoded with EncodeBlock() and read by 
+// FetchBlockCompressed()
+//
+// sigmaps : significance maps returned by ExtractSigMaps(). Each level's
+// map gives the number of coefficients encoded and their subbands.
+//
+template <class T>
+int DecodeBlock(
+	const CoeffCodec *codec,
+	const Compressor *cmp,
+	unsigned char *codebuf,
+	vector <size_t> ncoeffs,
+	vector <SignificanceMap> &sigmaps,
+	const vector <unsigned char> &bands,
+	int xtype,
+	T *coeffs
+) {
+    unsigned long LSBTest = 1;
+    bool do_swapbytes = false;
+    if (! (*(char *) &LSBTest)) {
+        // swap to MSBFirst
+        do_swapbytes = true;
+    }
+
+	size_t wsize = NetCDFCpp::SizeOf(xtype);
+	int nbits = codec->GetNumBits();
+
+	vector <unsigned char> level_bands;
+	for (int i=0; i<ncoeffs.size(); i++) {
+		size_t nslot = coeff_slot_size(ncoeffs[i], nbits, xtype, i, cmp);
+
+		size_t n = sigmaps[i].GetNumSignificant();
+		if (n > ncoeffs[i]) {
+			SignificanceMap::SetErrMsg("Invalid significance map");
+			return(-1);
+		}
+
+		// Levels with no coefficients have no stream
+		//
+		if (n) {
+			if (do_swapbytes) swapbytes((void *) codebuf, wsize, nslot);
+
+			int rc = get_level_bands(sigmaps[i], bands, level_bands);
+			if (rc<0) return(rc);
+
+			rc = codec->Decode(
+				codebuf, nslot * wsize, level_bands.data(), coeffs, n
+			);
+			if (rc<0) return(rc);
+		}
+
+		coeffs += ncoeffs[i];
+		codebuf += nslot * wsize;
+	}
+	return(0);
+}
+
+// Largest error of a block reconstructed, as a reader would, from 
+// the coefficients encoded by EncodeBlock()
+//
+// cmp : Compressor used to transform the block
+// codec : coefficient codec
+// codebuf : encoded coefficients. Not modified.
+// ncoeffs : vector describing partitioning of coefficients 
+// sigmaps : significance map of each compression level
+// bands : subband of each wavelet coefficient
+// xtype : external type of variable
+// datarange : min and max data value in 'block'
+// block : the original block
+// n : number of elements in 'block'
+// error : maximum absolute error of the reconstruction
+//
+template <class T>
+int EncodedBlockError(
+	Compressor *cmp,
+	const CoeffCodec *codec,
+	const unsigned char *codebuf,
+	vector <size_t> ncoeffs,
+	vector <SignificanceMap> &sigmaps,
+	const vector <unsigned char> &bands,
+	int xtype,
+	const T *datarange,
+	const T *block,
+	size_t n,
+	double &error
+) {
+	error = 0.0;
+
+	size_t nwords = 0;
+	for (int i=0; i<ncoeffs.size(); i++) {
+		nwords += coeff_slot_size(
+			ncoeffs[i], codec->GetNumBits(), xtype, i, cmp
+		);
+	}
+
+	// DecodeBlock() byte swaps in place
+	//
+	vector <unsigned char> buf(
+		codebuf, codebuf + nwords * NetCDFCpp::SizeOf(xtype)
+	);
+	vector <T> coeffs(vsum(ncoeffs), 0);
+	vector <T> recon(n);
+
+	int rc = DecodeBlock(
+		codec, cmp, buf.data(), ncoeffs, sigmaps, bands, xtype, coeffs.data()
+	);
+	if (rc<0) return(rc);
+
+	bool clamp_min_flag = cmp->ClampMinOnOff();
+	bool clamp_max_flag = cmp->ClampMaxOnOff();
+	double clamp_min = cmp->ClampMin();
+	double clamp_max = cmp->ClampMax();
+
+	rc = ReconstructBlock(
+		cmp, coeffs.data(), datarange, sigmaps, recon.data(), n, -1
+	);
+
+	cmp->ClampMinOnOff() = clamp_min_flag;
+	cmp->ClampMaxOnOff() = clamp_max_flag;
+	cmp->ClampMin() = clamp_min;
+	cmp->ClampMax() = clamp_max;
+
+	if (rc<0) return(rc);
+
+	for (size_t i=0; i<n; i++) {
+		double e = fabs((double) recon[i] - (double) block[i]);
+		if (e > error) error = e;
+	}
+	return(0);
+}
+
 // Write a single block (no compression) to disk
 //
 // varname : name of variable
@@ -901,13 +1256,23 @@ int StoreBlock(
 // each compression level.
 // coeffs : transformed coefficients for each compression level
 // maps : encoded significance maps for each compression level
+// nstore : number of coefficients at each compression level actually
+// written. Unused coefficient storage is left unwritten.
+// nbits : coefficient quantization bit depth, or 0 if not quantized
+// codebuf : if not NULL, encoded coefficients returned by EncodeBlock(),
+// which are written in place of 'coeffs'
+// codewords : number of words of each compression level's encoded 
+// coefficients
+// cmp : Compressor for the variable's blocks. Only used if 'nbits'
+// is non-zero.
 //
 template <class T>
 int StoreBlockCompressed(
 	string varname, vector <NetCDFCpp *> ncdfcptrs, vector <size_t> bcoords, 
 	vector <size_t> ncoeffs, vector <size_t> encoded_dims,
-	const T *coeffs, const T *datarange, unsigned char *maps, int xtype
-	
+	const T *coeffs, const T *datarange, unsigned char *maps, int xtype,
+	const vector <size_t> &nstore, int nbits, const unsigned char *codebuf,
+	const vector <size_t> &codewords, const Compressor *cmp
 ) {
 
 
@@ -938,21 +1303,37 @@ int StoreBlockCompressed(
 	//
 	assert(ncdfcptrs.size() >= ncoeffs.size());
 	for (int i=0; i<ncoeffs.size(); i++) {
+		size_t nslot = coeff_slot_size(ncoeffs[i], nbits, xtype, i, cmp);
+
 		start[start.size()-1] = i==0 ? BLK_HDR_SZ : 0;	// skip header
-		count[start.size()-1] = ncoeffs[i];
+		count[start.size()-1] = nstore[i];
 
-		int rc = ncdfcptrs[i]->NetCDFCpp::PutVara(
-			varname, start, count, coeffs
-		);
-		if (rc<0) return(rc);
+		if (nstore[i] && codebuf) {
+
+			// Encoded streams are written with the untyped flavor of 
+			// PutVara, like the significance maps
+			//
+			count[start.size()-1] = codewords[i];
+			int rc = ncdfcptrs[i]->NetCDFCpp::PutVara(
+				varname, start, count, (const void *) codebuf
+			);
+			if (rc<0) return(rc);
+		}
+		else if (nstore[i]) {
+			int rc = ncdfcptrs[i]->NetCDFCpp::PutVara(
+				varname, start, count, coeffs
+			);
+			if (rc<0) return(rc);
+		}
 
 		coeffs += ncoeffs[i];
+		if (codebuf) codebuf += nslot * NetCDFCpp::SizeOf(xtype);
 
 		// Sigmap size (in words) is difference between encoded_dims and 
-		// number of coefficients
+		// coefficient storage
 		//
-		assert(encoded_dims[i] >= ncoeffs[i]);
-		size_t n = encoded_dims[i] - ncoeffs[i];
+		assert(encoded_dims[i] >= nslot);
+		size_t n = encoded_dims[i] - nslot;
 
 		if (i==0) n-=BLK_HDR_SZ;	// adjust for header
 
@@ -965,7 +1346,7 @@ int StoreBlockCompressed(
 			// conversion, so start & count arguments are in sizes of
 			// external variable type
 			//
-			start[start.size()-1] = i==0 ? ncoeffs[i] + BLK_HDR_SZ : ncoeffs[i];
+			start[start.size()-1] = i==0 ? nslot + BLK_HDR_SZ : nslot;
 			count[start.size()-1] = n;
 
 			//
@@ -1017,6 +1398,59 @@ int FetchBlock(
 	return(0);
 }
 
+// Read a CoeffCodec stream stored in the 'nslot' words of a block's 
+// coefficient storage, beginning at 'offset', into 'codebuf'. The stream
+// header is read first so that only the words occupied by the
+// stream are transferred.
+//
+int fetch_encoded(
+	string varname, NetCDFCpp *ncdfcptr, vector <size_t> start,
+	size_t offset, size_t nslot, int xtype, unsigned char *codebuf
+) {
+	size_t wsize = NetCDFCpp::SizeOf(xtype);
+
+	vector <size_t> count(start.size(), 1);
+
+	size_t nhdr = (CoeffCodec::GetHeaderSize() + wsize - 1) / wsize;
+	assert(nhdr <= nslot);
+
+	start[start.size()-1] = offset;
+	count[count.size()-1] = nhdr;
+	int rc = ncdfcptr->NetCDFCpp::GetVara(
+		varname, start, count, (void *) codebuf
+	);
+	if (rc<0) return(rc);
+
+    unsigned long LSBTest = 1;
+	unsigned char header[16];
+	assert(sizeof(header) >= nhdr * wsize);
+	memcpy(header, codebuf, nhdr * wsize);
+    if (! (*(char *) &LSBTest)) {
+		swapbytes((void *) header, wsize, nhdr);
+	}
+
+	size_t nbytes;
+	rc = CoeffCodec::GetEncodedSize(header, nbytes);
+	if (rc<0) return(rc);
+
+	size_t nwords = (nbytes + wsize - 1) / wsize;
+	if (nwords > nslot) {
+		CoeffCodec::SetErrMsg("Invalid coefficient stream");
+		return(-1);
+	}
+
+	if (nwords > nhdr) {
+		start[start.size()-1] = offset + nhdr;
+		count[count.size()-1] = nwords - nhdr;
+		rc = ncdfcptr->NetCDFCpp::GetVara(
+			varname, start, count, (void *) (codebuf + nhdr * wsize)
+		);
+		if (rc<0) return(rc);
+	}
+
+	return(0);
+}
+
 // Read a single transformed & compressed block from disk
 //
 // varname : name of variable
@@ -1027,13 +1461,21 @@ int FetchBlock(
 // each compression level.
 // coeffs : transformed coefficients for each compression level
 // maps : encoded significance maps for each compression level
+// bounded : if true the variable is error bounded. The number of
+// coefficients stored at each level is variable and given by the level's
+// significance map, which is read first.
+// nbits : coefficient quantization bit depth, or 0 if not quantized
+// codebuf : if 'nbits' is non-zero, storage for the encoded coefficients,
+// which are decoded with DecodeBlock(), instead of 'coeffs'
+// cmp : Compressor for the variable's blocks. Only used if 'nbits'
+// is non-zero.
 //
 template <class T>
 int FetchBlockCompressed(
 	string varname, vector <NetCDFCpp *> ncdfcptrs, vector <size_t> bcoords, 
 	vector <size_t> ncoeffs, vector <size_t> encoded_dims,
-	T *coeffs, T *datarange, unsigned char *maps, int xtype
-	
+	T *coeffs, T *datarange, unsigned char *maps, int xtype, bool bounded,
+	int nbits, unsigned char *codebuf, const Compressor *cmp
 ) {
     unsigned long LSBTest = 1;
     bool do_swapbytes = false;
@@ -1061,28 +1503,20 @@ int FetchBlockCompressed(
 	//
 	assert(ncdfcptrs.size() >= ncoeffs.size());
 	for (int i=0; i<ncoeffs.size(); i++) {
-		start[start.size()-1] = i==0 ? BLK_HDR_SZ : 0;	// skip header
-		count[start.size()-1] = ncoeffs[i];
-
-		int rc = ncdfcptrs[i]->NetCDFCpp::GetVara(
-			varname, start, count, coeffs
-		);
-		if (rc<0) return(rc);
-
-		coeffs += ncoeffs[i];
+		size_t nslot = coeff_slot_size(ncoeffs[i], nbits, xtype, i, cmp);
 
 		// Sigmap size (in words) is difference between encoded_dims and 
-		// number of coefficients
+		// coefficient storage
 		//
-		assert(encoded_dims[i] >= ncoeffs[i]);
-		size_t n = encoded_dims[i] - ncoeffs[i];
+		assert(encoded_dims[i] >= nslot);
+		size_t n = encoded_dims[i] - nslot;
 		if (i==0) n-=BLK_HDR_SZ;
 
 		//
 		// If sigmap size is zero don't read it!
 		//
 		if (n != 0) {
-			start[start.size()-1] = i==0 ? ncoeffs[i] + BLK_HDR_SZ : ncoeffs[i];
+			start[start.size()-1] = i==0 ? nslot + BLK_HDR_SZ : nslot;
 			count[start.size()-1] = n;
 
 
@@ -1100,9 +1534,43 @@ int FetchBlockCompressed(
 			if (do_swapbytes) {
 				swapbytes((void *) maps, NetCDFCpp::SizeOf(xtype), n);
 			}
+		}
 
-			maps += n * NetCDFCpp::SizeOf(xtype);
+		// Only the significant coefficients of an error bounded variable
+		// are stored
+		//
+		size_t nread = ncoeffs[i];
+		if (bounded) {
+			assert(n != 0);
+			int rc = SignificanceMap::GetNumEntries(maps, nread);
+			if (rc<0) return(rc);
+
+			if (nread > ncoeffs[i]) {
+				SignificanceMap::SetErrMsg("Invalid significance map");
+				return(-1);
+			}
+		}
+
+		if (nread && nbits) {
+			int rc = fetch_encoded(
+				varname, ncdfcptrs[i], start, i==0 ? BLK_HDR_SZ : 0,
+				nslot, xtype, codebuf
+			);
+			if (rc<0) return(rc);
+		}
+		else if (nread) {
+			start[start.size()-1] = i==0 ? BLK_HDR_SZ : 0;	// skip header
+			count[start.size()-1] = nread;
+
+			int rc = ncdfcptrs[i]->NetCDFCpp::GetVara(
+				varname, start, count, coeffs
+			);
+			if (rc<0) return(rc);
 		}
+
+		coeffs += ncoeffs[i];
+		maps += n * NetCDFCpp::SizeOf(xtype);
+		if (nbits) codebuf += nslot * NetCDFCpp::SizeOf(xtype);
 	}
 	return(0);
 }
@@ -1193,6 +1661,158 @@ void *RunWriteThread(void *arg) {
 	}
 }
 
+// A transformed block waiting to be written by a block_writer
+//
+template <class U>
+struct pending_block {
+	size_t _index;	// block number within region being written
+	vector <size_t> _bcoords;
+	U _datarange[2];
+	vector <U> _coeffs;
+	vector <unsigned char> _maps;
+	vector <unsigned char> _codebuf;
+	vector <size_t> _nstore;
+	vector <size_t> _codewords;
+};
+
+// Write-behind stage for compressed writes. Write threads hand 
+// transformed blocks to a single writer thread, the only thread
+// that calls NetCDF, so they never wait on NetCDF. Pending blocks
+// are written lowest block number first to keep file access sequential.
+// At most 'max_pending' blocks are allocated; Get() blocks until one
+// has been written if all are in use.
+//
+template <class U>
+class block_writer {
+public:
+ block_writer(const thread_state &s, size_t max_pending) :
+	_varname(s._varname), _ncdfcptrs(s._ncdfcptrs), _ncoeffs(s._ncoeffs),
+	_encoded_dims(s._encoded_dims), _xtype(s._xtype), _nbits(s._nbits),
+	_cmp(s._compressors[0]),
+	_coeffs_size(vsum(s._ncoeffs)), _maps_size(maps_buf_size(s)),
+	_codebuf_size(s._nbits ? codebuf_size(s) : 0),
+	_max_pending(max_pending), _done(false), _failed(false)
+ {
+	_thread = std::thread(&block_writer::_run, this);
+ }
+
+ ~block_writer() {
+	if (_thread.joinable()) Finish();
+	for (size_t i=0; i<_blocks.size(); i++) delete _blocks[i];
+ }
+
+ // Return storage for a block, or NULL if a write has failed
+ //
+ pending_block <U> *Get() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (_free.empty() && _blocks.size() >= _max_pending && ! _failed) {
+		_written.wait(lock);
+	}
+	if (_failed) return(NULL);
+
+	if (! _free.empty()) {
+		pending_block <U> *b = _free.back();
+		_free.pop_back();
+		return(b);
+	}
+
+	pending_block <U> *b = new pending_block <U>;
+	b->_coeffs.resize(_coeffs_size);
+	b->_maps.resize(_maps_size);
+	b->_codebuf.resize(_codebuf_size);
+	_blocks.push_back(b);
+	return(b);
+ }
+
+ // Queue a block returned by Get() for writing
+ //
+ void Put(pending_block <U> *b) {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_queue[b->_index] = b;
+	}
+	_ready.notify_one();
+ }
+
+ // Return a block obtained with Get() that won't be written, so that
+ // threads blocked in Get() can reuse it
+ //
+ void Release(pending_block <U> *b) {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_free.push_back(b);
+	}
+	_written.notify_all();
+ }
+
+ // Write all queued blocks and stop the writer thread
+ //
+ int Finish() {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done = true;
+	}
+	_ready.notify_one();
+	_thread.join();
+	return(_failed ? -1 : 0);
+ }
+
+private:
+ string _varname;
+ vector <NetCDFCpp *> _ncdfcptrs;
+ vector <size_t> _ncoeffs;
+ vector <size_t> _encoded_dims;
+ int _xtype;
+ int _nbits;
+ const Compressor *_cmp;	// for storage layout only
+ size_t _coeffs_size;
+ size_t _maps_size;
+ size_t _codebuf_size;
+ size_t _max_pending;
+ bool _done;
+ bool _failed;
+ vector <pending_block <U> *> _blocks;
+ vector <pending_block <U> *> _free;
+ std::map <size_t, pending_block <U> *> _queue;
+ std::thread _thread;
+ std::mutex _mutex;
+ std::condition_variable _ready;
+ std::condition_variable _written;
+
+ void _run() {
+	for (;;) {
+		pending_block <U> *b;
+		bool failed;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (_queue.empty() && ! _done) _ready.wait(lock);
+			if (_queue.empty()) return;
+
+			b = _queue.begin()->second;
+			_queue.erase(_queue.begin());
+			failed = _failed;
+		}
+
+		int rc = 0;
+		if (! failed) {
+			rc = StoreBlockCompressed(
+				_varname, _ncdfcptrs, b->_bcoords, _ncoeffs, _encoded_dims,
+				b->_coeffs.data(), b->_datarange, b->_maps.data(), _xtype, 
+				b->_nstore, _nbits, _nbits ? b->_codebuf.data() : NULL,
+				b->_codewords, _cmp
+			);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (rc<0) _failed = true;
+			_free.push_back(b);
+		}
+		_written.notify_all();
+	}
+ }
+};
+
 // Thread execution help function for data writes
 //
 	
@@ -1205,12 +1825,42 @@ void *RunWriteThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 
 	s._status = 0;
 
+	Compressor *cmp = s._compressors[s._id];
+
+	CoeffCodec codec(s._nbits);
+	vector <unsigned char> codebuf;
+	vector <size_t> codewords;
+	vector <SignificanceMap> sigmaps;
+	vector <unsigned char> bands;
+	if (s._nbits) cmp->GetSubbands(bands);
+
+	block_writer <U> *writer = (block_writer <U> *) s._writer;
+	if (! writer) codebuf.resize(codebuf_size(s));
+
 	//
 	// Process blocks of data assigned to this thread
 	//
 	int n = vec.num();
 	for (int i=s._id; i<n; i += s._nthreads) {
 
+		// With a block_writer, blocks are transformed directly into
+		// storage that is handed off to the writer thread
+		//
+		U *coeffs = (U *) s._coeffs;
+		unsigned char *maps = s._maps;
+		unsigned char *cbuf = codebuf.data();
+		pending_block <U> *pb = NULL;
+		if (writer) {
+			pb = writer->Get();
+			if (! pb) {
+				s._status = -1;
+				break;
+			}
+			coeffs = pb->_coeffs.data();
+			maps = pb->_maps.data();
+			cbuf = pb->_codebuf.data();
+		}
+
 		// Get starting coordinates of i'th block
 		//
 		size_t offset;
@@ -1232,16 +1882,47 @@ void *RunWriteThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 		);
 
 		//
-		// Wavelet transform the current block
+		// Wavelet transform the current block. Quantization adds to the
+		// error of an error bounded block, which is measured after 
+		// encoding. If the bound is exceeded the block is transformed 
+		// again with a tighter bound. Encoding is done outside of the
+		// mutex below so threads quantize and entropy code in parallel
 		//
-		int rc = DecomposeBlock(
-			s._compressors[s._id], (const U *) s._block, vproduct(s._bs),
-			(U *) s._coeffs, s._maps, s._xtype, s._ncoeffs, s._encoded_dims
-		);
+		const int max_tries = 4;
+		double target = s._max_error;
+		double error;
+		vector <size_t> nstore;
+		int rc = 0;
+		for (int tries = 0; tries < max_tries; tries++) {
+			rc = DecomposeBlock(
+				cmp, (const U *) s._block, vproduct(s._bs),
+				coeffs, maps, s._xtype, s._ncoeffs, s._encoded_dims,
+				s._nbits, datarange, s._bounded, target, error, nstore,
+				sigmaps
+			);
+			if (rc<0 || ! s._nbits) break;
+
+			rc = EncodeBlock(
+				&codec, cmp, (const U *) coeffs, s._ncoeffs, nstore, sigmaps,
+				bands, s._xtype, cbuf, codewords
+			);
+			if (rc<0 || ! s._bounded) break;
+
+			rc = EncodedBlockError(
+				cmp, &codec, cbuf, s._ncoeffs, sigmaps, bands, s._xtype,
+				(const U *) datarange, (const U *) s._block, vproduct(s._bs),
+				error
+			);
+			if (rc<0 || error <= s._max_error) break;
+
+			target *= 0.5;
+		}
 		if (rc<0) {
+			if (pb) writer->Release(pb);
 			s._status = -1;
 			break;
 		}
+		if (error > s._error) s._error = error;
 
 		// Convert from voxel to block coordinates
 		//
@@ -1250,6 +1931,17 @@ void *RunWriteThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 		to_block_coords(start, s._bs, bcoords, residual);
 		assert(residual == 0);
 
+		if (writer) {
+			pb->_index = i;
+			pb->_bcoords = bcoords;
+			pb->_datarange[0] = datarange[0];
+			pb->_datarange[1] = datarange[1];
+			pb->_nstore = nstore;
+			pb->_codewords = codewords;
+			writer->Put(pb);
+			continue;
+		}
+
 		// Write the transformed block to disk. Need a mutex because
 		// NetCDF library is not thread safe
 		//
@@ -1257,7 +1949,8 @@ void *RunWriteThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 		s._et->MutexLock();
 			rc = StoreBlockCompressed(
 				s._varname, s._ncdfcptrs, bcoords, s._ncoeffs, s._encoded_dims,
-				(U *) s._coeffs, datarange, s._maps, s._xtype
+				coeffs, datarange, maps, s._xtype, nstore,
+				s._nbits, s._nbits ? cbuf : NULL, codewords, cmp
 			);
 			if (rc<0) {
 				s._status = -1;
@@ -1466,6 +2159,14 @@ void *RunReadThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 
 	s._status = 0;
 
+	Compressor *cmp = s._compressors[s._id];
+
+	CoeffCodec codec(s._nbits);
+	vector <unsigned char> codebuf(codebuf_size(s));
+	vector <SignificanceMap> sigmaps;
+	vector <unsigned char> bands;
+	if (s._nbits) cmp->GetSubbands(bands);
+
 	int n = vec.num();
 	for (int i=s._id; i<n; i += s._nthreads) {
 
@@ -1486,12 +2187,33 @@ void *RunReadThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 		s._et->MutexLock();
 			int rc = FetchBlockCompressed(
 				s._varname, s._ncdfcptrs, bcoords, s._ncoeffs, 
-				s._encoded_dims, (U *) s._coeffs, datarange, s._maps, s._xtype
+				s._encoded_dims, (U *) s._coeffs, datarange, s._maps, s._xtype,
+				s._bounded, s._nbits, codebuf.data(), cmp
 			);
 			if (rc<0) s._status = -1;
 		s._et->MutexUnlock();
 		if (s._status < 0) break;
 
+		rc = ExtractSigMaps(
+			cmp, s._maps, s._xtype, s._ncoeffs, s._encoded_dims, s._nbits,
+			sigmaps
+		);
+		if (rc<0) {
+			s._status = -1;
+			break;
+		}
+
+		if (s._nbits) {
+			rc = DecodeBlock(
+				&codec, cmp, codebuf.data(), s._ncoeffs, sigmaps, bands,
+				s._xtype, (U *) s._coeffs
+			);
+			if (rc<0) {
+				s._status = -1;
+				break;
+			}
+		}
+
 		// Transform coordinates from global to the region-of-interest
 		//
 		vector <size_t> roi_start = vector_sub(start, aligned_start);
@@ -1502,8 +2224,7 @@ void *RunReadThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 		// Transform from wavelet to physical space
 		//
 		rc = ReconstructBlock(
-			s._compressors[s._id], (U *) s._coeffs, datarange, s._maps, 
-			s._xtype, s._ncoeffs, s._encoded_dims, blockptr, 
+			cmp, (U *) s._coeffs, datarange, sigmaps, blockptr, 
 			vproduct(s._bs), s._level
 		);
 		if (rc<0) {
@@ -1625,6 +2346,11 @@ WASP::WASP(int nthreads) {
 	_open_level = 0;
 	_open_write = false;
 	_open_varname.clear();
+	_open_bounded = false;
+	_open_max_error = 0.0;
+	_open_relative = false;
+	_open_nbits = 0;
+	_quant_nbits = 0;
 
 	_et = NULL;
 
@@ -1843,6 +2569,58 @@ int WASP::DefVar(
     string name, int xtype, vector <string> dimnames, 
 	string wname, vector <size_t> bs, vector <size_t> cratios
 ) {
+	return(_DefVar(name, xtype, dimnames, wname, bs, cratios, false));
+}
+
+int WASP::DefVar(
+	string name, int xtype, vector <string> dimnames, 
+	string wname, vector <size_t> bs, vector <size_t> cratios,
+	double max_error, bool relative
+) {
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	if (bs.size()==0 || vproduct(bs) == 1 || wname.empty()) { 
+		SetErrMsg("Error bounded variables must be compressed");
+		return(-1);
+	}
+
+	if (! (max_error >= 0.0)) {
+		SetErrMsg("Invalid error bound : %f", max_error);
+		return(-1);
+	}
+
+	int rc = _DefVar(name, xtype, dimnames, wname, bs, cratios, true);
+	if (rc<0) return(rc);
+
+	// Unused coefficient storage is never written. Disable filling so
+	// that it isn't written at EndDef() either
+	//
+	int old_fillmode;
+	rc = SetFill(NC_NOFILL, old_fillmode);
+	if (rc<0) return(rc);
+
+	vector <double> bound;
+	bound.push_back(max_error);
+	bound.push_back(relative ? 1.0 : 0.0);
+	rc = PutAtt(name, AttNameErrorBound(), bound);
+	if (rc<0) return(rc);
+
+	// Updated as blocks are written. See _update_max_error()
+	//
+	rc = PutAtt(name, AttNameMaxError(), 0.0);
+	if (rc<0) return(rc);
+
+	return(NC_NOERR);
+}
+
+int WASP::_DefVar(
+    string name, int xtype, vector <string> dimnames, 
+	string wname, vector <size_t> bs, vector <size_t> cratios,
+	bool bounded
+) {
 
 	if (! _waspFile) {
 		SetErrMsg("Not a WASP file");
@@ -1918,8 +2696,12 @@ int WASP::DefVar(
 	vector <size_t> cdims;
 
 	int rc;
+	// Coefficients of uncompressed variables are never quantized
+	//
+	int nbits = wname.empty() ? 0 : _quant_nbits;
+
 	rc = _GetCompressedDims(
-		dimnames, wname, bs, cratios, xtype, cdimnames, cdims,
+		dimnames, wname, bs, cratios, xtype, bounded, nbits, cdimnames, cdims,
 		encoded_dim_names, encoded_dims
 	);
 	if (rc<0) return(rc);
@@ -1986,6 +2768,11 @@ int WASP::DefVar(
 	rc = PutAtt(name, AttNameBlockSize(), bs);
 	if (rc<0) return(rc);
 
+	if (nbits) {
+		rc = PutAtt(name, AttNameQuantization(), nbits);
+		if (rc<0) return(rc);
+	}
+
 	return(NC_NOERR);
 }
 
@@ -2073,6 +2860,113 @@ int WASP::InqVarCompressionParams(
 	return(0);
 }
 
+int WASP::InqVarErrorBound(
+	string name, double &max_error, bool &relative, double &error
+) const {
+	max_error = -1.0;
+	relative = false;
+	error = 0.0;
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	bool waspvar;
+	int rc = InqVarWASP(name, waspvar);
+	if (rc<0) return(rc);
+
+	if (! waspvar) return(0);
+
+	// disable error reporting otherwise an error is generated 
+	// if the attribute doesn't exist
+	//
+	bool enabled = MyBase::EnableErrMsg(false);
+
+	int xtype;
+	size_t len;
+	rc = NetCDFCpp::InqAtt(name, AttNameErrorBound(), xtype, len);
+
+	(void) MyBase::EnableErrMsg(enabled);
+
+	if (rc<0 || len != 2) return(0);	// not error bounded
+
+	vector <double> bound;
+	rc = GetAtt(name, AttNameErrorBound(), bound);
+	if (rc<0) return(rc);
+
+	rc = GetAtt(name, AttNameMaxError(), error);
+	if (rc<0) return(rc);
+
+	max_error = bound[0];
+	relative = bound[1] != 0.0;
+
+	return(0);
+}
+
+int WASP::SetCoeffQuantization(int nbits) {
+	if (nbits != 0 && ! CoeffCodec::IsValidNumBits(nbits)) {
+		SetErrMsg("Invalid quantization bit depth : %d", nbits);
+		return(-1);
+	}
+	_quant_nbits = nbits;
+	return(0);
+}
+
+int WASP::InqVarQuantization(string name, int &nbits) const {
+	nbits = 0;
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	bool waspvar;
+	int rc = InqVarWASP(name, waspvar);
+	if (rc<0) return(rc);
+
+	if (! waspvar) return(0);
+
+	// disable error reporting otherwise an error is generated 
+	// if the attribute doesn't exist. Files written before quantization
+	// was supported lack the attribute.
+	//
+	bool enabled = MyBase::EnableErrMsg(false);
+
+	int xtype;
+	size_t len;
+	rc = NetCDFCpp::InqAtt(name, AttNameQuantization(), xtype, len);
+
+	(void) MyBase::EnableErrMsg(enabled);
+
+	if (rc<0 || len != 1) return(0);	// not quantized
+
+	rc = GetAtt(name, AttNameQuantization(), nbits);
+	if (rc<0) return(rc);
+
+	if (nbits != 0 && ! CoeffCodec::IsValidNumBits(nbits)) {
+		SetErrMsg("Invalid quantization bit depth : %d", nbits);
+		return(-1);
+	}
+
+	return(0);
+}
+
+// Record the largest error seen so far for an error bounded variable.
+// The attribute is overwritten in place, which netCDF permits in data
+// mode because its size is unchanged.
+//
+int WASP::_update_max_error(string name, double error) {
+
+	double max_error;
+	int rc = GetAtt(name, AttNameMaxError(), max_error);
+	if (rc<0) return(rc);
+
+	if (error <= max_error) return(0);
+
+	return(PutAtt(name, AttNameMaxError(), error));
+}
+
 int WASP::InqVarDimlens(
 	string name, int level, 
 	vector <size_t> &dims_at_level, vector <size_t> &bs_at_level
@@ -2329,6 +3223,10 @@ int WASP::OpenVarWrite(string name, int lod) {
 	_open_write = false;
 	_open_varname.clear();
 	_open_varxtype = 0;
+	_open_bounded = false;
+	_open_max_error = 0.0;
+	_open_relative = false;
+	_open_nbits = 0;
 	_open = false;
 
 	nc_type xtype;
@@ -2338,6 +3236,15 @@ int WASP::OpenVarWrite(string name, int lod) {
 	rc = _get_compression_params(name, bs, cratios, udims, dims, wname);
 	if (rc<0) return(rc);
 
+	double max_error, error;
+	bool relative;
+	rc = InqVarErrorBound(name, max_error, relative, error);
+	if (rc<0) return(rc);
+
+	int nbits;
+	rc = InqVarQuantization(name, nbits);
+	if (rc<0) return(rc);
+
 	if (lod < 0)  lod = cratios.size() - 1;
 
     if (lod >= cratios.size()) {
@@ -2364,6 +3271,10 @@ int WASP::OpenVarWrite(string name, int lod) {
 	_open_write = true;
 	_open_varname = name;
 	_open_varxtype = xtype;
+	_open_bounded = max_error >= 0.0;
+	_open_max_error = _open_bounded ? max_error : 0.0;
+	_open_relative = relative;
+	_open_nbits = nbits;
 	_open = true;
 
 	return(NC_NOERR);
@@ -2412,6 +3323,10 @@ int WASP::OpenVarRead(string name, int level, int lod) {
 	_open_write = false;
 	_open_varname.clear();
 	_open_varxtype = 0;
+	_open_bounded = false;
+	_open_max_error = 0.0;
+	_open_relative = false;
+	_open_nbits = 0;
 	_open = false;
 
 	nc_type xtype;
@@ -2421,6 +3336,15 @@ int WASP::OpenVarRead(string name, int level, int lod) {
 	rc = _get_compression_params(name, bs, cratios, udims, dims, wname);
 	if (rc<0) return(rc);
 
+	double max_error, error;
+	bool relative;
+	rc = InqVarErrorBound(name, max_error, relative, error);
+	if (rc<0) return(rc);
+
+	int nbits;
+	rc = InqVarQuantization(name, nbits);
+	if (rc<0) return(rc);
+
 	// For multi-file storage higher-numbered files may be missing
 	// and the max LOD is determined by the number files actually present.
 	// In general cratios.size() == _ncdfcptrs.size()
@@ -2467,6 +3391,10 @@ int WASP::OpenVarRead(string name, int level, int lod) {
 	_open_write = false;
 	_open_varname = name;
 	_open_varxtype = xtype;
+	_open_bounded = max_error >= 0.0;
+	_open_max_error = _open_bounded ? max_error : 0.0;
+	_open_relative = relative;
+	_open_nbits = nbits;
 	_open = true;
 
 	return(NC_NOERR);
@@ -2583,8 +3511,8 @@ int WASP::_PutVara(
 	vector <size_t> ncoeffs;
 	vector <size_t> encoded_dims;
 	_get_encoding_vectors(
-		_open_wname, _open_bs, _open_cratios, _open_varxtype, 
-		ncoeffs, encoded_dims
+		_open_wname, _open_bs, _open_cratios, _open_varxtype, _open_bounded,
+		_open_nbits, ncoeffs, encoded_dims
 	);
 
 
@@ -2609,13 +3537,38 @@ int WASP::_PutVara(
 		coeffs_size = vsum(ncoeffs);
 		coeffs = (U *) _coeffbuf.Alloc(coeffs_size * _nthreads * sizeof(U));
 
-		maps_size = vsum(encoded_dims) - vsum(ncoeffs);  
-		maps_size -= BLK_HDR_SZ; 
+		maps_size = vsum(encoded_dims) - BLK_HDR_SZ; 
+		for (int i=0; i<ncoeffs.size(); i++) {
+			maps_size -= coeff_slot_size(
+				ncoeffs[i], _open_nbits, _open_varxtype, i, _open_compressors[0]
+			);
+		}
 		maps = (unsigned char*) _sigbuf.Alloc(
 			maps_size * _nthreads * NetCDFCpp::SizeOf(_open_varxtype)
 		);
 	}
 
+	// Relative error bounds are scaled by the range of the valid data
+	// in this request
+	//
+	double max_error = _open_max_error;
+	if (_open_bounded && _open_relative) {
+		size_t n = vproduct(count);
+		bool first = true;
+		double minval = 0.0;
+		double maxval = 0.0;
+		for (size_t i=0; i<n; i++) {
+			if (mask && ! mask[i]) continue;
+			if (first) {
+				minval = maxval = data[i];
+				first = false;
+			}
+			if (data[i] < minval) minval = data[i];
+			if (data[i] > maxval) maxval = data[i];
+		}
+		max_error *= (maxval - minval);
+	}
+
 	// Ugh. Can't preserve type in thread_state, which has to be passed
 	// as a void * to thread library
 	//
@@ -2628,14 +3581,31 @@ int WASP::_PutVara(
 	vector <void *> argvec;
 	for (int i=0; i<_nthreads; i++) {
 
-		argvec.push_back((void *) new thread_state(
+		thread_state *ts = new thread_state(
 			i, _et, _nthreads, _open_varname, _ncdfcptrs, start, count, 
 			_open_bs, _open_udims, ncoeffs, encoded_dims, _open_compressors, 
 			(void *) data, data_type, (unsigned char *) mask,
 			block + i*block_size, coeffs + i*coeffs_size, 
 			block_type, _open_varxtype,
 			maps + i*maps_size*NetCDFCpp::SizeOf(_open_varxtype), 0, true
-		));
+		);
+		ts->_bounded = _open_bounded && ! _open_wname.empty();
+		ts->_max_error = max_error;
+		ts->_nbits = _open_wname.empty() ? 0 : _open_nbits;
+		argvec.push_back((void *) ts);
+	}
+
+	// Compressed blocks are written by a dedicated thread when there 
+	// are several threads transforming them
+	//
+	block_writer <U> *writer = NULL;
+	if (_nthreads > 1 && ! _open_wname.empty()) {
+		writer = new block_writer <U>(
+			*(thread_state *) argvec[0], 2 * _nthreads
+		);
+		for (int i=0; i<argvec.size(); i++) {
+			((thread_state *) argvec[i])->_writer = writer;
+		}
 	}
 
 	if (_nthreads == 1) {
@@ -2655,12 +3625,29 @@ int WASP::_PutVara(
 			rc = _et->ParRun(RunWriteThreadCompressed, argvec);
 		}
 
+		if (writer) {
+			if (writer->Finish() < 0) thread_state::_status = -1;
+			delete writer;
+		}
+
 		if (rc < 0) {
 			SetErrMsg("Error spawning threads");
 			return(-1);
 		}
 	}
-	for (int i=0; i<argvec.size(); i++) delete (thread_state *) argvec[i];
+
+	double error = 0.0;
+	for (int i=0; i<argvec.size(); i++) {
+		thread_state *ts = (thread_state *) argvec[i];
+		if (ts->_error > error) error = ts->_error;
+		delete ts;
+	}
+	if (thread_state::_status < 0) return(thread_state::_status);
+
+	if (_open_bounded && ! _open_wname.empty()) {
+		int rc = _update_max_error(_open_varname, error);
+		if (rc<0) return(rc);
+	}
 
 	return(thread_state::_status);
 }
@@ -2881,8 +3868,8 @@ int WASP::_GetVara(
 	vector <size_t> ncoeffs;
 	vector <size_t> encoded_dims;
 	_get_encoding_vectors(
-		_open_wname, _open_bs, _open_cratios, _open_varxtype, 
-		ncoeffs, encoded_dims
+		_open_wname, _open_bs, _open_cratios, _open_varxtype, _open_bounded,
+		_open_nbits, ncoeffs, encoded_dims
 	);
 
 	// Compute the dimension and block size at the grid hierarchy
@@ -2924,8 +3911,12 @@ int WASP::_GetVara(
 		coeffs_size = vsum(ncoeffs);
 		coeffs = (U *) _coeffbuf.Alloc(coeffs_size * _nthreads * sizeof(U));
 
-		maps_size = vsum(encoded_dims) - vsum(ncoeffs);  
-		maps_size -= BLK_HDR_SZ;
+		maps_size = vsum(encoded_dims) - BLK_HDR_SZ; 
+		for (int i=0; i<ncoeffs.size(); i++) {
+			maps_size -= coeff_slot_size(
+				ncoeffs[i], _open_nbits, _open_varxtype, i, _open_compressors[0]
+			);
+		}
 		maps = (unsigned char*) _sigbuf.Alloc(
 			maps_size * _nthreads * NetCDFCpp::SizeOf(_open_varxtype)
 		);
@@ -2945,14 +3936,17 @@ int WASP::_GetVara(
 
 		U *blkptr = block + i*block_size;
 
-		argvec.push_back((void *) new thread_state(
+		thread_state *ts = new thread_state(
 			i, _et, _nthreads, _open_varname, _ncdfcptrs, start, count, 
 			bs_at_level, dims_at_level, ncoeffs,
 			encoded_dims, _open_compressors, data, data_type, NULL,
 			blkptr, coeffs + i*coeffs_size, block_type, _open_varxtype,
 			maps + i*maps_size*NetCDFCpp::SizeOf(_open_varxtype), 
 			_open_level, unblock_flag
-		));
+		);
+		ts->_bounded = _open_bounded;
+		ts->_nbits = _open_wname.empty() ? 0 : _open_nbits;
+		argvec.push_back((void *) ts);
 	}
 
 	if (_nthreads == 1) {
@@ -3355,6 +4349,8 @@ int WASP::_GetCompressedDims(
 	vector <size_t> bs,
 	vector <size_t> cratios,
 	int xtype,
+	bool bounded,
+	int nbits,
 	vector <string> &cdimnames, 
 	vector <size_t> &cdims,
 	vector <string> &encoded_dim_names, 
@@ -3407,7 +4403,9 @@ int WASP::_GetCompressedDims(
 	// coefficients. There is one coefficient dimension for each LOD
 	//
 	vector <size_t> ncoeffs;
-	_get_encoding_vectors(wname, bs, cratios, xtype, ncoeffs, encoded_dims);
+	_get_encoding_vectors(
+		wname, bs, cratios, xtype, bounded, nbits, ncoeffs, encoded_dims
+	);
 
 	string encoded_dim_base;
 	for (int i=0; i<cdimnames.size(); i++) {
@@ -3425,6 +4423,12 @@ int WASP::_GetCompressedDims(
 		for (int i=0; i<encoded_dims.size(); i++) {
 			ostringstream oss;
 			oss << encoded_dim_base << i;
+
+			// Encoded dimensions of error bounded and quantized variables
+			// differ from those of other variables with the same blocking
+			//
+			if (bounded) oss << "E";
+			if (nbits) oss << "Q" << nbits;
 			encoded_dim_names.push_back(oss.str());
 		}
 //	}
@@ -3447,10 +4451,14 @@ int WASP::_GetCompressedDims(
 // ncoeffs : number of wavelet coefficients for each compression level
 // encoded_dims : dimension of encoded block for each compression
 // level.  The dimension is ncoeffs + size of encoded sig map
+// bounded : if true the variable is error bounded and every level 
+// stores a sigmap
+// nbits : coefficient quantization bit depth, or 0 if not quantized. 
+// Quantized coefficients are stored in coeff_slot_size() words.
 //
 void WASP::_get_encoding_vectors(
 	string wname, vector <size_t> bs, vector <size_t> cratios, int xtype,
-	vector <size_t> &ncoeffs, 
+	bool bounded, int nbits, vector <size_t> &ncoeffs, 
 	vector <size_t> &encoded_dims
 ) const {
 	ncoeffs.clear();
@@ -3493,24 +4501,25 @@ void WASP::_get_encoding_vectors(
 
 		ncoeffs.push_back(n);
 
+		size_t nslot = coeff_slot_size(n, nbits, xtype, i, &compressor);
 
 		// Signifance map is encoded with the wavelet coefficients. 
 		// Size of sigmap returned by GetSigMapSize() is in bytes. Need to
 		// convert bytes to word size of POD
 		//
-		if (cratios[i] != 1) {
+		if (cratios[i] != 1 || bounded) {
 			size_t s = compressor.GetSigMapSize(n);
 
 			s = (s + SizeOf(xtype)-1) / SizeOf(xtype);
 
-			encoded_dims.push_back(header_size+n+s);
+			encoded_dims.push_back(header_size+nslot+s);
 		}
 		else {
 			assert (naccum == ntotal);
 
 			// Special case. Don't need to explicitly store sigmap
 			//
-			encoded_dims.push_back(header_size+n+0);
+			encoded_dims.push_back(header_size+nslot+0);
 		}
 	}
 }
@@ -0,0 +1,40 @@
+#version 330 core
+
+// Shared barb mesh, in the barb's local frame. A vertex is placed at
+// (vMesh.x * u + vMesh.y * b) * radius from the barb's axis, and at
+// vMesh.z * length + vMesh.w * radius along it, so the head keeps its
+// shape however long the barb is
+//
+layout (location = 0) in vec4 vMesh;
+layout (location = 1) in vec3 vNormal;
+
+// Per barb: start point, unit direction and length, and color
+//
+layout (location = 2) in vec3 iStart;
+layout (location = 3) in vec4 iDir;
+layout (location = 4) in vec4 iColor;
+
+out vec3 fNormal;
+out vec4 fColor;
+
+uniform mat4 P;
+uniform mat4 MV;
+uniform float radius;
+
+void main() {
+    vec3 dir = iDir.xyz;
+    vec3 u = cross(dir, vec3(1.0, 0.0, 0.0));
+    if (dot(u, u) == 0.0)
+        u = cross(dir, vec3(0.0, 1.0, 0.0));
+    u = normalize(u);
+    vec3 b = cross(u, dir);
+
+    vec3 pos = iStart
+        + (vMesh.x * u + vMesh.y * b) * radius
+        + dir * (vMesh.z * iDir.w + vMesh.w * radius);
+    vec3 normal = vNormal.x * u + vNormal.y * b + vNormal.z * dir;
+
+    gl_Position = P * MV * vec4(pos, 1.0f);
+    fNormal = mat3(transpose(inverse(MV))) * normal;
+    fColor = iColor;
+}
@@ -1,12 +1,12 @@
 #version 330 core
 in vec2 TexCoords;
+in vec4 fColor;
 out vec4 fragment;
 
-uniform vec4 color;
 uniform sampler2D text;
 
 void main()
 {
     vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    fragment = color * sampled;
+    fragment = fColor * sampled;
 }
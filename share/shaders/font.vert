@@ -1,11 +1,15 @@
 #version 330 core
-layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex in atlas pixels>
+layout (location = 1) in vec4 vColor;
 out vec2 TexCoords;
+out vec4 fColor;
 
 uniform mat4 MVP;
+uniform vec2 atlasSize;
 
 void main()
 {
     gl_Position = MVP * vec4(vertex.xy, 0.0, 1.0);
-    TexCoords = vertex.zw;
+    TexCoords = vertex.zw / atlasSize;
+    fColor = vColor;
 }
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include <vapor/Compressor.h>
+#include <vapor/CoeffCodec.h>
+
+using namespace std;
+using namespace VAPoR;
+
+// Generate coefficients whose magnitude decreases with the subband,
+// as it does for the detail subbands of a smooth field
+//
+template <class T>
+void make_coeffs(const vector <unsigned char> &bands, vector <T> &coeffs) {
+	coeffs.resize(bands.size());
+	for (size_t i=0; i<bands.size(); i++) {
+		double scale = 1000.0 / (1 + bands[i]);
+		double r = (double) rand() / RAND_MAX - 0.5;
+		coeffs[i] = (T) (2.0 * r * scale);
+	}
+}
+
+// Encode and decode coeffs, and check that subband 0 is returned 
+// exactly and that every other coefficient is within half the 
+// quantization step of its subband
+//
+template <class T>
+int test_round_trip(
+	const vector <T> &coeffs, const vector <unsigned char> &bands,
+	int nbands, int nbits, const char *label
+) {
+	const unsigned char *bptr = bands.empty() ? NULL : bands.data();
+	size_t n = coeffs.size();
+	size_t napprox = 0;
+	for (size_t i=0; i<bands.size(); i++) {
+		if (bands[i] == 0) napprox++;
+	}
+
+	CoeffCodec codec(nbits);
+	vector <unsigned char> buf(
+		CoeffCodec::GetMaxEncodedSize(
+			n, nbits, bptr ? nbands : 2, napprox
+		)
+	);
+	size_t nbytes;
+	codec.Encode(coeffs.data(), bptr, nbands, n, buf.data(), nbytes);
+	if (nbytes > buf.size()) {
+		cerr << label << " : encoded size " << nbytes << 
+			" exceeds maximum " << buf.size() << endl;
+		return(-1);
+	}
+
+	size_t len;
+	if (CoeffCodec::GetEncodedSize(buf.data(), len) < 0 || len != nbytes) {
+		cerr << label << " : invalid header" << endl;
+		return(-1);
+	}
+
+	vector <T> out(n);
+	if (codec.Decode(buf.data(), nbytes, bptr, out.data(), n) < 0) {
+		cerr << label << " : decode failed" << endl;
+		return(-1);
+	}
+
+	// A truncated stream must be rejected
+	//
+	vector <T> tmp(n);
+	if (codec.Decode(buf.data(), nbytes/2, bptr, tmp.data(), n) >= 0) {
+		cerr << label << " : truncated stream accepted" << endl;
+		return(-1);
+	}
+
+	int nb = bptr ? nbands : 2;
+	vector <double> maxabs(nb, 0.0);
+	for (size_t i=0; i<n; i++) {
+		int b = bptr ? bptr[i] : 1;
+		double a = fabs((double) coeffs[i]);
+		if (a > maxabs[b]) maxabs[b] = a;
+	}
+
+	double qmax = (double) (((long) 1 << (nbits-1)) - 1);
+	for (size_t i=0; i<n; i++) {
+		int b = bptr ? bptr[i] : 1;
+		double err = fabs((double) out[i] - (double) coeffs[i]);
+		double tol = b == 0 ? 0.0 : 
+			0.5 * maxabs[b] / qmax + 1e-6 * maxabs[b];
+
+		// Integer coefficients that fit in nbits are coded losslessly,
+		// others are rounded to the nearest integer on decode
+		//
+		if (b != 0 && numeric_limits<T>::is_integer) {
+			tol = maxabs[b] <= qmax ? 0.0 : tol + 0.5;
+		}
+
+		if (err > tol) {
+			cerr << label << " : coefficient " << i << " of subband " << 
+				b << " is " << out[i] << ", expected " << coeffs[i] << 
+				" (tolerance " << tol << ")" << endl;
+			return(-1);
+		}
+	}
+	return(0);
+}
+
+int test_block(vector <size_t> dims, string wname, int nbits) {
+	Compressor cmp(dims, wname);
+
+	vector <unsigned char> bands;
+	int nbands = cmp.GetSubbands(bands);
+	if (nbands != cmp.GetNumSubbands() || 
+		bands.size() != cmp.GetNumWaveCoeffs()) {
+
+		cerr << "Invalid subbands" << endl;
+		return(-1);
+	}
+
+	int rc = 0;
+
+	vector <double> dcoeffs;
+	make_coeffs(bands, dcoeffs);
+	if (test_round_trip(dcoeffs, bands, nbands, nbits, "double") < 0) {
+		rc = -1;
+	}
+
+	vector <long> lcoeffs;
+	make_coeffs(bands, lcoeffs);
+	if (test_round_trip(lcoeffs, bands, nbands, nbits, "long") < 0) {
+		rc = -1;
+	}
+
+	// Without a subband table every coefficient is quantized with 
+	// a single step
+	//
+	vector <unsigned char> nobands;
+	if (test_round_trip(dcoeffs, nobands, 0, nbits, "no subbands") < 0) {
+		rc = -1;
+	}
+	return(rc);
+}
+
+int	main(int argc, char **argv) {
+	int rc = 0;
+
+	size_t shapes[][3] = {{64,1,1}, {32,32,1}, {16,16,16}, {17,9,33}};
+	int depths[] = {2, 8, 16, 32};
+
+	for (int i=0; i<sizeof(shapes)/sizeof(shapes[0]); i++) {
+		vector <size_t> dims;
+		for (int j=0; j<3; j++) {
+			if (shapes[i][j] > 1) dims.push_back(shapes[i][j]);
+		}
+		for (int j=0; j<sizeof(depths)/sizeof(depths[0]); j++) {
+			if (test_block(dims, "bior4.4", depths[j]) < 0) {
+				cerr << "Failed for " << dims.size() << "D block with " <<
+					depths[j] << " bits" << endl;
+				rc = 1;
+			}
+		}
+	}
+
+	if (rc == 0) cout << "All coefficient codec tests passed" << endl;
+	exit(rc);
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include <vapor/vizutil.h>
+
+using namespace std;
+using namespace VAPoR;
+
+// Decimate an ni x nj x nk block of constant value. Every element of 
+// the result must have the same value, whatever axes are degenerate
+//
+int test_constant(size_t ni, size_t nj, size_t nk) {
+	vector <float> src(ni*nj*nk, 1.0);
+	vector <float> dst(((ni+1)/2) * ((nj+1)/2) * ((nk+1)/2), -1.0);
+
+	DecimateBlock(ni, nj, nk, src.data(), dst.data());
+
+	for (size_t i=0; i<dst.size(); i++) {
+		if (fabs(dst[i] - 1.0) > 1e-6) {
+			cerr << "Constant block " << ni << "x" << nj << "x" << nk <<
+				" : element " << i << " is " << dst[i] << endl;
+			return(-1);
+		}
+	}
+	return(0);
+}
+
+// Decimate an ni x nj x nk block with random values, and compare with 
+// the average of the samples in each neighborhood
+//
+int test_average(size_t ni, size_t nj, size_t nk) {
+	vector <float> src(ni*nj*nk);
+	for (size_t i=0; i<src.size(); i++) src[i] = (float) rand() / RAND_MAX;
+
+	size_t ni1 = (ni+1)/2;
+	size_t nj1 = (nj+1)/2;
+	size_t nk1 = (nk+1)/2;
+	vector <float> dst(ni1*nj1*nk1);
+
+	DecimateBlock(ni, nj, nk, src.data(), dst.data());
+
+	for (size_t k=0; k<nk1; k++) {
+	for (size_t j=0; j<nj1; j++) {
+	for (size_t i=0; i<ni1; i++) {
+		double sum = 0.0;
+		int n = 0;
+		for (size_t kk=2*k; kk<2*k+2 && kk<nk; kk++) {
+		for (size_t jj=2*j; jj<2*j+2 && jj<nj; jj++) {
+		for (size_t ii=2*i; ii<2*i+2 && ii<ni; ii++) {
+			sum += src[(kk*nj + jj)*ni + ii];
+			n++;
+		}
+		}
+		}
+
+		float v = dst[(k*nj1 + j)*ni1 + i];
+		if (fabs(v - sum/n) > 1e-5) {
+			cerr << "Block " << ni << "x" << nj << "x" << nk <<
+				" : element (" << i << "," << j << "," << k << ") is " << 
+				v << ", expected " << sum/n << endl;
+			return(-1);
+		}
+	}
+	}
+	}
+	return(0);
+}
+
+int	main(int argc, char **argv) {
+	size_t shapes[][3] = {
+		{2,1,2}, {2,2,2}, {2,2,1}, {2,1,1}, {1,1,2}, {1,2,2}, 
+		{4,1,6}, {3,1,3}, {5,3,1}, {7,5,3}, {8,8,8}, {1,1,1}
+	};
+
+	int rc = 0;
+	for (int i=0; i<sizeof(shapes)/sizeof(shapes[0]); i++) {
+		size_t *s = shapes[i];
+		if (test_constant(s[0], s[1], s[2]) < 0) rc = 1;
+		if (test_average(s[0], s[1], s[2]) < 0) rc = 1;
+	}
+
+	if (rc == 0) cout << "All decimation tests passed" << endl;
+	exit(rc);
+}
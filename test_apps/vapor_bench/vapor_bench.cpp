@@ -0,0 +1,942 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <cassert>
+#include <algorithm>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/utsname.h>
+#endif
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/EasyThreads.h>
+#include <vapor/Version.h>
+#include <vapor/VDCNetCDF.h>
+#include <vapor/DataMgr.h>
+#include <vapor/DerivedVar.h>
+#include <vapor/vizutil.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Performance benchmarks for the data access paths. Synthetic VDC data
+// sets are generated for each grid type and size, and the results
+// are written as JSON so that they may be compared across commits.
+//
+
+struct {
+	std::vector <size_t> sizes;
+	std::vector <string> types;
+	std::vector <size_t> bs;
+	std::vector <size_t> cratios;
+	string wname;
+	string dir;
+	string output;
+	int loop;
+	int memsize;
+	int nthreads;
+	int npoints;
+	int ncontours;
+	OptionParser::Boolean_T	quiet;
+	OptionParser::Boolean_T	debug;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{
+		"sizes",  1,  "64:128",  "Colon delimited list of grid sizes. "
+		"Each data set has size^3 grid points"
+	},
+	{
+		"types",  1,  "regular:stretched:layered:curvilinear",
+		"Colon delimited list of grid types to benchmark"
+	},
+	{
+		"bs",  1,  "64:64:64",  "Colon delimited 3-element vector "
+		"specifying block size"
+	},
+	{
+		"cratios",  1,  "1:10:100",  "Colon delimited list of "
+		"compression ratios"
+	},
+	{"wname",	1, 	"bior4.4",	"Wavelet family name"},
+	{"dir",	1, 	"vapor_bench_data",	"Directory for generated data sets"},
+	{"output",	1, 	"",	"Write JSON results to this file. Default is stdout"},
+	{"loop",	1, 	"3","Number of times each benchmark is run"},
+	{"memsize",	1, 	"2000","DataMgr cache size in MBs"},
+	{"nthreads",    1,  "0",    "Specify number of execution threads "
+		"0 => use number of cores"},
+	{"npoints",	1, 	"100000","Number of GetValue() samples"},
+	{"ncontours",	1, 	"10","Number of contour values"},
+	{"quiet",	0,	"",	"Don't report progress on stderr"},
+	{"debug",	0,	"",	"Debug mode"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"sizes", Wasp::CvtToSize_tVec, &opt.sizes, sizeof(opt.sizes)},
+	{"types", Wasp::CvtToStrVec, &opt.types, sizeof(opt.types)},
+	{"bs", Wasp::CvtToSize_tVec, &opt.bs, sizeof(opt.bs)},
+	{"cratios", Wasp::CvtToSize_tVec, &opt.cratios, sizeof(opt.cratios)},
+	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"dir", Wasp::CvtToCPPStr, &opt.dir, sizeof(opt.dir)},
+	{"output", Wasp::CvtToCPPStr, &opt.output, sizeof(opt.output)},
+	{"loop", Wasp::CvtToInt, &opt.loop, sizeof(opt.loop)},
+	{"memsize", Wasp::CvtToInt, &opt.memsize, sizeof(opt.memsize)},
+	{"nthreads", Wasp::CvtToInt, &opt.nthreads, sizeof(opt.nthreads)},
+	{"npoints", Wasp::CvtToInt, &opt.npoints, sizeof(opt.npoints)},
+	{"ncontours", Wasp::CvtToInt, &opt.ncontours, sizeof(opt.ncontours)},
+	{"quiet", Wasp::CvtToBoolean, &opt.quiet, sizeof(opt.quiet)},
+	{"debug", Wasp::CvtToBoolean, &opt.debug, sizeof(opt.debug)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+namespace {
+
+// Timing results for one benchmark on one data set
+//
+struct result_t {
+	string dataset;
+	size_t size;
+	string benchmark;
+	vector <double> times;
+	size_t nitems;	// number of voxels, samples, etc. processed per run
+};
+
+vector <result_t> Results;
+
+// Benchmark loop results are stored here to keep the compiler from 
+// discarding the loops
+//
+volatile double Sink;
+
+void record(
+	string dataset, size_t size, string benchmark,
+	const vector <double> &times, size_t nitems
+) {
+	result_t r = {dataset, size, benchmark, times, nitems};
+	Results.push_back(r);
+
+	if (! opt.quiet) {
+		cerr << setw(12) << dataset << " " << setw(5) << size << " "
+			<< setw(16) << benchmark << " : "
+			<< *min_element(times.begin(), times.end()) << " s" << endl;
+	}
+}
+
+string json_escape(const string &s) {
+	string r;
+	for (int i=0; i<s.size(); i++) {
+		if (s[i] == '"' || s[i] == '\\') r += '\\';
+		if ((unsigned char) s[i] < 0x20) continue;
+		r += s[i];
+	}
+	return(r);
+}
+
+// Return the value of the first line in a /proc file beginning with key
+//
+string proc_value(string path, string key) {
+	ifstream in(path.c_str());
+	string line;
+	while (getline(in, line)) {
+		if (line.compare(0, key.size(), key) != 0) continue;
+
+		size_t pos = line.find(':');
+		if (pos == string::npos) continue;
+		pos = line.find_first_not_of(" \t", pos+1);
+		if (pos == string::npos) return("");
+		return(line.substr(pos));
+	}
+	return("");
+}
+
+};
+
+//
+// Synthetic data set generation
+//
+
+// Smooth analytic field so that compression behaves like real data
+//
+float field(size_t i, size_t j, size_t k, size_t n, float phase) {
+	double x = (double) i / (double) n;
+	double y = (double) j / (double) n;
+	double z = (double) k / (double) n;
+	return(
+		sin(2*M_PI*(x + phase)) * cos(2*M_PI*y) * (1.0 + z) +
+		0.1 * sin(8*M_PI*x*y + phase)
+	);
+}
+
+int put_coord_1d(
+	VDCNetCDF &vdc, string varname, size_t n, bool stretched
+) {
+	vector <float> buf(n);
+	for (size_t i=0; i<n; i++) {
+		double t = n > 1 ? (double) i / (double) (n-1) : 0.0;
+		buf[i] = stretched ? t * t : t;
+	}
+	return(vdc.PutVar(0, varname, -1, buf.data()));
+}
+
+// Create a VDC containing two 3D variables, "u" and "v", and a
+// 2D variable, "t2", on a grid of the given type. Returns the time
+// spent encoding (writing) the 3D variables
+//
+int make_dataset(
+	string master, string type, size_t n, double &encodeTime
+) {
+	encodeTime = 0.0;
+
+	VDCNetCDF vdc(opt.nthreads);
+
+	size_t chunksize = 1024*1024*4;
+	int rc = vdc.Initialize(master, vector <string> (), VDC::W, opt.bs, chunksize);
+	if (rc<0) return(-1);
+
+	vector <size_t> cratios(1,1);
+	rc = vdc.SetCompressionBlock("", cratios);
+	if (rc<0) return(-1);
+
+	// Time and, for regular grids, uniform spatial coordinates
+	//
+	rc = vdc.DefineDimension("Nt", 1, 3);
+	if (rc<0) return(-1);
+
+	vector <string> dimnames = {"Nx", "Ny", "Nz", "Nt"};
+	vector <string> coordvars;
+	vector <string> coordvars2d;
+	if (type == "regular" || type == "layered" || type == "curvilinear") {
+		rc = vdc.DefineDimension("Nx", n, 0);
+		if (rc<0) return(-1);
+		rc = vdc.DefineDimension("Ny", n, 1);
+		if (rc<0) return(-1);
+		rc = vdc.DefineDimension("Nz", n, 2);
+		if (rc<0) return(-1);
+	}
+	else {
+		rc = vdc.DefineDimension("Nx", n);
+		if (rc<0) return(-1);
+		rc = vdc.DefineDimension("Ny", n);
+		if (rc<0) return(-1);
+		rc = vdc.DefineDimension("Nz", n);
+		if (rc<0) return(-1);
+	}
+
+	if (type == "regular") {
+		coordvars = {"Nx", "Ny", "Nz", "Nt"};
+		coordvars2d = {"Nx", "Ny", "Nt"};
+	}
+	else if (type == "stretched") {
+		rc = vdc.DefineCoordVar(
+			"xs", {"Nx"}, "", "", 0, DC::FLOAT, false
+		);
+		if (rc<0) return(-1);
+		rc = vdc.DefineCoordVar(
+			"ys", {"Ny"}, "", "", 1, DC::FLOAT, false
+		);
+		if (rc<0) return(-1);
+		rc = vdc.DefineCoordVar(
+			"zs", {"Nz"}, "", "", 2, DC::FLOAT, false
+		);
+		if (rc<0) return(-1);
+		coordvars = {"xs", "ys", "zs", "Nt"};
+		coordvars2d = {"xs", "ys", "Nt"};
+	}
+	else if (type == "layered") {
+		rc = vdc.DefineCoordVar(
+			"elevation", {"Nx", "Ny", "Nz"}, "", "", 2, DC::FLOAT, false
+		);
+		if (rc<0) return(-1);
+		coordvars = {"Nx", "Ny", "elevation", "Nt"};
+		coordvars2d = {"Nx", "Ny", "Nt"};
+	}
+	else if (type == "curvilinear") {
+		rc = vdc.DefineCoordVar(
+			"xc", {"Nx", "Ny"}, "", "", 0, DC::FLOAT, false
+		);
+		if (rc<0) return(-1);
+		rc = vdc.DefineCoordVar(
+			"yc", {"Nx", "Ny"}, "", "", 1, DC::FLOAT, false
+		);
+		if (rc<0) return(-1);
+		coordvars = {"xc", "yc", "Nz", "Nt"};
+		coordvars2d = {"xc", "yc", "Nt"};
+	}
+	else {
+		MyBase::SetErrMsg("Invalid grid type : %s", type.c_str());
+		return(-1);
+	}
+
+	rc = vdc.SetCompressionBlock(opt.wname, opt.cratios);
+	if (rc<0) return(-1);
+
+	rc = vdc.DefineDataVar("u", dimnames, coordvars, "", DC::FLOAT, true);
+	if (rc<0) return(-1);
+	rc = vdc.DefineDataVar("v", dimnames, coordvars, "", DC::FLOAT, true);
+	if (rc<0) return(-1);
+
+	vector <string> dimnames2d = {"Nx", "Ny", "Nt"};
+	rc = vdc.DefineDataVar("t2", dimnames2d, coordvars2d, "", DC::FLOAT, true);
+	if (rc<0) return(-1);
+
+	rc = vdc.EndDefine();
+	if (rc<0) return(-1);
+
+	// Coordinate data
+	//
+	float t = 0.0;
+	rc = vdc.PutVar(0, "Nt", -1, &t);
+	if (rc<0) return(-1);
+
+	if (type == "regular" || type == "layered" || type == "curvilinear") {
+		rc = put_coord_1d(vdc, "Nx", n, false);
+		if (rc<0) return(-1);
+		rc = put_coord_1d(vdc, "Ny", n, false);
+		if (rc<0) return(-1);
+		rc = put_coord_1d(vdc, "Nz", n, false);
+		if (rc<0) return(-1);
+	}
+
+	if (type == "stretched") {
+		rc = put_coord_1d(vdc, "xs", n, true);
+		if (rc<0) return(-1);
+		rc = put_coord_1d(vdc, "ys", n, true);
+		if (rc<0) return(-1);
+		rc = put_coord_1d(vdc, "zs", n, true);
+		if (rc<0) return(-1);
+	}
+	else if (type == "layered") {
+
+		// Terrain following layers
+		//
+		vector <float> buf(n*n*n);
+		for (size_t k=0; k<n; k++) {
+		for (size_t j=0; j<n; j++) {
+		for (size_t i=0; i<n; i++) {
+			double terrain = 0.1 * sin(M_PI * i / n) * sin(M_PI * j / n);
+			double z = (double) k / (double) (n-1);
+			buf[k*n*n + j*n + i] = terrain + z * (1.0 - terrain);
+		}
+		}
+		}
+		rc = vdc.PutVar(0, "elevation", -1, buf.data());
+		if (rc<0) return(-1);
+	}
+	else if (type == "curvilinear") {
+
+		// Rotated and sheared quadrilaterals
+		//
+		vector <float> xbuf(n*n), ybuf(n*n);
+		for (size_t j=0; j<n; j++) {
+		for (size_t i=0; i<n; i++) {
+			double x = (double) i / (double) (n-1);
+			double y = (double) j / (double) (n-1);
+			xbuf[j*n + i] = x + 0.1 * y;
+			ybuf[j*n + i] = y + 0.05 * sin(M_PI * x);
+		}
+		}
+		rc = vdc.PutVar(0, "xc", -1, xbuf.data());
+		if (rc<0) return(-1);
+		rc = vdc.PutVar(0, "yc", -1, ybuf.data());
+		if (rc<0) return(-1);
+	}
+
+	// Data variables. Only the wavelet encoding is timed
+	//
+	vector <float> buf(n*n*n);
+	const char *vars[] = {"u", "v"};
+	for (int v=0; v<2; v++) {
+		for (size_t k=0; k<n; k++) {
+		for (size_t j=0; j<n; j++) {
+		for (size_t i=0; i<n; i++) {
+			buf[k*n*n + j*n + i] = field(i,j,k,n, 0.25 * v);
+		}
+		}
+		}
+
+		double t0 = Wasp::GetTime();
+		rc = vdc.PutVar(0, vars[v], -1, buf.data());
+		if (rc<0) return(-1);
+		encodeTime += Wasp::GetTime() - t0;
+	}
+
+	for (size_t j=0; j<n; j++) {
+	for (size_t i=0; i<n; i++) {
+		buf[j*n + i] = field(i,j,0,n, 0.0);
+	}
+	}
+	rc = vdc.PutVar(0, "t2", -1, buf.data());
+	if (rc<0) return(-1);
+
+	return(0);
+}
+
+//
+// Derived variable used to benchmark derived variable evaluation:
+// the magnitude of (u, v), read through the DataMgr
+//
+class DerivedSpeedVar : public DerivedDataVar {
+public:
+ DerivedSpeedVar(string name, DataMgr *dataMgr)
+	: DerivedDataVar(name), _dataMgr(dataMgr) {}
+
+ virtual int Initialize() {
+	bool ok = _dataMgr->GetDataVarInfo("u", _dataVarInfo);
+	if (! ok) return(-1);
+	_dataVarInfo.SetName(_derivedVarName);
+	return(0);
+ }
+
+ virtual bool GetBaseVarInfo(DC::BaseVar &var) const {
+	var = _dataVarInfo;
+	return(true);
+ }
+
+ virtual bool GetDataVarInfo(DC::DataVar &var) const {
+	var = _dataVarInfo;
+	return(true);
+ }
+
+ virtual size_t GetNumRefLevels() const {
+	return(_dataMgr->GetNumRefLevels("u"));
+ }
+
+ virtual std::vector <string> GetInputs() const {
+	return(std::vector <string> {"u", "v"});
+ }
+
+ virtual int GetDimLensAtLevel(
+	int level, std::vector <size_t> &dims_at_level,
+	std::vector <size_t> &bs_at_level
+ ) const {
+	return(_dataMgr->GetDimLensAtLevel("u", level, dims_at_level, bs_at_level));
+ }
+
+ virtual int OpenVariableRead(size_t ts, int level=0, int lod=0) {
+	DC::FileTable::FileObject *f = new DC::FileTable::FileObject(
+		ts, _derivedVarName, level, lod
+	);
+	return(_fileTable.AddEntry(f));
+ }
+
+ virtual int CloseVariable(int fd) {
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+	if (! f) return(-1);
+	_fileTable.RemoveEntry(fd);
+	delete f;
+	return(0);
+ }
+
+ virtual int ReadRegionBlock(
+	int fd,
+	const std::vector <size_t> &min, const std::vector <size_t> &max,
+	float *region
+ ) {
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+	if (! f) return(-1);
+
+	vector <size_t> dims, bs;
+	int rc = GetDimLensAtLevel(f->GetLevel(), dims, bs);
+	if (rc<0) return(-1);
+
+	vector <size_t> inMax = max;
+	for (int i=0; i<inMax.size(); i++) {
+		if (inMax[i] >= dims[i]) inMax[i] = dims[i]-1;
+	}
+
+	Grid *u, *v;
+	rc = _getInputs(f, min, inMax, u, v);
+	if (rc<0) return(-1);
+
+	const vector <size_t> &gbs = u->GetBlockSize();
+	size_t blocksize = 1;
+	for (int i=0; i<gbs.size(); i++) blocksize *= gbs[i];
+
+	const vector <float *> &ublks = u->GetBlks();
+	const vector <float *> &vblks = v->GetBlks();
+	for (size_t b=0; b<ublks.size(); b++) {
+		float *out = region + b*blocksize;
+		for (size_t i=0; i<blocksize; i++) {
+			out[i] = sqrt(ublks[b][i]*ublks[b][i] + vblks[b][i]*vblks[b][i]);
+		}
+	}
+
+	_releaseInputs(u, v);
+	return(0);
+ }
+
+ virtual int ReadRegion(
+	int fd,
+	const std::vector <size_t> &min, const std::vector <size_t> &max,
+	float *region
+ ) {
+	DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+	if (! f) return(-1);
+
+	Grid *u, *v;
+	int rc = _getInputs(f, min, max, u, v);
+	if (rc<0) return(-1);
+
+	// Grid iterators visit the region in the same order as it is 
+	// stored in region: fastest varying dimension first
+	//
+	Grid::ConstIterator uitr = u->cbegin();
+	Grid::ConstIterator vitr = v->cbegin();
+	Grid::ConstIterator enditr = u->cend();
+	for (size_t i=0; uitr != enditr; ++uitr, ++vitr, ++i) {
+		region[i] = sqrt((*uitr) * (*uitr) + (*vitr) * (*vitr));
+	}
+
+	_releaseInputs(u, v);
+	return(0);
+ }
+
+ virtual bool VariableExists(size_t ts, int reflevel, int lod) const {
+	return(
+		_dataMgr->VariableExists(ts, "u", reflevel, lod) &&
+		_dataMgr->VariableExists(ts, "v", reflevel, lod)
+	);
+ }
+
+private:
+ DataMgr *_dataMgr;
+ DC::DataVar _dataVarInfo;
+
+ // Read and lock the input variables over a region
+ //
+ int _getInputs(
+	const DC::FileTable::FileObject *f,
+	const std::vector <size_t> &min, const std::vector <size_t> &max,
+	Grid *&u, Grid *&v
+ ) {
+	u = _dataMgr->GetVariable(
+		f->GetTS(), "u", f->GetLevel(), f->GetLOD(), min, max, true
+	);
+	if (! u) return(-1);
+
+	v = _dataMgr->GetVariable(
+		f->GetTS(), "v", f->GetLevel(), f->GetLOD(), min, max, true
+	);
+	if (! v) {
+		_dataMgr->UnlockGrid(u);
+		delete u;
+		return(-1);
+	}
+	return(0);
+ }
+
+ void _releaseInputs(Grid *u, Grid *v) {
+	_dataMgr->UnlockGrid(u);
+	_dataMgr->UnlockGrid(v);
+	delete u;
+	delete v;
+ }
+};
+
+//
+// Benchmarks
+//
+
+DataMgr *open_datamgr(string master) {
+	DataMgr *datamgr = new DataMgr("vdc", opt.memsize, opt.nthreads);
+	int rc = datamgr->Initialize(vector <string> (1, master), vector <string> ());
+	if (rc<0) {
+		delete datamgr;
+		return(NULL);
+	}
+	return(datamgr);
+}
+
+int bench_decode(string master, string type, size_t n) {
+	vector <double> times;
+	vector <float> buf(n*n*n);
+
+	for (int l=0; l<opt.loop; l++) {
+		VDCNetCDF vdc(opt.nthreads);
+		int rc = vdc.Initialize(
+			master, vector <string> (), VDC::R, vector <size_t> (), 0
+		);
+		if (rc<0) return(-1);
+
+		double t0 = Wasp::GetTime();
+		rc = vdc.GetVar(0, "u", -1, -1, buf.data());
+		if (rc<0) return(-1);
+		times.push_back(Wasp::GetTime() - t0);
+	}
+	record(type, n, "wasp_decode", times, n*n*n);
+	return(0);
+}
+
+int bench_datamgr(string master, string type, size_t n) {
+	vector <double> coldTimes, warmTimes;
+
+	for (int l=0; l<opt.loop; l++) {
+		DataMgr *datamgr = open_datamgr(master);
+		if (! datamgr) return(-1);
+
+		double t0 = Wasp::GetTime();
+		Grid *g = datamgr->GetVariable(0, "u", -1, -1);
+		if (! g) {
+			delete datamgr;
+			return(-1);
+		}
+		coldTimes.push_back(Wasp::GetTime() - t0);
+		delete g;
+
+		t0 = Wasp::GetTime();
+		g = datamgr->GetVariable(0, "u", -1, -1);
+		if (! g) {
+			delete datamgr;
+			return(-1);
+		}
+		warmTimes.push_back(Wasp::GetTime() - t0);
+		delete g;
+
+		delete datamgr;
+	}
+	record(type, n, "getvariable_cold", coldTimes, n*n*n);
+	record(type, n, "getvariable_warm", warmTimes, n*n*n);
+	return(0);
+}
+
+int bench_grid(DataMgr *datamgr, string type, size_t n) {
+	Grid *g = datamgr->GetVariable(0, "u", -1, -1);
+	if (! g) return(-1);
+
+	// Iteration over all grid values
+	//
+	vector <double> times;
+	double accum = 0.0;
+	for (int l=0; l<opt.loop; l++) {
+		double t0 = Wasp::GetTime();
+		Grid::ConstIterator itr;
+		Grid::ConstIterator enditr = g->cend();
+		for (itr = g->cbegin(); itr!=enditr; ++itr) {
+			accum += *itr;
+		}
+		times.push_back(Wasp::GetTime() - t0);
+	}
+	record(type, n, "grid_iterate", times, n*n*n);
+
+	// Trilinear interpolation at random points. Fixed seed so runs are
+	// comparable
+	//
+	vector <double> minu, maxu;
+	g->GetUserExtents(minu, maxu);
+	g->SetInterpolationOrder(1);
+
+	vector <vector <double> > points(opt.npoints, vector <double> (3));
+	srand(1);
+	for (int i=0; i<opt.npoints; i++) {
+		for (int d=0; d<3; d++) {
+			double r = (double) rand() / (double) RAND_MAX;
+			points[i][d] = minu[d] + r * (maxu[d] - minu[d]);
+		}
+	}
+
+	times.clear();
+	for (int l=0; l<opt.loop; l++) {
+		double t0 = Wasp::GetTime();
+		for (int i=0; i<opt.npoints; i++) {
+			accum += g->GetValue(points[i]);
+		}
+		times.push_back(Wasp::GetTime() - t0);
+	}
+	record(type, n, "getvalue", times, opt.npoints);
+
+	delete g;
+
+	Sink = accum;
+
+	return(0);
+}
+
+// Contour line extraction on a 2D variable, using the same code as the
+// contour renderer
+//
+int bench_contour(DataMgr *datamgr, string type, size_t n) {
+	Grid *g = datamgr->GetVariable(0, "t2", -1, -1);
+	if (! g) return(-1);
+
+	float range[2];
+	g->GetRange(range);
+
+	vector <double> contours;
+	for (int i=0; i<opt.ncontours; i++) {
+		contours.push_back(
+			range[0] + (range[1]-range[0]) * (i+1) / (opt.ncontours+1)
+		);
+	}
+
+	vector <double> minu, maxu;
+	g->GetUserExtents(minu, maxu);
+
+	vector <double> times;
+	size_t nvertices = 0;
+	for (int l=0; l<opt.loop; l++) {
+		vector <float> vertices;
+		vector <int> contourIndex;
+
+		double t0 = Wasp::GetTime();
+		ContourLines2D(*g, NULL, minu, maxu, contours, vertices, contourIndex);
+		times.push_back(Wasp::GetTime() - t0);
+
+		nvertices = contourIndex.size();
+	}
+	record(type, n, "contour", times, n*n);
+
+	delete g;
+
+	if (! opt.quiet) {
+		cerr << setw(36) << "contour vertices : " << nvertices << endl;
+	}
+	return(0);
+}
+
+int bench_derived(string master, string type, size_t n) {
+	vector <double> times;
+
+	for (int l=0; l<opt.loop; l++) {
+		DataMgr *datamgr = open_datamgr(master);
+		if (! datamgr) return(-1);
+
+		DerivedSpeedVar *dvar = new DerivedSpeedVar("speed", datamgr);
+		int rc = datamgr->AddDerivedVar(dvar);
+		if (rc<0) {
+			delete dvar;
+			delete datamgr;
+			return(-1);
+		}
+
+		double t0 = Wasp::GetTime();
+		Grid *g = datamgr->GetVariable(0, "speed", -1, -1);
+		if (! g) {
+			delete datamgr;
+			return(-1);
+		}
+		times.push_back(Wasp::GetTime() - t0);
+		delete g;
+
+		delete datamgr;
+	}
+	record(type, n, "derived_var", times, n*n*n);
+	return(0);
+}
+
+//
+// Output
+//
+
+void write_json(ostream &out) {
+	out << setprecision(6);
+	out << "{" << endl;
+
+	time_t now = time(NULL);
+	char tbuf[64];
+	strftime(tbuf, sizeof(tbuf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+	out << "  \"vapor\": {" << endl;
+	out << "    \"version\": \""
+		<< json_escape(Version::GetVersionString()) << "\"," << endl;
+	out << "    \"build_hash\": \""
+		<< json_escape(Version::GetBuildHash()) << "\"," << endl;
+	out << "    \"build_type\": \""
+		<< json_escape(Version::GetBuildType()) << "\"" << endl;
+	out << "  }," << endl;
+
+	out << "  \"timestamp\": \"" << tbuf << "\"," << endl;
+
+	string hostname, sysname, release, machine;
+#ifndef WIN32
+	char hbuf[256];
+	if (gethostname(hbuf, sizeof(hbuf)) == 0) {
+		hbuf[sizeof(hbuf)-1] = '\0';
+		hostname = hbuf;
+	}
+	struct utsname uts;
+	if (uname(&uts) == 0) {
+		sysname = uts.sysname;
+		release = uts.release;
+		machine = uts.machine;
+	}
+#endif
+
+	out << "  \"host\": {" << endl;
+	out << "    \"hostname\": \"" << json_escape(hostname) << "\"," << endl;
+	out << "    \"os\": \"" << json_escape(sysname) << "\"," << endl;
+	out << "    \"os_release\": \"" << json_escape(release) << "\"," << endl;
+	out << "    \"machine\": \"" << json_escape(machine) << "\"," << endl;
+	out << "    \"cpu\": \""
+		<< json_escape(proc_value("/proc/cpuinfo", "model name")) << "\","
+		<< endl;
+	out << "    \"ncpus\": " << EasyThreads::NProc() << "," << endl;
+	out << "    \"memory\": \""
+		<< json_escape(proc_value("/proc/meminfo", "MemTotal")) << "\","
+		<< endl;
+#ifdef __VERSION__
+	out << "    \"compiler\": \"" << json_escape(__VERSION__) << "\"" << endl;
+#else
+	out << "    \"compiler\": \"\"" << endl;
+#endif
+	out << "  }," << endl;
+
+	out << "  \"config\": {" << endl;
+	out << "    \"loop\": " << opt.loop << "," << endl;
+	out << "    \"nthreads\": " << opt.nthreads << "," << endl;
+	out << "    \"memsize\": " << opt.memsize << "," << endl;
+	out << "    \"wname\": \"" << json_escape(opt.wname) << "\"," << endl;
+	out << "    \"bs\": [";
+	for (int i=0; i<opt.bs.size(); i++) {
+		out << (i ? ", " : "") << opt.bs[i];
+	}
+	out << "]," << endl;
+	out << "    \"cratios\": [";
+	for (int i=0; i<opt.cratios.size(); i++) {
+		out << (i ? ", " : "") << opt.cratios[i];
+	}
+	out << "]" << endl;
+	out << "  }," << endl;
+
+	out << "  \"results\": [" << endl;
+	for (int i=0; i<Results.size(); i++) {
+		const result_t &r = Results[i];
+
+		double tmin = *min_element(r.times.begin(), r.times.end());
+		double tsum = 0.0;
+		for (int j=0; j<r.times.size(); j++) tsum += r.times[j];
+		double tmean = tsum / r.times.size();
+
+		out << "    {";
+		out << "\"dataset\": \"" << json_escape(r.dataset) << "\", ";
+		out << "\"size\": " << r.size << ", ";
+		out << "\"benchmark\": \"" << json_escape(r.benchmark) << "\", ";
+		out << "\"runs\": " << r.times.size() << ", ";
+		out << "\"min_seconds\": " << tmin << ", ";
+		out << "\"mean_seconds\": " << tmean << ", ";
+		out << "\"items\": " << r.nitems << ", ";
+		out << "\"items_per_second\": " << (tmin > 0.0 ? r.nitems / tmin : 0.0);
+		out << "}" << (i < Results.size()-1 ? "," : "") << endl;
+	}
+	out << "  ]" << endl;
+	out << "}" << endl;
+}
+
+int run(string type, size_t n) {
+
+	ostringstream oss;
+	oss << opt.dir << "/" << type << "_" << n << ".nc";
+	string master = oss.str();
+
+	// Each run rewrites the data set. The last one is used by the
+	// remaining benchmarks
+	//
+	vector <double> encodeTimes;
+	for (int l=0; l<opt.loop; l++) {
+		double encodeTime;
+		int rc = make_dataset(master, type, n, encodeTime);
+		if (rc<0) return(-1);
+		encodeTimes.push_back(encodeTime);
+	}
+	record(type, n, "wasp_encode", encodeTimes, 2*n*n*n);
+
+	int rc = bench_decode(master, type, n);
+	if (rc<0) return(-1);
+
+	rc = bench_datamgr(master, type, n);
+	if (rc<0) return(-1);
+
+	DataMgr *datamgr = open_datamgr(master);
+	if (! datamgr) return(-1);
+
+	rc = bench_grid(datamgr, type, n);
+	if (rc == 0) rc = bench_contour(datamgr, type, n);
+	delete datamgr;
+	if (rc<0) return(-1);
+
+	rc = bench_derived(master, type, n);
+	if (rc<0) return(-1);
+
+	return(0);
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = Basename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options]" << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (argc != 1 || opt.bs.size() != 3 || opt.loop < 1) {
+		cerr << "Usage: " << ProgName << " [options]" << endl;
+		op.PrintOptionHelp(stderr);
+		exit(1);
+	}
+
+	if (opt.debug) {
+		MyBase::SetDiagMsgFilePtr(stderr);
+	}
+
+	if (MkDirHier(opt.dir) < 0) {
+		exit(1);
+	}
+
+	int status = 0;
+	for (int i=0; i<opt.types.size(); i++) {
+		for (int j=0; j<opt.sizes.size(); j++) {
+			int rc = run(opt.types[i], opt.sizes[j]);
+			if (rc<0) {
+				MyBase::SetErrMsg(
+					"Benchmark failed for %s data set of size %d",
+					opt.types[i].c_str(), (int) opt.sizes[j]
+				);
+				status = 1;
+			}
+		}
+	}
+
+	if (opt.output.empty()) {
+		write_json(cout);
+	}
+	else {
+		ofstream out(opt.output.c_str());
+		if (! out) {
+			MyBase::SetErrMsg("Can't open output file %s", opt.output.c_str());
+			exit(1);
+		}
+		write_json(out);
+	}
+
+	exit(status);
+}